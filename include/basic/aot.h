@@ -0,0 +1,222 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file aot.h
+ * @brief Runtime support for programs compiled by basic8k-compile
+ *
+ * basic8k-compile turns a BASIC program into a C file that includes
+ * this header and links against basic8k_core. The generated code keeps
+ * the program image in interpreter memory and runs each statement
+ * either as native C (numeric LET, GOTO, GOSUB, IF) or by handing it
+ * to basic_execute_statement(), so output is byte-identical to the
+ * interpreter. Expressions the compiler does not translate are handed
+ * to eval_expression() the same way.
+ *
+ * The helpers here are what the generated statements call. Each one
+ * mirrors the matching code in execute_statement() exactly, including
+ * which error is raised and when.
+ *
+ * Helpers returning bool return true when straight-line execution must
+ * stop (error, or text_ptr changed) and the caller should re-dispatch
+ * on text_ptr.
+ */
+
+#ifndef BASIC_AOT_H
+#define BASIC_AOT_H
+
+#include "basic/basic.h"
+#include "basic/errors.h"
+#include <string.h>
+
+/*============================================================================
+ * VALUES AND VARIABLES
+ *============================================================================*/
+
+/** MBF constant from its raw bit pattern */
+#define AOT_NUM(bits) ((mbf_t){ .raw = (bits) })
+
+/**
+ * @brief Cached location of a simple numeric variable
+ *
+ * Simple variables never move while a program runs (new ones are
+ * appended, arrays are shifted up), so the table index found by the
+ * first lookup stays valid until CLEAR/RUN empties the table. The
+ * encoded name is re-checked on every use.
+ */
+typedef struct {
+    uint16_t index;     /**< Slot in the variable table (6 bytes each) */
+    uint8_t name[2];    /**< Encoded name as stored in the table */
+} aot_var_t;
+
+/** Initializer for an aot_var_t: first and second name characters */
+#define AOT_VAR(c1, c2) { 0, { (c1), (c2) } }
+
+/* Cached slot, or NULL if the cache is stale */
+static inline uint8_t *aot_var_slot(basic_state_t *s, const aot_var_t *v) {
+    if (v->index >= s->var_count_) return NULL;
+    uint8_t *p = s->memory + s->var_start + v->index * 6u;
+    return (p[0] == v->name[0] && p[1] == v->name[1]) ? p : NULL;
+}
+
+/* Remember where a variable was found */
+static inline void aot_var_remember(basic_state_t *s, aot_var_t *v, const uint8_t *p) {
+    v->index = (uint16_t)((size_t)(p - (s->memory + s->var_start)) / 6u);
+}
+
+/**
+ * @brief Stop the program with an error, as the main loop does
+ * @return Always true
+ */
+static inline bool aot_fail(basic_state_t *s, basic_error_t err) {
+    basic_print_error(s, err, s->current_line);
+    s->running = false;
+    s->can_continue = false;
+    return true;
+}
+
+/** Read a simple numeric variable (0 if it does not exist yet) */
+static inline mbf_t aot_get(basic_state_t *s, aot_var_t *v, const char *name) {
+    uint8_t *p = aot_var_slot(s, v);
+    if (!p) {
+        p = var_find(s, name);
+        if (!p) return MBF_ZERO;
+        aot_var_remember(s, v, p);
+    }
+    mbf_t value;
+    memcpy(&value.raw, p + 2, 4);
+    return value;
+}
+
+/** LET for a simple numeric variable */
+static inline bool aot_set(basic_state_t *s, aot_var_t *v, const char *name, mbf_t value) {
+    uint8_t *p = aot_var_slot(s, v);
+    if (!p) {
+        p = var_get_or_create(s, name);
+        if (!p) return aot_fail(s, ERR_OM);
+        aot_var_remember(s, v, p);
+    }
+    memcpy(p + 2, &value.raw, 4);
+    mem_mark_dirty_at(s, p + 2, 4);
+    return false;
+}
+
+/** Convert an array subscript for LET; overflow is a BS error */
+static inline bool aot_subscript(basic_state_t *s, mbf_t value, int16_t *index) {
+    bool overflow;
+    *index = mbf_to_index(value, &overflow);
+    return overflow ? aot_fail(s, ERR_BS) : false;
+}
+
+/** Array subscript in an expression, as the parser converts it */
+static inline int16_t aot_index(mbf_t value) {
+    bool overflow;
+    return mbf_to_index(value, &overflow);
+}
+
+/** LET for a numeric array element (array_set_numeric() marks the page dirty) */
+static inline bool aot_set_element(basic_state_t *s, const char *name,
+                                   int index1, int index2, mbf_t value) {
+    if (!array_set_numeric(s, name, index1, index2, value)) {
+        return aot_fail(s, ERR_BS);
+    }
+    return false;
+}
+
+/** End of a translated expression: stop on the error it raised */
+static inline bool aot_check(basic_state_t *s, basic_error_t err) {
+    return err != ERR_NONE && aot_fail(s, err);
+}
+
+/**
+ * @brief Evaluate an expression the compiler left to the parser
+ *
+ * @param s Interpreter state
+ * @param ptr Offset of the expression text
+ * @param len Bytes to the end of the statement
+ * @param extent Bytes the expression takes up when the statement reads
+ *               what follows it (0 when it does not)
+ * @param[out] value Result
+ * @return true if it failed
+ */
+static inline bool aot_eval(basic_state_t *s, uint16_t ptr, size_t len, size_t extent,
+                            mbf_t *value) {
+    basic_error_t err;
+    size_t consumed;
+    *value = eval_expression(s, s->memory + ptr, len, &consumed, &err);
+    if (err != ERR_NONE) return aot_fail(s, err);
+    return extent && consumed != extent ? aot_fail(s, ERR_SN) : false;
+}
+
+/** PEEK(addr) */
+static inline mbf_t aot_peek(basic_state_t *s, mbf_t arg) {
+    bool overflow;
+    int16_t addr = mbf_to_int16(arg, &overflow);
+    if (!overflow && addr >= 0 && (uint16_t)addr < s->memory_size) {
+        return mbf_from_int16(s->memory[(uint16_t)addr]);
+    }
+    return MBF_ZERO;
+}
+
+
+/*============================================================================
+ * CONTROL FLOW
+ *============================================================================*/
+
+/** Ctrl-C or program edited: leave straight-line code */
+static inline bool aot_poll(basic_state_t *s, uint32_t gen) {
+    return basic_check_interrupt(s) || s->program_gen != gen;
+}
+
+/** GOTO expr, line number already evaluated */
+static inline bool aot_goto(basic_state_t *s, mbf_t target) {
+    bool overflow;
+    int16_t line_num = mbf_to_int16(target, &overflow);
+    if (overflow || line_num < 0) return aot_fail(s, ERR_UL);
+
+    basic_error_t err = stmt_goto(s, (uint16_t)line_num);
+    return err != ERR_NONE ? aot_fail(s, err) : true;
+}
+
+/** GOSUB expr, return position resolved at compile time */
+static inline bool aot_gosub(basic_state_t *s, mbf_t target, uint16_t return_ptr) {
+    bool overflow;
+    int16_t line_num = mbf_to_int16(target, &overflow);
+    if (overflow || line_num < 0) return aot_fail(s, ERR_UL);
+
+    basic_error_t err = stmt_gosub(s, (uint16_t)line_num, s->current_line, return_ptr);
+    return err != ERR_NONE ? aot_fail(s, err) : true;
+}
+
+/** IF ... THEN line */
+static inline bool aot_goto_line(basic_state_t *s, uint16_t line_num) {
+    basic_error_t err = stmt_goto(s, line_num);
+    return err != ERR_NONE ? aot_fail(s, err) : true;
+}
+
+/**
+ * @brief Run a statement the compiler left to the interpreter
+ *
+ * @param s Interpreter state
+ * @param ptr Offset of the statement text
+ * @param len Length of the statement
+ * @param ctx text_ptr while it runs (the enclosing IF for THEN clauses)
+ * @return true if it failed or moved text_ptr
+ */
+static inline bool aot_exec(basic_state_t *s, uint16_t ptr, size_t len, uint16_t ctx) {
+    basic_error_t err = basic_execute_statement(s, ptr, len);
+    if (err != ERR_NONE) return aot_fail(s, err);
+    return basic_moved(s, ctx);
+}
+
+/** Program stopped after advancing to text_ptr (STOP, END, last line) */
+static inline void aot_stopped(basic_state_t *s) {
+    if (s->can_continue) {
+        s->cont_ptr = s->text_ptr;
+    }
+}
+
+#endif /* BASIC_AOT_H */
@@ -126,6 +126,14 @@
 /** Maximum terminal width (one byte) */
 #define BASIC8K_MAX_WIDTH       255
 
+/** Remembered results per pure DEF FN function (at most 8) */
+#define FN_MEMO_SLOTS           8
+
+/** Bytes of memory[] per checkpoint page (see memory/checkpoint.c) */
+#define CHECKPOINT_PAGE_SIZE    256
+/** Pages in the largest memory[] */
+#define CHECKPOINT_MAX_PAGES    (BASIC8K_MAX_MEMORY / CHECKPOINT_PAGE_SIZE)
+
 
 /* ============================================================================
  * CORE DATA TYPES
@@ -193,6 +201,11 @@ typedef struct {
  *
  * The 'var' pointer points directly to the loop variable in the variable table,
  * avoiding repeated name lookups during iteration.
+ *
+ * When STEP is an exact integer below 2^23 and TO one below 2^24 in
+ * magnitude, NEXT counts in native integers (int_loop). The result is only
+ * used while the sum is below 2^24, where MBF addition of integers is
+ * exact, so the stored bit patterns are the same as mbf_add() would give.
  */
 typedef struct {
     uint16_t line_number;   /**< Line number containing the NEXT statement */
@@ -200,6 +213,11 @@ typedef struct {
     uint8_t *var;           /**< Direct pointer to loop variable value */
     mbf_t limit;            /**< TO value - loop continues while var <= limit (or >= for STEP<0) */
     mbf_t step;             /**< STEP value (default 1) */
+    bool int_loop;          /**< step and limit are small exact integers */
+    int32_t int_step;       /**< step as an integer (int_loop only) */
+    int32_t int_limit;      /**< limit as an integer (int_loop only) */
+    uint32_t int_bits;      /**< Variable bits last stored by NEXT... */
+    int32_t int_value;      /**< ...and the integer they represent */
 } for_entry_t;
 
 /**
@@ -258,6 +276,9 @@ typedef struct {
     bool want_trig;         /**< Enable SIN/COS/TAN/ATN? (original prompted for this) */
     FILE *input;            /**< Input stream (default: stdin) */
     FILE *output;           /**< Output stream (default: stdout) */
+    bool enable_jit;        /**< Compile hot lines to native code (default: off) */
+    bool enable_mat;        /**< Accept extended MAT statements (default: off) */
+    bool enable_instr;      /**< Accept the INSTR function (default: off) */
 } basic_config_t;
 
 /**
@@ -292,6 +313,20 @@ typedef struct {
     /** Number of simple variables currently allocated */
     uint16_t var_count_;
 
+    /**
+     * Bumped whenever the array area is emptied or reloaded, so a cached
+     * position of an array (see quick_stmt_t) can tell it is out of date.
+     * Arrays only ever move as a block when a variable is created.
+     */
+    uint32_t array_gen;
+
+    /**
+     * Pages of memory[] written since the last checkpoint, one bit per
+     * CHECKPOINT_PAGE_SIZE bytes. Every store into memory[] marks its
+     * pages through mem_mark_dirty().
+     */
+    uint64_t dirty_pages[CHECKPOINT_MAX_PAGES / 64];
+
     /* -------------------------------------------------------------------------
      * Execution State
      * ------------------------------------------------------------------------- */
@@ -317,6 +352,14 @@ typedef struct {
     /** Random number generator state */
     rnd_state_t rnd;
 
+    /**
+     * Program edit generation.
+     * Bumped whenever the stored program changes (line insert/delete, NEW,
+     * POKE into program text). Anything cached from program text compares
+     * against this to know when it must be discarded.
+     */
+    uint32_t program_gen;
+
     /* -------------------------------------------------------------------------
      * Control Flow Stacks
      * ------------------------------------------------------------------------- */
@@ -339,11 +382,35 @@ typedef struct {
      * User function definitions (FNA through FNZ).
      * The original supported 26 user functions. Each stores the location
      * of its DEF FN statement for evaluation when called.
+     *
+     * DEF also parses the definition once (stmt_fn_compile). The parsed
+     * form is used while program_gen is unchanged; otherwise, or if the
+     * definition is malformed, a call re-parses the text as before.
+     *
+     * A pure body (numbers, operators, the parameter and the numeric
+     * functions other than RND/USR/FRE/INP/POS/PEEK) always gives the
+     * same result for the same argument bits, so its last FN_MEMO_SLOTS
+     * distinct results are kept in memo[], replaced round-robin.
      */
     struct {
         char name;          /**< Function letter (A-Z), 0 if not defined */
         uint16_t line;      /**< Line number of DEF FN statement */
         uint16_t ptr;       /**< Byte offset to parameter list */
+        bool compiled;      /**< Fields below are valid for gen */
+        uint32_t gen;       /**< program_gen the definition was parsed in */
+        char param[3];      /**< Parameter name */
+        uint16_t param_index; /**< Cached variable table slot of the parameter */
+        uint16_t body;      /**< Offset of the defining expression */
+        uint16_t body_len;  /**< Its length (up to ':' or end of line) */
+        bool pure;          /**< Body depends on the argument only */
+        uint8_t memo_valid; /**< Bit n set: memo[n] holds a result */
+        uint8_t memo_next;  /**< memo[] entry the next result replaces */
+        struct {
+            uint32_t arg;   /**< Argument bits */
+            mbf_t value;    /**< Function value */
+        } memo[FN_MEMO_SLOTS];
+        uint32_t memo_hits;   /**< Calls answered from memo[] */
+        uint32_t memo_misses; /**< Pure calls that evaluated the body */
     } user_funcs[26];
 
     /* -------------------------------------------------------------------------
@@ -355,6 +422,8 @@ typedef struct {
     uint8_t null_count;         /**< NULL statement padding count */
     bool output_suppressed;     /**< Ctrl-O toggle suppresses output */
     bool want_trig;             /**< Trig functions enabled */
+    bool mat_enabled;           /**< Extended MAT statements accepted */
+    bool instr_enabled;         /**< INSTR function accepted */
 
     /** Input stream (usually stdin) */
     FILE *input;
@@ -369,6 +438,7 @@ typedef struct {
     bool can_continue;      /**< true if CONT command is allowed */
     uint16_t cont_line;     /**< Line to continue from after STOP/Ctrl-C */
     uint16_t cont_ptr;      /**< Position within line to continue from */
+    bool loop_to_self;      /**< A NEXT went round to its own offset; see basic_moved() */
 
     /* Hardware stub warning flags - warn only once per session */
     bool warned_inp;        /**< Already warned about INP() stub */
@@ -376,6 +446,18 @@ typedef struct {
     bool warned_wait;       /**< Already warned about WAIT stub */
     bool warned_usr;        /**< Already warned about USR() stub */
 
+    /** Hot-line native code cache (NULL unless the JIT is enabled) */
+    struct basic_jit *jit;
+
+    /** Decoded statement records (allocated on first run) */
+    struct basic_quick *quick;
+
+    /** Folded constant subexpressions (allocated on first use) */
+    struct basic_fold *fold;
+
+    /** DATA item index for READ/RESTORE (allocated on first use) */
+    struct basic_data *data_index;
+
 } basic_state_t;
 
 
@@ -458,6 +540,342 @@ bool basic_execute_line(basic_state_t *state, const char *line);
  */
 void basic_run_program(basic_state_t *state);
 
+/**
+ * Execute one statement stored in program memory.
+ *
+ * Runs the statement at memory[offset] exactly as the main loop would,
+ * including any flow control it performs. state->text_ptr must already
+ * point at the statement. Used by the JIT and by compiled programs.
+ *
+ * @param state   Interpreter state
+ * @param offset  Byte offset of the statement within memory[]
+ * @param len     Length of the statement (up to ':' or end of line)
+ * @return        ERR_NONE on success, error code on failure
+ */
+basic_error_t basic_execute_statement(basic_state_t *state, uint16_t offset, size_t len);
+
+
+/* ============================================================================
+ * HOT-LINE JIT (core/jit.c)
+ *
+ * Optional template JIT for x86-64. basic_run_program() counts how often
+ * each line is entered; once a line is hot, simple LET and integer NEXT
+ * statements are emitted as native code on resolved variable slots and
+ * the rest as calls back into the interpreter. Lines with no such
+ * statement, lines using strings, errors and program edits fall back to
+ * the interpreter.
+ * ============================================================================ */
+
+/** Is the JIT compiled in and supported on this platform? */
+bool jit_available(void);
+
+/** Enable the JIT for an interpreter. Returns false if unavailable. */
+bool jit_init(basic_state_t *state);
+
+/** Release the JIT code cache (safe if never enabled). */
+void jit_free(basic_state_t *state);
+
+/**
+ * Run a whole line through the JIT.
+ *
+ * @param state        Interpreter state, text_ptr at the line's first statement
+ * @param line_offset  Offset of the line header (link field)
+ * @param error        OUT: Error code when JIT_ERROR is returned
+ * @return             JIT_MISS if the line must be interpreted this time,
+ *                     JIT_DECLINED if it must always be (until the program
+ *                     changes), JIT_LINE_DONE if every statement ran,
+ *                     JIT_EXIT if a statement moved text_ptr or stopped the
+ *                     program, JIT_ERROR on error
+ */
+int jit_run_line(basic_state_t *state, uint16_t line_offset, basic_error_t *error);
+
+/** Number of lines currently held as native code. */
+int jit_compiled_lines(const basic_state_t *state);
+
+#define JIT_MISS        0   /**< Not compiled - interpret the line */
+#define JIT_LINE_DONE   1   /**< All statements ran, fall through to next line */
+#define JIT_EXIT        2   /**< Flow left the line (GOTO, NEXT, END, STOP...) */
+#define JIT_ERROR       3   /**< A statement failed; error returned */
+#define JIT_DECLINED    4   /**< Never compiled - interpret the line from now on */
+
+
+/* ============================================================================
+ * STATEMENT QUICKENING (core/quicken.c)
+ *
+ * basic_run_program() decodes each statement the first time it runs into
+ * a quick_stmt_t: owning line, length, and for the commonest shapes the
+ * already-resolved operands. The records live in a side table keyed by
+ * statement offset and are thrown away whenever program_gen changes, so
+ * editing a program in an interactive session costs nothing up front.
+ * ============================================================================ */
+
+/** What a decoded statement can be run as */
+typedef enum {
+    QUICK_GENERIC = 0,  /**< Run through execute_statement() */
+    QUICK_NOP,          /**< Empty, REM or DATA: nothing to do */
+    QUICK_GOTO,         /**< GOTO literal line, target resolved */
+    QUICK_GOSUB,        /**< GOSUB literal line, target and return resolved */
+    QUICK_LET,          /**< Numeric simple variable = expression */
+    QUICK_LET_CONST,    /**< Numeric simple variable = literal */
+    QUICK_LET_INC,      /**< V = V + literal */
+    QUICK_LET_DEC,      /**< V = V - literal */
+    QUICK_LET_VAR,      /**< Numeric simple variable = another one */
+    QUICK_LET_STRING,   /**< String simple variable = another one */
+    QUICK_LET_ELEMENT,  /**< A(V) or A(V,W) = expression, V and W numeric simple variables */
+    QUICK_NEXT,         /**< NEXT with at most one variable */
+    QUICK_IF,           /**< IF expr THEN, clause and false exit resolved */
+    QUICK_ON_GOTO,      /**< ON expr GOTO list, targets resolved */
+    QUICK_ON_GOSUB,     /**< ON expr GOSUB list, targets and return resolved */
+    QUICK_FOR_ARRAY,    /**< FOR whose body is one element-wise array assignment */
+    QUICK_PRINT         /**< PRINT or ?, with a plan compiled on first run */
+} quick_op_t;
+
+/** Most output steps a compiled PRINT statement can have */
+#define PRINT_PLAN_MAX 32
+
+#define PRINT_PLAN_NONE     0   /**< Not compiled: the next run records it */
+#define PRINT_PLAN_READY    1   /**< Recorded: runs replay the steps */
+#define PRINT_PLAN_GENERIC  2   /**< Too many steps: the list is always walked */
+
+/** One output step of a compiled PRINT statement */
+typedef enum {
+    PRINT_LITERAL = 0,  /**< "text" on its own */
+    PRINT_STRING,       /**< Any other string expression */
+    PRINT_NUMBER,       /**< Numeric expression, including string comparisons */
+    PRINT_ZONE,         /**< Comma: next 14-column zone */
+    PRINT_TAB,          /**< TAB(expr) */
+    PRINT_SPC           /**< SPC(expr) */
+} print_op_t;
+
+typedef struct {
+    uint8_t op;             /**< print_op_t */
+    uint8_t length;         /**< LITERAL: characters between the quotes */
+    uint16_t start;         /**< Statement offset of the expression (of the text for LITERAL) */
+} print_item_t;
+
+/**
+ * A PRINT statement compiled on its first complete run: the items it
+ * printed in order and whether it ended with a newline. Separators and
+ * the string-or-number lookahead are resolved, so a replay only
+ * evaluates and outputs.
+ */
+typedef struct {
+    uint8_t status;         /**< PRINT_PLAN_NONE, _READY or _GENERIC */
+    uint8_t count;          /**< Steps in items */
+    bool newline;           /**< The list did not end with ; , TAB or SPC */
+    print_item_t items[PRINT_PLAN_MAX];
+} print_plan_t;
+
+/**
+ * Run the PRINT (or ?) at text[pos] within a statement of len bytes,
+ * replaying plan if it is ready, otherwise walking the list and
+ * recording into it. Output is the same as execute_statement() gives.
+ */
+basic_error_t print_execute(basic_state_t *state, const uint8_t *text, size_t len,
+                            size_t pos, print_plan_t *plan);
+
+/** Loop body of a QUICK_FOR_ARRAY record */
+typedef enum {
+    QUICK_IDIOM_FILL = 0,   /**< A(V) = number */
+    QUICK_IDIOM_COPY,       /**< A(V) = B(V) */
+    QUICK_IDIOM_ADD,        /**< A(V) = B(V) + C(V) */
+    QUICK_IDIOM_SUB,        /**< A(V) = B(V) - C(V) */
+    QUICK_IDIOM_MUL,        /**< A(V) = B(V) * C(V) */
+    QUICK_IDIOM_FUNC        /**< A(V) = f(B(V)), f one of SQR SIN COS TAN ATN LOG EXP */
+} quick_idiom_t;
+
+/**
+ * Decoded form of one statement.
+ *
+ * Everything here is derived from program text only, except var_index,
+ * src_index and for_index, which cache variable slots and the FOR stack
+ * entry, and the LET_ELEMENT array fields, which cache where the target
+ * array is; all are re-checked on use. jit_declined spares the main loop
+ * asking the JIT about a line it has given up on. var_name doubles as the
+ * FOR_ARRAY loop variable and the first LET_ELEMENT subscript, src_name
+ * as the second.
+ */
+typedef struct {
+    uint16_t offset;        /**< Statement offset (table key) */
+    uint16_t line;          /**< Offset of the owning line's link field */
+    uint16_t line_num;      /**< Owning line number */
+    uint16_t len;           /**< Statement length (up to ':' or end of line) */
+    uint8_t op;             /**< quick_op_t */
+    char var_name[3];       /**< LET target / NEXT variable as written */
+    uint8_t var_key[2];     /**< The same, as stored in the variable table */
+    uint16_t var_index;     /**< LET/NEXT: cached variable table slot */
+    uint8_t for_index;      /**< NEXT: FOR stack entry used last time */
+    char src_name[3];       /**< LET_VAR/LET_STRING: source variable as written, LET_ELEMENT: second subscript */
+    uint8_t src_key[2];     /**< The same, as stored in the variable table */
+    uint16_t src_index;     /**< LET_VAR/LET_STRING: cached source slot */
+    uint16_t expr;          /**< LET: offset of the expression, IF: of the condition */
+    uint16_t then_pos;      /**< IF: offset of the THEN token */
+    uint16_t clause;        /**< IF: offset of the THEN clause */
+    uint16_t skip_ptr;      /**< IF: where a false condition continues */
+    uint16_t target;        /**< GOTO/GOSUB/IF: text offset of the target line */
+    uint16_t target_line;   /**< GOTO/GOSUB/IF: target line number */
+    uint16_t return_ptr;    /**< GOSUB/ON GOSUB: where RETURN continues */
+    uint16_t on_keyword;    /**< ON: offset of the GOTO/GOSUB token */
+    uint16_t on_table;      /**< ON: index of the target list */
+    uint8_t on_count;       /**< ON: number of targets */
+    uint16_t plan;          /**< PRINT: index of the print plan */
+    mbf_t value;            /**< LET_CONST/INC/DEC: the literal's value, FOR_ARRAY: fill value */
+    uint8_t idiom;          /**< FOR_ARRAY: quick_idiom_t of the body */
+    uint8_t func;           /**< FOR_ARRAY: function token of a FUNC body */
+    char arrays[3][3];      /**< FOR_ARRAY: target and source array names, LET_ELEMENT: target */
+    uint16_t body;          /**< FOR_ARRAY: offset of the body statement, NEXT: body last checked */
+    uint16_t next_stmt;     /**< FOR_ARRAY: offset of the NEXT statement */
+    uint16_t next_line;     /**< FOR_ARRAY: line number of the NEXT statement */
+    uint8_t subscripts;     /**< LET_ELEMENT: 1 for A(V), 2 for A(V,W) */
+    uint16_t array_at;      /**< LET_ELEMENT: first element, from the start of the array area */
+    uint16_t array_dims[2]; /**< LET_ELEMENT: its highest subscripts (the second is the row stride - 1) */
+    uint32_t array_gen;     /**< LET_ELEMENT: state->array_gen when array_at was found */
+    bool jit_declined;      /**< First statement of a line the JIT will not compile */
+    bool body_empty;        /**< NEXT: nothing runs between body and this NEXT, and the loop may be finished here */
+} quick_stmt_t;
+
+/**
+ * Find (decoding on first use) the statement starting at offset.
+ *
+ * @param state    Interpreter state
+ * @param offset   Statement offset, as held in text_ptr
+ * @param scratch  Used instead of the table if it cannot be allocated
+ * @return         The record, valid until the next quick_lookup(), or
+ *                 NULL if offset is not inside any program line
+ */
+quick_stmt_t *quick_lookup(basic_state_t *state, uint16_t offset, quick_stmt_t *scratch);
+
+/**
+ * Run a decoded statement without re-parsing it.
+ *
+ * @param state  Interpreter state, text_ptr == q->offset
+ * @param q      Record from quick_lookup()
+ * @param error  OUT: Result when the statement was run
+ * @return       false if the statement must go through execute_statement()
+ */
+bool quick_execute(basic_state_t *state, quick_stmt_t *q, basic_error_t *error);
+
+/** Release the statement table (safe if never allocated). */
+void quick_free(basic_state_t *state);
+
+/** Number of statements decoded since the last program change. */
+size_t quick_decoded_statements(const basic_state_t *state);
+
+
+/* ============================================================================
+ * CONSTANT FOLDING (core/fold.c)
+ *
+ * The expression parser remembers the value of every pure constant
+ * subexpression it evaluates in program text (numbers, arithmetic and
+ * numeric functions of numbers, no variables, RND, FN, PEEK or strings),
+ * keyed by text offset and grammar level. Later evaluations take the
+ * stored bit pattern and skip the text. Spans that are not constant are
+ * remembered too so they are not re-analysed, and expressions with
+ * nothing to fold are evaluated without tracking. Records are dropped
+ * when program_gen changes.
+ * ============================================================================ */
+
+/** Grammar levels a folded span can belong to */
+typedef enum {
+    FOLD_UNARY = 0,     /**< One operand: [+|-]primary[^primary...] */
+    FOLD_MUL,           /**< Leading constant operands of a * / chain */
+    FOLD_ADD            /**< Leading constant operands of a + - chain */
+} fold_level_t;
+
+/**
+ * Look up a span.
+ *
+ * @param state    Interpreter state
+ * @param offset   Offset of the span's first byte in memory[]
+ * @param level    fold_level_t the span was parsed at
+ * @param end      OUT: Offset just past the span (0: span is not constant)
+ * @param value    OUT: The span's value when constant
+ * @return         true if the span has been analysed before
+ */
+bool fold_lookup(basic_state_t *state, uint16_t offset, uint8_t level,
+                 uint16_t *end, mbf_t *value);
+
+/**
+ * Record the result of analysing a span.
+ *
+ * @param end    Offset just past the constant span, or 0 if not constant
+ * @param value  Its value (ignored when end is 0)
+ */
+void fold_store(basic_state_t *state, uint16_t offset, uint8_t level,
+                uint16_t end, mbf_t value);
+
+/**
+ * Has the expression starting at offset been evaluated in full without
+ * meeting anything worth folding? The parser then evaluates it without
+ * tracking spans.
+ */
+bool fold_plain(basic_state_t *state, uint16_t offset);
+
+/** Record that the expression starting at offset has nothing to fold. */
+void fold_store_plain(basic_state_t *state, uint16_t offset);
+
+/** Release the folding table (safe if never allocated). */
+void fold_free(basic_state_t *state);
+
+/** Number of constant spans known since the last program change. */
+size_t fold_constant_spans(const basic_state_t *state);
+
+
+/* ============================================================================
+ * DATA INDEX (core/data_index.c)
+ *
+ * READ remembers, per position of the DATA pointer, where the next item
+ * is and how data_line changes on the way there, and per item the value
+ * a numeric READ converted. RESTORE n binary-searches a table of the
+ * program's lines. Everything is dropped when program_gen changes.
+ * ============================================================================ */
+
+/**
+ * Look up where the DATA scan from a position finds its next item.
+ *
+ * @param state    Interpreter state
+ * @param from     data_ptr the scan starts from (0: start of program)
+ * @param item     OUT: Offset of the item
+ * @param crossed  OUT: true if the scan moved to another line
+ * @param line     OUT: data_line after the move (only if crossed)
+ * @return         true if the scan from this position is known
+ */
+bool data_index_next(basic_state_t *state, uint16_t from, uint16_t *item,
+                     bool *crossed, uint16_t *line);
+
+/** Record the result of a DATA scan (see data_index_next()). */
+void data_index_store_next(basic_state_t *state, uint16_t from, uint16_t item,
+                           bool crossed, uint16_t line);
+
+/**
+ * Look up the numeric value of a DATA item.
+ *
+ * @param item   Offset of the item, as found by the scan
+ * @param value  OUT: Its value as a numeric READ converts it
+ * @param end    OUT: Offset where the item ends (the next data_ptr)
+ * @return       true if the item has been read as a number before
+ */
+bool data_index_value(basic_state_t *state, uint16_t item, mbf_t *value, uint16_t *end);
+
+/** Record the numeric value of a DATA item. */
+void data_index_store_value(basic_state_t *state, uint16_t item, mbf_t value, uint16_t end);
+
+/**
+ * Find the first line numbered line_num or higher, for RESTORE n.
+ *
+ * @param num   OUT: Its line number
+ * @param text  OUT: Offset of its text, or 0 if there is no such line
+ * @return      false if the line table could not be built
+ */
+bool data_index_find_line(basic_state_t *state, uint16_t line_num,
+                          uint16_t *num, uint16_t *text);
+
+/** Release the DATA index (safe if never allocated). */
+void data_index_free(basic_state_t *state);
+
+/** Number of DATA scan results known since the last program change. */
+size_t data_index_items(const basic_state_t *state);
+
 
 /* ============================================================================
  * FILE I/O
@@ -508,6 +926,17 @@ void basic_setup_interrupt(basic_state_t *state);
  */
 void basic_clear_interrupt(void);
 
+/**
+ * Handle a pending Ctrl-C at a statement boundary.
+ *
+ * Prints "BREAK IN line", stops the program and records the CONT
+ * position. Compiled programs call this before every statement.
+ *
+ * @param state  Interpreter state, text_ptr at the next statement
+ * @return       true if execution was interrupted
+ */
+bool basic_check_interrupt(basic_state_t *state);
+
 
 /* ============================================================================
  * PROGRAM LISTING
@@ -572,6 +1001,63 @@ void basic_print_error(basic_state_t *state, basic_error_t err, uint16_t line);
 mbf_t eval_expression(basic_state_t *state, const uint8_t *text, size_t len,
                       size_t *consumed, basic_error_t *error);
 
+/**
+ * Evaluate an integer argument (array subscript, CHR$, TAB, SPC) that is a
+ * lone simple variable or integer literal directly followed by ',' or ')'.
+ *
+ * Gives the same value and overflow flag as mbf_to_int16() of
+ * eval_expression() over the same text, without running the parser.
+ *
+ * @param state     Interpreter state
+ * @param text      Tokenized text at the argument
+ * @param len       Length of text buffer
+ * @param consumed  OUT: Bytes up to the ',' or ')'
+ * @param value     OUT: Argument as mbf_to_int16() converts it
+ * @param overflow  OUT: mbf_to_int16() overflow flag
+ * @return          false if the argument needs eval_expression()
+ */
+bool eval_int_operand(basic_state_t *state, const uint8_t *text, size_t len,
+                      size_t *consumed, int16_t *value, bool *overflow);
+
+/** Relational operators: =, <, >, <=, >=, <> */
+typedef enum {
+    REL_EQ, REL_LT, REL_GT, REL_LE, REL_GE, REL_NE
+} eval_relation_t;
+
+/**
+ * Numeric comparison: MBF_TRUE (-1) or MBF_ZERO, from one integer compare
+ * of the order keys (see mbf_order_key()).
+ */
+static inline mbf_t eval_compare(mbf_t a, mbf_t b, eval_relation_t relation) {
+    int32_t ka = mbf_order_key(a);
+    int32_t kb = mbf_order_key(b);
+
+    bool result = false;
+    switch (relation) {
+        case REL_EQ: result = ka == kb; break;
+        case REL_LT: result = ka < kb; break;
+        case REL_GT: result = ka > kb; break;
+        case REL_LE: result = ka <= kb; break;
+        case REL_GE: result = ka >= kb; break;
+        case REL_NE: result = ka != kb; break;
+    }
+    return result ? MBF_TRUE : MBF_ZERO;
+}
+
+/**
+ * One step of a ^ chain, as the parser evaluates it.
+ *
+ * Returns MBF_ZERO without computing anything if *error is already set.
+ * Otherwise sets *error to ERR_OV on overflow, or ERR_FC for a negative
+ * number raised to a fractional power, and returns MBF_ZERO.
+ *
+ * @param base      Left operand
+ * @param exponent  Right operand, sign already applied
+ * @param error     IN/OUT: error of the expression so far
+ * @return          base ^ exponent
+ */
+mbf_t eval_power(mbf_t base, mbf_t exponent, basic_error_t *error);
+
 /**
  * Evaluate a string expression.
  *
@@ -704,7 +1190,7 @@ string_desc_t string_copy(basic_state_t *state, string_desc_t src);
 /** Concatenate two strings. */
 string_desc_t string_concat(basic_state_t *state, string_desc_t a, string_desc_t b);
 
-/** Compare two strings. Returns <0, 0, >0 like strcmp. */
+/** Compare two strings (bytes, then length). Returns -1, 0 or 1. */
 int string_compare(basic_state_t *state, string_desc_t a, string_desc_t b);
 
 /** LEFT$: Get leftmost n characters. */
@@ -785,6 +1271,116 @@ uint16_t program_next_line(basic_state_t *state, uint16_t line_num);
 /** Clear the entire program. */
 void program_clear(basic_state_t *state);
 
+/**
+ * Replace the program with a pre-built image of tokenized lines.
+ *
+ * The image is the raw program area (linked lines as stored by
+ * program_insert_line) and must have been built for the same
+ * program_start. Used by compiled programs (basic8k-compile).
+ *
+ * @param state  Interpreter state
+ * @param image  Program area bytes
+ * @param size   Number of bytes in the image
+ * @return       true on success, false if it does not fit in memory
+ */
+bool program_load_image(basic_state_t *state, const uint8_t *image, size_t size);
+
+
+/* ============================================================================
+ * CHECKPOINTS (memory/checkpoint.c)
+ *
+ * A checkpoint holds the pages of memory[] written since the previous one
+ * plus the registers outside memory[] (region boundaries, execution
+ * position, stacks, RND and DEF FN). The first checkpoint of a session,
+ * or one taken with full = true, holds every page. A chain of one full
+ * checkpoint followed by deltas restores the state as of its last entry.
+ * ============================================================================ */
+
+/**
+ * Registers saved with a checkpoint.
+ *
+ * FOR entries are stored with var = NULL; for_var[] holds each loop
+ * variable's offset in memory[] instead.
+ */
+typedef struct {
+    uint16_t program_start;     /**< Region boundaries, as in basic_state_t */
+    uint16_t program_end;
+    uint16_t var_start;
+    uint16_t array_start;
+    uint16_t string_start;
+    uint16_t string_end;
+    uint16_t var_count;         /**< basic_state_t.var_count_ */
+    uint16_t current_line;      /**< Execution position */
+    uint16_t text_ptr;
+    uint16_t data_line;
+    uint16_t data_ptr;
+    rnd_state_t rnd;
+    for_entry_t for_stack[16];
+    uint16_t for_var[16];       /**< Loop variable offsets for for_stack[] */
+    int for_sp;
+    gosub_entry_t gosub_stack[16];
+    int gosub_sp;
+    char fn_name[26];           /**< DEF FN letters (0 if undefined)... */
+    uint16_t fn_line[26];       /**< ...their DEF lines... */
+    uint16_t fn_ptr[26];        /**< ...and parameter list offsets */
+    uint8_t terminal_x;
+    bool can_continue;
+    uint16_t cont_line;
+    uint16_t cont_ptr;
+} checkpoint_regs_t;
+
+/** One checkpoint: changed pages of memory[] and the registers. */
+typedef struct {
+    uint32_t memory_size;       /**< Size of the memory[] it was taken from */
+    bool full;                  /**< Holds every page (a chain starts with one) */
+    uint16_t page_count;        /**< Pages stored */
+    uint16_t *pages;            /**< Their page numbers, ascending */
+    uint8_t *data;              /**< page_count * CHECKPOINT_PAGE_SIZE bytes */
+    checkpoint_regs_t regs;     /**< Registers at the time it was taken */
+} basic_checkpoint_t;
+
+/**
+ * Record a store of len bytes at memory[offset] for the next checkpoint.
+ */
+static inline void mem_mark_dirty(basic_state_t *state, uint32_t offset, uint32_t len) {
+    if (len == 0) return;
+    uint32_t last = (offset + len - 1) / CHECKPOINT_PAGE_SIZE;
+    for (uint32_t page = offset / CHECKPOINT_PAGE_SIZE; page <= last; page++) {
+        state->dirty_pages[page / 64] |= (uint64_t)1 << (page % 64);
+    }
+}
+
+/** mem_mark_dirty() for a pointer into memory[]. */
+static inline void mem_mark_dirty_at(basic_state_t *state, const uint8_t *ptr, uint32_t len) {
+    mem_mark_dirty(state, (uint32_t)(ptr - state->memory), len);
+}
+
+/**
+ * Take a checkpoint of the pages written since the last one.
+ *
+ * @param state  Interpreter state (its dirty pages are cleared)
+ * @param full   Store every page, to start a new chain
+ * @return       The checkpoint (free with basic_checkpoint_free()), or
+ *               NULL if out of memory
+ */
+basic_checkpoint_t *basic_checkpoint(basic_state_t *state, bool full);
+
+/**
+ * Restore a chain of checkpoints.
+ *
+ * chain[0] must be full and all entries must come from a memory[] of this
+ * state's size; otherwise nothing is changed. Pages are applied in order
+ * and the registers of the last entry are loaded. Later checkpoints of
+ * this state are deltas against the restored image, so they can extend
+ * the same chain. Cached program data is discarded.
+ *
+ * @return  true if the chain was applied
+ */
+bool basic_restore(basic_state_t *state, basic_checkpoint_t *const *chain, size_t count);
+
+/** Release a checkpoint (safe with NULL). */
+void basic_checkpoint_free(basic_checkpoint_t *checkpoint);
+
 
 /* ============================================================================
  * CONTROL FLOW STATEMENTS (statements/flow.c)
@@ -808,6 +1404,45 @@ basic_error_t stmt_for(basic_state_t *state, const char *var_name,
 /** NEXT: Advance loop variable, continue or exit loop. */
 basic_error_t stmt_next(basic_state_t *state, const char *var_name, bool *continue_loop);
 
+/**
+ * NEXT with the loop variable already resolved.
+ *
+ * @param state          Interpreter state
+ * @param var            Loop variable entry, or NULL for a bare NEXT
+ * @param hint           IN/OUT: FOR stack index this NEXT used last time
+ * @param continue_loop  OUT: true if the loop goes round again
+ * @return               ERR_NONE or ERR_NF
+ */
+basic_error_t stmt_next_var(basic_state_t *state, uint8_t *var, uint8_t *hint,
+                            bool *continue_loop);
+
+/**
+ * Whether the statement just run from offset moved execution elsewhere:
+ * text_ptr changed, or a NEXT went round to itself. Clears the NEXT flag.
+ *
+ * @param state  Interpreter state
+ * @param from   text_ptr before the statement ran
+ * @return       true if execution continues at text_ptr
+ */
+static inline bool basic_moved(basic_state_t *state, uint16_t from) {
+    if (state->text_ptr != from) return true;
+    if (!state->loop_to_self) return false;
+    state->loop_to_self = false;
+    return true;
+}
+
+/**
+ * Run the innermost FOR loop to its end in one step.
+ *
+ * For a NEXT that has just continued a loop whose body runs nothing: the
+ * variable gets the value the remaining NEXTs would leave and the entry
+ * is popped. Only exact integer loops with a non-zero step qualify.
+ *
+ * @param state  Interpreter state
+ * @return       false if the loop was left as it was
+ */
+bool stmt_next_finish(basic_state_t *state);
+
 /** Evaluate IF condition (non-zero = true). */
 bool stmt_if_eval(mbf_t condition);
 
@@ -861,6 +1496,9 @@ void io_tab(basic_state_t *state, int column);
 /** SPC: Output specified number of spaces. */
 void io_spc(basic_state_t *state, int count);
 
+/** PRINT comma: advance to the next 14-column zone. */
+void io_zone(basic_state_t *state);
+
 /** Read a line of input. Returns true if successful. */
 bool io_input_line(basic_state_t *state, char *buf, size_t bufsize, size_t *len);
 
@@ -892,6 +1530,27 @@ basic_error_t stmt_width(basic_state_t *state, int width);
 int io_pos(basic_state_t *state);
 
 
+/* ============================================================================
+ * MAT STATEMENTS (statements/mat.c)
+ *
+ * Extended-dialect whole-array statements, accepted only when the
+ * interpreter was initialized with basic_config_t.enable_mat.
+ * ============================================================================ */
+
+/** Does the statement at text (its first byte) start with MAT? */
+bool stmt_mat_match(const uint8_t *text, size_t len);
+
+/**
+ * MAT READ, MAT PRINT or MAT assignment.
+ *
+ * @param state Interpreter state
+ * @param text  Statement text, starting at the MAT keyword
+ * @param len   Length of the statement text
+ * @return ERR_NONE, ERR_SN for bad syntax, ERR_BS for mismatched shapes
+ */
+basic_error_t stmt_mat(basic_state_t *state, const uint8_t *text, size_t len);
+
+
 /* ============================================================================
  * MISCELLANEOUS STATEMENTS (statements/misc.c)
  * ============================================================================ */
@@ -917,6 +1576,31 @@ basic_error_t stmt_dim(basic_state_t *state, const char *arr_name, int dim1, int
 basic_error_t stmt_def_fn(basic_state_t *state, char fn_name,
                           uint16_t line, uint16_t ptr);
 
+/** Parse the definition of user function fn_idx (0-25) for fast calls. */
+void stmt_fn_compile(basic_state_t *state, int fn_idx);
+
+/**
+ * Call user function fn_idx through its parsed definition.
+ *
+ * @param state   Interpreter state
+ * @param fn_idx  Function index (0-25)
+ * @param arg     Argument value
+ * @param result  OUT: Function value
+ * @param error   OUT: Error from evaluating the body
+ * @return        false if there is no valid parsed form; the caller
+ *                must then interpret the definition text itself
+ */
+bool stmt_fn_call(basic_state_t *state, int fn_idx, mbf_t arg,
+                  mbf_t *result, basic_error_t *error);
+
+/**
+ * Memo statistics of user function fn_idx since it was last defined.
+ *
+ * @return false if fn_idx is not a defined function with a pure body
+ */
+bool stmt_fn_memo_stats(const basic_state_t *state, int fn_idx,
+                        uint32_t *hits, uint32_t *misses);
+
 /** Look up a user function definition. */
 basic_error_t stmt_fn_lookup(basic_state_t *state, char fn_name,
                              uint16_t *line, uint16_t *ptr);
@@ -988,6 +1672,27 @@ void rnd_seed_from_mbf(rnd_state_t *state, mbf_t seed);
 /** Generate next random value. */
 mbf_t rnd_next(rnd_state_t *state, mbf_t arg);
 
+/**
+ * @brief Advance the RNG as if RND(1) were called n times
+ *
+ * Long skips find the tail and cycle of the generator's orbit and walk
+ * only the tail plus n modulo the cycle length. The last few orbits
+ * found are cached per thread, so repeated and chained skips search once.
+ *
+ * @param state RNG state
+ * @param n     Number of values to skip
+ */
+void rnd_skip(rnd_state_t *state, uint64_t n);
+
+/**
+ * @brief Generate n values into a buffer
+ *
+ * @param state RNG state
+ * @param out   Receives the values RND(1) would return, in order
+ * @param n     Number of values
+ */
+void rnd_fill(rnd_state_t *state, mbf_t *out, size_t n);
+
 
 /* ============================================================================
  * NUMERIC FUNCTIONS (functions/numeric.c)
@@ -1027,7 +1732,7 @@ string_desc_t fn_str(basic_state_t *state, mbf_t value); /**< STR$: Number to st
 mbf_t fn_val(basic_state_t *state, string_desc_t str);  /**< VAL: String to number */
 
 /**
- * INSTR: Find substring position.
+ * INSTR: Find substring position (parsed only with enable_instr).
  * @param start  Starting position (1-based)
  * @return       Position found (1-based), or 0 if not found
  */
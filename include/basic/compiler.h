@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file compiler.h
+ * @brief BASIC to C translator used by basic8k-compile
+ *
+ * Translates the program currently stored in an interpreter into a
+ * C17 source file. The generated file includes "basic/aot.h", links
+ * against basic8k_core and behaves exactly like running the program
+ * with `basic8k file.bas` (banner, output, errors, final OK).
+ *
+ * ## What Gets Compiled
+ *
+ * Every statement gets a C label and a case in a dispatch switch on
+ * text_ptr. Numeric LET, GOTO, GOSUB and IF with expressions made of
+ * numbers, simple variables, array elements, arithmetic, relational
+ * and logical operators and the numeric functions become straight C
+ * calls into the MBF library. Everything else (PRINT, INPUT, FOR/NEXT,
+ * ON, READ, strings, ...) is run by the interpreter's own statement
+ * code, so semantics never drift. Computed GOTO, ON...GOSUB, RETURN
+ * and NEXT re-enter compiled code through the dispatch switch.
+ */
+
+#ifndef BASIC_COMPILER_H
+#define BASIC_COMPILER_H
+
+#include "basic/basic.h"
+#include <stdio.h>
+
+/**
+ * @brief Options baked into the generated program
+ */
+typedef struct {
+    const char *source_name;    /**< Shown in the generated header comment */
+    uint32_t memory_size;       /**< Same as basic8k -m */
+    uint8_t terminal_width;     /**< Same as basic8k -w */
+} compiler_options_t;
+
+/**
+ * @brief Write the stored program of @p state as a C source file
+ *
+ * @param state Interpreter holding the tokenized program
+ * @param out Stream receiving the C source
+ * @param options Generation options
+ * @return true on success, false on I/O or memory failure
+ */
+bool compile_program(basic_state_t *state, FILE *out,
+                     const compiler_options_t *options);
+
+#endif /* BASIC_COMPILER_H */
@@ -214,6 +214,13 @@ typedef union {
  */
 #define MBF_ONE     ((mbf_t){.raw = 0x81000000})
 
+/**
+ * @brief MBF representation of -1.0, the value of a true relation
+ *
+ * Same bits as mbf_from_int16(-1): exponent 0x81 with the sign bit set.
+ */
+#define MBF_TRUE    ((mbf_t){.raw = 0x81800000})
+
 
 /*============================================================================
  * BASIC ARITHMETIC OPERATIONS
@@ -227,9 +234,10 @@ typedef union {
  *
  * Algorithm:
  * 1. If either is zero, return the other
- * 2. Align mantissas by shifting the smaller exponent's mantissa right
+ * 2. Align mantissas by shifting the smaller exponent's mantissa right,
+ *    keeping the 8 bits shifted out in a rounding byte
  * 3. Add mantissas (handling signs)
- * 4. Normalize result
+ * 4. Normalize result and round on bit 7 of the rounding byte
  *
  * @param a First operand
  * @param b Second operand
@@ -303,7 +311,12 @@ mbf_t mbf_div(mbf_t a, mbf_t b);
  * @param a Value to negate
  * @return -a
  */
-mbf_t mbf_neg(mbf_t a);
+static inline mbf_t mbf_neg(mbf_t a) {
+    if (a.bytes.exponent != 0) {
+        a.bytes.mantissa_hi ^= 0x80;  /* Flip sign bit; -0 = 0 */
+    }
+    return a;
+}
 
 /**
  * @brief Absolute value of MBF number
@@ -313,7 +326,10 @@ mbf_t mbf_neg(mbf_t a);
  * @param a Input value
  * @return |a| (always non-negative)
  */
-mbf_t mbf_abs(mbf_t a);
+static inline mbf_t mbf_abs(mbf_t a) {
+    a.bytes.mantissa_hi &= 0x7F;  /* Clear sign bit */
+    return a;
+}
 
 
 /*============================================================================
@@ -329,11 +345,7 @@ mbf_t mbf_abs(mbf_t a);
  * @param b Second value
  * @return -1 if a < b, 0 if a == b, +1 if a > b
  *
- * Comparison algorithm:
- * 1. Handle zero cases (exponent = 0)
- * 2. Compare signs (negative < positive)
- * 3. Compare exponents (for same sign)
- * 4. Compare mantissas (for same exponent)
+ * Both values are mapped to mbf_order_key() and the keys compared.
  */
 int mbf_cmp(mbf_t a, mbf_t b);
 
@@ -373,6 +385,26 @@ static inline bool mbf_is_negative(mbf_t a) {
     return !mbf_is_zero(a) && (a.bytes.mantissa_hi & 0x80);
 }
 
+/**
+ * @brief Signed integer that orders like the MBF value
+ *
+ * The magnitude bits (exponent above the 23 mantissa bits) already sort
+ * like the magnitude; negative values negate them and every zero maps
+ * to 0, whatever its mantissa. So mbf_cmp(a, b) has the sign of
+ * mbf_order_key(a) - mbf_order_key(b), and a relation is one integer
+ * compare.
+ *
+ * @param a Value
+ * @return Key in -0x7FFFFFFF..0x7FFFFFFF
+ */
+static inline int32_t mbf_order_key(mbf_t a) {
+    uint32_t exponent = a.raw >> 24;
+    int32_t magnitude = (int32_t)((exponent << 23) | (a.raw & 0x7FFFFF));
+    int32_t negative = -(int32_t)((a.raw >> 23) & 1);
+    int32_t key = (magnitude ^ negative) - negative;
+    return exponent ? key : 0;
+}
+
 
 /*============================================================================
  * INTEGER/MBF CONVERSION
@@ -424,6 +456,27 @@ mbf_t mbf_from_int32(int32_t n);
  */
 int16_t mbf_to_int16(mbf_t a, bool *overflow);
 
+/**
+ * @brief mbf_to_int16() for array subscripts and other small integers
+ *
+ * Positive values below 32768 are decoded straight from the bits,
+ * truncating as mbf_to_int16() does; anything else is passed to it.
+ * Value and overflow flag are always those of mbf_to_int16().
+ *
+ * @param a MBF value to convert
+ * @param[out] overflow Set to true if value doesn't fit in int16_t
+ * @return Integer value, or 0 if overflow
+ */
+static inline int16_t mbf_to_index(mbf_t a, bool *overflow) {
+    uint32_t exponent = a.raw >> 24;
+    if (exponent >= MBF_BIAS && exponent <= MBF_BIAS + 14 && !(a.raw & 0x800000)) {
+        uint32_t mantissa = (a.raw & 0x7FFFFF) | 0x800000;
+        *overflow = false;
+        return (int16_t)(mantissa >> (23 - (exponent - MBF_BIAS)));
+    }
+    return mbf_to_int16(a, overflow);
+}
+
 /**
  * @brief Convert MBF to signed 32-bit integer
  *
@@ -574,6 +627,37 @@ mbf_t mbf_log(mbf_t a);
  */
 mbf_t mbf_exp(mbf_t a);
 
+/**
+ * @brief Exponentiation (the ^ operator)
+ *
+ * X^0 is 1 and 0^Y is 0 otherwise. Integer powers whose value is exactly
+ * representable (2^N, 3^10, 0.5^-20, ...) are computed exactly; other
+ * powers 1..10 by repeated mbf_mul(); everything else as EXP(Y*LOG(X))
+ * in double precision.
+ *
+ * @param base     X
+ * @param exponent Y
+ * @return X raised to the power Y
+ *
+ * Sets MBF_DOMAIN for a negative X with a non-integer Y, and
+ * MBF_OVERFLOW if the result is too large.
+ */
+mbf_t mbf_pow(mbf_t base, mbf_t exponent);
+
+/**
+ * @brief Transcendental functions over n contiguous values
+ *
+ * out[i] = mbf_sin(in[i]) and so on for i < n, with the same results and
+ * error flags as the scalar loop. out may be the same array as in.
+ */
+void mbf_sqr_n(mbf_t *out, const mbf_t *in, size_t n);
+void mbf_sin_n(mbf_t *out, const mbf_t *in, size_t n);  /**< @copydoc mbf_sqr_n */
+void mbf_cos_n(mbf_t *out, const mbf_t *in, size_t n);  /**< @copydoc mbf_sqr_n */
+void mbf_tan_n(mbf_t *out, const mbf_t *in, size_t n);  /**< @copydoc mbf_sqr_n */
+void mbf_atn_n(mbf_t *out, const mbf_t *in, size_t n);  /**< @copydoc mbf_sqr_n */
+void mbf_log_n(mbf_t *out, const mbf_t *in, size_t n);  /**< @copydoc mbf_sqr_n */
+void mbf_exp_n(mbf_t *out, const mbf_t *in, size_t n);  /**< @copydoc mbf_sqr_n */
+
 
 /*============================================================================
  * IEEE DOUBLE CONVERSION
@@ -638,9 +722,12 @@ mbf_t mbf_normalize(mbf_t a);
  * @param a MBF value
  * @return 24-bit mantissa (0x800000 to 0xFFFFFF for normalized values)
  *
- * Returns 0 for zero inputs.
+ * Returns 0 for zero inputs. Inline because every arithmetic routine
+ * unpacks its operands through it.
  */
-uint32_t mbf_get_mantissa24(mbf_t a);
+static inline uint32_t mbf_get_mantissa24(mbf_t a) {
+    return a.bytes.exponent ? (a.raw & 0x7FFFFF) | 0x800000 : 0;
+}
 
 /**
  * @brief Create MBF from components
@@ -653,7 +740,14 @@ uint32_t mbf_get_mantissa24(mbf_t a);
  * @param mantissa24 24-bit mantissa with implicit bit
  * @return Constructed MBF value
  */
-mbf_t mbf_make(bool negative, uint8_t exponent, uint32_t mantissa24);
+static inline mbf_t mbf_make(bool negative, uint8_t exponent, uint32_t mantissa24) {
+    mbf_t result;
+    result.raw = exponent ? ((uint32_t)exponent << 24) |
+                            ((uint32_t)negative << 23) |
+                            (mantissa24 & 0x7FFFFF)
+                          : 0;
+    return result;
+}
 
 
 /*============================================================================
@@ -704,4 +798,51 @@ void mbf_clear_error(void);
  */
 void mbf_set_error(mbf_error_t err);
 
+
+/*============================================================================
+ * BATCH OPERATIONS (mbf_batch.c)
+ *
+ * The arithmetic above applied to n contiguous values at once, with SIMD
+ * where the CPU has it. Results and the error flag are exactly those of
+ * the equivalent loop over the scalar function. out may be the same
+ * array as an input.
+ *============================================================================*/
+
+/** Implementations of the batch operations */
+typedef enum {
+    MBF_BATCH_SCALAR = 0,   /**< Loop over the scalar functions */
+    MBF_BATCH_SSE2,         /**< x86 SSE2, 4 values per step */
+    MBF_BATCH_AVX2          /**< x86 AVX2, 8 values per step */
+} mbf_batch_level_t;
+
+/** @brief out[i] = mbf_add(a[i], b[i]) for i < n */
+void mbf_add_n(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n);
+
+/** @brief out[i] = mbf_mul(a[i], b[i]) for i < n */
+void mbf_mul_n(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n);
+
+/** @brief out[i] = mbf_cmp(a[i], b[i]) for i < n */
+void mbf_cmp_n(int8_t *out, const mbf_t *a, const mbf_t *b, size_t n);
+
+/** @brief out[i] = mbf_from_int16(in[i]) for i < n */
+void mbf_from_int16_n(mbf_t *out, const int16_t *in, size_t n);
+
+/**
+ * @brief Can this CPU (and build) run the given implementation?
+ */
+bool mbf_batch_supported(mbf_batch_level_t level);
+
+/**
+ * @brief Select the implementation used by the batch operations
+ *
+ * By default the fastest supported one is used.
+ *
+ * @param level Implementation to use
+ * @return false (and no change) if it is not supported
+ */
+bool mbf_batch_use(mbf_batch_level_t level);
+
+/** @brief Implementation the batch operations currently use */
+mbf_batch_level_t mbf_batch_level(void);
+
 #endif /* BASIC8K_MBF_H */
@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file compile.c
+ * @brief basic8k-compile Entry Point
+ *
+ * Translates a BASIC program into a C17 source file that links against
+ * basic8k_core. The resulting executable behaves exactly like
+ * `basic8k file.bas` (same banner, output, RND sequence, errors and final
+ * OK) but runs without the interpreter's per-statement overhead.
+ *
+ * ## Usage
+ *
+ * ```
+ *   basic8k-compile game.bas -o game.c
+ *   cc -std=c17 -O2 -Iinclude game.c -Lbuild -lbasic8k_core -lm -o game
+ * ```
+ *
+ * ## Command Line Options
+ *
+ * - `-o FILE` : Write the C source to FILE (default: standard output)
+ * - `-m SIZE` : Memory size baked into the program (default: 65536)
+ * - `-w WIDTH` : Terminal width baked into the program (default: 72)
+ * - `-h` : Show help
+ */
+
+#include "basic/basic.h"
+#include "basic/compiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "Altair 8K BASIC 4.0 compiler (BASIC to C)\n");
+    fprintf(stderr, "Usage: %s [options] file.bas\n", program);
+    fprintf(stderr, "\nOptions:\n");
+    fprintf(stderr, "  -o FILE    Write C source to FILE (default: stdout)\n");
+    fprintf(stderr, "  -m SIZE    Set memory size in bytes (default: 65536)\n");
+    fprintf(stderr, "  -w WIDTH   Set terminal width (default: 72)\n");
+    fprintf(stderr, "  -h         Show this help\n");
+}
+
+int main(int argc, char *argv[]) {
+    compiler_options_t options = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH
+    };
+    const char *output_file = NULL;
+
+    /* Parse command line arguments */
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') {
+            switch (argv[i][1]) {
+                case 'o':
+                    if (i + 1 < argc) {
+                        output_file = argv[++i];
+                    }
+                    break;
+                case 'm':
+                    if (i + 1 < argc) {
+                        options.memory_size = (uint32_t)atoi(argv[++i]);
+                    }
+                    break;
+                case 'w':
+                    if (i + 1 < argc) {
+                        options.terminal_width = (uint8_t)atoi(argv[++i]);
+                    }
+                    break;
+                case 'h':
+                    print_usage(argv[0]);
+                    return 0;
+                default:
+                    fprintf(stderr, "Unknown option: %s\n", argv[i]);
+                    print_usage(argv[0]);
+                    return 1;
+            }
+        } else {
+            options.source_name = argv[i];
+        }
+    }
+
+    if (!options.source_name) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    /* Load the program exactly as basic8k would */
+    basic_config_t config = {
+        .memory_size = options.memory_size,
+        .terminal_width = options.terminal_width,
+        .want_trig = true,
+        .input = stdin,
+        .output = stderr
+    };
+    basic_state_t *state = basic_init(&config);
+    if (!state) {
+        fprintf(stderr, "Error: Failed to initialize interpreter\n");
+        return 1;
+    }
+
+    if (!basic_load_file(state, options.source_name)) {
+        fprintf(stderr, "Error: Failed to load '%s'\n", options.source_name);
+        basic_free(state);
+        return 1;
+    }
+
+    FILE *out = output_file ? fopen(output_file, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Cannot create '%s'\n", output_file);
+        basic_free(state);
+        return 1;
+    }
+
+    bool ok = compile_program(state, out, &options);
+    if (output_file && fclose(out) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write C source\n");
+    }
+
+    basic_free(state);
+    return ok ? 0 : 1;
+}
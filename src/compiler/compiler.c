@@ -0,0 +1,1262 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file compiler.c
+ * @brief BASIC to C Translator (basic8k-compile)
+ *
+ * Turns a tokenized program into a C file whose run function is one big
+ * block of labelled statements:
+ *
+ * ```
+ *   S_4:                                  ; 10 S=S+I*I
+ *       s->text_ptr = 4;
+ *       if (aot_poll(s, gen)) goto dispatch;
+ *       s->current_line = 10;
+ *       {
+ *           mbf_t t1 = aot_get(s, &v0, "S");
+ *           mbf_t t2 = aot_get(s, &v1, "I");
+ *           ...
+ *           if (aot_set(s, &v0, "S", t4)) goto dispatch;
+ *       }
+ *   S_17:                                 ; 20 PRINT S
+ *       ...
+ *       if (aot_exec(s, 17, 7, 17)) goto dispatch;
+ * ```
+ *
+ * Statements that change text_ptr in ways only known at run time (NEXT,
+ * RETURN, ON, computed GOTO) jump to `dispatch`, a switch over every
+ * statement offset, which lands back on the right label.
+ *
+ * ## Exactness
+ *
+ * The program image is kept in interpreter memory byte for byte, so
+ * DATA/READ, RESTORE, PEEK, LIST, FOR/NEXT and GOSUB/RETURN positions are
+ * exactly those of the interpreter. The expression compiler below walks
+ * the recursive descent of parser.c and emits the calls it would make,
+ * through the same helpers, in the same order. An expression holding
+ * anything it does not translate (FN, INSTR, strings, ^ chains) is
+ * evaluated by eval_expression() over the same bytes, and a statement it
+ * cannot follow at all (syntax errors) falls back to
+ * basic_execute_statement(), so an unusual program is slower but never
+ * different.
+ */
+
+#include "basic/compiler.h"
+#include "basic/tokens.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*============================================================================
+ * OUTPUT BUFFER
+ *
+ * Generated code is assembled in memory: a statement that turns out not
+ * to be compilable is rolled back, and the variable table must be
+ * written before the function that uses it.
+ *============================================================================*/
+
+#if defined(__GNUC__)
+#define CG_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define CG_PRINTF(fmt, args)
+#endif
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;        /**< Allocation failed; output is incomplete */
+} cg_buf_t;
+
+CG_PRINTF(2, 3)
+static void buf_printf(cg_buf_t *b, const char *fmt, ...) {
+    if (b->failed) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        b->failed = true;
+        return;
+    }
+
+    size_t need = b->len + (size_t)n + 1;
+    if (need > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < need) cap *= 2;
+        char *data = realloc(b->data, cap);
+        if (!data) {
+            b->failed = true;
+            return;
+        }
+        b->data = data;
+        b->cap = cap;
+    }
+
+    va_start(ap, fmt);
+    vsnprintf(b->data + b->len, b->cap - b->len, fmt, ap);
+    va_end(ap);
+    b->len += (size_t)n;
+}
+
+
+/*============================================================================
+ * COMPILER STATE
+ *============================================================================*/
+
+/** Maximum distinct simple variables given an inline cache */
+#define CG_MAX_VARS 1024
+
+/** Result of compiling an expression */
+typedef struct {
+    bool literal;       /**< Number literal: value is known now */
+    mbf_t value;        /**< Literal value */
+    int temp;           /**< Otherwise: index of the mbf_t temporary */
+} cg_val_t;
+
+/** How control leaves a compiled statement */
+typedef enum {
+    CG_FAIL,            /**< Not compilable: emit a fallback instead */
+    CG_NEXT,            /**< Falls through to the next statement */
+    CG_NEXT_MAY_STOP,   /**< Falls through, but may have stopped the program */
+    CG_JUMPS            /**< Never falls through */
+} cg_flow_t;
+
+typedef struct {
+    basic_state_t *state;
+    const uint8_t *mem;
+
+    cg_buf_t *code;             /**< Receives the current statement */
+    int temps;                  /**< Temporaries used so far in run() */
+
+    /* Expression scanner over one statement (mirrors parse_state_t) */
+    const uint8_t *text;
+    size_t pos;
+    size_t len;
+    uint16_t base;              /**< Offset of text in memory[] */
+    bool ok;                    /**< Still exactly reproducible */
+    bool parse;                 /**< Evaluation is left to the parser */
+    int err;                    /**< Its error variable, 0 if none yet */
+
+    /* Simple variables with an inline cache: first spelling seen */
+    char vars[CG_MAX_VARS][3];
+    int var_count;
+
+    /* Every label, for the dispatch switch */
+    uint16_t *labels;
+    size_t label_count;
+    size_t label_cap;
+} compiler_t;
+
+static uint8_t peek(compiler_t *c) {
+    return c->pos < c->len ? c->text[c->pos] : 0;
+}
+
+static uint8_t consume(compiler_t *c) {
+    return c->pos < c->len ? c->text[c->pos++] : 0;
+}
+
+static void skip_space(compiler_t *c) {
+    while (c->pos < c->len && c->text[c->pos] == ' ') c->pos++;
+}
+
+static bool expect(compiler_t *c, uint8_t expected) {
+    skip_space(c);
+    if (peek(c) == expected) {
+        consume(c);
+        return true;
+    }
+    return false;
+}
+
+/* Give up on exact reproduction of the current statement */
+static cg_val_t fail(compiler_t *c) {
+    c->ok = false;
+    return (cg_val_t){ .temp = 0 };
+}
+
+/* C operand for a value: literal constant or temporary */
+static const char *operand(const cg_val_t *v, char *buf, size_t size) {
+    if (v->literal) {
+        snprintf(buf, size, "AOT_NUM(0x%08XU)", (unsigned)v->value.raw);
+    } else {
+        snprintf(buf, size, "t%d", v->temp);
+    }
+    return buf;
+}
+
+/* Emit "mbf_t tN = <expr>;" and return tN */
+CG_PRINTF(2, 3)
+static cg_val_t emit_temp(compiler_t *c, const char *fmt, ...) {
+    char expr[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(expr, sizeof(expr), fmt, ap);
+    va_end(ap);
+
+    cg_val_t v = { .temp = ++c->temps };
+    buf_printf(c->code, "        mbf_t t%d = %s;\n", v.temp, expr);
+    return v;
+}
+
+/* Inline cache index for a simple variable, or -1 if the table is full */
+static int intern_var(compiler_t *c, const char *name) {
+    uint8_t n0 = (uint8_t)toupper((unsigned char)name[0]);
+    uint8_t n1 = (uint8_t)toupper((unsigned char)name[1]);
+
+    for (int i = 0; i < c->var_count; i++) {
+        if ((uint8_t)toupper((unsigned char)c->vars[i][0]) == n0 &&
+            (uint8_t)toupper((unsigned char)c->vars[i][1]) == n1) {
+            return i;
+        }
+    }
+    if (c->var_count >= CG_MAX_VARS) return -1;
+
+    memcpy(c->vars[c->var_count], name, 3);
+    return c->var_count++;
+}
+
+/* Line number -> offset of its text, or 0 if there is no such line */
+static uint16_t find_line_text(compiler_t *c, uint16_t line_num) {
+    const basic_state_t *st = c->state;
+    uint16_t ptr = st->program_start;
+
+    while (ptr < st->program_end) {
+        uint16_t link = (uint16_t)(c->mem[ptr] | (c->mem[ptr + 1] << 8));
+        uint16_t num = (uint16_t)(c->mem[ptr + 2] | (c->mem[ptr + 3] << 8));
+        if (num == line_num) return (uint16_t)(ptr + 4);
+        if (link == 0) break;
+        ptr = link;
+    }
+    return 0;
+}
+
+
+/*============================================================================
+ * EXPRESSIONS
+ *
+ * One function per level of parser.c, consuming exactly the same bytes
+ * and emitting the operations parser.c would perform, left to right,
+ * through the same helpers: eval_power() for ^, eval_compare() for
+ * relations, mbf_to_index() for subscripts. Operations on literals are
+ * done now, with the same calls, as the fold table would at run time.
+ *
+ * Whatever else the grammar allows (FN, INSTR, strings, functions of
+ * strings, FRE, POS, USR, INP, ^ chains) is only scanned for its extent.
+ * The evaluation containing it is then left to eval_expression() itself
+ * (see c_evaluate()), so there is one grammar for those, not two.
+ *============================================================================*/
+
+static cg_val_t c_expression(compiler_t *c);
+static cg_val_t c_unary(compiler_t *c);
+
+/* Same test as is_string_expr_start() in parser.c */
+static bool is_string_expr_start(compiler_t *c) {
+    size_t save_pos = c->pos;
+    skip_space(c);
+    uint8_t ch = peek(c);
+
+    bool is_string = false;
+    if (ch == '"' || TOK_IS_STRING_FUNC(ch)) {
+        is_string = true;
+    } else if (isalpha(ch)) {
+        consume(c);
+        if (c->pos < c->len && isalnum(peek(c))) {
+            consume(c);
+        }
+        if (peek(c) == '$') {
+            is_string = true;
+        }
+    }
+
+    c->pos = save_pos;
+    return is_string;
+}
+
+/* Same test as is_instr() in parser.c */
+static bool is_instr(compiler_t *c) {
+    static const char name[] = "INSTR(";
+    if (c->len - c->pos < sizeof(name) - 1) return false;
+    for (size_t i = 0; i < sizeof(name) - 1; i++) {
+        if (toupper(c->text[c->pos + i]) != name[i]) return false;
+    }
+    return true;
+}
+
+/* Skip "( ... )" up to the matching parenthesis, outside quotes */
+static bool scan_parens(compiler_t *c) {
+    skip_space(c);
+    if (peek(c) != '(') return false;
+
+    int depth = 0;
+    bool in_string = false;
+    while (c->pos < c->len) {
+        uint8_t ch = consume(c);
+        if (ch == '"') {
+            in_string = !in_string;
+        } else if (!in_string && ch == '(') {
+            depth++;
+        } else if (!in_string && ch == ')' && --depth == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Skip what parse_string_term() reads */
+static bool scan_string_term(compiler_t *c) {
+    skip_space(c);
+    uint8_t ch = peek(c);
+
+    if (ch == '"') {
+        consume(c);
+        while (c->pos < c->len && c->text[c->pos] != '"' && c->text[c->pos] != '\0') {
+            c->pos++;
+        }
+        if (peek(c) == '"') consume(c);
+        return true;
+    }
+    if (TOK_IS_STRING_FUNC(ch)) {
+        consume(c);
+        return scan_parens(c);
+    }
+    if (!isalpha(ch)) return false;
+
+    consume(c);
+    while (c->pos < c->len && isalnum(peek(c))) consume(c);
+    if (peek(c) != '$') return false;
+    consume(c);
+    skip_space(c);
+    return peek(c) == '(' ? scan_parens(c) : true;
+}
+
+/* Skip what parse_string_arg() reads */
+static bool scan_string_arg(compiler_t *c) {
+    if (!scan_string_term(c)) return false;
+
+    skip_space(c);
+    while (peek(c) == '+' || peek(c) == TOK_PLUS) {
+        consume(c);
+        if (!scan_string_term(c)) return false;
+        skip_space(c);
+    }
+    return true;
+}
+
+/* Skip a string comparison, as the string branch of parse_relational() */
+static bool scan_string_relation(compiler_t *c) {
+    if (!scan_string_arg(c)) return false;
+
+    skip_space(c);
+    uint8_t op = peek(c);
+    bool lt = op == TOK_LT || op == '<';
+    bool gt = op == TOK_GT || op == '>';
+    if (!lt && !gt && op != TOK_EQ && op != '=') return false;
+    consume(c);
+
+    uint8_t op2 = peek(c);
+    bool eq2 = op2 == TOK_EQ || op2 == '=';
+    if ((lt && (eq2 || op2 == TOK_GT || op2 == '>')) || (gt && eq2)) {
+        consume(c);
+    }
+    return scan_string_arg(c);
+}
+
+/* The construct just scanned is for the parser (see c_evaluate()) */
+static cg_val_t parsed(compiler_t *c, bool scanned) {
+    if (!scanned) return fail(c);
+    c->parse = true;
+    return (cg_val_t){ .temp = 0 };
+}
+
+static cg_val_t literal(mbf_t value) {
+    return (cg_val_t){ .literal = true, .value = value };
+}
+
+/* Error variable of the current evaluation (declared on first use) */
+static int error_var(compiler_t *c) {
+    if (!c->err) {
+        c->err = ++c->temps;
+        buf_printf(c->code, "        basic_error_t e%d = ERR_NONE;\n", c->err);
+    }
+    return c->err;
+}
+
+static cg_val_t c_negate(compiler_t *c, cg_val_t v) {
+    if (v.literal) return literal(mbf_neg(v.value));
+    char a[32];
+    return emit_temp(c, "mbf_neg(%s)", operand(&v, a, sizeof(a)));
+}
+
+/* One ^ step; done now only if it raises nothing and nothing is pending */
+static cg_val_t c_pow(compiler_t *c, cg_val_t left, cg_val_t right) {
+    if (left.literal && right.literal && !c->err) {
+        basic_error_t err = ERR_NONE;
+        mbf_t value = eval_power(left.value, right.value, &err);
+        if (err == ERR_NONE) return literal(value);
+    }
+
+    char a[32], b[32];
+    int e = error_var(c);
+    return emit_temp(c, "eval_power(%s, %s, &e%d)", operand(&left, a, sizeof(a)),
+                     operand(&right, b, sizeof(b)), e);
+}
+
+/* Apply mul/div/add/sub, or emit the call */
+static cg_val_t c_arith(compiler_t *c, mbf_t (*fn)(mbf_t, mbf_t), const char *name,
+                        cg_val_t left, cg_val_t right) {
+    if (left.literal && right.literal) return literal(fn(left.value, right.value));
+    char a[32], b[32];
+    return emit_temp(c, "%s(%s, %s)", name, operand(&left, a, sizeof(a)),
+                     operand(&right, b, sizeof(b)));
+}
+
+/* NOT, AND and OR as parser.c computes them */
+static mbf_t logical_not(mbf_t a) {
+    return mbf_from_int16((int16_t)~mbf_to_int16(a, NULL));
+}
+
+static mbf_t logical_and(mbf_t a, mbf_t b) {
+    return mbf_from_int16((int16_t)(mbf_to_int16(a, NULL) & mbf_to_int16(b, NULL)));
+}
+
+static mbf_t logical_or(mbf_t a, mbf_t b) {
+    return mbf_from_int16((int16_t)(mbf_to_int16(a, NULL) | mbf_to_int16(b, NULL)));
+}
+
+static mbf_t sgn_value(mbf_t a) {
+    return mbf_from_int16((int16_t)mbf_sign(a));
+}
+
+static cg_val_t c_number(compiler_t *c) {
+    size_t start = c->pos;
+    size_t n = 0;
+
+    /* Same scan as parse_number() */
+    while (n < 63) {
+        uint8_t ch = peek(c);
+        if (isdigit(ch) || ch == '.' || ch == 'E' || ch == 'e') {
+            consume(c);
+            n++;
+        } else if ((ch == '+' || ch == '-' || ch == TOK_PLUS || ch == TOK_MINUS) &&
+                   n > 0 && (c->text[c->pos - 1] == 'E' || c->text[c->pos - 1] == 'e')) {
+            consume(c);
+            n++;
+        } else {
+            break;
+        }
+    }
+
+    /* Let the real parser convert it */
+    size_t consumed;
+    basic_error_t err;
+    mbf_t value = eval_expression(NULL, c->text + start, c->pos - start,
+                                  &consumed, &err);
+    if (err != ERR_NONE || consumed != c->pos - start) return fail(c);
+
+    return literal(value);
+}
+
+static cg_val_t c_function(compiler_t *c, uint8_t token) {
+    static const struct {
+        uint8_t token;
+        const char *open;       /* Call text before the argument */
+        const char *close;      /* ... and after it */
+        mbf_t (*pure)(mbf_t);   /* Same call, for a literal argument */
+    } functions[] = {
+        { TOK_ABS,  "mbf_abs(", ")", mbf_abs },
+        { TOK_SGN,  "mbf_from_int16((int16_t)mbf_sign(", "))", sgn_value },
+        { TOK_INT,  "mbf_int(", ")", mbf_int },
+        { TOK_SQR,  "mbf_sqr(", ")", mbf_sqr },
+        { TOK_RND,  "basic_rnd(s, ", ")", NULL },
+        { TOK_SIN,  "mbf_sin(", ")", mbf_sin },
+        { TOK_COS,  "mbf_cos(", ")", mbf_cos },
+        { TOK_TAN,  "mbf_tan(", ")", mbf_tan },
+        { TOK_ATN,  "mbf_atn(", ")", mbf_atn },
+        { TOK_LOG,  "mbf_log(", ")", mbf_log },
+        { TOK_EXP,  "mbf_exp(", ")", mbf_exp },
+        { TOK_PEEK, "aot_peek(s, ", ")", NULL },
+    };
+
+    size_t fn = sizeof(functions) / sizeof(functions[0]);
+    for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+        if (functions[i].token == token) fn = i;
+    }
+    /* String argument, FRE, POS, USR, INP */
+    if (fn == sizeof(functions) / sizeof(functions[0])) return parsed(c, scan_parens(c));
+
+    if (!expect(c, '(')) return fail(c);
+    cg_val_t arg = c_expression(c);
+    if (!c->ok || !expect(c, ')')) return fail(c);
+
+    if (arg.literal && functions[fn].pure) {
+        return literal(functions[fn].pure(arg.value));
+    }
+    char a[32];
+    return emit_temp(c, "%s%s%s", functions[fn].open,
+                     operand(&arg, a, sizeof(a)), functions[fn].close);
+}
+
+/* Array subscript as parse_int_operand() converts it (overflow ignored) */
+static const char *subscript(const cg_val_t *v, char *buf, size_t size) {
+    if (v->literal) {
+        bool overflow;
+        snprintf(buf, size, "%d", mbf_to_index(v->value, &overflow));
+    } else {
+        snprintf(buf, size, "aot_index(t%d)", v->temp);
+    }
+    return buf;
+}
+
+static cg_val_t c_variable(compiler_t *c) {
+    char name[3] = {0};
+    name[0] = (char)consume(c);
+    if (c->pos < c->len && isalnum(peek(c))) {
+        name[1] = (char)consume(c);
+    }
+    while (c->pos < c->len && isalnum(peek(c))) {
+        consume(c);
+    }
+
+    /* String variable in numeric context: 0, as parse_primary() */
+    if (peek(c) == '$') {
+        consume(c);
+        return literal(MBF_ZERO);
+    }
+
+    char a[32], b[32];
+    if (peek(c) == '(') {
+        consume(c);
+        cg_val_t idx1 = c_expression(c);
+        if (!c->ok) return idx1;
+
+        bool two = false;
+        cg_val_t idx2 = { .temp = 0 };
+        if (peek(c) == ',') {
+            consume(c);
+            idx2 = c_expression(c);
+            if (!c->ok) return idx2;
+            two = true;
+        }
+        if (!expect(c, ')')) return fail(c);
+
+        return emit_temp(c, "array_get_numeric(s, \"%s\", %s, %s)", name,
+                         subscript(&idx1, a, sizeof(a)),
+                         two ? subscript(&idx2, b, sizeof(b)) : "-1");
+    }
+
+    int var = intern_var(c, name);
+    if (var < 0) return emit_temp(c, "var_get_numeric(s, \"%s\")", name);
+    return emit_temp(c, "aot_get(s, &v%d, \"%s\")", var, name);
+}
+
+static cg_val_t c_primary(compiler_t *c) {
+    skip_space(c);
+    uint8_t ch = peek(c);
+
+    if (ch == '(') {
+        consume(c);
+        cg_val_t v = c_expression(c);
+        if (!c->ok || !expect(c, ')')) return fail(c);
+        return v;
+    }
+
+    if (isdigit(ch) || ch == '.') {
+        return c_number(c);
+    }
+
+    if (TOK_IS_FUNCTION(ch)) {
+        consume(c);
+        return c_function(c, ch);
+    }
+
+    bool is_fn = (ch == TOK_FN) ||
+                 (toupper(ch) == 'F' &&
+                  c->pos + 1 < c->len && toupper(c->text[c->pos + 1]) == 'N' &&
+                  c->pos + 2 < c->len && isalpha(c->text[c->pos + 2]));
+    if (is_fn) {
+        c->pos += ch == TOK_FN ? 1 : 2;
+        if (!isalpha(peek(c))) return fail(c);
+        consume(c);
+        return parsed(c, scan_parens(c));
+    }
+
+    /* INSTR, or when it is disabled the array IN(): the parser decides */
+    if (is_instr(c)) {
+        c->pos += 5;
+        return parsed(c, scan_parens(c));
+    }
+
+    if (isalpha(ch)) {
+        return c_variable(c);
+    }
+
+    return fail(c);
+}
+
+static cg_val_t c_power(compiler_t *c) {
+    cg_val_t left = c_primary(c);
+
+    for (int steps = 0; c->ok && peek(c) == TOK_POW; steps++) {
+        consume(c);
+
+        /* The exponent may carry its own sign: X^-1 */
+        skip_space(c);
+        uint8_t sign = peek(c);
+        if (sign == TOK_MINUS || sign == TOK_PLUS) consume(c);
+        cg_val_t right = c_primary(c);
+        if (!c->ok) break;
+        if (sign == TOK_MINUS) right = c_negate(c, right);
+
+        /* After an error parse_power() stops reading at the next ^ */
+        if (steps > 0) c->parse = true;
+        left = c_pow(c, left, right);
+    }
+
+    return left;
+}
+
+static cg_val_t c_unary(compiler_t *c) {
+    skip_space(c);
+    uint8_t op = peek(c);
+
+    if (op == TOK_PLUS) {
+        consume(c);
+        return c_unary(c);
+    } else if (op == TOK_MINUS) {
+        consume(c);
+        cg_val_t v = c_unary(c);
+        if (!c->ok) return v;
+        return c_negate(c, v);
+    }
+
+    return c_power(c);
+}
+
+static cg_val_t c_multiplicative(compiler_t *c) {
+    cg_val_t left = c_unary(c);
+
+    while (c->ok) {
+        skip_space(c);
+        uint8_t op = peek(c);
+        if (op != TOK_MUL && op != TOK_DIV) break;
+
+        consume(c);
+        cg_val_t right = c_unary(c);
+        if (!c->ok) break;
+
+        left = op == TOK_MUL ? c_arith(c, mbf_mul, "mbf_mul", left, right)
+                             : c_arith(c, mbf_div, "mbf_div", left, right);
+    }
+
+    return left;
+}
+
+static cg_val_t c_additive(compiler_t *c) {
+    cg_val_t left = c_multiplicative(c);
+
+    while (c->ok) {
+        skip_space(c);
+        uint8_t op = peek(c);
+        if (op != TOK_PLUS && op != TOK_MINUS) break;
+
+        consume(c);
+        cg_val_t right = c_multiplicative(c);
+        if (!c->ok) break;
+
+        left = op == TOK_PLUS ? c_arith(c, mbf_add, "mbf_add", left, right)
+                              : c_arith(c, mbf_sub, "mbf_sub", left, right);
+    }
+
+    return left;
+}
+
+static cg_val_t c_relational(compiler_t *c) {
+    if (is_string_expr_start(c)) return parsed(c, scan_string_relation(c));
+
+    cg_val_t left = c_additive(c);
+    if (!c->ok) return left;
+
+    skip_space(c);
+    uint8_t op = peek(c);
+    if (op != TOK_EQ && op != TOK_LT && op != TOK_GT) return left;
+
+    consume(c);
+    uint8_t op2 = peek(c);
+    eval_relation_t relation = REL_EQ;
+    const char *name = "REL_EQ";
+    if (op == TOK_LT) {
+        if (op2 == TOK_GT) {
+            consume(c);
+            relation = REL_NE;
+            name = "REL_NE";
+        } else if (op2 == TOK_EQ) {
+            consume(c);
+            relation = REL_LE;
+            name = "REL_LE";
+        } else {
+            relation = REL_LT;
+            name = "REL_LT";
+        }
+    } else if (op == TOK_GT) {
+        if (op2 == TOK_EQ) {
+            consume(c);
+            relation = REL_GE;
+            name = "REL_GE";
+        } else {
+            relation = REL_GT;
+            name = "REL_GT";
+        }
+    }
+
+    cg_val_t right = c_additive(c);
+    if (!c->ok) return right;
+
+    if (left.literal && right.literal) {
+        return literal(eval_compare(left.value, right.value, relation));
+    }
+    char a[32], b[32];
+    return emit_temp(c, "eval_compare(%s, %s, %s)", operand(&left, a, sizeof(a)),
+                     operand(&right, b, sizeof(b)), name);
+}
+
+static cg_val_t c_not(compiler_t *c) {
+    if (peek(c) == TOK_NOT) {
+        consume(c);
+        cg_val_t v = c_not(c);
+        if (!c->ok) return v;
+        if (v.literal) return literal(logical_not(v.value));
+        char a[32];
+        return emit_temp(c, "mbf_from_int16((int16_t)~mbf_to_int16(%s, NULL))",
+                         operand(&v, a, sizeof(a)));
+    }
+    return c_relational(c);
+}
+
+static cg_val_t c_and(compiler_t *c) {
+    cg_val_t left = c_not(c);
+
+    while (c->ok && peek(c) == TOK_AND) {
+        consume(c);
+        cg_val_t right = c_not(c);
+        if (!c->ok) break;
+
+        if (left.literal && right.literal) {
+            left = literal(logical_and(left.value, right.value));
+            continue;
+        }
+        char a[32], b[32];
+        left = emit_temp(c, "mbf_from_int16((int16_t)(mbf_to_int16(%s, NULL) & "
+                         "mbf_to_int16(%s, NULL)))",
+                         operand(&left, a, sizeof(a)), operand(&right, b, sizeof(b)));
+    }
+
+    return left;
+}
+
+static cg_val_t c_or(compiler_t *c) {
+    cg_val_t left = c_and(c);
+
+    while (c->ok && peek(c) == TOK_OR) {
+        consume(c);
+        cg_val_t right = c_and(c);
+        if (!c->ok) break;
+
+        if (left.literal && right.literal) {
+            left = literal(logical_or(left.value, right.value));
+            continue;
+        }
+        char a[32], b[32];
+        left = emit_temp(c, "mbf_from_int16((int16_t)(mbf_to_int16(%s, NULL) | "
+                         "mbf_to_int16(%s, NULL)))",
+                         operand(&left, a, sizeof(a)), operand(&right, b, sizeof(b)));
+    }
+
+    return left;
+}
+
+static cg_val_t c_expression(compiler_t *c) {
+    skip_space(c);
+    return c_or(c);
+}
+
+/**
+ * @brief One eval_expression() call of the interpreter
+ *
+ * Translated when every construct in it is. Otherwise the code emitted
+ * for it is dropped and eval_expression() runs over the same bytes, so
+ * evaluation order, side effects and the error raised are the parser's.
+ *
+ * @param c Compiler
+ * @param checked The statement reads what follows, so the expression
+ *                must end where the scan did
+ * @return Value (a literal, or a temporary)
+ */
+static cg_val_t c_evaluate(compiler_t *c, bool checked) {
+    size_t mark = c->code->len;
+    int temps = c->temps;
+    size_t start = c->pos;
+    c->err = 0;
+    c->parse = false;
+
+    cg_val_t v = c_expression(c);
+    if (!c->ok) return v;
+
+    if (c->parse) {
+        c->code->len = mark;
+        c->temps = temps;
+        v = (cg_val_t){ .temp = ++c->temps };
+        buf_printf(c->code, "        mbf_t t%d;\n", v.temp);
+        buf_printf(c->code, "        if (aot_eval(s, %u, %zu, %zu, &t%d)) goto dispatch;\n",
+                   (unsigned)(c->base + start), c->len - start,
+                   checked ? c->pos - start : 0, v.temp);
+    } else if (c->err) {
+        buf_printf(c->code, "        if (aot_check(s, e%d)) goto dispatch;\n", c->err);
+    }
+    return v;
+}
+
+
+/*============================================================================
+ * STATEMENTS
+ *============================================================================*/
+
+/* Length of the statement at text, split exactly as basic_run_program() does */
+static size_t statement_length(const uint8_t *text) {
+    size_t len = 0;
+    size_t skip = 0;
+    while (text[skip] == ' ') skip++;
+
+    if (text[skip] == TOK_REM) {
+        while (text[len] != '\0') len++;
+        return len;
+    }
+
+    bool in_string = false;
+    while (text[len] != '\0') {
+        if (text[len] == '"') {
+            in_string = !in_string;
+        } else if (text[len] == ':' && !in_string) {
+            break;
+        }
+        len++;
+    }
+    return len;
+}
+
+/* Where GOSUB at text_ptr == ctx returns to (same scan as execute_statement) */
+static uint16_t gosub_return_ptr(compiler_t *c, uint16_t ctx) {
+    uint16_t p = ctx;
+    while (c->mem[p] != '\0' && c->mem[p] != ':') p++;
+    if (c->mem[p] == ':') return (uint16_t)(p + 1);
+
+    const basic_state_t *st = c->state;
+    uint16_t line = st->program_start;
+    while (line < st->program_end) {
+        uint16_t link = (uint16_t)(c->mem[line] | (c->mem[line + 1] << 8));
+        uint16_t line_end = link > 0 ? link : st->program_end;
+        if (ctx >= line + 4 && ctx < line_end) {
+            return link > 0 ? (uint16_t)(link + 4) : st->program_end;
+        }
+        if (link == 0) break;
+        line = link;
+    }
+    return ctx;
+}
+
+/* Jump to a line number known at compile time */
+static cg_flow_t emit_goto_line(compiler_t *c, uint16_t line_num) {
+    uint16_t target = find_line_text(c, line_num);
+    if (target) {
+        buf_printf(c->code, "        s->current_line = %u;\n", line_num);
+        buf_printf(c->code, "        goto S_%u;\n", target);
+    } else {
+        buf_printf(c->code, "        aot_goto_line(s, %u);\n", line_num);
+        buf_printf(c->code, "        goto dispatch;\n");
+    }
+    return CG_JUMPS;
+}
+
+static cg_flow_t compile_statement(compiler_t *c, uint16_t offset, size_t len,
+                                   uint16_t ctx, uint16_t line_end);
+
+/* GOTO / GOSUB expr */
+static cg_flow_t compile_jump(compiler_t *c, bool gosub, uint16_t ctx) {
+    cg_val_t target = c_evaluate(c, false);
+    if (!c->ok) return CG_FAIL;
+
+    char a[32];
+    operand(&target, a, sizeof(a));
+
+    if (gosub) {
+        buf_printf(c->code, "        aot_gosub(s, %s, %u);\n", a, gosub_return_ptr(c, ctx));
+        buf_printf(c->code, "        goto dispatch;\n");
+        return CG_JUMPS;
+    }
+
+    if (target.literal) {
+        bool overflow;
+        int16_t line_num = mbf_to_int16(target.value, &overflow);
+        if (!overflow && line_num >= 0) {
+            return emit_goto_line(c, (uint16_t)line_num);
+        }
+    }
+    buf_printf(c->code, "        aot_goto(s, %s);\n", a);
+    buf_printf(c->code, "        goto dispatch;\n");
+    return CG_JUMPS;
+}
+
+/* IF cond THEN line / IF cond THEN statement */
+static cg_flow_t compile_if(compiler_t *c, uint16_t offset, uint16_t ctx,
+                            uint16_t line_end) {
+    cg_val_t cond = c_evaluate(c, true);
+    if (!c->ok) return CG_FAIL;
+
+    skip_space(c);
+    if (peek(c) != TOK_THEN) return CG_FAIL;
+    consume(c);
+    skip_space(c);
+
+    /* False: continue at the end of the line */
+    char a[32];
+    buf_printf(c->code, "        if (!stmt_if_eval(%s)) goto S_%u;\n",
+               operand(&cond, a, sizeof(a)), line_end);
+
+    if (c->pos < c->len && isdigit(c->text[c->pos])) {
+        uint16_t line_num = 0;
+        while (c->pos < c->len && isdigit(c->text[c->pos])) {
+            line_num = (uint16_t)(line_num * 10 + (uint16_t)(c->text[c->pos] - '0'));
+            c->pos++;
+        }
+        return emit_goto_line(c, line_num);
+    }
+
+    if (c->pos >= c->len || c->text[c->pos] == '\0') {
+        return CG_NEXT;
+    }
+
+    /* THEN clause: one statement, run with text_ptr still at the IF */
+    size_t inner_len = 0;
+    bool in_string = false;
+    for (size_t i = c->pos; i < c->len && c->text[i] != '\0'; i++) {
+        if (c->text[i] == '"') {
+            in_string = !in_string;
+        } else if (c->text[i] == ':' && !in_string) {
+            break;
+        }
+        inner_len++;
+    }
+    if (c->pos + inner_len < c->len) return CG_FAIL;
+
+    return compile_statement(c, (uint16_t)(offset + c->pos), inner_len, ctx, line_end);
+}
+
+/* [LET] var = expr, numeric only */
+static cg_flow_t compile_let(compiler_t *c) {
+    if (c->text[c->pos] == TOK_LET) c->pos++;
+    skip_space(c);
+
+    if (!(c->pos < c->len && isalpha(c->text[c->pos]))) return CG_FAIL;
+
+    char name[3] = {0};
+    name[0] = (char)c->text[c->pos++];
+    if (c->pos < c->len && isalnum(c->text[c->pos])) {
+        name[1] = (char)c->text[c->pos++];
+    }
+    while (c->pos < c->len && isalnum(c->text[c->pos])) c->pos++;
+
+    if (c->pos < c->len && c->text[c->pos] == '$') return CG_FAIL;
+
+    char a[32];
+    int idx1 = 0, idx2 = 0;
+    bool is_array = false;
+    if (c->pos < c->len && c->text[c->pos] == '(') {
+        is_array = true;
+        c->pos++;
+
+        cg_val_t v = c_evaluate(c, true);
+        if (!c->ok) return CG_FAIL;
+        idx1 = ++c->temps;
+        buf_printf(c->code, "        int16_t i%d;\n", idx1);
+        buf_printf(c->code, "        if (aot_subscript(s, %s, &i%d)) goto dispatch;\n",
+                   operand(&v, a, sizeof(a)), idx1);
+
+        if (c->pos < c->len && c->text[c->pos] == ',') {
+            c->pos++;
+            v = c_evaluate(c, true);
+            if (!c->ok) return CG_FAIL;
+            idx2 = ++c->temps;
+            buf_printf(c->code, "        int16_t i%d;\n", idx2);
+            buf_printf(c->code, "        if (aot_subscript(s, %s, &i%d)) goto dispatch;\n",
+                       operand(&v, a, sizeof(a)), idx2);
+        }
+
+        if (c->pos >= c->len || c->text[c->pos] != ')') return CG_FAIL;
+        c->pos++;
+    }
+
+    skip_space(c);
+    if (c->pos >= c->len || c->text[c->pos] != TOK_EQ) return CG_FAIL;
+    c->pos++;
+    skip_space(c);
+
+    cg_val_t value = c_evaluate(c, false);
+    if (!c->ok) return CG_FAIL;
+    operand(&value, a, sizeof(a));
+
+    if (is_array) {
+        char second[16] = "-1";
+        if (idx2) snprintf(second, sizeof(second), "i%d", idx2);
+        buf_printf(c->code,
+                   "        if (aot_set_element(s, \"%s\", i%d, %s, %s)) goto dispatch;\n",
+                   name, idx1, second, a);
+        return CG_NEXT;
+    }
+
+    int var = intern_var(c, name);
+    if (var < 0) {
+        buf_printf(c->code, "        if (!var_set_numeric(s, \"%s\", %s) && "
+                   "aot_fail(s, ERR_OM)) goto dispatch;\n", name, a);
+    } else {
+        buf_printf(c->code, "        if (aot_set(s, &v%d, \"%s\", %s)) goto dispatch;\n",
+                   var, name, a);
+    }
+    return CG_NEXT;
+}
+
+/**
+ * @brief Emit one statement
+ *
+ * @param c Compiler
+ * @param offset Offset of the statement text
+ * @param len Statement length
+ * @param ctx text_ptr while it runs (differs for THEN clauses)
+ * @param line_end Offset of the line's terminating NUL
+ * @return How control leaves the emitted code
+ */
+static cg_flow_t compile_statement(compiler_t *c, uint16_t offset, size_t len,
+                                   uint16_t ctx, uint16_t line_end) {
+    size_t mark = c->code->len;
+    int temps = c->temps;
+
+    c->text = c->mem + offset;
+    c->base = offset;
+    c->pos = 0;
+    c->len = len;
+    c->ok = true;
+
+    skip_space(c);
+    cg_flow_t flow = CG_FAIL;
+
+    uint8_t cmd = c->pos < c->len ? c->text[c->pos] : 0;
+    if (cmd == 0 || cmd == TOK_REM || cmd == TOK_DATA) {
+        flow = CG_NEXT;
+    } else if (cmd == TOK_GOTO || cmd == TOK_GOSUB) {
+        c->pos++;
+        flow = compile_jump(c, cmd == TOK_GOSUB, ctx);
+    } else if (cmd == TOK_IF) {
+        c->pos++;
+        flow = compile_if(c, offset, ctx, line_end);
+    } else if (isalpha(cmd) || cmd == TOK_LET) {
+        flow = compile_let(c);
+    }
+
+    if (flow == CG_FAIL) {
+        /* Roll back and let the interpreter run it */
+        c->code->len = mark;
+        c->temps = temps;
+        buf_printf(c->code, "        if (aot_exec(s, %u, %zu, %u)) goto dispatch;\n",
+                   offset, len, ctx);
+        flow = CG_NEXT_MAY_STOP;
+    }
+    return flow;
+}
+
+static void add_label(compiler_t *c, cg_buf_t *code, uint16_t offset, uint16_t line_num) {
+    if (c->label_count == c->label_cap) {
+        size_t cap = c->label_cap ? c->label_cap * 2 : 256;
+        uint16_t *labels = realloc(c->labels, cap * sizeof(*labels));
+        if (!labels) {
+            code->failed = true;
+            return;
+        }
+        c->labels = labels;
+        c->label_cap = cap;
+    }
+    c->labels[c->label_count++] = offset;
+
+    /* Same per-statement bookkeeping as the main loop */
+    buf_printf(code, "S_%u:\n", offset);
+    buf_printf(code, "    s->text_ptr = %u;\n", offset);
+    buf_printf(code, "    if (aot_poll(s, gen)) goto dispatch;\n");
+    buf_printf(code, "    s->current_line = %u;\n", line_num);
+}
+
+/* Continue at next (0 = fell off the last line) */
+static void emit_advance(cg_buf_t *code, uint16_t next, bool may_stop, bool adjacent) {
+    if (next == 0) {
+        buf_printf(code, "    s->running = false;\n");
+        buf_printf(code, "    aot_stopped(s);\n");
+        buf_printf(code, "    goto done;\n");
+        return;
+    }
+    if (may_stop) {
+        buf_printf(code, "    s->text_ptr = %u;\n", next);
+        buf_printf(code, "    if (!s->running) {\n");
+        buf_printf(code, "        aot_stopped(s);\n");
+        buf_printf(code, "        goto done;\n");
+        buf_printf(code, "    }\n");
+    }
+    if (!adjacent) {
+        buf_printf(code, "    goto S_%u;\n", next);
+    }
+}
+
+/* Emit all statements of every line */
+static void compile_lines(compiler_t *c, cg_buf_t *code) {
+    const basic_state_t *st = c->state;
+    uint16_t line = st->program_start;
+
+    while (line < st->program_end) {
+        uint16_t link = (uint16_t)(c->mem[line] | (c->mem[line + 1] << 8));
+        uint16_t line_num = (uint16_t)(c->mem[line + 2] | (c->mem[line + 3] << 8));
+        uint16_t next_line = link ? (uint16_t)(link + 4) : 0;
+
+        uint16_t nul = (uint16_t)(line + 4);
+        while (c->mem[nul] != '\0') nul++;
+
+        uint16_t p = (uint16_t)(line + 4);
+        while (p < nul) {
+            size_t len = statement_length(c->mem + p);
+
+            add_label(c, code, p, line_num);
+            buf_printf(code, "    {   /* %u */\n", line_num);
+            c->code = code;
+            cg_flow_t flow = compile_statement(c, p, len, p, nul);
+            buf_printf(code, "    }\n");
+
+            if (flow != CG_JUMPS) {
+                if (c->mem[p + len] == ':') {
+                    emit_advance(code, (uint16_t)(p + len + 1),
+                                 flow == CG_NEXT_MAY_STOP, true);
+                } else {
+                    emit_advance(code, next_line, flow == CG_NEXT_MAY_STOP, false);
+                }
+            }
+
+            if (c->mem[p + len] != ':') break;
+            p = (uint16_t)(p + len + 1);
+        }
+
+        /* End of line (IF false lands here) */
+        add_label(c, code, nul, line_num);
+        emit_advance(code, next_line, false, false);
+
+        if (link == 0) break;
+        line = link;
+    }
+}
+
+
+/*============================================================================
+ * PUBLIC INTERFACE
+ *============================================================================*/
+
+bool compile_program(basic_state_t *state, FILE *out,
+                     const compiler_options_t *options) {
+    if (!state || !out || !options) return false;
+
+    compiler_t *c = calloc(1, sizeof(*c));
+    if (!c) return false;
+    c->state = state;
+    c->mem = state->memory;
+
+    cg_buf_t code = {0};
+    compile_lines(c, &code);
+
+    cg_buf_t file = {0};
+    buf_printf(&file, "/*\n * Generated by basic8k-compile from %s\n",
+               options->source_name ? options->source_name : "(program)");
+    buf_printf(&file, " * Build: cc -std=c17 -O2 -I<basic8k>/include this.c "
+               "-L<build> -lbasic8k_core -lm\n */\n\n");
+    buf_printf(&file, "#include \"basic/aot.h\"\n#include <stdio.h>\n\n");
+
+    /* Program area, byte for byte as the interpreter stores it */
+    size_t size = (size_t)(state->program_end - state->program_start);
+    buf_printf(&file, "static const uint8_t program_image[%zu] = {", size ? size : 1);
+    for (size_t i = 0; i < size; i++) {
+        buf_printf(&file, "%s0x%02X,", i % 12 ? " " : "\n    ",
+                   state->memory[state->program_start + i]);
+    }
+    buf_printf(&file, "%s\n};\n\n", size ? "" : " 0");
+
+    for (int i = 0; i < c->var_count; i++) {
+        buf_printf(&file, "static aot_var_t v%d = AOT_VAR(%u, %u);\n", i,
+                   (unsigned)toupper((unsigned char)c->vars[i][0]),
+                   (unsigned)toupper((unsigned char)c->vars[i][1]));
+    }
+
+    buf_printf(&file, "\nstatic void run(basic_state_t *s) {\n");
+    buf_printf(&file, "    uint32_t gen = s->program_gen;\n");
+    buf_printf(&file, "    s->running = true;\n");
+    buf_printf(&file, "    basic_setup_interrupt(s);\n");
+    buf_printf(&file, "    goto dispatch;\n\n");
+    if (code.data) buf_printf(&file, "%s", code.data);
+    buf_printf(&file, "\ndispatch:\n");
+    buf_printf(&file, "    if (!s->running) goto done;\n");
+    buf_printf(&file, "    if (s->program_gen != gen) goto interpret;\n");
+    buf_printf(&file, "    switch (s->text_ptr) {\n");
+    for (size_t i = 0; i < c->label_count; i++) {
+        buf_printf(&file, "        case %u: goto S_%u;\n", c->labels[i], c->labels[i]);
+    }
+    buf_printf(&file, "        default: goto interpret;\n");
+    buf_printf(&file, "    }\n\n");
+    buf_printf(&file, "interpret:\n");
+    buf_printf(&file, "    /* Position the compiler did not see, or program edited */\n");
+    buf_printf(&file, "    basic_run_program(s);\n");
+    buf_printf(&file, "    return;\n\n");
+    buf_printf(&file, "done:\n");
+    buf_printf(&file, "    basic_clear_interrupt();\n");
+    buf_printf(&file, "}\n\n");
+
+    /* Same startup and shutdown as `basic8k file.bas` */
+    buf_printf(&file, "int main(void) {\n");
+    buf_printf(&file, "    basic_config_t config = {\n");
+    buf_printf(&file, "        .memory_size = %lu,\n", (unsigned long)options->memory_size);
+    buf_printf(&file, "        .terminal_width = %u,\n", options->terminal_width);
+    buf_printf(&file, "        .want_trig = true,\n");
+    buf_printf(&file, "        .input = stdin,\n");
+    buf_printf(&file, "        .output = stdout\n");
+    buf_printf(&file, "    };\n\n");
+    buf_printf(&file, "    basic_state_t *s = basic_init(&config);\n");
+    buf_printf(&file, "    if (!s || !program_load_image(s, program_image, %zu)) {\n", size);
+    buf_printf(&file, "        fprintf(stderr, \"Error: Failed to initialize interpreter\\n\");\n");
+    buf_printf(&file, "        return 1;\n");
+    buf_printf(&file, "    }\n\n");
+    buf_printf(&file, "    basic_print_banner(s);\n");
+    buf_printf(&file, "    basic_error_t err = stmt_run(s, 0);\n");
+    buf_printf(&file, "    if (err == ERR_NONE) {\n");
+    buf_printf(&file, "        run(s);\n");
+    buf_printf(&file, "    } else {\n");
+    buf_printf(&file, "        basic_print_error(s, err, 0xFFFF);\n");
+    buf_printf(&file, "    }\n");
+    buf_printf(&file, "    basic_print_ok(s);\n");
+    buf_printf(&file, "    basic_free(s);\n");
+    buf_printf(&file, "    return 0;\n");
+    buf_printf(&file, "}\n");
+
+    bool ok = !code.failed && !file.failed &&
+              fwrite(file.data, 1, file.len, out) == file.len;
+
+    free(code.data);
+    free(file.data);
+    free(c->labels);
+    free(c);
+    return ok;
+}
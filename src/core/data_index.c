@@ -0,0 +1,267 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file data_index.c
+ * @brief DATA Item Index for READ and RESTORE
+ *
+ * READ finds its next item by scanning program bytes from the DATA
+ * pointer for a DATA token or a comma, then converts the item's decimal
+ * text. RESTORE n walks the line chain. With thousands of DATA items the
+ * scan and the conversion dominate table-driven programs.
+ *
+ * Where the next item is depends only on the program text and the
+ * position the scan starts from, and a numeric item's value only on its
+ * text. This module remembers both, per program_gen:
+ *
+ * - for a start position: the item the scan found, and whether (and to
+ *   which line) it crossed a line boundary on the way, so data_line is
+ *   updated exactly as the scan would;
+ * - for an item: its MBF value as READ converts it and where the item
+ *   ends, filled in the first time it is read as a number;
+ * - the program's lines in order, so RESTORE n is a binary search.
+ *
+ * Results are recorded from the original code paths, so quirks of the
+ * scan (commas after a RESTORE n position, items read with the other
+ * type) are kept as they were.
+ */
+
+#include "basic/basic.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Initial number of table slots (power of two) */
+#define DATA_INITIAL_SLOTS 256
+
+/** What a record describes */
+enum {
+    DATA_NEXT = 0,      /**< Scan result for a start position */
+    DATA_VALUE = 1      /**< Numeric value of an item */
+};
+
+/** One remembered result */
+typedef struct {
+    uint32_t key;       /**< (offset << 1 | kind) + 1, or 0 if empty */
+    uint16_t pos;       /**< NEXT: item found; VALUE: end of the item */
+    uint16_t line;      /**< NEXT: data_line after crossing a line */
+    bool crossed;       /**< NEXT: the scan crossed a line boundary */
+    mbf_t value;        /**< VALUE: the item's value */
+} data_entry_t;
+
+/** Index: open-addressed records plus the line table */
+struct basic_data {
+    uint32_t gen;           /**< program_gen the records belong to */
+    size_t capacity;        /**< Number of slots (power of two) */
+    size_t count;           /**< Slots in use */
+    size_t items;           /**< NEXT records */
+    data_entry_t *entries;
+    uint16_t *line_nums;    /**< Line numbers in program order */
+    uint16_t *line_text;    /**< Offsets of their text */
+    size_t line_count;
+    bool lines_built;       /**< line_nums/line_text are current */
+};
+
+static uint32_t data_key(uint16_t offset, unsigned kind) {
+    return (((uint32_t)offset << 1) | kind) + 1;
+}
+
+static size_t data_slot(uint32_t key, size_t capacity) {
+    return ((size_t)key * 40503u) & (capacity - 1);
+}
+
+/* Current index, emptied if the program has changed since it was filled */
+static struct basic_data *data_table(basic_state_t *state, bool create) {
+    struct basic_data *data = state->data_index;
+    if (!data && create) {
+        data = calloc(1, sizeof(*data));
+        if (!data) return NULL;
+        data->entries = calloc(DATA_INITIAL_SLOTS, sizeof(*data->entries));
+        if (!data->entries) {
+            free(data);
+            return NULL;
+        }
+        data->capacity = DATA_INITIAL_SLOTS;
+        data->gen = state->program_gen;
+        state->data_index = data;
+    }
+    if (data && data->gen != state->program_gen) {
+        memset(data->entries, 0, data->capacity * sizeof(*data->entries));
+        data->count = 0;
+        data->items = 0;
+        data->lines_built = false;
+        data->gen = state->program_gen;
+    }
+    return data;
+}
+
+static const data_entry_t *data_find(basic_state_t *state, uint32_t key) {
+    struct basic_data *data = data_table(state, false);
+    if (!data) return NULL;
+
+    size_t mask = data->capacity - 1;
+    for (size_t slot = data_slot(key, data->capacity); data->entries[slot].key;
+         slot = (slot + 1) & mask) {
+        if (data->entries[slot].key == key) return &data->entries[slot];
+    }
+    return NULL;
+}
+
+/* Double the table, keeping its records */
+static bool data_grow(struct basic_data *data) {
+    size_t capacity = data->capacity * 2;
+    data_entry_t *entries = calloc(capacity, sizeof(*entries));
+    if (!entries) return false;
+
+    for (size_t i = 0; i < data->capacity; i++) {
+        if (!data->entries[i].key) continue;
+        size_t slot = data_slot(data->entries[i].key, capacity);
+        while (entries[slot].key) slot = (slot + 1) & (capacity - 1);
+        entries[slot] = data->entries[i];
+    }
+
+    free(data->entries);
+    data->entries = entries;
+    data->capacity = capacity;
+    return true;
+}
+
+/* Slot for a new record, or NULL if it exists or there is no memory */
+static data_entry_t *data_insert(basic_state_t *state, uint32_t key) {
+    struct basic_data *data = data_table(state, true);
+    if (!data) return NULL;
+
+    /* Keep the load factor at or below one half */
+    if ((data->count + 1) * 2 > data->capacity && !data_grow(data)) {
+        return NULL;
+    }
+
+    size_t mask = data->capacity - 1;
+    size_t slot = data_slot(key, data->capacity);
+    while (data->entries[slot].key) {
+        if (data->entries[slot].key == key) return NULL;    /* Already known */
+        slot = (slot + 1) & mask;
+    }
+    data->entries[slot].key = key;
+    data->count++;
+    return &data->entries[slot];
+}
+
+bool data_index_next(basic_state_t *state, uint16_t from, uint16_t *item,
+                     bool *crossed, uint16_t *line) {
+    const data_entry_t *e = data_find(state, data_key(from, DATA_NEXT));
+    if (!e) return false;
+    *item = e->pos;
+    *crossed = e->crossed;
+    *line = e->line;
+    return true;
+}
+
+void data_index_store_next(basic_state_t *state, uint16_t from, uint16_t item,
+                           bool crossed, uint16_t line) {
+    data_entry_t *e = data_insert(state, data_key(from, DATA_NEXT));
+    if (!e) return;
+    e->pos = item;
+    e->crossed = crossed;
+    e->line = line;
+    state->data_index->items++;
+}
+
+bool data_index_value(basic_state_t *state, uint16_t item, mbf_t *value, uint16_t *end) {
+    const data_entry_t *e = data_find(state, data_key(item, DATA_VALUE));
+    if (!e) return false;
+    *value = e->value;
+    *end = e->pos;
+    return true;
+}
+
+void data_index_store_value(basic_state_t *state, uint16_t item, mbf_t value, uint16_t end) {
+    data_entry_t *e = data_insert(state, data_key(item, DATA_VALUE));
+    if (!e) return;
+    e->value = value;
+    e->pos = end;
+}
+
+/* Collect the line chain, walked exactly like stmt_restore_line() */
+static bool data_build_lines(basic_state_t *state, struct basic_data *data) {
+    size_t count = 0;
+    uint8_t *ptr = state->memory + state->program_start;
+    uint8_t *end = state->memory + state->program_end;
+    while (ptr < end) {
+        count++;
+        uint16_t link = (uint16_t)(ptr[0] | (ptr[1] << 8));
+        if (link == 0) break;
+        ptr = state->memory + link;
+    }
+
+    uint16_t *nums = malloc((count ? count : 1) * sizeof(*nums));
+    uint16_t *text = malloc((count ? count : 1) * sizeof(*text));
+    if (!nums || !text) {
+        free(nums);
+        free(text);
+        return false;
+    }
+
+    size_t i = 0;
+    ptr = state->memory + state->program_start;
+    while (ptr < end && i < count) {
+        nums[i] = (uint16_t)(ptr[2] | (ptr[3] << 8));
+        text[i] = (uint16_t)(ptr - state->memory) + 4;
+        i++;
+        uint16_t link = (uint16_t)(ptr[0] | (ptr[1] << 8));
+        if (link == 0) break;
+        ptr = state->memory + link;
+    }
+
+    free(data->line_nums);
+    free(data->line_text);
+    data->line_nums = nums;
+    data->line_text = text;
+    data->line_count = i;
+    data->lines_built = true;
+    return true;
+}
+
+bool data_index_find_line(basic_state_t *state, uint16_t line_num,
+                          uint16_t *num, uint16_t *text) {
+    struct basic_data *data = data_table(state, true);
+    if (!data) return false;
+    if (!data->lines_built && !data_build_lines(state, data)) return false;
+
+    /* First line numbered line_num or higher (lines are in order) */
+    size_t lo = 0, hi = data->line_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (data->line_nums[mid] < line_num) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == data->line_count) {
+        *text = 0;
+    } else {
+        *num = data->line_nums[lo];
+        *text = data->line_text[lo];
+    }
+    return true;
+}
+
+void data_index_free(basic_state_t *state) {
+    if (!state || !state->data_index) return;
+    free(state->data_index->entries);
+    free(state->data_index->line_nums);
+    free(state->data_index->line_text);
+    free(state->data_index);
+    state->data_index = NULL;
+}
+
+size_t data_index_items(const basic_state_t *state) {
+    if (!state || !state->data_index || state->data_index->gen != state->program_gen) {
+        return 0;
+    }
+    return state->data_index->items;
+}
@@ -0,0 +1,218 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file fold.c
+ * @brief Constant Subexpression Table
+ *
+ * The parser evaluates expressions straight from program text, so a
+ * line such as `X=INT(RND(1)*6)+1` converts "6" and "1" from decimal
+ * every time it runs, and `A=3.14159/180` repeats the division.
+ *
+ * While evaluating, the parser tracks whether a span touched anything
+ * that can change between evaluations (variables, arrays, RND, FN, PEEK,
+ * FRE, POS, USR, INP, string space). Spans that did not are constant:
+ * their value depends only on the text. This table records, per
+ * (text offset, grammar level):
+ *
+ * - for a constant span: where it ends and the MBF result, bit for bit
+ *   as the parser produced it;
+ * - otherwise: that it is not constant, so the parser does not track it
+ *   again.
+ *
+ * Most spans are not constant, and the parser asks about one at nearly
+ * every operand. Those answers are kept outside the hash table in a
+ * byte map parallel to memory[] (one bit per level), so the common
+ * lookup is a single indexed load rather than a probe sequence.
+ *
+ * Most expressions have no span worth folding at all: `S=S+I*(K-1)/3`
+ * only has lone numbers, which cost about as much to look up as to
+ * convert. Once an evaluation of such an expression has been fully
+ * recorded, a bit in the same map at the expression's first byte tells
+ * the parser to evaluate it without tracking anything, which is what it
+ * did before folding existed.
+ *
+ * Only spans the parser itself evaluated as a unit are stored, so the
+ * rounding order of the original expression is kept: in `X*3.14159/180`
+ * nothing after X is folded, because BASIC evaluates it as
+ * (X*3.14159)/180.
+ *
+ * Records are thrown away when program_gen changes.
+ */
+
+#include "basic/basic.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Initial number of table slots (power of two) */
+#define FOLD_INITIAL_SLOTS 256
+
+/** Bit in the varying map: the expression starting here has nothing to fold */
+#define FOLD_PLAIN 0x80
+
+/** One analysed span */
+typedef struct {
+    uint32_t key;       /**< (offset << 2 | level) + 1, or 0 if empty */
+    uint16_t end;       /**< Offset past the span, 0 if not constant */
+    mbf_t value;        /**< Value of a constant span */
+} fold_entry_t;
+
+/** Span table: open addressing with linear probing */
+struct basic_fold {
+    uint32_t gen;           /**< program_gen the records belong to */
+    size_t capacity;        /**< Number of slots (power of two) */
+    size_t count;           /**< Slots in use */
+    size_t constants;       /**< Records for constant spans */
+    fold_entry_t *entries;
+    uint8_t *varying;       /**< Per offset in memory[]: bit 1 << level set when
+                                 that span is known not to be constant, and
+                                 FOLD_PLAIN */
+    uint32_t varying_size;  /**< Bytes in varying (state->memory_size) */
+};
+
+static uint32_t fold_key(uint16_t offset, uint8_t level) {
+    return (((uint32_t)offset << 2) | level) + 1;
+}
+
+static size_t fold_slot(uint32_t key, size_t capacity) {
+    return ((size_t)key * 40503u) & (capacity - 1);
+}
+
+/* Current table, emptied if the program has changed since it was filled */
+static struct basic_fold *fold_table(basic_state_t *state) {
+    struct basic_fold *fold = state->fold;
+    if (fold && fold->gen != state->program_gen) {
+        memset(fold->entries, 0, fold->capacity * sizeof(*fold->entries));
+        memset(fold->varying, 0, fold->varying_size);
+        fold->count = 0;
+        fold->constants = 0;
+        fold->gen = state->program_gen;
+    }
+    return fold;
+}
+
+bool fold_lookup(basic_state_t *state, uint16_t offset, uint8_t level,
+                 uint16_t *end, mbf_t *value) {
+    struct basic_fold *fold = fold_table(state);
+    if (!fold) return false;
+
+    /* Most spans are not constant: answered without probing the table */
+    if (offset < fold->varying_size && (fold->varying[offset] & (1u << level))) {
+        *end = 0;
+        return true;
+    }
+
+    uint32_t key = fold_key(offset, level);
+    size_t mask = fold->capacity - 1;
+    for (size_t slot = fold_slot(key, fold->capacity); fold->entries[slot].key;
+         slot = (slot + 1) & mask) {
+        if (fold->entries[slot].key == key) {
+            *end = fold->entries[slot].end;
+            *value = fold->entries[slot].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Double the table, keeping its records */
+static bool fold_grow(struct basic_fold *fold) {
+    size_t capacity = fold->capacity * 2;
+    fold_entry_t *entries = calloc(capacity, sizeof(*entries));
+    if (!entries) return false;
+
+    for (size_t i = 0; i < fold->capacity; i++) {
+        if (!fold->entries[i].key) continue;
+        size_t slot = fold_slot(fold->entries[i].key, capacity);
+        while (entries[slot].key) slot = (slot + 1) & (capacity - 1);
+        entries[slot] = fold->entries[i];
+    }
+
+    free(fold->entries);
+    fold->entries = entries;
+    fold->capacity = capacity;
+    return true;
+}
+
+/* Current table, allocated on first use */
+static struct basic_fold *fold_create(basic_state_t *state) {
+    struct basic_fold *fold = fold_table(state);
+    if (fold) return fold;
+
+    fold = calloc(1, sizeof(*fold));
+    if (!fold) return NULL;
+    fold->entries = calloc(FOLD_INITIAL_SLOTS, sizeof(*fold->entries));
+    fold->varying = calloc(state->memory_size, 1);
+    if (!fold->entries || !fold->varying) {
+        free(fold->entries);
+        free(fold->varying);
+        free(fold);
+        return NULL;
+    }
+    fold->varying_size = state->memory_size;
+    fold->capacity = FOLD_INITIAL_SLOTS;
+    fold->gen = state->program_gen;
+    state->fold = fold;
+    return fold;
+}
+
+void fold_store(basic_state_t *state, uint16_t offset, uint8_t level,
+                uint16_t end, mbf_t value) {
+    struct basic_fold *fold = fold_create(state);
+    if (!fold) return;
+
+    if (end == 0 && offset < fold->varying_size) {
+        fold->varying[offset] |= (uint8_t)(1u << level);
+        return;
+    }
+
+    /* Keep the load factor at or below one half */
+    if ((fold->count + 1) * 2 > fold->capacity && !fold_grow(fold)) {
+        return;
+    }
+
+    uint32_t key = fold_key(offset, level);
+    size_t mask = fold->capacity - 1;
+    size_t slot = fold_slot(key, fold->capacity);
+    while (fold->entries[slot].key) {
+        if (fold->entries[slot].key == key) return;     /* Already known */
+        slot = (slot + 1) & mask;
+    }
+
+    fold->entries[slot].key = key;
+    fold->entries[slot].end = end;
+    fold->entries[slot].value = value;
+    fold->count++;
+    if (end) fold->constants++;
+}
+
+bool fold_plain(basic_state_t *state, uint16_t offset) {
+    struct basic_fold *fold = fold_table(state);
+    return fold && offset < fold->varying_size &&
+           (fold->varying[offset] & FOLD_PLAIN);
+}
+
+void fold_store_plain(basic_state_t *state, uint16_t offset) {
+    struct basic_fold *fold = fold_create(state);
+    if (fold && offset < fold->varying_size) {
+        fold->varying[offset] |= FOLD_PLAIN;
+    }
+}
+
+void fold_free(basic_state_t *state) {
+    if (!state || !state->fold) return;
+    free(state->fold->entries);
+    free(state->fold->varying);
+    free(state->fold);
+    state->fold = NULL;
+}
+
+size_t fold_constant_spans(const basic_state_t *state) {
+    if (!state || !state->fold || state->fold->gen != state->program_gen) {
+        return 0;
+    }
+    return state->fold->constants;
+}
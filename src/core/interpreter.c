@@ -171,6 +171,32 @@ void basic_clear_interrupt(void) {
     signal(SIGINT, SIG_DFL);
 }
 
+/**
+ * @brief Handle a pending Ctrl-C at a statement boundary
+ *
+ * Prints "BREAK IN line" and stops the program so that CONT resumes
+ * at the statement that was about to run. Called before every statement
+ * by the main loop and by compiled programs (basic8k-compile).
+ *
+ * @param state Interpreter state, text_ptr at the next statement
+ * @return true if execution was interrupted
+ */
+bool basic_check_interrupt(basic_state_t *state) {
+    if (!g_interrupt_flag) return false;
+
+    g_interrupt_flag = 0;
+    fprintf(state->output, "\nBREAK");
+    if (state->current_line > 0) {
+        fprintf(state->output, " IN %u", state->current_line);
+    }
+    fprintf(state->output, "\n");
+    state->running = false;
+    state->can_continue = true;
+    state->cont_line = state->current_line;
+    state->cont_ptr = state->text_ptr;
+    return true;
+}
+
 
 /*============================================================================
  * ERROR CODE TABLE
@@ -340,6 +366,9 @@ basic_state_t *basic_init(const basic_config_t *config) {
     }
     state->memory_size = mem_size;
 
+    /* Nothing checkpointed yet: the first checkpoint holds every page */
+    memset(state->dirty_pages, 0xFF, sizeof(state->dirty_pages));
+
     /* Set up I/O */
     state->input = config && config->input ? config->input : stdin;
     state->output = config && config->output ? config->output : stdout;
@@ -347,10 +376,17 @@ basic_state_t *basic_init(const basic_config_t *config) {
     /* Terminal settings */
     state->terminal_width = config ? config->terminal_width : BASIC8K_DEFAULT_WIDTH;
     state->want_trig = config ? config->want_trig : true;
+    state->mat_enabled = config && config->enable_mat;
+    state->instr_enabled = config && config->enable_instr;
 
     /* Initialize RND */
     rnd_init(&state->rnd);
 
+    /* Optional hot-line JIT (silently stays off where unsupported) */
+    if (config && config->enable_jit) {
+        jit_init(state);
+    }
+
     /* Set up memory regions */
     /* Note: max addressable memory is 65535 (uint16_t max) */
     uint16_t max_addr = (mem_size > 65535) ? 65535 : (uint16_t)mem_size;
@@ -375,6 +411,10 @@ basic_state_t *basic_init(const basic_config_t *config) {
  */
 void basic_free(basic_state_t *state) {
     if (state) {
+        jit_free(state);
+        quick_free(state);
+        fold_free(state);
+        data_index_free(state);
         free(state->memory);
         free(state);
     }
@@ -408,8 +448,10 @@ void basic_reset(basic_state_t *state) {
     state->program_end = state->program_start;
     state->var_start = state->program_end;
     state->array_start = state->var_start;
+    state->array_gen++;
     state->string_start = state->string_end;
     state->var_count_ = 0;
+    state->program_gen++;
 
     /* Reset stacks */
     state->for_sp = 0;
@@ -690,1398 +732,1667 @@ bool basic_execute_line(basic_state_t *state, const char *line) {
     return true;
 }
 
+/*============================================================================
+ * STATEMENT HANDLERS
+ *
+ * One function per statement, reached through statement_handlers[], a
+ * table indexed by the statement's first byte. Dispatch is a single
+ * indexed indirect call instead of a compare/jump cascade through one
+ * large switch, and each handler is small enough to be optimised on its
+ * own.
+ *
+ * Handlers are grouped by how often programs run them. With GCC/Clang
+ * the hot group goes into .text.hot and the commands typed at the OK
+ * prompt into .text.unlikely, so the statements inner loops use share
+ * instruction cache lines instead of being interleaved with CLOAD and
+ * CSAVE.
+ *
+ * Every handler receives the statement and the position of its command
+ * byte, and behaves exactly like the case it replaced in the old switch.
+ *
+ * There is no computed-goto threading. Hot statements are dispatched by
+ * quick_execute() before they get here, and basic_run_program() has one
+ * dispatch point per statement either way; a label table in
+ * quick_execute() ran bench_statements.bas no faster than its switch.
+ *============================================================================*/
+
+#if defined(__GNUC__)
+#define STMT_HOT  __attribute__((hot))
+#define STMT_COLD __attribute__((cold))
+#else
+#define STMT_HOT
+#define STMT_COLD
+#endif
+
+/** Handlers for statements without operands ignore the statement text */
+#define STMT_NO_OPERANDS() ((void)tokenized, (void)len, (void)pos)
+
 /**
- * @brief Execute a tokenized statement
- *
- * This is the core statement dispatcher. It examines the first token
- * of the statement and branches to the appropriate handler.
- *
- * Statement Categories:
- *
- * **Flow Control (flow.c):**
- * - GOTO, GOSUB, RETURN, FOR, NEXT, IF, ON, END, STOP, CONT
- *
- * **I/O Operations (io.c):**
- * - PRINT, INPUT, READ, DATA, RESTORE
- *
- * **Variables and Memory:**
- * - LET (implicit or explicit), DIM, POKE, DEF
- *
- * **Program Management:**
- * - LIST, RUN, NEW, CLEAR, CLOAD, CSAVE
- *
- * **Miscellaneous:**
- * - REM (comment, skipped), NULL
+ * @brief Statement handler
  *
  * @param state Interpreter state
  * @param tokenized Tokenized statement bytes
  * @param len Length of tokenized data
+ * @param pos Position of the command byte within tokenized
  * @return ERR_NONE on success, error code on failure
- *
- * Note: This function may modify state->text_ptr for flow control
- * statements (GOTO, GOSUB, NEXT, etc.). The caller checks if text_ptr
- * changed to determine whether to advance normally or let the
- * statement control flow.
  */
-static basic_error_t execute_statement(basic_state_t *state,
-                                       const uint8_t *tokenized, size_t len) {
-    if (!state || !tokenized || len == 0) return ERR_NONE;
-
-    size_t pos = 0;
-
-    /* Skip leading whitespace */
-    while (pos < len && tokenized[pos] == ' ') pos++;
+typedef basic_error_t (*stmt_handler_t)(basic_state_t *state, const uint8_t *tokenized,
+                                        size_t len, size_t pos);
 
-    /* Empty statement is not an error */
-    if (pos >= len || tokenized[pos] == '\0') {
-        return ERR_NONE;
-    }
+/* Hot statements (run-time inner loops) */
 
-    /* Get the command token (first non-space character) */
+/** [LET] var[(i[,j])][$] = expr */
+static STMT_HOT basic_error_t exec_let(basic_state_t *state, const uint8_t *tokenized,
+                                       size_t len, size_t pos) {
     uint8_t cmd = tokenized[pos];
 
-    /*
-     * Main statement dispatch switch.
-     *
-     * Each case handles a specific statement type. Complex statements
-     * delegate to functions in other modules (flow.c, io.c, etc.).
-     */
-    switch (cmd) {
-        case TOK_REM:
-            /* Comment - skip rest of line */
-            return ERR_NONE;
-
-        case TOK_PRINT:
-        case '?': {
-            /* PRINT statement */
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+    /* MAT is spelled out, not tokenized, so it arrives here */
+    if (state->mat_enabled && stmt_mat_match(tokenized + pos, len - pos)) {
+        return stmt_mat(state, tokenized + pos, len - pos);
+    }
 
-            bool need_newline = true;
+    /* Check for variable assignment (LET is optional) */
+    if (isalpha(cmd) || cmd == TOK_LET) {
+        if (cmd == TOK_LET) pos++;
 
-            while (pos < len && tokenized[pos] != '\0' && tokenized[pos] != ':') {
-                uint8_t ch = tokenized[pos];
+        /* Skip spaces */
+        while (pos < len && tokenized[pos] == ' ') pos++;
 
-                if (ch == '"') {
-                    /* String expression starting with literal - use eval_string_desc */
-                    basic_error_t err;
-                    size_t consumed;
-                    string_desc_t desc = eval_string_desc(state, tokenized + pos,
-                                                          len - pos, &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
+        /* Get variable name */
+        char var_name[4] = {0};  /* Room for 2 chars + $ + null */
+        size_t name_len = 0;
+        if (pos < len && isalpha(tokenized[pos])) {
+            var_name[name_len++] = (char)tokenized[pos++];
+            if (pos < len && isalnum(tokenized[pos])) {
+                var_name[name_len++] = (char)tokenized[pos++];
+            }
+            SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
+        } else {
+            return ERR_SN;
+        }
 
-                    /* Print the string */
-                    if (desc.length > 0 && desc.ptr > 0) {
-                        const char *str = (const char *)(state->memory + desc.ptr);
-                        for (uint8_t i = 0; i < desc.length; i++) {
-                            io_putchar(state, str[i]);
-                        }
-                    }
-                    need_newline = true;
-                } else if (ch == ';') {
-                    /* Semicolon - no space */
-                    pos++;
-                    need_newline = false;
-                } else if (ch == ',') {
-                    /* Comma - tab to next zone */
-                    int col = state->terminal_x;
-                    int next_zone = ((col / 14) + 1) * 14;
-                    while (state->terminal_x < next_zone) {
-                        io_putchar(state, ' ');
-                    }
-                    pos++;
-                    need_newline = false;
-                } else if (ch == TOK_TAB) {
-                    /* TAB function - token includes the '(' */
-                    pos++;
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                                &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
-                    if (pos < len && tokenized[pos] == ')') pos++;
+        /* Check for string variable/array first ($ comes before () in BASIC) */
+        int16_t idx1 = 0, idx2 = -1;
+        bool is_array = false;
+        bool is_string = false;
 
-                    bool overflow;
-                    int col = mbf_to_int16(val, &overflow);
-                    if (!overflow && col >= 1) {
-                        io_tab(state, col);
-                    }
-                    need_newline = false;  /* TAB doesn't imply newline */
-                } else if (ch == TOK_SPC) {
-                    /* SPC function - token includes the '(' */
-                    pos++;
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                                &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
-                    if (pos < len && tokenized[pos] == ')') pos++;
+        if (pos < len && tokenized[pos] == '$') {
+            is_string = true;
+            var_name[name_len] = '$';  /* Append $ to var_name */
+            pos++;
+        }
 
-                    bool overflow;
-                    int count = mbf_to_int16(val, &overflow);
-                    if (!overflow && count >= 0) {
-                        io_spc(state, count);
-                    }
-                    need_newline = false;  /* SPC doesn't imply newline */
-                } else if (ch == ' ') {
-                    pos++;
-                } else if (isalpha(ch)) {
-                    /* Check for string variable or function */
-                    size_t save_pos = pos;
-                    char var_name[4] = {0};  /* Room for 2 chars + $ + null */
-                    size_t name_len = 0;
-                    var_name[name_len++] = (char)tokenized[pos++];
-                    if (pos < len && isalnum(tokenized[pos])) {
-                        var_name[name_len++] = (char)tokenized[pos++];
-                    }
+        /* Now check for array subscript */
+        if (pos < len && tokenized[pos] == '(') {
+            /* Array element */
+            is_array = true;
+            pos++;  /* Skip ( */
 
-                    if (pos < len && tokenized[pos] == '$') {
-                        /* Check if this is a string comparison (result is numeric) */
-                        /* Look ahead past $ and any array subscript to see if comparison follows */
-                        size_t look_pos = pos + 1;  /* Skip $ */
-                        /* Skip any remaining variable name chars in look_pos */
-                        while (look_pos < len && isalnum(tokenized[look_pos])) look_pos++;
-                        if (look_pos < len && tokenized[look_pos] == '(') {
-                            /* Skip array subscript */
-                            int paren_depth = 1;
-                            look_pos++;
-                            while (look_pos < len && paren_depth > 0) {
-                                if (tokenized[look_pos] == '(') paren_depth++;
-                                else if (tokenized[look_pos] == ')') paren_depth--;
-                                look_pos++;
-                            }
-                        }
-                        /* Skip spaces */
-                        while (look_pos < len && tokenized[look_pos] == ' ') look_pos++;
-                        /* Check for comparison operator */
-                        bool is_comparison = false;
-                        if (look_pos < len) {
-                            uint8_t next_ch = tokenized[look_pos];
-                            if (next_ch == TOK_LT || next_ch == TOK_GT || next_ch == TOK_EQ ||
-                                next_ch == '<' || next_ch == '>' || next_ch == '=') {
-                                is_comparison = true;
-                            }
-                        }
-
-                        if (is_comparison) {
-                            /* String comparison - result is numeric, use eval_expression */
-                            pos = save_pos;
-                            basic_error_t err;
-                            size_t consumed;
-                            mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                                        &consumed, &err);
-                            if (err != ERR_NONE) return err;
-                            pos += consumed;
-                            io_print_number(state, val);
-                        } else {
-                            /* Pure string expression - use eval_string_desc */
-                            pos = save_pos;  /* Restore to start of expression */
-                            basic_error_t err;
-                            size_t consumed;
-                            string_desc_t desc = eval_string_desc(state, tokenized + pos,
-                                                                  len - pos, &consumed, &err);
-                            if (err != ERR_NONE) return err;
-                            pos += consumed;
-
-                            /* Print the string */
-                            if (desc.length > 0 && desc.ptr > 0) {
-                                const char *str = (const char *)(state->memory + desc.ptr);
-                                for (uint8_t i = 0; i < desc.length; i++) {
-                                    io_putchar(state, str[i]);
-                                }
-                            }
-                        }
-                        need_newline = true;
-                    } else {
-                        /* Numeric variable or expression - restore and evaluate */
-                        pos = save_pos;
-                        basic_error_t err;
-                        size_t consumed;
-                        mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                                    &consumed, &err);
-                        if (err != ERR_NONE) return err;
-                        pos += consumed;
-
-                        io_print_number(state, val);
-                        need_newline = true;
-                    }
-                } else if (TOK_IS_STRING_FUNC(ch)) {
-                    /* String function */
-                    basic_error_t err;
-                    size_t consumed;
-                    string_desc_t desc = eval_string_desc(state, tokenized + pos,
-                                                          len - pos, &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
+            /* Parse first index */
+            basic_error_t err;
+            size_t consumed;
+            bool overflow;
+            int16_t index;
+            if (eval_int_operand(state, tokenized + pos, len - pos, &consumed,
+                                 &index, &overflow)) {
+                idx1 = index;
+            } else {
+                mbf_t idx1_val = eval_expression(state, tokenized + pos, len - pos,
+                                                 &consumed, &err);
+                if (err != ERR_NONE) return err;
+                idx1 = mbf_to_int16(idx1_val, &overflow);
+            }
+            pos += consumed;
+            if (overflow) return ERR_BS;
 
-                    /* Print the string */
-                    if (desc.length > 0 && desc.ptr > 0) {
-                        const char *str = (const char *)(state->memory + desc.ptr);
-                        for (uint8_t i = 0; i < desc.length; i++) {
-                            io_putchar(state, str[i]);
-                        }
-                    }
-                    need_newline = true;
+            /* Check for second dimension */
+            if (pos < len && tokenized[pos] == ',') {
+                pos++;
+                if (eval_int_operand(state, tokenized + pos, len - pos, &consumed,
+                                     &index, &overflow)) {
+                    idx2 = index;
                 } else {
-                    /* Numeric expression */
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                                &consumed, &err);
+                    mbf_t idx2_val = eval_expression(state, tokenized + pos, len - pos,
+                                                     &consumed, &err);
                     if (err != ERR_NONE) return err;
-                    pos += consumed;
-
-                    io_print_number(state, val);
-                    need_newline = true;
+                    idx2 = mbf_to_int16(idx2_val, &overflow);
                 }
+                pos += consumed;
+                if (overflow) return ERR_BS;
             }
 
-            if (need_newline) {
-                io_newline(state);
+            /* Expect ) */
+            if (pos >= len || tokenized[pos] != ')') {
+                return ERR_SN;
             }
-            return ERR_NONE;
+            pos++;
         }
 
-        case TOK_LIST: {
-            /* LIST statement */
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+        /* Skip to = */
+        while (pos < len && tokenized[pos] == ' ') pos++;
 
-            uint16_t start = 0, end = 0;
+        if (pos >= len || tokenized[pos] != TOK_EQ) {
+            return ERR_SN;
+        }
+        pos++;
 
-            if (pos < len && isdigit(tokenized[pos])) {
-                /* Parse start line */
-                while (pos < len && isdigit(tokenized[pos])) {
-                    start = start * 10 + (uint16_t)(tokenized[pos] - '0');
-                    pos++;
+        /* Skip spaces after = */
+        while (pos < len && tokenized[pos] == ' ') pos++;
+
+        if (is_string) {
+            /* Parse string expression (handles literals, variables, functions, concatenation) */
+            basic_error_t err;
+            size_t consumed;
+            string_desc_t desc = eval_string_desc(state, tokenized + pos,
+                                                  len - pos, &consumed, &err);
+            if (err != ERR_NONE) return err;
+            pos += consumed;
+
+            if (is_array) {
+                /* String array element assignment */
+                if (!array_set_string(state, var_name, idx1, idx2, desc)) {
+                    return ERR_BS;  /* Bad subscript */
                 }
+                return ERR_NONE;
             }
+            return stmt_let_string(state, var_name, desc);
+        } else {
+            /* Evaluate numeric expression */
+            basic_error_t err;
+            size_t consumed;
+            mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                        &consumed, &err);
+            if (err != ERR_NONE) return err;
 
-            if (pos < len && tokenized[pos] == '-') {
-                pos++;
-                if (pos < len && isdigit(tokenized[pos])) {
-                    while (pos < len && isdigit(tokenized[pos])) {
-                        end = end * 10 + (uint16_t)(tokenized[pos] - '0');
-                        pos++;
-                    }
-                } else {
-                    end = 0xFFFF;
+            if (is_array) {
+                if (!array_set_numeric(state, var_name, idx1, idx2, val)) {
+                    return ERR_BS;  /* Bad subscript */
                 }
-            } else if (start > 0) {
-                end = start;
+                return ERR_NONE;
+            } else {
+                return stmt_let_numeric(state, var_name, val);
             }
-
-            basic_list_program(state, start, end);
-            return ERR_NONE;
         }
+    }
 
-        case TOK_RUN: {
-            /* RUN statement */
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+    return ERR_SN;
+}
 
-            uint16_t start_line = 0;
-            if (pos < len && isdigit(tokenized[pos])) {
-                while (pos < len && isdigit(tokenized[pos])) {
-                    start_line = start_line * 10 + (uint16_t)(tokenized[pos] - '0');
-                    pos++;
-                }
-            }
+/** IF expr THEN statements / line_num */
+static STMT_HOT basic_error_t exec_if(basic_state_t *state, const uint8_t *tokenized,
+                                      size_t len, size_t pos) {
+    pos++;
 
-            basic_error_t err = stmt_run(state, start_line);
-            if (err != ERR_NONE) return err;
+    /* Evaluate condition */
+    basic_error_t err;
+    size_t consumed;
+    mbf_t condition = eval_expression(state, tokenized + pos, len - pos,
+                                      &consumed, &err);
+    if (err != ERR_NONE) return err;
+    pos += consumed;
 
-            /* Execute the program */
-            basic_run_program(state);
-            return ERR_NONE;
-        }
+    /* Expect THEN */
+    while (pos < len && tokenized[pos] == ' ') pos++;
+    if (pos >= len || tokenized[pos] != TOK_THEN) {
+        return ERR_SN;
+    }
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-        case TOK_NEW:
-            stmt_new(state);
-            return ERR_NONE;
+    /* If condition is false, skip rest of line (not just THEN clause) */
+    if (!stmt_if_eval(condition)) {
+        /* Find end of line (null terminator) and set text_ptr there */
+        /* This causes the main loop to advance to the next line */
+        uint8_t *ptr = state->memory + state->text_ptr;
+        while (*ptr != '\0') ptr++;
+        state->text_ptr = (uint16_t)(ptr - state->memory);
+        return ERR_NONE;
+    }
 
-        case TOK_CLOAD: {
-            /* CLOAD "filename" - Load program from file */
+    /* Condition is true - check if THEN is followed by line number */
+    if (pos < len && isdigit(tokenized[pos])) {
+        /* GOTO the line number */
+        uint16_t line_num = 0;
+        while (pos < len && isdigit(tokenized[pos])) {
+            line_num = line_num * 10 + (uint16_t)(tokenized[pos] - '0');
             pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
-
-            /* Optional filename in quotes */
-            char filename[256] = "";
-            if (pos < len && tokenized[pos] == '"') {
-                pos++;  /* Skip opening quote */
-                size_t fname_len = 0;
-                while (pos < len && tokenized[pos] != '"' && fname_len < sizeof(filename) - 1) {
-                    filename[fname_len++] = (char)tokenized[pos++];
-                }
-                filename[fname_len] = '\0';
-                if (pos < len && tokenized[pos] == '"') pos++;  /* Skip closing quote */
-            }
-
-            if (filename[0] == '\0') {
-                return ERR_FC;  /* Function call error - no filename */
-            }
+        }
+        return stmt_goto(state, line_num);
+    }
 
-            /* Open and read the file */
-            FILE *fp = fopen(filename, "r");
-            if (!fp) {
-                io_print_cstring(state, "?FILE NOT FOUND\r\n");
-                return ERR_NONE;
+    /* Execute ALL statements in the THEN clause (colon-separated) */
+    while (pos < len && tokenized[pos] != '\0') {
+        /* Find end of this statement (colon or end of line) */
+        size_t stmt_len = 0;
+        bool in_string = false;
+        size_t scan = pos;
+        while (scan < len && tokenized[scan] != '\0') {
+            if (tokenized[scan] == '"') {
+                in_string = !in_string;
+            } else if (tokenized[scan] == ':' && !in_string) {
+                break;
             }
+            scan++;
+            stmt_len++;
+        }
 
-            /* Clear existing program */
-            stmt_new(state);
-
-            /* Read each line and store it */
-            char line[256];
-            while (fgets(line, sizeof(line), fp)) {
-                /* Remove trailing newline/CR */
-                size_t linelen = strlen(line);
-                while (linelen > 0 && (line[linelen-1] == '\n' || line[linelen-1] == '\r')) {
-                    line[--linelen] = '\0';
-                }
+        /* Save text_ptr to detect flow control changes */
+        uint16_t saved_ptr = state->text_ptr;
 
-                if (linelen > 0) {
-                    if (!basic_execute_line(state, line)) {
-                        fclose(fp);
-                        return ERR_SN;
-                    }
-                }
-            }
+        /* Execute this statement */
+        err = execute_statement(state, tokenized + pos, stmt_len);
+        if (err != ERR_NONE) return err;
 
-            fclose(fp);
-            io_print_cstring(state, "OK\r\n");
+        /* If a flow control statement modified text_ptr, stop */
+        /* (GOTO, GOSUB, NEXT continuing loop, etc.) */
+        if (basic_moved(state, saved_ptr)) {
             return ERR_NONE;
         }
 
-        case TOK_CSAVE: {
-            /* CSAVE "filename" - Save program to file */
+        /* Move past this statement */
+        pos += stmt_len;
+
+        /* Skip the colon if present */
+        if (pos < len && tokenized[pos] == ':') {
             pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+        }
 
-            /* Filename in quotes */
-            char filename[256] = "";
-            if (pos < len && tokenized[pos] == '"') {
-                pos++;  /* Skip opening quote */
-                size_t fname_len = 0;
-                while (pos < len && tokenized[pos] != '"' && fname_len < sizeof(filename) - 1) {
-                    filename[fname_len++] = (char)tokenized[pos++];
-                }
-                filename[fname_len] = '\0';
-                if (pos < len && tokenized[pos] == '"') pos++;  /* Skip closing quote */
-            }
+        /* Skip whitespace before next statement */
+        while (pos < len && tokenized[pos] == ' ') pos++;
+    }
+    return ERR_NONE;
+}
 
-            if (filename[0] == '\0') {
-                return ERR_FC;  /* Function call error - no filename */
-            }
+/** FOR var = init TO limit [STEP step] */
+static STMT_HOT basic_error_t exec_for(basic_state_t *state, const uint8_t *tokenized,
+                                       size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-            /* Open file for writing */
-            FILE *fp = fopen(filename, "w");
-            if (!fp) {
-                io_print_cstring(state, "?FILE ERROR\r\n");
-                return ERR_NONE;
-            }
+    /* Get variable name */
+    char var_name[3] = {0};
+    if (pos < len && isalpha(tokenized[pos])) {
+        var_name[0] = (char)tokenized[pos++];
+        if (pos < len && isalnum(tokenized[pos])) {
+            var_name[1] = (char)tokenized[pos++];
+        }
+        SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
+    } else {
+        return ERR_SN;
+    }
 
-            /* Iterate through program and write lines */
-            uint8_t *ptr = state->memory + state->program_start;
-            uint8_t *end = state->memory + state->program_end;
+    /* Expect = */
+    while (pos < len && tokenized[pos] == ' ') pos++;
+    if (pos >= len || tokenized[pos] != TOK_EQ) {
+        return ERR_SN;
+    }
+    pos++;
 
-            while (ptr < end) {
-                uint16_t link = (uint16_t)(ptr[0] | (ptr[1] << 8));
-                uint16_t line_num = (uint16_t)(ptr[2] | (ptr[3] << 8));
+    /* Parse initial value */
+    basic_error_t err;
+    size_t consumed;
+    mbf_t initial = eval_expression(state, tokenized + pos, len - pos,
+                                    &consumed, &err);
+    if (err != ERR_NONE) return err;
+    pos += consumed;
 
-                if (link == 0) break;
+    /* Expect TO */
+    while (pos < len && tokenized[pos] == ' ') pos++;
+    if (pos >= len || tokenized[pos] != TOK_TO) {
+        return ERR_SN;
+    }
+    pos++;
 
-                /* Detokenize the line */
-                uint8_t *line_start = ptr + 4;
-                uint8_t *line_end = state->memory + link;
-                size_t line_len = (size_t)(line_end - line_start - 1);  /* -1 for null */
+    /* Parse limit */
+    mbf_t limit = eval_expression(state, tokenized + pos, len - pos,
+                                  &consumed, &err);
+    if (err != ERR_NONE) return err;
+    pos += consumed;
 
-                char detok_buf[512];
-                size_t detok_len = detokenize_line(line_start, line_len, detok_buf, sizeof(detok_buf));
+    /* Check for STEP */
+    mbf_t step = MBF_ONE;
+    while (pos < len && tokenized[pos] == ' ') pos++;
+    if (pos < len && tokenized[pos] == TOK_STEP) {
+        pos++;
+        step = eval_expression(state, tokenized + pos, len - pos,
+                               &consumed, &err);
+        if (err != ERR_NONE) return err;
+        pos += consumed;
+    }
 
-                fprintf(fp, "%d %.*s\n", line_num, (int)detok_len, detok_buf);
+    /* The loop body starts after this statement */
+    /* We need to find the position after the current statement */
+    uint16_t next_line = state->current_line;
+    uint16_t next_ptr = state->text_ptr;
 
-                ptr = state->memory + link;
-            }
+    /* Check if there are more statements on this line */
+    const uint8_t *stmt_ptr = state->memory + state->text_ptr;
+    while (*stmt_ptr != '\0' && *stmt_ptr != ':') {
+        stmt_ptr++;
+    }
 
-            fclose(fp);
-            io_print_cstring(state, "OK\r\n");
-            return ERR_NONE;
-        }
+    if (*stmt_ptr == ':') {
+        /* More statements on this line - return to next statement */
+        next_ptr = (uint16_t)(stmt_ptr + 1 - state->memory);
+    } else {
+        /* End of line - find next line */
+        /* Go back to find line start (link bytes) */
+        uint8_t *line_ptr = state->memory + state->program_start;
+        uint8_t *end_ptr = state->memory + state->program_end;
+
+        while (line_ptr < end_ptr) {
+            uint16_t link = (uint16_t)(line_ptr[0] | (line_ptr[1] << 8));
+            uint16_t line_num = (uint16_t)(line_ptr[2] | (line_ptr[3] << 8));
+            uint8_t *line_text = line_ptr + 4;
+            uint8_t *line_end = (link > 0) ? state->memory + link : end_ptr;
 
-        case TOK_CLEAR: {
-            pos++;
-            int string_space = 0;
-            if (pos < len && isdigit(tokenized[pos])) {
-                while (pos < len && isdigit(tokenized[pos])) {
-                    string_space = string_space * 10 + (tokenized[pos] - '0');
-                    pos++;
+            if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
+                state->text_ptr < (uint16_t)(line_end - state->memory)) {
+                /* Found current line - get next line's text start */
+                if (link > 0) {
+                    next_line = (uint16_t)(state->memory[link + 2] |
+                                           (state->memory[link + 3] << 8));
+                    next_ptr = link + 4;
+                } else {
+                    /* No next line - shouldn't happen in valid FOR loop */
+                    next_ptr = state->text_ptr;
                 }
+                break;
             }
-            return stmt_clear(state, string_space);
-        }
+            (void)line_num;
 
-        case TOK_CONT: {
-            basic_error_t err = stmt_cont(state);
-            if (err != ERR_NONE) return err;
-            /* Resume program execution */
-            basic_run_program(state);
-            return ERR_NONE;
+            if (link == 0) break;
+            line_ptr = state->memory + link;
         }
+    }
 
-        case TOK_END:
-            return stmt_end(state);
+    return stmt_for(state, var_name, initial, limit, step, next_line, next_ptr);
+}
 
-        case TOK_STOP:
-            return stmt_stop(state, state->current_line, state->text_ptr);
+/** NEXT [var [, var ...]] - handles comma-separated variables */
+static STMT_HOT basic_error_t exec_next(basic_state_t *state, const uint8_t *tokenized,
+                                        size_t len, size_t pos) {
+    pos++;
 
-        case TOK_RESTORE: {
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+    do {
+        while (pos < len && tokenized[pos] == ' ') pos++;
 
-            if (pos < len && isdigit(tokenized[pos])) {
-                uint16_t line_num = 0;
-                while (pos < len && isdigit(tokenized[pos])) {
-                    line_num = line_num * 10 + (uint16_t)(tokenized[pos] - '0');
-                    pos++;
-                }
-                return stmt_restore_line(state, line_num);
+        char var_name[3] = {0};
+        if (pos < len && isalpha(tokenized[pos])) {
+            var_name[0] = (char)tokenized[pos++];
+            if (pos < len && isalnum(tokenized[pos])) {
+                var_name[1] = (char)tokenized[pos++];
             }
-            return stmt_restore(state);
+            SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
         }
 
-        case TOK_GOTO: {
-            pos++;
-            basic_error_t err;
-            size_t consumed;
-            mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                        &consumed, &err);
-            if (err != ERR_NONE) return err;
-
-            bool overflow;
-            int16_t line_num = mbf_to_int16(val, &overflow);
-            if (overflow || line_num < 0) return ERR_UL;
+        bool continue_loop;
+        basic_error_t err = stmt_next(state, var_name, &continue_loop);
+        if (err != ERR_NONE) return err;
 
-            return stmt_goto(state, (uint16_t)line_num);
+        /* If this loop continues, stmt_next set text_ptr back to FOR */
+        if (continue_loop) {
+            return ERR_NONE;
         }
 
-        case TOK_GOSUB: {
-            pos++;
-            basic_error_t err;
-            size_t consumed;
-            mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                        &consumed, &err);
-            if (err != ERR_NONE) return err;
+        /* Loop finished, check for comma and another variable */
+        while (pos < len && tokenized[pos] == ' ') pos++;
+    } while (pos < len && tokenized[pos] == ',' && ++pos);
 
-            bool overflow;
-            int16_t line_num = mbf_to_int16(val, &overflow);
-            if (overflow || line_num < 0) return ERR_UL;
-
-            /* Calculate return position (after this statement) */
-            uint16_t return_ptr;
-            const uint8_t *stmt_ptr = state->memory + state->text_ptr;
-            while (*stmt_ptr != '\0' && *stmt_ptr != ':') {
-                stmt_ptr++;
-            }
+    /* All loops finished, continue to next statement */
+    return ERR_NONE;
+}
 
-            if (*stmt_ptr == ':') {
-                /* More statements on this line - return to next statement */
-                return_ptr = (uint16_t)(stmt_ptr + 1 - state->memory);
-            } else {
-                /* End of line - find next line */
-                uint8_t *line_ptr = state->memory + state->program_start;
-                uint8_t *end_ptr = state->memory + state->program_end;
-                return_ptr = state->text_ptr;  /* Default if not found */
-
-                while (line_ptr < end_ptr) {
-                    uint16_t link = (uint16_t)(line_ptr[0] | (line_ptr[1] << 8));
-                    uint8_t *line_text = line_ptr + 4;
-                    uint8_t *line_end = (link > 0) ? state->memory + link : end_ptr;
-
-                    if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
-                        state->text_ptr < (uint16_t)(line_end - state->memory)) {
-                        if (link > 0) {
-                            return_ptr = link + 4;
-                        } else {
-                            return_ptr = state->program_end;
-                        }
-                        break;
-                    }
+/** GOTO line */
+static STMT_HOT basic_error_t exec_goto(basic_state_t *state, const uint8_t *tokenized,
+                                        size_t len, size_t pos) {
+    pos++;
+    basic_error_t err;
+    size_t consumed;
+    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                &consumed, &err);
+    if (err != ERR_NONE) return err;
+
+    bool overflow;
+    int16_t line_num = mbf_to_int16(val, &overflow);
+    if (overflow || line_num < 0) return ERR_UL;
+
+    return stmt_goto(state, (uint16_t)line_num);
+}
+
+/** GOSUB line */
+static STMT_HOT basic_error_t exec_gosub(basic_state_t *state, const uint8_t *tokenized,
+                                         size_t len, size_t pos) {
+    pos++;
+    basic_error_t err;
+    size_t consumed;
+    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                &consumed, &err);
+    if (err != ERR_NONE) return err;
+
+    bool overflow;
+    int16_t line_num = mbf_to_int16(val, &overflow);
+    if (overflow || line_num < 0) return ERR_UL;
+
+    /* Calculate return position (after this statement) */
+    uint16_t return_ptr;
+    const uint8_t *stmt_ptr = state->memory + state->text_ptr;
+    while (*stmt_ptr != '\0' && *stmt_ptr != ':') {
+        stmt_ptr++;
+    }
+
+    if (*stmt_ptr == ':') {
+        /* More statements on this line - return to next statement */
+        return_ptr = (uint16_t)(stmt_ptr + 1 - state->memory);
+    } else {
+        /* End of line - find next line */
+        uint8_t *line_ptr = state->memory + state->program_start;
+        uint8_t *end_ptr = state->memory + state->program_end;
+        return_ptr = state->text_ptr;  /* Default if not found */
 
-                    if (link == 0) break;
-                    line_ptr = state->memory + link;
+        while (line_ptr < end_ptr) {
+            uint16_t link = (uint16_t)(line_ptr[0] | (line_ptr[1] << 8));
+            uint8_t *line_text = line_ptr + 4;
+            uint8_t *line_end = (link > 0) ? state->memory + link : end_ptr;
+
+            if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
+                state->text_ptr < (uint16_t)(line_end - state->memory)) {
+                if (link > 0) {
+                    return_ptr = link + 4;
+                } else {
+                    return_ptr = state->program_end;
                 }
+                break;
             }
 
-            return stmt_gosub(state, (uint16_t)line_num,
-                              state->current_line, return_ptr);
+            if (link == 0) break;
+            line_ptr = state->memory + link;
         }
+    }
 
-        case TOK_RETURN:
-            return stmt_return(state);
+    return stmt_gosub(state, (uint16_t)line_num,
+                      state->current_line, return_ptr);
+}
 
-        case TOK_FOR: {
-            /* FOR var = init TO limit [STEP step] */
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+/** RETURN */
+static STMT_HOT basic_error_t exec_return(basic_state_t *state, const uint8_t *tokenized,
+                                          size_t len, size_t pos) {
+    STMT_NO_OPERANDS();
 
-            /* Get variable name */
-            char var_name[3] = {0};
-            if (pos < len && isalpha(tokenized[pos])) {
-                var_name[0] = (char)tokenized[pos++];
-                if (pos < len && isalnum(tokenized[pos])) {
-                    var_name[1] = (char)tokenized[pos++];
-                }
-                SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
-            } else {
-                return ERR_SN;
-            }
+    return stmt_return(state);
+}
 
-            /* Expect = */
-            while (pos < len && tokenized[pos] == ' ') pos++;
-            if (pos >= len || tokenized[pos] != TOK_EQ) {
-                return ERR_SN;
-            }
-            pos++;
+/** ON expr GOTO/GOSUB line[,line...] */
+static STMT_HOT basic_error_t exec_on(basic_state_t *state, const uint8_t *tokenized,
+                                      size_t len, size_t pos) {
+    pos++;
 
-            /* Parse initial value */
-            basic_error_t err;
+    /* Evaluate selector expression */
+    basic_error_t err;
+    size_t consumed;
+    mbf_t selector = eval_expression(state, tokenized + pos, len - pos,
+                                     &consumed, &err);
+    if (err != ERR_NONE) return err;
+    pos += consumed;
+
+    bool overflow;
+    int16_t value = mbf_to_int16(selector, &overflow);
+    if (overflow) return ERR_FC;
+
+    /* Check for GOTO or GOSUB */
+    while (pos < len && tokenized[pos] == ' ') pos++;
+    bool is_gosub = false;
+    if (pos < len && tokenized[pos] == TOK_GOTO) {
+        pos++;
+    } else if (pos < len && tokenized[pos] == TOK_GOSUB) {
+        pos++;
+        is_gosub = true;
+    } else {
+        return ERR_SN;
+    }
+
+    /* Parse line numbers */
+    uint16_t lines[16];
+    int num_lines = 0;
+
+    while (pos < len && num_lines < 16) {
+        while (pos < len && tokenized[pos] == ' ') pos++;
+
+        if (pos >= len || !isdigit(tokenized[pos])) break;
+
+        uint16_t line_num = 0;
+        while (pos < len && isdigit(tokenized[pos])) {
+            line_num = line_num * 10 + (uint16_t)(tokenized[pos] - '0');
+            pos++;
+        }
+        lines[num_lines++] = line_num;
+
+        while (pos < len && tokenized[pos] == ' ') pos++;
+        if (pos < len && tokenized[pos] == ',') {
+            pos++;
+        } else {
+            break;
+        }
+    }
+
+    if (is_gosub) {
+        /* Calculate return position (after this statement) */
+        /* Same logic as regular GOSUB */
+        uint16_t return_ptr;
+        const uint8_t *stmt_ptr = state->memory + state->text_ptr;
+        while (*stmt_ptr != '\0' && *stmt_ptr != ':') {
+            stmt_ptr++;
+        }
+
+        if (*stmt_ptr == ':') {
+            /* More statements on this line - return to next statement */
+            return_ptr = (uint16_t)(stmt_ptr + 1 - state->memory);
+        } else {
+            /* End of line - find next line */
+            uint8_t *line_ptr = state->memory + state->program_start;
+            uint8_t *end_ptr = state->memory + state->program_end;
+            return_ptr = state->text_ptr;  /* Default if not found */
+
+            while (line_ptr < end_ptr) {
+                uint16_t link = (uint16_t)(line_ptr[0] | (line_ptr[1] << 8));
+                uint8_t *line_text = line_ptr + 4;
+                uint8_t *line_end = (link > 0) ? state->memory + link : end_ptr;
+
+                if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
+                    state->text_ptr < (uint16_t)(line_end - state->memory)) {
+                    if (link > 0) {
+                        return_ptr = link + 4;
+                    } else {
+                        return_ptr = state->program_end;
+                    }
+                    break;
+                }
+
+                if (link == 0) break;
+                line_ptr = state->memory + link;
+            }
+        }
+
+        return stmt_on_gosub(state, value, lines, num_lines,
+                             state->current_line, return_ptr);
+    } else {
+        return stmt_on_goto(state, value, lines, num_lines);
+    }
+}
+
+/*
+ * TAB( / SPC( argument at text[pos]: a lone variable or number, else an
+ * expression. Sets *consumed to the text used, before the ')'.
+ */
+static basic_error_t print_int_arg(basic_state_t *state, const uint8_t *text, size_t len,
+                                   size_t pos, size_t *consumed, int16_t *value,
+                                   bool *overflow) {
+    if (!eval_int_operand(state, text + pos, len - pos, consumed, value, overflow)) {
+        basic_error_t err;
+        mbf_t val = eval_expression(state, text + pos, len - pos, consumed, &err);
+        if (err != ERR_NONE) return err;
+        *value = mbf_to_int16(val, overflow);
+    }
+    return ERR_NONE;
+}
+
+/* Print a string result (nothing for an empty or unallocated one) */
+static void print_desc(basic_state_t *state, string_desc_t desc) {
+    if (desc.length > 0 && desc.ptr > 0) {
+        io_print_string(state, (const char *)(state->memory + desc.ptr), desc.length);
+    }
+}
+
+/* Append a step to the plan being recorded, giving up when it is full */
+static void plan_add(print_plan_t *plan, uint8_t op, size_t start, size_t length) {
+    if (!plan) return;
+    if (plan->count == PRINT_PLAN_MAX) {
+        plan->status = PRINT_PLAN_GENERIC;
+        return;
+    }
+    print_item_t *item = &plan->items[plan->count++];
+    item->op = op;
+    item->length = (uint8_t)length;
+    item->start = (uint16_t)start;
+}
+
+/*
+ * Walk a PRINT list and output it. If record is not NULL, also write the
+ * steps taken into it; every step's extent depends only on the text, so
+ * a completed recording replays exactly (see print_execute()).
+ */
+static basic_error_t print_list(basic_state_t *state, const uint8_t *tokenized,
+                                size_t len, size_t pos, print_plan_t *record) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
+
+    bool need_newline = true;
+
+    while (pos < len && tokenized[pos] != '\0' && tokenized[pos] != ':') {
+        uint8_t ch = tokenized[pos];
+
+        if (ch == '"') {
+            /* String expression starting with literal - use eval_string_desc */
+            basic_error_t err;
             size_t consumed;
-            mbf_t initial = eval_expression(state, tokenized + pos, len - pos,
-                                            &consumed, &err);
+            string_desc_t desc = eval_string_desc(state, tokenized + pos,
+                                                  len - pos, &consumed, &err);
             if (err != ERR_NONE) return err;
-            pos += consumed;
 
-            /* Expect TO */
-            while (pos < len && tokenized[pos] == ' ') pos++;
-            if (pos >= len || tokenized[pos] != TOK_TO) {
-                return ERR_SN;
+            /* A literal on its own is copied to string space, as the parser does */
+            size_t end = pos + 1;
+            while (end < len && tokenized[end] != '"' && tokenized[end] != '\0') end++;
+            size_t literal_len = end - (pos + 1);
+            if (end < len && tokenized[end] == '"') end++;
+            while (end < len && tokenized[end] == ' ') end++;
+            if (end == pos + consumed) {
+                plan_add(record, PRINT_LITERAL, pos + 1, literal_len);
+            } else {
+                plan_add(record, PRINT_STRING, pos, 0);
             }
-            pos++;
+            pos += consumed;
 
-            /* Parse limit */
-            mbf_t limit = eval_expression(state, tokenized + pos, len - pos,
-                                          &consumed, &err);
+            print_desc(state, desc);
+            need_newline = true;
+        } else if (ch == ';') {
+            /* Semicolon - no space */
+            pos++;
+            need_newline = false;
+        } else if (ch == ',') {
+            /* Comma - tab to next zone */
+            plan_add(record, PRINT_ZONE, pos, 0);
+            io_zone(state);
+            pos++;
+            need_newline = false;
+        } else if (ch == TOK_TAB || ch == TOK_SPC) {
+            /* TAB/SPC function - token includes the '(' */
+            pos++;
+            size_t consumed;
+            bool overflow;
+            int16_t value;
+            basic_error_t err = print_int_arg(state, tokenized, len, pos, &consumed,
+                                              &value, &overflow);
             if (err != ERR_NONE) return err;
+            plan_add(record, ch == TOK_TAB ? PRINT_TAB : PRINT_SPC, pos, 0);
             pos += consumed;
+            if (pos < len && tokenized[pos] == ')') pos++;
 
-            /* Check for STEP */
-            mbf_t step = MBF_ONE;
-            while (pos < len && tokenized[pos] == ' ') pos++;
-            if (pos < len && tokenized[pos] == TOK_STEP) {
-                pos++;
-                step = eval_expression(state, tokenized + pos, len - pos,
-                                       &consumed, &err);
+            if (ch == TOK_TAB && !overflow && value >= 1) {
+                io_tab(state, value);
+            } else if (ch == TOK_SPC && !overflow && value >= 0) {
+                io_spc(state, value);
+            }
+            need_newline = false;  /* TAB/SPC don't imply newline */
+        } else if (ch == ' ') {
+            pos++;
+        } else if (isalpha(ch)) {
+            /* Check for string variable or function */
+            size_t save_pos = pos;
+            pos++;
+            if (pos < len && isalnum(tokenized[pos])) pos++;
+
+            if (pos < len && tokenized[pos] == '$') {
+                /* Check if this is a string comparison (result is numeric) */
+                /* Look ahead past $ and any array subscript to see if comparison follows */
+                size_t look_pos = pos + 1;  /* Skip $ */
+                /* Skip any remaining variable name chars in look_pos */
+                while (look_pos < len && isalnum(tokenized[look_pos])) look_pos++;
+                if (look_pos < len && tokenized[look_pos] == '(') {
+                    /* Skip array subscript */
+                    int paren_depth = 1;
+                    look_pos++;
+                    while (look_pos < len && paren_depth > 0) {
+                        if (tokenized[look_pos] == '(') paren_depth++;
+                        else if (tokenized[look_pos] == ')') paren_depth--;
+                        look_pos++;
+                    }
+                }
+                /* Skip spaces */
+                while (look_pos < len && tokenized[look_pos] == ' ') look_pos++;
+                /* Check for comparison operator */
+                bool is_comparison = false;
+                if (look_pos < len) {
+                    uint8_t next_ch = tokenized[look_pos];
+                    if (next_ch == TOK_LT || next_ch == TOK_GT || next_ch == TOK_EQ ||
+                        next_ch == '<' || next_ch == '>' || next_ch == '=') {
+                        is_comparison = true;
+                    }
+                }
+
+                pos = save_pos;  /* Restore to start of expression */
+                basic_error_t err;
+                size_t consumed;
+                if (is_comparison) {
+                    /* String comparison - result is numeric, use eval_expression */
+                    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                                &consumed, &err);
+                    if (err != ERR_NONE) return err;
+                    plan_add(record, PRINT_NUMBER, pos, 0);
+                    io_print_number(state, val);
+                } else {
+                    /* Pure string expression - use eval_string_desc */
+                    string_desc_t desc = eval_string_desc(state, tokenized + pos,
+                                                          len - pos, &consumed, &err);
+                    if (err != ERR_NONE) return err;
+                    plan_add(record, PRINT_STRING, pos, 0);
+                    print_desc(state, desc);
+                }
+                pos += consumed;
+                need_newline = true;
+            } else {
+                /* Numeric variable or expression - restore and evaluate */
+                pos = save_pos;
+                basic_error_t err;
+                size_t consumed;
+                mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                            &consumed, &err);
                 if (err != ERR_NONE) return err;
+                plan_add(record, PRINT_NUMBER, pos, 0);
                 pos += consumed;
+
+                io_print_number(state, val);
+                need_newline = true;
             }
+        } else if (TOK_IS_STRING_FUNC(ch)) {
+            /* String function */
+            basic_error_t err;
+            size_t consumed;
+            string_desc_t desc = eval_string_desc(state, tokenized + pos,
+                                                  len - pos, &consumed, &err);
+            if (err != ERR_NONE) return err;
+            plan_add(record, PRINT_STRING, pos, 0);
+            pos += consumed;
 
-            /* The loop body starts after this statement */
-            /* We need to find the position after the current statement */
-            uint16_t next_line = state->current_line;
-            uint16_t next_ptr = state->text_ptr;
+            print_desc(state, desc);
+            need_newline = true;
+        } else {
+            /* Numeric expression */
+            basic_error_t err;
+            size_t consumed;
+            mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                        &consumed, &err);
+            if (err != ERR_NONE) return err;
+            plan_add(record, PRINT_NUMBER, pos, 0);
+            pos += consumed;
 
-            /* Check if there are more statements on this line */
-            const uint8_t *stmt_ptr = state->memory + state->text_ptr;
-            while (*stmt_ptr != '\0' && *stmt_ptr != ':') {
-                stmt_ptr++;
-            }
+            io_print_number(state, val);
+            need_newline = true;
+        }
+    }
 
-            if (*stmt_ptr == ':') {
-                /* More statements on this line - return to next statement */
-                next_ptr = (uint16_t)(stmt_ptr + 1 - state->memory);
-            } else {
-                /* End of line - find next line */
-                /* Go back to find line start (link bytes) */
-                uint8_t *line_ptr = state->memory + state->program_start;
-                uint8_t *end_ptr = state->memory + state->program_end;
-
-                while (line_ptr < end_ptr) {
-                    uint16_t link = (uint16_t)(line_ptr[0] | (line_ptr[1] << 8));
-                    uint16_t line_num = (uint16_t)(line_ptr[2] | (line_ptr[3] << 8));
-                    uint8_t *line_text = line_ptr + 4;
-                    uint8_t *line_end = (link > 0) ? state->memory + link : end_ptr;
-
-                    if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
-                        state->text_ptr < (uint16_t)(line_end - state->memory)) {
-                        /* Found current line - get next line's text start */
-                        if (link > 0) {
-                            next_line = (uint16_t)(state->memory[link + 2] |
-                                                   (state->memory[link + 3] << 8));
-                            next_ptr = link + 4;
-                        } else {
-                            /* No next line - shouldn't happen in valid FOR loop */
-                            next_ptr = state->text_ptr;
-                        }
-                        break;
-                    }
-                    (void)line_num;
+    if (need_newline) {
+        io_newline(state);
+    }
+    if (record && record->status == PRINT_PLAN_NONE) {
+        record->newline = need_newline;
+        record->status = PRINT_PLAN_READY;
+    }
+    return ERR_NONE;
+}
 
-                    if (link == 0) break;
-                    line_ptr = state->memory + link;
+/* Output a recorded PRINT: the same steps, without walking the list */
+static basic_error_t print_replay(basic_state_t *state, const uint8_t *text, size_t len,
+                                  const print_plan_t *plan) {
+    for (uint8_t i = 0; i < plan->count; i++) {
+        const print_item_t *item = &plan->items[i];
+        size_t pos = item->start;
+        basic_error_t err = ERR_NONE;
+        size_t consumed;
+
+        switch ((print_op_t)item->op) {
+            case PRINT_LITERAL:
+                if (item->length > 0) {
+                    print_desc(state, string_create_len(state, (const char *)(text + pos),
+                                                        item->length));
                 }
+                break;
+
+            case PRINT_STRING: {
+                string_desc_t desc = eval_string_desc(state, text + pos, len - pos,
+                                                      &consumed, &err);
+                if (err != ERR_NONE) return err;
+                print_desc(state, desc);
+                break;
+            }
+
+            case PRINT_NUMBER: {
+                mbf_t val = eval_expression(state, text + pos, len - pos, &consumed, &err);
+                if (err != ERR_NONE) return err;
+                io_print_number(state, val);
+                break;
             }
 
-            return stmt_for(state, var_name, initial, limit, step, next_line, next_ptr);
+            case PRINT_ZONE:
+                io_zone(state);
+                break;
+
+            case PRINT_TAB:
+            case PRINT_SPC: {
+                bool overflow;
+                int16_t value;
+                err = print_int_arg(state, text, len, pos, &consumed, &value, &overflow);
+                if (err != ERR_NONE) return err;
+                if (item->op == PRINT_TAB && !overflow && value >= 1) {
+                    io_tab(state, value);
+                } else if (item->op == PRINT_SPC && !overflow && value >= 0) {
+                    io_spc(state, value);
+                }
+                break;
+            }
         }
+    }
 
-        case TOK_NEXT: {
-            /* NEXT [var [, var ...]] - handles comma-separated variables */
+    if (plan->newline) {
+        io_newline(state);
+    }
+    return ERR_NONE;
+}
+
+basic_error_t print_execute(basic_state_t *state, const uint8_t *text, size_t len,
+                            size_t pos, print_plan_t *plan) {
+    if (plan->status == PRINT_PLAN_READY) {
+        return print_replay(state, text, len, plan);
+    }
+    if (plan->status == PRINT_PLAN_NONE) {
+        plan->count = 0;
+        basic_error_t err = print_list(state, text, len, pos, plan);
+        if (err != ERR_NONE && plan->status == PRINT_PLAN_NONE) plan->count = 0;
+        return err;
+    }
+    return print_list(state, text, len, pos, NULL);
+}
+
+/** PRINT / ? [item][;|,]... */
+static STMT_HOT basic_error_t exec_print(basic_state_t *state, const uint8_t *tokenized,
+                                         size_t len, size_t pos) {
+    return print_list(state, tokenized, len, pos, NULL);
+}
+
+/** REM comment */
+static STMT_HOT basic_error_t exec_rem(basic_state_t *state, const uint8_t *tokenized,
+                                       size_t len, size_t pos) {
+    (void)state;
+    STMT_NO_OPERANDS();
+
+    return ERR_NONE;
+}
+
+/** DATA constants (skipped; only used by READ) */
+static STMT_HOT basic_error_t exec_data(basic_state_t *state, const uint8_t *tokenized,
+                                        size_t len, size_t pos) {
+    (void)state;
+    STMT_NO_OPERANDS();
+
+    return ERR_NONE;
+}
+
+/* Other run-time statements */
+
+/** INPUT ["prompt";] var[,var...] */
+static basic_error_t exec_input(basic_state_t *state, const uint8_t *tokenized,
+                                size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
+
+    /* Check for prompt string */
+    const char *prompt = "? ";
+    if (pos < len && tokenized[pos] == '"') {
+        pos++;
+        while (pos < len && tokenized[pos] != '"') {
+            io_putchar(state, (char)tokenized[pos]);
+            pos++;
+        }
+        if (pos < len && tokenized[pos] == '"') pos++;
+        if (pos < len && tokenized[pos] == ';') {
+            pos++;
+            prompt = "? ";
+        } else if (pos < len && tokenized[pos] == ',') {
             pos++;
+            prompt = "";  /* No question mark */
+        }
+    }
 
-            do {
-                while (pos < len && tokenized[pos] == ' ') pos++;
+    /* Print prompt */
+    io_print_cstring(state, prompt);
 
-                char var_name[3] = {0};
-                if (pos < len && isalpha(tokenized[pos])) {
-                    var_name[0] = (char)tokenized[pos++];
-                    if (pos < len && isalnum(tokenized[pos])) {
-                        var_name[1] = (char)tokenized[pos++];
-                    }
-                    SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
-                }
+    /* Read input line */
+    char input_buf[256];
+    size_t input_len;
+    if (!io_input_line(state, input_buf, sizeof(input_buf), &input_len)) {
+        return ERR_NONE;  /* Ctrl-C pressed */
+    }
 
-                bool continue_loop;
-                basic_error_t err = stmt_next(state, var_name, &continue_loop);
-                if (err != ERR_NONE) return err;
+    /* Parse multiple variables, each getting a value from input */
+    const char *input_ptr = input_buf;
 
-                /* If this loop continues, stmt_next set text_ptr back to FOR */
-                if (continue_loop) {
-                    return ERR_NONE;
-                }
+    while (pos < len && tokenized[pos] != ':' && tokenized[pos] != '\0') {
+        while (pos < len && tokenized[pos] == ' ') pos++;
 
-                /* Loop finished, check for comma and another variable */
-                while (pos < len && tokenized[pos] == ' ') pos++;
-            } while (pos < len && tokenized[pos] == ',' && ++pos);
+        if (!isalpha(tokenized[pos])) break;
 
-            /* All loops finished, continue to next statement */
-            return ERR_NONE;
+        /* Parse variable name */
+        char var_name[4] = {0};
+        size_t name_len = 0;
+        var_name[name_len++] = (char)tokenized[pos++];
+        if (pos < len && isalnum(tokenized[pos])) {
+            var_name[name_len++] = (char)tokenized[pos++];
         }
+        SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
 
-        case TOK_IF: {
-            /* IF expr THEN statements / line_num */
-            pos++;
+        /* Check for array subscript */
+        int16_t idx1 = 0, idx2 = -1;
+        bool is_array = false;
+        if (pos < len && tokenized[pos] == '(') {
+            is_array = true;
+            pos++;  /* Skip ( */
 
-            /* Evaluate condition */
             basic_error_t err;
             size_t consumed;
-            mbf_t condition = eval_expression(state, tokenized + pos, len - pos,
-                                              &consumed, &err);
+            mbf_t idx1_val = eval_expression(state, tokenized + pos, len - pos,
+                                             &consumed, &err);
             if (err != ERR_NONE) return err;
             pos += consumed;
 
-            /* Expect THEN */
-            while (pos < len && tokenized[pos] == ' ') pos++;
-            if (pos >= len || tokenized[pos] != TOK_THEN) {
-                return ERR_SN;
-            }
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+            bool overflow;
+            idx1 = mbf_to_int16(idx1_val, &overflow);
+            if (overflow) return ERR_BS;
 
-            /* If condition is false, skip rest of line (not just THEN clause) */
-            if (!stmt_if_eval(condition)) {
-                /* Find end of line (null terminator) and set text_ptr there */
-                /* This causes the main loop to advance to the next line */
-                uint8_t *ptr = state->memory + state->text_ptr;
-                while (*ptr != '\0') ptr++;
-                state->text_ptr = (uint16_t)(ptr - state->memory);
-                return ERR_NONE;
+            /* Check for second dimension */
+            if (pos < len && tokenized[pos] == ',') {
+                pos++;
+                mbf_t idx2_val = eval_expression(state, tokenized + pos, len - pos,
+                                                 &consumed, &err);
+                if (err != ERR_NONE) return err;
+                pos += consumed;
+                idx2 = mbf_to_int16(idx2_val, &overflow);
+                if (overflow) return ERR_BS;
             }
 
-            /* Condition is true - check if THEN is followed by line number */
-            if (pos < len && isdigit(tokenized[pos])) {
-                /* GOTO the line number */
-                uint16_t line_num = 0;
-                while (pos < len && isdigit(tokenized[pos])) {
-                    line_num = line_num * 10 + (uint16_t)(tokenized[pos] - '0');
-                    pos++;
-                }
-                return stmt_goto(state, line_num);
+            if (pos >= len || tokenized[pos] != ')') {
+                return ERR_SN;
             }
+            pos++;  /* Skip ) */
+        }
 
-            /* Execute ALL statements in the THEN clause (colon-separated) */
-            while (pos < len && tokenized[pos] != '\0') {
-                /* Find end of this statement (colon or end of line) */
-                size_t stmt_len = 0;
-                bool in_string = false;
-                size_t scan = pos;
-                while (scan < len && tokenized[scan] != '\0') {
-                    if (tokenized[scan] == '"') {
-                        in_string = !in_string;
-                    } else if (tokenized[scan] == ':' && !in_string) {
-                        break;
-                    }
-                    scan++;
-                    stmt_len++;
-                }
-
-                /* Save text_ptr to detect flow control changes */
-                uint16_t saved_ptr = state->text_ptr;
+        /* Check for string variable */
+        if (pos < len && tokenized[pos] == '$') {
+            pos++;  /* Skip $ */
+            var_name[name_len] = '$';
 
-                /* Execute this statement */
-                err = execute_statement(state, tokenized + pos, stmt_len);
-                if (err != ERR_NONE) return err;
+            /* Find end of this input value (comma or end) */
+            const char *end = input_ptr;
+            while (*end && *end != ',') end++;
+            size_t val_len = (size_t)(end - input_ptr);
+            if (val_len > 255) val_len = 255;
 
-                /* If a flow control statement modified text_ptr, stop */
-                /* (GOTO, GOSUB, NEXT continuing loop, etc.) */
-                if (state->text_ptr != saved_ptr) {
-                    return ERR_NONE;
+            /* Create string from this portion of input */
+            string_desc_t desc = string_create_len(state, input_ptr, (uint8_t)val_len);
+            basic_error_t err;
+            if (is_array) {
+                if (!array_set_string(state, var_name, idx1, idx2, desc)) {
+                    return ERR_BS;
                 }
+                err = ERR_NONE;
+            } else {
+                err = stmt_let_string(state, var_name, desc);
+            }
+            if (err != ERR_NONE) return err;
 
-                /* Move past this statement */
-                pos += stmt_len;
+            /* Advance input pointer past this value and comma */
+            input_ptr = end;
+            if (*input_ptr == ',') input_ptr++;
+        } else {
+            /* Parse numeric value from input */
+            mbf_t value;
+            size_t consumed = io_parse_number(input_ptr, &value);
+            if (consumed == 0) {
+                value = MBF_ZERO;
+            }
 
-                /* Skip the colon if present */
-                if (pos < len && tokenized[pos] == ':') {
-                    pos++;
+            basic_error_t err;
+            if (is_array) {
+                if (!array_set_numeric(state, var_name, idx1, idx2, value)) {
+                    return ERR_BS;
                 }
-
-                /* Skip whitespace before next statement */
-                while (pos < len && tokenized[pos] == ' ') pos++;
+                err = ERR_NONE;
+            } else {
+                err = stmt_let_numeric(state, var_name, value);
             }
-            return ERR_NONE;
+            if (err != ERR_NONE) return err;
+
+            /* Advance input pointer past this value and comma */
+            input_ptr += consumed;
+            while (*input_ptr == ' ') input_ptr++;
+            if (*input_ptr == ',') input_ptr++;
         }
 
-        case TOK_INPUT: {
-            /* INPUT ["prompt";] var[,var...] */
+        /* Skip comma in token stream for next variable */
+        while (pos < len && tokenized[pos] == ' ') pos++;
+        if (pos < len && tokenized[pos] == ',') {
             pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+        }
+    }
+    return ERR_NONE;
+}
 
-            /* Check for prompt string */
-            const char *prompt = "? ";
-            if (pos < len && tokenized[pos] == '"') {
-                pos++;
-                while (pos < len && tokenized[pos] != '"') {
-                    io_putchar(state, (char)tokenized[pos]);
-                    pos++;
-                }
-                if (pos < len && tokenized[pos] == '"') pos++;
-                if (pos < len && tokenized[pos] == ';') {
-                    pos++;
-                    prompt = "? ";
-                } else if (pos < len && tokenized[pos] == ',') {
-                    pos++;
-                    prompt = "";  /* No question mark */
-                }
-            }
+/** READ var[,var...] */
+static basic_error_t exec_read(basic_state_t *state, const uint8_t *tokenized,
+                               size_t len, size_t pos) {
+    pos++;
 
-            /* Print prompt */
-            io_print_cstring(state, prompt);
+    while (pos < len) {
+        while (pos < len && tokenized[pos] == ' ') pos++;
 
-            /* Read input line */
-            char input_buf[256];
-            size_t input_len;
-            if (!io_input_line(state, input_buf, sizeof(input_buf), &input_len)) {
-                return ERR_NONE;  /* Ctrl-C pressed */
+        if (pos >= len || tokenized[pos] == ':' || tokenized[pos] == '\0') {
+            break;
+        }
+
+        if (isalpha(tokenized[pos])) {
+            char var_name[4] = {0};  /* Room for 2 chars + $ + null */
+            size_t name_len = 0;
+            var_name[name_len++] = (char)tokenized[pos++];
+            if (pos < len && isalnum(tokenized[pos])) {
+                var_name[name_len++] = (char)tokenized[pos++];
             }
+            SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
 
-            /* Parse multiple variables, each getting a value from input */
-            const char *input_ptr = input_buf;
+            /* Check for string variable ($ comes before array subscript) */
+            bool is_string = false;
+            if (pos < len && tokenized[pos] == '$') {
+                is_string = true;
+                var_name[name_len] = '$';
+                pos++;
+            }
 
-            while (pos < len && tokenized[pos] != ':' && tokenized[pos] != '\0') {
-                while (pos < len && tokenized[pos] == ' ') pos++;
+            /* Check for array subscript */
+            int16_t idx1 = 0, idx2 = -1;
+            bool is_array = false;
+            if (pos < len && tokenized[pos] == '(') {
+                is_array = true;
+                pos++;  /* Skip ( */
+
+                basic_error_t err;
+                size_t consumed;
+                mbf_t idx1_val = eval_expression(state, tokenized + pos, len - pos,
+                                                 &consumed, &err);
+                if (err != ERR_NONE) return err;
+                pos += consumed;
 
-                if (!isalpha(tokenized[pos])) break;
+                bool overflow;
+                idx1 = mbf_to_int16(idx1_val, &overflow);
+                if (overflow) return ERR_BS;
 
-                /* Parse variable name */
-                char var_name[4] = {0};
-                size_t name_len = 0;
-                var_name[name_len++] = (char)tokenized[pos++];
-                if (pos < len && isalnum(tokenized[pos])) {
-                    var_name[name_len++] = (char)tokenized[pos++];
-                }
-                SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
-
-                /* Check for array subscript */
-                int16_t idx1 = 0, idx2 = -1;
-                bool is_array = false;
-                if (pos < len && tokenized[pos] == '(') {
-                    is_array = true;
-                    pos++;  /* Skip ( */
-
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t idx1_val = eval_expression(state, tokenized + pos, len - pos,
+                /* Check for second dimension */
+                if (pos < len && tokenized[pos] == ',') {
+                    pos++;
+                    mbf_t idx2_val = eval_expression(state, tokenized + pos, len - pos,
                                                      &consumed, &err);
                     if (err != ERR_NONE) return err;
                     pos += consumed;
-
-                    bool overflow;
-                    idx1 = mbf_to_int16(idx1_val, &overflow);
+                    idx2 = mbf_to_int16(idx2_val, &overflow);
                     if (overflow) return ERR_BS;
+                }
 
-                    /* Check for second dimension */
-                    if (pos < len && tokenized[pos] == ',') {
-                        pos++;
-                        mbf_t idx2_val = eval_expression(state, tokenized + pos, len - pos,
-                                                         &consumed, &err);
-                        if (err != ERR_NONE) return err;
-                        pos += consumed;
-                        idx2 = mbf_to_int16(idx2_val, &overflow);
-                        if (overflow) return ERR_BS;
-                    }
-
-                    if (pos >= len || tokenized[pos] != ')') {
-                        return ERR_SN;
-                    }
-                    pos++;  /* Skip ) */
+                if (pos >= len || tokenized[pos] != ')') {
+                    return ERR_SN;
                 }
+                pos++;  /* Skip ) */
+            }
 
-                /* Check for string variable */
-                if (pos < len && tokenized[pos] == '$') {
-                    pos++;  /* Skip $ */
-                    var_name[name_len] = '$';
-
-                    /* Find end of this input value (comma or end) */
-                    const char *end = input_ptr;
-                    while (*end && *end != ',') end++;
-                    size_t val_len = (size_t)(end - input_ptr);
-                    if (val_len > 255) val_len = 255;
-
-                    /* Create string from this portion of input */
-                    string_desc_t desc = string_create_len(state, input_ptr, (uint8_t)val_len);
-                    basic_error_t err;
-                    if (is_array) {
-                        if (!array_set_string(state, var_name, idx1, idx2, desc)) {
-                            return ERR_BS;
-                        }
-                        err = ERR_NONE;
-                    } else {
-                        err = stmt_let_string(state, var_name, desc);
+            /* Read value from DATA */
+            basic_error_t err;
+            if (is_string) {
+                string_desc_t value;
+                err = io_read_string(state, &value);
+                if (err != ERR_NONE) return err;
+                if (is_array) {
+                    if (!array_set_string(state, var_name, idx1, idx2, value)) {
+                        return ERR_BS;
                     }
-                    if (err != ERR_NONE) return err;
-
-                    /* Advance input pointer past this value and comma */
-                    input_ptr = end;
-                    if (*input_ptr == ',') input_ptr++;
+                    err = ERR_NONE;
                 } else {
-                    /* Parse numeric value from input */
-                    mbf_t value;
-                    size_t consumed = io_parse_number(input_ptr, &value);
-                    if (consumed == 0) {
-                        value = MBF_ZERO;
+                    err = stmt_let_string(state, var_name, value);
+                }
+            } else {
+                mbf_t value;
+                err = io_read_numeric(state, &value);
+                if (err != ERR_NONE) return err;
+                if (is_array) {
+                    if (!array_set_numeric(state, var_name, idx1, idx2, value)) {
+                        return ERR_BS;
                     }
+                    err = ERR_NONE;
+                } else {
+                    err = stmt_let_numeric(state, var_name, value);
+                }
+            }
+            if (err != ERR_NONE) return err;
+        }
 
-                    basic_error_t err;
-                    if (is_array) {
-                        if (!array_set_numeric(state, var_name, idx1, idx2, value)) {
-                            return ERR_BS;
-                        }
-                        err = ERR_NONE;
-                    } else {
-                        err = stmt_let_numeric(state, var_name, value);
-                    }
-                    if (err != ERR_NONE) return err;
+        /* Skip comma between variables */
+        while (pos < len && tokenized[pos] == ' ') pos++;
+        if (pos < len && tokenized[pos] == ',') {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    return ERR_NONE;
+}
 
-                    /* Advance input pointer past this value and comma */
-                    input_ptr += consumed;
-                    while (*input_ptr == ' ') input_ptr++;
-                    if (*input_ptr == ',') input_ptr++;
-                }
+/** RESTORE [line] */
+static basic_error_t exec_restore(basic_state_t *state, const uint8_t *tokenized,
+                                  size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-                /* Skip comma in token stream for next variable */
-                while (pos < len && tokenized[pos] == ' ') pos++;
-                if (pos < len && tokenized[pos] == ',') {
-                    pos++;
-                }
-            }
-            return ERR_NONE;
+    if (pos < len && isdigit(tokenized[pos])) {
+        uint16_t line_num = 0;
+        while (pos < len && isdigit(tokenized[pos])) {
+            line_num = line_num * 10 + (uint16_t)(tokenized[pos] - '0');
+            pos++;
         }
+        return stmt_restore_line(state, line_num);
+    }
+    return stmt_restore(state);
+}
+
+/** DIM var(size)[,var(size)...] */
+static basic_error_t exec_dim(basic_state_t *state, const uint8_t *tokenized,
+                              size_t len, size_t pos) {
+    pos++;
 
-        case TOK_READ: {
-            /* READ var[,var...] */
+    while (pos < len) {
+        while (pos < len && tokenized[pos] == ' ') pos++;
+
+        if (pos >= len || tokenized[pos] == ':' || tokenized[pos] == '\0') {
+            break;
+        }
+
+        if (isalpha(tokenized[pos])) {
+            char var_name[4] = {0};  /* Room for 2 chars + $ + null */
+            size_t name_len = 0;
+            var_name[name_len++] = (char)tokenized[pos++];
+            if (pos < len && isalnum(tokenized[pos])) {
+                var_name[name_len++] = (char)tokenized[pos++];
+            }
+            SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
+            /* Check for string array */
+            if (pos < len && tokenized[pos] == '$') {
+                var_name[name_len] = '$';
+                pos++;
+            }
+
+            /* Expect ( */
+            while (pos < len && tokenized[pos] == ' ') pos++;
+            if (pos >= len || tokenized[pos] != '(') {
+                return ERR_SN;
+            }
             pos++;
 
-            while (pos < len) {
-                while (pos < len && tokenized[pos] == ' ') pos++;
+            /* Parse first dimension */
+            basic_error_t err;
+            size_t consumed;
+            mbf_t dim1_val = eval_expression(state, tokenized + pos, len - pos,
+                                             &consumed, &err);
+            if (err != ERR_NONE) return err;
+            pos += consumed;
 
-                if (pos >= len || tokenized[pos] == ':' || tokenized[pos] == '\0') {
-                    break;
-                }
+            bool overflow;
+            int16_t dim1 = mbf_to_int16(dim1_val, &overflow);
+            if (overflow || dim1 < 0) return ERR_BS;
 
-                if (isalpha(tokenized[pos])) {
-                    char var_name[4] = {0};  /* Room for 2 chars + $ + null */
-                    size_t name_len = 0;
-                    var_name[name_len++] = (char)tokenized[pos++];
-                    if (pos < len && isalnum(tokenized[pos])) {
-                        var_name[name_len++] = (char)tokenized[pos++];
-                    }
-                    SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
-
-                    /* Check for string variable ($ comes before array subscript) */
-                    bool is_string = false;
-                    if (pos < len && tokenized[pos] == '$') {
-                        is_string = true;
-                        var_name[name_len] = '$';
-                        pos++;
-                    }
+            int16_t dim2 = 0;
+            while (pos < len && tokenized[pos] == ' ') pos++;
+            if (pos < len && tokenized[pos] == ',') {
+                pos++;
+                mbf_t dim2_val = eval_expression(state, tokenized + pos, len - pos,
+                                                 &consumed, &err);
+                if (err != ERR_NONE) return err;
+                pos += consumed;
+                dim2 = mbf_to_int16(dim2_val, &overflow);
+                if (overflow || dim2 < 0) return ERR_BS;
+            }
+
+            /* Expect ) */
+            while (pos < len && tokenized[pos] == ' ') pos++;
+            if (pos >= len || tokenized[pos] != ')') {
+                return ERR_SN;
+            }
+            pos++;
+
+            /* Dimension the array */
+            /* Check if array already exists */
+            if (array_find(state, var_name)) {
+                return ERR_DD;  /* Double dimension */
+            }
+            uint8_t *arr = array_create(state, var_name, dim1,
+                                        dim2 > 0 ? dim2 : -1);
+            if (!arr) return ERR_OM;  /* Out of memory */
+        }
+
+        /* Skip comma between dimensions */
+        while (pos < len && tokenized[pos] == ' ') pos++;
+        if (pos < len && tokenized[pos] == ',') {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    return ERR_NONE;
+}
 
-                    /* Check for array subscript */
-                    int16_t idx1 = 0, idx2 = -1;
-                    bool is_array = false;
-                    if (pos < len && tokenized[pos] == '(') {
-                        is_array = true;
-                        pos++;  /* Skip ( */
-
-                        basic_error_t err;
-                        size_t consumed;
-                        mbf_t idx1_val = eval_expression(state, tokenized + pos, len - pos,
-                                                         &consumed, &err);
-                        if (err != ERR_NONE) return err;
-                        pos += consumed;
-
-                        bool overflow;
-                        idx1 = mbf_to_int16(idx1_val, &overflow);
-                        if (overflow) return ERR_BS;
-
-                        /* Check for second dimension */
-                        if (pos < len && tokenized[pos] == ',') {
-                            pos++;
-                            mbf_t idx2_val = eval_expression(state, tokenized + pos, len - pos,
-                                                             &consumed, &err);
-                            if (err != ERR_NONE) return err;
-                            pos += consumed;
-                            idx2 = mbf_to_int16(idx2_val, &overflow);
-                            if (overflow) return ERR_BS;
-                        }
-
-                        if (pos >= len || tokenized[pos] != ')') {
-                            return ERR_SN;
-                        }
-                        pos++;  /* Skip ) */
-                    }
+/** DEF FNx(y) = expr - define user function */
+static basic_error_t exec_def(basic_state_t *state, const uint8_t *tokenized,
+                              size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-                    /* Read value from DATA */
-                    basic_error_t err;
-                    if (is_string) {
-                        string_desc_t value;
-                        err = io_read_string(state, &value);
-                        if (err != ERR_NONE) return err;
-                        if (is_array) {
-                            if (!array_set_string(state, var_name, idx1, idx2, value)) {
-                                return ERR_BS;
-                            }
-                            err = ERR_NONE;
-                        } else {
-                            err = stmt_let_string(state, var_name, value);
-                        }
-                    } else {
-                        mbf_t value;
-                        err = io_read_numeric(state, &value);
-                        if (err != ERR_NONE) return err;
-                        if (is_array) {
-                            if (!array_set_numeric(state, var_name, idx1, idx2, value)) {
-                                return ERR_BS;
-                            }
-                            err = ERR_NONE;
-                        } else {
-                            err = stmt_let_numeric(state, var_name, value);
-                        }
-                    }
-                    if (err != ERR_NONE) return err;
-                }
+    /* Expect FN - either as token or as literal 'F' 'N' */
+    if (pos >= len) return ERR_SN;
 
-                /* Skip comma between variables */
-                while (pos < len && tokenized[pos] == ' ') pos++;
-                if (pos < len && tokenized[pos] == ',') {
-                    pos++;
-                } else {
-                    break;
-                }
-            }
-            return ERR_NONE;
+    char fn_name = 0;
+    if (tokenized[pos] == TOK_FN) {
+        /* FN was tokenized */
+        pos++;
+        if (pos >= len || !isalpha(tokenized[pos])) {
+            return ERR_SN;
         }
+        fn_name = (char)toupper(tokenized[pos]);
+        pos++;
+    } else if (toupper(tokenized[pos]) == 'F' &&
+               pos + 1 < len && toupper(tokenized[pos + 1]) == 'N' &&
+               pos + 2 < len && isalpha(tokenized[pos + 2])) {
+        /* FN was not tokenized - it's literal "FN" followed by function name */
+        pos += 2;  /* Skip 'F' and 'N' */
+        fn_name = (char)toupper(tokenized[pos]);
+        pos++;
+    } else {
+        return ERR_SN;
+    }
 
-        case TOK_DATA:
-            /* DATA is skipped during execution - only used by READ */
-            return ERR_NONE;
+    /* Store pointer to the function definition (includes parameter and expr) */
+    int fn_idx = fn_name - 'A';
+    if (fn_idx < 0 || fn_idx >= 26) return ERR_SN;
 
-        case TOK_DIM: {
-            /* DIM var(size)[,var(size)...] */
-            pos++;
+    state->user_funcs[fn_idx].name = fn_name;
+    state->user_funcs[fn_idx].line = state->current_line;
+    /* Store pointer to opening paren of parameter */
+    state->user_funcs[fn_idx].ptr = (uint16_t)(state->text_ptr + pos);
+    stmt_fn_compile(state, fn_idx);
 
-            while (pos < len) {
-                while (pos < len && tokenized[pos] == ' ') pos++;
+    /* Skip to end of line - don't evaluate the definition */
+    return ERR_NONE;
+}
 
-                if (pos >= len || tokenized[pos] == ':' || tokenized[pos] == '\0') {
-                    break;
-                }
+/** POKE addr, value */
+static basic_error_t exec_poke(basic_state_t *state, const uint8_t *tokenized,
+                               size_t len, size_t pos) {
+    pos++;
+    basic_error_t err;
+    size_t consumed;
 
-                if (isalpha(tokenized[pos])) {
-                    char var_name[4] = {0};  /* Room for 2 chars + $ + null */
-                    size_t name_len = 0;
-                    var_name[name_len++] = (char)tokenized[pos++];
-                    if (pos < len && isalnum(tokenized[pos])) {
-                        var_name[name_len++] = (char)tokenized[pos++];
-                    }
-                    SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
-                    /* Check for string array */
-                    if (pos < len && tokenized[pos] == '$') {
-                        var_name[name_len] = '$';
-                        pos++;
-                    }
+    mbf_t addr_val = eval_expression(state, tokenized + pos, len - pos,
+                                     &consumed, &err);
+    if (err != ERR_NONE) return err;
+    pos += consumed;
 
-                    /* Expect ( */
-                    while (pos < len && tokenized[pos] == ' ') pos++;
-                    if (pos >= len || tokenized[pos] != '(') {
-                        return ERR_SN;
-                    }
-                    pos++;
+    if (pos >= len || tokenized[pos] != ',') return ERR_SN;
+    pos++;
 
-                    /* Parse first dimension */
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t dim1_val = eval_expression(state, tokenized + pos, len - pos,
-                                                     &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
+    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
+                                &consumed, &err);
+    if (err != ERR_NONE) return err;
 
-                    bool overflow;
-                    int16_t dim1 = mbf_to_int16(dim1_val, &overflow);
-                    if (overflow || dim1 < 0) return ERR_BS;
-
-                    int16_t dim2 = 0;
-                    while (pos < len && tokenized[pos] == ' ') pos++;
-                    if (pos < len && tokenized[pos] == ',') {
-                        pos++;
-                        mbf_t dim2_val = eval_expression(state, tokenized + pos, len - pos,
-                                                         &consumed, &err);
-                        if (err != ERR_NONE) return err;
-                        pos += consumed;
-                        dim2 = mbf_to_int16(dim2_val, &overflow);
-                        if (overflow || dim2 < 0) return ERR_BS;
-                    }
+    bool overflow1, overflow2;
+    int16_t addr = mbf_to_int16(addr_val, &overflow1);
+    int16_t value = mbf_to_int16(val, &overflow2);
 
-                    /* Expect ) */
-                    while (pos < len && tokenized[pos] == ' ') pos++;
-                    if (pos >= len || tokenized[pos] != ')') {
-                        return ERR_SN;
-                    }
-                    pos++;
+    if (overflow1 || overflow2 || addr < 0 || value < 0 || value > 255) {
+        return ERR_FC;
+    }
 
-                    /* Dimension the array */
-                    /* Check if array already exists */
-                    if (array_find(state, var_name)) {
-                        return ERR_DD;  /* Double dimension */
-                    }
-                    uint8_t *arr = array_create(state, var_name, dim1,
-                                                dim2 > 0 ? dim2 : -1);
-                    if (!arr) return ERR_OM;  /* Out of memory */
-                }
+    return stmt_poke(state, (uint16_t)addr, (uint8_t)value);
+}
 
-                /* Skip comma between dimensions */
-                while (pos < len && tokenized[pos] == ' ') pos++;
-                if (pos < len && tokenized[pos] == ',') {
-                    pos++;
-                } else {
-                    break;
-                }
-            }
-            return ERR_NONE;
-        }
+/** NULL count */
+static basic_error_t exec_null(basic_state_t *state, const uint8_t *tokenized,
+                               size_t len, size_t pos) {
+    pos++;
+    basic_error_t err;
+    size_t consumed;
 
-        case TOK_ON: {
-            /* ON expr GOTO/GOSUB line[,line...] */
-            pos++;
+    mbf_t count_val = eval_expression(state, tokenized + pos, len - pos,
+                                      &consumed, &err);
+    if (err != ERR_NONE) return err;
 
-            /* Evaluate selector expression */
-            basic_error_t err;
-            size_t consumed;
-            mbf_t selector = eval_expression(state, tokenized + pos, len - pos,
-                                             &consumed, &err);
-            if (err != ERR_NONE) return err;
-            pos += consumed;
+    bool overflow;
+    int16_t count = mbf_to_int16(count_val, &overflow);
+    if (overflow) return ERR_FC;
 
-            bool overflow;
-            int16_t value = mbf_to_int16(selector, &overflow);
-            if (overflow) return ERR_FC;
+    return stmt_null(state, count);
+}
 
-            /* Check for GOTO or GOSUB */
-            while (pos < len && tokenized[pos] == ' ') pos++;
-            bool is_gosub = false;
-            if (pos < len && tokenized[pos] == TOK_GOTO) {
-                pos++;
-            } else if (pos < len && tokenized[pos] == TOK_GOSUB) {
-                pos++;
-                is_gosub = true;
-            } else {
-                return ERR_SN;
-            }
+/** END */
+static basic_error_t exec_end(basic_state_t *state, const uint8_t *tokenized,
+                              size_t len, size_t pos) {
+    STMT_NO_OPERANDS();
 
-            /* Parse line numbers */
-            uint16_t lines[16];
-            int num_lines = 0;
+    return stmt_end(state);
+}
 
-            while (pos < len && num_lines < 16) {
-                while (pos < len && tokenized[pos] == ' ') pos++;
+/** STOP */
+static basic_error_t exec_stop(basic_state_t *state, const uint8_t *tokenized,
+                               size_t len, size_t pos) {
+    STMT_NO_OPERANDS();
 
-                if (pos >= len || !isdigit(tokenized[pos])) break;
+    return stmt_stop(state, state->current_line, state->text_ptr);
+}
 
-                uint16_t line_num = 0;
-                while (pos < len && isdigit(tokenized[pos])) {
-                    line_num = line_num * 10 + (uint16_t)(tokenized[pos] - '0');
-                    pos++;
-                }
-                lines[num_lines++] = line_num;
+/* Commands (mostly typed in direct mode) */
 
-                while (pos < len && tokenized[pos] == ' ') pos++;
-                if (pos < len && tokenized[pos] == ',') {
-                    pos++;
-                } else {
-                    break;
-                }
-            }
+/** LIST [start][-[end]] */
+static STMT_COLD basic_error_t exec_list(basic_state_t *state, const uint8_t *tokenized,
+                                         size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-            if (is_gosub) {
-                /* Calculate return position (after this statement) */
-                /* Same logic as regular GOSUB */
-                uint16_t return_ptr;
-                const uint8_t *stmt_ptr = state->memory + state->text_ptr;
-                while (*stmt_ptr != '\0' && *stmt_ptr != ':') {
-                    stmt_ptr++;
-                }
+    uint16_t start = 0, end = 0;
 
-                if (*stmt_ptr == ':') {
-                    /* More statements on this line - return to next statement */
-                    return_ptr = (uint16_t)(stmt_ptr + 1 - state->memory);
-                } else {
-                    /* End of line - find next line */
-                    uint8_t *line_ptr = state->memory + state->program_start;
-                    uint8_t *end_ptr = state->memory + state->program_end;
-                    return_ptr = state->text_ptr;  /* Default if not found */
-
-                    while (line_ptr < end_ptr) {
-                        uint16_t link = (uint16_t)(line_ptr[0] | (line_ptr[1] << 8));
-                        uint8_t *line_text = line_ptr + 4;
-                        uint8_t *line_end = (link > 0) ? state->memory + link : end_ptr;
-
-                        if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
-                            state->text_ptr < (uint16_t)(line_end - state->memory)) {
-                            if (link > 0) {
-                                return_ptr = link + 4;
-                            } else {
-                                return_ptr = state->program_end;
-                            }
-                            break;
-                        }
-
-                        if (link == 0) break;
-                        line_ptr = state->memory + link;
-                    }
-                }
+    if (pos < len && isdigit(tokenized[pos])) {
+        /* Parse start line */
+        while (pos < len && isdigit(tokenized[pos])) {
+            start = start * 10 + (uint16_t)(tokenized[pos] - '0');
+            pos++;
+        }
+    }
 
-                return stmt_on_gosub(state, value, lines, num_lines,
-                                     state->current_line, return_ptr);
-            } else {
-                return stmt_on_goto(state, value, lines, num_lines);
+    if (pos < len && tokenized[pos] == '-') {
+        pos++;
+        if (pos < len && isdigit(tokenized[pos])) {
+            while (pos < len && isdigit(tokenized[pos])) {
+                end = end * 10 + (uint16_t)(tokenized[pos] - '0');
+                pos++;
             }
+        } else {
+            end = 0xFFFF;
         }
+    } else if (start > 0) {
+        end = start;
+    }
 
-        case TOK_DEF: {
-            /* DEF FNx(y) = expr - define user function */
-            pos++;
-            while (pos < len && tokenized[pos] == ' ') pos++;
+    basic_list_program(state, start, end);
+    return ERR_NONE;
+}
 
-            /* Expect FN - either as token or as literal 'F' 'N' */
-            if (pos >= len) return ERR_SN;
+/** RUN [line] */
+static STMT_COLD basic_error_t exec_run(basic_state_t *state, const uint8_t *tokenized,
+                                        size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-            char fn_name = 0;
-            if (tokenized[pos] == TOK_FN) {
-                /* FN was tokenized */
-                pos++;
-                if (pos >= len || !isalpha(tokenized[pos])) {
-                    return ERR_SN;
-                }
-                fn_name = (char)toupper(tokenized[pos]);
-                pos++;
-            } else if (toupper(tokenized[pos]) == 'F' &&
-                       pos + 1 < len && toupper(tokenized[pos + 1]) == 'N' &&
-                       pos + 2 < len && isalpha(tokenized[pos + 2])) {
-                /* FN was not tokenized - it's literal "FN" followed by function name */
-                pos += 2;  /* Skip 'F' and 'N' */
-                fn_name = (char)toupper(tokenized[pos]);
-                pos++;
-            } else {
-                return ERR_SN;
-            }
+    uint16_t start_line = 0;
+    if (pos < len && isdigit(tokenized[pos])) {
+        while (pos < len && isdigit(tokenized[pos])) {
+            start_line = start_line * 10 + (uint16_t)(tokenized[pos] - '0');
+            pos++;
+        }
+    }
 
-            /* Store pointer to the function definition (includes parameter and expr) */
-            int fn_idx = fn_name - 'A';
-            if (fn_idx < 0 || fn_idx >= 26) return ERR_SN;
+    basic_error_t err = stmt_run(state, start_line);
+    if (err != ERR_NONE) return err;
 
-            state->user_funcs[fn_idx].name = fn_name;
-            state->user_funcs[fn_idx].line = state->current_line;
-            /* Store pointer to opening paren of parameter */
-            state->user_funcs[fn_idx].ptr = (uint16_t)(state->text_ptr + pos);
+    /* Execute the program */
+    basic_run_program(state);
+    return ERR_NONE;
+}
 
-            /* Skip to end of line - don't evaluate the definition */
-            return ERR_NONE;
-        }
+/** NEW */
+static STMT_COLD basic_error_t exec_new(basic_state_t *state, const uint8_t *tokenized,
+                                        size_t len, size_t pos) {
+    STMT_NO_OPERANDS();
 
-        case TOK_POKE: {
-            pos++;
-            basic_error_t err;
-            size_t consumed;
+    stmt_new(state);
+    return ERR_NONE;
+}
 
-            mbf_t addr_val = eval_expression(state, tokenized + pos, len - pos,
-                                             &consumed, &err);
-            if (err != ERR_NONE) return err;
-            pos += consumed;
+/** CLOAD "filename" - Load program from file */
+static STMT_COLD basic_error_t exec_cload(basic_state_t *state, const uint8_t *tokenized,
+                                          size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-            if (pos >= len || tokenized[pos] != ',') return ERR_SN;
-            pos++;
+    /* Optional filename in quotes */
+    char filename[256] = "";
+    if (pos < len && tokenized[pos] == '"') {
+        pos++;  /* Skip opening quote */
+        size_t fname_len = 0;
+        while (pos < len && tokenized[pos] != '"' && fname_len < sizeof(filename) - 1) {
+            filename[fname_len++] = (char)tokenized[pos++];
+        }
+        filename[fname_len] = '\0';
+        if (pos < len && tokenized[pos] == '"') pos++;  /* Skip closing quote */
+    }
 
-            mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                        &consumed, &err);
-            if (err != ERR_NONE) return err;
+    if (filename[0] == '\0') {
+        return ERR_FC;  /* Function call error - no filename */
+    }
 
-            bool overflow1, overflow2;
-            int16_t addr = mbf_to_int16(addr_val, &overflow1);
-            int16_t value = mbf_to_int16(val, &overflow2);
+    /* Open and read the file */
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        io_print_cstring(state, "?FILE NOT FOUND\r\n");
+        return ERR_NONE;
+    }
 
-            if (overflow1 || overflow2 || addr < 0 || value < 0 || value > 255) {
-                return ERR_FC;
-            }
+    /* Clear existing program */
+    stmt_new(state);
 
-            return stmt_poke(state, (uint16_t)addr, (uint8_t)value);
+    /* Read each line and store it */
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        /* Remove trailing newline/CR */
+        size_t linelen = strlen(line);
+        while (linelen > 0 && (line[linelen-1] == '\n' || line[linelen-1] == '\r')) {
+            line[--linelen] = '\0';
         }
 
-        case TOK_NULL: {
-            pos++;
-            basic_error_t err;
-            size_t consumed;
+        if (linelen > 0) {
+            if (!basic_execute_line(state, line)) {
+                fclose(fp);
+                return ERR_SN;
+            }
+        }
+    }
 
-            mbf_t count_val = eval_expression(state, tokenized + pos, len - pos,
-                                              &consumed, &err);
-            if (err != ERR_NONE) return err;
+    fclose(fp);
+    io_print_cstring(state, "OK\r\n");
+    return ERR_NONE;
+}
 
-            bool overflow;
-            int16_t count = mbf_to_int16(count_val, &overflow);
-            if (overflow) return ERR_FC;
+/** CSAVE "filename" - Save program to file */
+static STMT_COLD basic_error_t exec_csave(basic_state_t *state, const uint8_t *tokenized,
+                                          size_t len, size_t pos) {
+    pos++;
+    while (pos < len && tokenized[pos] == ' ') pos++;
 
-            return stmt_null(state, count);
+    /* Filename in quotes */
+    char filename[256] = "";
+    if (pos < len && tokenized[pos] == '"') {
+        pos++;  /* Skip opening quote */
+        size_t fname_len = 0;
+        while (pos < len && tokenized[pos] != '"' && fname_len < sizeof(filename) - 1) {
+            filename[fname_len++] = (char)tokenized[pos++];
         }
+        filename[fname_len] = '\0';
+        if (pos < len && tokenized[pos] == '"') pos++;  /* Skip closing quote */
+    }
 
-        default:
-            /* Check for variable assignment (LET is optional) */
-            if (isalpha(cmd) || cmd == TOK_LET) {
-                if (cmd == TOK_LET) pos++;
+    if (filename[0] == '\0') {
+        return ERR_FC;  /* Function call error - no filename */
+    }
 
-                /* Skip spaces */
-                while (pos < len && tokenized[pos] == ' ') pos++;
-
-                /* Get variable name */
-                char var_name[4] = {0};  /* Room for 2 chars + $ + null */
-                size_t name_len = 0;
-                if (pos < len && isalpha(tokenized[pos])) {
-                    var_name[name_len++] = (char)tokenized[pos++];
-                    if (pos < len && isalnum(tokenized[pos])) {
-                        var_name[name_len++] = (char)tokenized[pos++];
-                    }
-                    SKIP_EXTRA_VAR_CHARS();  /* Skip remaining chars in long var names */
-                } else {
-                    return ERR_SN;
-                }
+    /* Open file for writing */
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        io_print_cstring(state, "?FILE ERROR\r\n");
+        return ERR_NONE;
+    }
 
-                /* Check for string variable/array first ($ comes before () in BASIC) */
-                int16_t idx1 = 0, idx2 = -1;
-                bool is_array = false;
-                bool is_string = false;
+    /* Iterate through program and write lines */
+    uint8_t *ptr = state->memory + state->program_start;
+    uint8_t *end = state->memory + state->program_end;
 
-                if (pos < len && tokenized[pos] == '$') {
-                    is_string = true;
-                    var_name[name_len] = '$';  /* Append $ to var_name */
-                    pos++;
-                }
+    while (ptr < end) {
+        uint16_t link = (uint16_t)(ptr[0] | (ptr[1] << 8));
+        uint16_t line_num = (uint16_t)(ptr[2] | (ptr[3] << 8));
 
-                /* Now check for array subscript */
-                if (pos < len && tokenized[pos] == '(') {
-                    /* Array element */
-                    is_array = true;
-                    pos++;  /* Skip ( */
+        if (link == 0) break;
 
-                    /* Parse first index */
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t idx1_val = eval_expression(state, tokenized + pos, len - pos,
-                                                     &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
+        /* Detokenize the line */
+        uint8_t *line_start = ptr + 4;
+        uint8_t *line_end = state->memory + link;
+        size_t line_len = (size_t)(line_end - line_start - 1);  /* -1 for null */
 
-                    bool overflow;
-                    idx1 = mbf_to_int16(idx1_val, &overflow);
-                    if (overflow) return ERR_BS;
+        char detok_buf[512];
+        size_t detok_len = detokenize_line(line_start, line_len, detok_buf, sizeof(detok_buf));
 
-                    /* Check for second dimension */
-                    if (pos < len && tokenized[pos] == ',') {
-                        pos++;
-                        mbf_t idx2_val = eval_expression(state, tokenized + pos, len - pos,
-                                                         &consumed, &err);
-                        if (err != ERR_NONE) return err;
-                        pos += consumed;
-                        idx2 = mbf_to_int16(idx2_val, &overflow);
-                        if (overflow) return ERR_BS;
-                    }
+        fprintf(fp, "%d %.*s\n", line_num, (int)detok_len, detok_buf);
 
-                    /* Expect ) */
-                    if (pos >= len || tokenized[pos] != ')') {
-                        return ERR_SN;
-                    }
-                    pos++;
-                }
+        ptr = state->memory + link;
+    }
 
-                /* Skip to = */
-                while (pos < len && tokenized[pos] == ' ') pos++;
+    fclose(fp);
+    io_print_cstring(state, "OK\r\n");
+    return ERR_NONE;
+}
 
-                if (pos >= len || tokenized[pos] != TOK_EQ) {
-                    return ERR_SN;
-                }
-                pos++;
+/** CLEAR [string space] */
+static STMT_COLD basic_error_t exec_clear(basic_state_t *state, const uint8_t *tokenized,
+                                          size_t len, size_t pos) {
+    pos++;
+    int string_space = 0;
+    if (pos < len && isdigit(tokenized[pos])) {
+        while (pos < len && isdigit(tokenized[pos])) {
+            string_space = string_space * 10 + (tokenized[pos] - '0');
+            pos++;
+        }
+    }
+    return stmt_clear(state, string_space);
+}
 
-                /* Skip spaces after = */
-                while (pos < len && tokenized[pos] == ' ') pos++;
+/** CONT */
+static STMT_COLD basic_error_t exec_cont(basic_state_t *state, const uint8_t *tokenized,
+                                         size_t len, size_t pos) {
+    STMT_NO_OPERANDS();
 
-                if (is_string) {
-                    /* Parse string expression (handles literals, variables, functions, concatenation) */
-                    basic_error_t err;
-                    size_t consumed;
-                    string_desc_t desc = eval_string_desc(state, tokenized + pos,
-                                                          len - pos, &consumed, &err);
-                    if (err != ERR_NONE) return err;
-                    pos += consumed;
+    basic_error_t err = stmt_cont(state);
+    if (err != ERR_NONE) return err;
+    /* Resume program execution */
+    basic_run_program(state);
+    return ERR_NONE;
+}
 
-                    if (is_array) {
-                        /* String array element assignment */
-                        if (!array_set_string(state, var_name, idx1, idx2, desc)) {
-                            return ERR_BS;  /* Bad subscript */
-                        }
-                        return ERR_NONE;
-                    }
-                    return stmt_let_string(state, var_name, desc);
-                } else {
-                    /* Evaluate numeric expression */
-                    basic_error_t err;
-                    size_t consumed;
-                    mbf_t val = eval_expression(state, tokenized + pos, len - pos,
-                                                &consumed, &err);
-                    if (err != ERR_NONE) return err;
+static const stmt_handler_t statement_handlers[256] = {
+    [TOK_PRINT]   = exec_print,
+    ['?']         = exec_print,
+    [TOK_IF]      = exec_if,
+    [TOK_FOR]     = exec_for,
+    [TOK_NEXT]    = exec_next,
+    [TOK_GOTO]    = exec_goto,
+    [TOK_GOSUB]   = exec_gosub,
+    [TOK_RETURN]  = exec_return,
+    [TOK_ON]      = exec_on,
+    [TOK_REM]     = exec_rem,
+    [TOK_DATA]    = exec_data,
+    [TOK_INPUT]   = exec_input,
+    [TOK_READ]    = exec_read,
+    [TOK_RESTORE] = exec_restore,
+    [TOK_DIM]     = exec_dim,
+    [TOK_DEF]     = exec_def,
+    [TOK_POKE]    = exec_poke,
+    [TOK_NULL]    = exec_null,
+    [TOK_END]     = exec_end,
+    [TOK_STOP]    = exec_stop,
+    [TOK_LIST]    = exec_list,
+    [TOK_RUN]     = exec_run,
+    [TOK_NEW]     = exec_new,
+    [TOK_CLOAD]   = exec_cload,
+    [TOK_CSAVE]   = exec_csave,
+    [TOK_CLEAR]   = exec_clear,
+    [TOK_CONT]    = exec_cont,
+    [TOK_LET]     = exec_let,
+};
 
-                    if (is_array) {
-                        if (!array_set_numeric(state, var_name, idx1, idx2, val)) {
-                            return ERR_BS;  /* Bad subscript */
-                        }
-                        return ERR_NONE;
-                    } else {
-                        return stmt_let_numeric(state, var_name, val);
-                    }
-                }
-            }
+/**
+ * @brief Execute a tokenized statement
+ *
+ * This is the core statement dispatcher. It looks up the first token
+ * of the statement in statement_handlers[] and calls the handler.
+ * Bytes with no handler start an implicit LET (exec_let() reports SN
+ * for anything that is not a variable name).
+ *
+ * Statement Categories:
+ *
+ * **Flow Control (flow.c):**
+ * - GOTO, GOSUB, RETURN, FOR, NEXT, IF, ON, END, STOP, CONT
+ *
+ * **I/O Operations (io.c):**
+ * - PRINT, INPUT, READ, DATA, RESTORE
+ *
+ * **Variables and Memory:**
+ * - LET (implicit or explicit), DIM, POKE, DEF
+ *
+ * **Program Management:**
+ * - LIST, RUN, NEW, CLEAR, CLOAD, CSAVE
+ *
+ * **Miscellaneous:**
+ * - REM (comment, skipped), NULL
+ *
+ * @param state Interpreter state
+ * @param tokenized Tokenized statement bytes
+ * @param len Length of tokenized data
+ * @return ERR_NONE on success, error code on failure
+ *
+ * Note: This function may modify state->text_ptr for flow control
+ * statements (GOTO, GOSUB, NEXT, etc.). The caller checks if text_ptr
+ * changed to determine whether to advance normally or let the
+ * statement control flow.
+ */
+static basic_error_t execute_statement(basic_state_t *state,
+                                       const uint8_t *tokenized, size_t len) {
+    if (!state || !tokenized || len == 0) return ERR_NONE;
 
-            return ERR_SN;
+    size_t pos = 0;
+
+    /* Skip leading whitespace */
+    while (pos < len && tokenized[pos] == ' ') pos++;
+
+    /* Empty statement is not an error */
+    if (pos >= len || tokenized[pos] == '\0') {
+        return ERR_NONE;
     }
+
+    /* Dispatch on the command token (first non-space character) */
+    stmt_handler_t handler = statement_handlers[tokenized[pos]];
+    if (!handler) handler = exec_let;
+    return handler(state, tokenized, len, pos);
+}
+
+/**
+ * @brief Execute one statement stored in program memory
+ *
+ * Entry point for code outside this file (the JIT) that has already
+ * located a statement and needs it run exactly as the main loop would.
+ *
+ * @param state Interpreter state, text_ptr pointing at the statement
+ * @param offset Offset of the statement within memory[]
+ * @param len Length of the statement
+ * @return ERR_NONE on success, error code on failure
+ */
+basic_error_t basic_execute_statement(basic_state_t *state, uint16_t offset, size_t len) {
+    if (!state) return ERR_FC;
+    return execute_statement(state, state->memory + offset, len);
 }
 
 
@@ -2106,11 +2417,11 @@ static basic_error_t execute_statement(basic_state_t *state,
  * ```
  * while (running) {
  *     1. Check for Ctrl-C interrupt
- *     2. Find the line containing text_ptr
- *     3. Extract current statement (up to ':' or end of line)
- *     4. execute_statement()
- *     5. If text_ptr unchanged, advance to next statement
- *     6. If text_ptr changed (GOTO, etc.), loop back without advancing
+ *     2. Look up the decoded statement at text_ptr (quick_lookup():
+ *        owning line and length, decoded on first execution)
+ *     3. quick_execute(), or execute_statement() for the general case
+ *     4. If text_ptr unchanged, advance to next statement
+ *     5. If text_ptr changed (GOTO, etc.), loop back without advancing
  * }
  * ```
  *
@@ -2139,17 +2450,7 @@ void basic_run_program(basic_state_t *state) {
 
     while (state->running) {
         /* Check for Ctrl-C interrupt */
-        if (g_interrupt_flag) {
-            g_interrupt_flag = 0;
-            fprintf(state->output, "\nBREAK");
-            if (state->current_line > 0) {
-                fprintf(state->output, " IN %u", state->current_line);
-            }
-            fprintf(state->output, "\n");
-            state->running = false;
-            state->can_continue = true;
-            state->cont_line = state->current_line;
-            state->cont_ptr = state->text_ptr;
+        if (basic_check_interrupt(state)) {
             break;
         }
 
@@ -2159,64 +2460,61 @@ void basic_run_program(basic_state_t *state) {
             break;
         }
 
-        /* Get current line info */
-        uint8_t *line_start = NULL;
-        uint8_t *ptr = state->memory + state->program_start;
-        uint8_t *end = state->memory + state->program_end;
-
-        /* Find the line containing text_ptr */
-        while (ptr < end) {
-            uint16_t link = (uint16_t)(ptr[0] | (ptr[1] << 8));
-            uint16_t line_num = (uint16_t)(ptr[2] | (ptr[3] << 8));
-            uint8_t *line_text = ptr + 4;
-            uint8_t *line_end = (link > 0) ? state->memory + link : end;
-
-            if (state->text_ptr >= (uint16_t)(line_text - state->memory) &&
-                state->text_ptr < (uint16_t)(line_end - state->memory)) {
-                state->current_line = line_num;
-                line_start = ptr;
-                break;
-            }
-
-            if (link == 0) break;
-            ptr = state->memory + link;
-        }
-
-        if (!line_start) {
+        /* Decoded form of the statement (line, length, operands) */
+        quick_stmt_t scratch;
+        quick_stmt_t *q = quick_lookup(state, state->text_ptr, &scratch);
+        if (!q) {
             state->running = false;
             break;
         }
+        state->current_line = q->line_num;
+        uint8_t *line_start = state->memory + q->line;
+        size_t text_len = q->len;
+
+        /* Hot lines run as native code when the JIT is enabled */
+        if (state->jit && !q->jit_declined &&
+            state->text_ptr == (uint16_t)(line_start + 4 - state->memory)) {
+            basic_error_t jit_err = ERR_NONE;
+            int rc = jit_run_line(state, (uint16_t)(line_start - state->memory), &jit_err);
+
+            /* No native code ran, so q is still the current record */
+            if (rc == JIT_DECLINED) {
+                q->jit_declined = true;
+            }
 
-        /* Get the statement to execute */
-        uint8_t *text = state->memory + state->text_ptr;
-        size_t text_len = 0;
-
-        /* Skip leading spaces to find the statement token */
-        size_t skip = 0;
-        while (text[skip] == ' ') skip++;
-
-        /* For REM statements, the entire rest of line is the statement */
-        /* (colons in REM comments should not be treated as separators) */
-        if (text[skip] == TOK_REM) {
-            while (text[text_len] != '\0') text_len++;
-        } else {
-            /* Find end of statement (: or null), but skip over strings */
-            bool in_string = false;
-            while (text[text_len] != '\0') {
-                if (text[text_len] == '"') {
-                    in_string = !in_string;
-                } else if (text[text_len] == ':' && !in_string) {
+            if (rc == JIT_ERROR) {
+                basic_print_error(state, jit_err, state->current_line);
+                state->running = false;
+                state->can_continue = false;
+                break;
+            }
+            if (rc == JIT_EXIT) {
+                if (!state->running) break;
+                continue;
+            }
+            if (rc == JIT_LINE_DONE) {
+                /* Same as falling off the end of the line below */
+                uint16_t link = (uint16_t)(line_start[0] | (line_start[1] << 8));
+                if (link == 0) {
+                    state->running = false;
                     break;
                 }
-                text_len++;
+                state->text_ptr = link + 4;
+                continue;
             }
         }
 
+        /* Get the statement to execute */
+        uint8_t *text = state->memory + state->text_ptr;
+
         /* Save current position to detect flow control */
         uint16_t saved_text_ptr = state->text_ptr;
 
-        /* Execute the statement */
-        basic_error_t err = execute_statement(state, text, text_len);
+        /* Execute the statement, pre-decoded if possible */
+        basic_error_t err;
+        if (!quick_execute(state, q, &err)) {
+            err = execute_statement(state, text, text_len);
+        }
 
         if (err != ERR_NONE) {
             basic_print_error(state, err, state->current_line);
@@ -2226,7 +2524,7 @@ void basic_run_program(basic_state_t *state) {
         }
 
         /* Check if statement changed text_ptr (GOTO, GOSUB, NEXT, etc.) */
-        if (state->text_ptr != saved_text_ptr) {
+        if (basic_moved(state, saved_text_ptr)) {
             /* Statement modified text_ptr - don't override it */
             /* Check if execution was stopped */
             if (!state->running) break;
@@ -0,0 +1,893 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file jit.c
+ * @brief Optional Hot-Line Template JIT (x86-64)
+ *
+ * The interpreter spends a surprising amount of its time in the main loop
+ * rather than in the statements themselves: every statement it locates the
+ * line containing text_ptr, scans for the statement end (':' outside
+ * strings) and only then dispatches. For lines executed over and over
+ * (loop bodies, subroutines) that work is identical every time.
+ *
+ * This module removes it for hot lines. Each line gets an entry counter;
+ * when a line has been entered JIT_HOT_THRESHOLD times it is compiled to
+ * native code. Statements of a few simple shapes (see TEMPLATES below)
+ * become inline x86-64 working on variable slots resolved at compile time;
+ * every other statement becomes a call into the interpreter:
+ *
+ * ```
+ *   push rbx / r12 / r13
+ *   mov  rbx, rdi              ; state
+ *   ; --- template statement ---
+ *   <guards>                   ; jcc .slow_i
+ *   <native body>
+ *   jmp  .next_i
+ * .slow_i:
+ *   ; --- called statement (and every template's slow path) ---
+ *   mov  rdi, rbx
+ *   mov  rsi, &stmt[i]         ; offset, length, resume position
+ *   mov  rax, jit_thunk
+ *   call rax
+ *   test eax, eax
+ *   jnz  .exit                 ; flow left the line, or error
+ * .next_i:
+ *   ; ---------------------------
+ *   xor  eax, eax
+ * .exit:
+ *   pop  r13 / r12 / rbx
+ *   ret
+ * ```
+ *
+ * Templates call the same mbf_* arithmetic the parser does, and called
+ * statements run exactly as the main loop would run them (quickened record
+ * first, basic_execute_statement() otherwise), so output is bit-identical.
+ * A line with no template statement is not compiled at all: a run of calls
+ * back into the interpreter costs more than the main loop it replaces.
+ *
+ * ## Deoptimization
+ *
+ * - **Program edits:** the cache remembers state->program_gen; any change
+ *   throws away all native code and counters.
+ * - **Strings:** lines containing string literals or string variables are
+ *   never compiled (statement boundaries depend on quote state, and string
+ *   work dominates anyway). They always run in the interpreter.
+ * - **Errors:** a line whose native code reports an error is marked as
+ *   rejected and interpreted from then on.
+ * - **Unsuitable statements:** RUN, CONT, LIST, NEW, CLOAD, CSAVE and
+ *   INPUT keep the line in the interpreter.
+ *
+ * The JIT is off by default (basic_config_t.enable_jit, `basic8k -j`) and is
+ * compiled only for x86-64 POSIX systems where anonymous executable mappings
+ * are allowed; elsewhere jit_init() reports that it is unavailable.
+ */
+
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE     /* MAP_ANONYMOUS under strict C17 */
+#endif
+
+#include "basic/basic.h"
+#include "basic/tokens.h"
+#include <ctype.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(BASIC8K_JIT) && BASIC8K_JIT && defined(__x86_64__) && \
+    (defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__))
+#define JIT_SUPPORTED 1
+#include <sys/mman.h>
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+#if JIT_SUPPORTED
+
+/** Line entries before a line is compiled */
+#define JIT_HOT_THRESHOLD   32
+
+/** Line table size (power of two, open addressing) */
+#define JIT_MAX_LINES       4096
+
+/** Statement descriptors available across all compiled lines */
+#define JIT_MAX_STMTS       8192
+
+/** Executable buffer size */
+#define JIT_CODE_SIZE       (256 * 1024)
+
+/** Most bytes one statement can emit, and a whole line */
+#define JIT_STMT_BYTES      512
+#define JIT_LINE_BYTES      (16 * 1024)
+
+/** Size of a simple variable entry */
+#define VAR_SIZE            6
+
+/** Integer loops stay below this magnitude (FOR_INT_RANGE in flow.c) */
+#define JIT_INT_RANGE       0x1000000
+
+/* Line status */
+#define JIT_COLD        0   /* Counting entries */
+#define JIT_COMPILED    1   /* Native code available */
+#define JIT_REJECTED    2   /* Never compile (strings, error, ...) */
+
+/* Thunk results (non-zero leaves the native line) */
+#define THUNK_NEXT      0
+#define THUNK_EXIT      1
+#define THUNK_ERROR     2
+
+/**
+ * One statement inside a compiled line.
+ * The native code passes a pointer to this to jit_thunk().
+ */
+typedef struct {
+    uint16_t offset;        /**< Statement start in memory[] */
+    uint16_t len;           /**< Statement length */
+    uint16_t resume;        /**< text_ptr after the statement (for STOP/CONT) */
+} jit_stmt_t;
+
+typedef int (*jit_code_fn)(basic_state_t *state);
+
+typedef struct {
+    uint16_t line_offset;   /**< Line header offset (0xFFFF = empty slot) */
+    uint16_t count;         /**< Entries while cold */
+    uint8_t status;         /**< JIT_COLD / JIT_COMPILED / JIT_REJECTED */
+    jit_code_fn code;       /**< Native code when compiled */
+} jit_line_t;
+
+struct basic_jit {
+    uint32_t program_gen;   /**< Program generation the cache belongs to */
+    uint8_t *code;          /**< mmap'd code buffer */
+    size_t code_used;
+    int compiled;           /**< Lines currently compiled */
+    int stmt_count;
+    basic_error_t error;    /**< Error reported by the last thunk */
+    jit_line_t lines[JIT_MAX_LINES];
+    jit_stmt_t stmts[JIT_MAX_STMTS];
+    uint8_t line_code[JIT_LINE_BYTES];  /**< A line being compiled */
+};
+
+
+/*============================================================================
+ * RUNTIME THUNK
+ *============================================================================*/
+
+/*
+ * Called from native code for every statement. Mirrors one iteration of
+ * the interpreter's main loop, minus the line search and statement scan.
+ */
+static int jit_thunk(basic_state_t *state, const jit_stmt_t *stmt) {
+    state->text_ptr = stmt->offset;
+
+    quick_stmt_t scratch;
+    quick_stmt_t *q = quick_lookup(state, stmt->offset, &scratch);
+    basic_error_t err;
+    if (!q || !quick_execute(state, q, &err)) {
+        err = basic_execute_statement(state, stmt->offset, stmt->len);
+    }
+    if (err != ERR_NONE) {
+        state->jit->error = err;
+        return THUNK_ERROR;
+    }
+
+    /* GOTO, GOSUB, NEXT, false IF, ... */
+    if (basic_moved(state, stmt->offset)) {
+        return THUNK_EXIT;
+    }
+
+    /* END or STOP: step past the statement the way the main loop does */
+    if (!state->running) {
+        state->text_ptr = stmt->resume;
+        if (state->can_continue) {
+            state->cont_ptr = state->text_ptr;
+        }
+        return THUNK_EXIT;
+    }
+
+    return THUNK_NEXT;
+}
+
+
+/*============================================================================
+ * CODE CACHE
+ *============================================================================*/
+
+static void jit_flush(struct basic_jit *jit, uint32_t program_gen) {
+    for (int i = 0; i < JIT_MAX_LINES; i++) {
+        jit->lines[i].line_offset = 0xFFFF;
+        jit->lines[i].count = 0;
+        jit->lines[i].status = JIT_COLD;
+        jit->lines[i].code = NULL;
+    }
+    jit->code_used = 0;
+    jit->compiled = 0;
+    jit->stmt_count = 0;
+    jit->program_gen = program_gen;
+}
+
+static jit_line_t *jit_lookup(struct basic_jit *jit, uint16_t line_offset) {
+    uint32_t h = ((uint32_t)line_offset * 2654435761u) >> 20;
+
+    for (int probe = 0; probe < JIT_MAX_LINES; probe++) {
+        jit_line_t *entry = &jit->lines[(h + (uint32_t)probe) & (JIT_MAX_LINES - 1)];
+        if (entry->line_offset == line_offset) return entry;
+        if (entry->line_offset == 0xFFFF) {
+            entry->line_offset = line_offset;
+            return entry;
+        }
+    }
+    return NULL;  /* Table full - interpret */
+}
+
+static void emit_u8(uint8_t **p, uint8_t b) {
+    *(*p)++ = b;
+}
+
+static void emit_u32(uint8_t **p, uint32_t v) {
+    memcpy(*p, &v, 4);
+    *p += 4;
+}
+
+static void emit_u64(uint8_t **p, uint64_t v) {
+    memcpy(*p, &v, 8);
+    *p += 8;
+}
+
+static void emit_bytes(uint8_t **p, const uint8_t *bytes, size_t n) {
+    memcpy(*p, bytes, n);
+    *p += n;
+}
+
+/* x86 condition codes for Jcc rel32 (0F 8x); 0 is an unconditional JMP */
+#define CC_ALWAYS   0x00
+#define CC_E        0x84
+#define CC_NE       0x85
+#define CC_BE       0x86
+#define CC_L        0x8C
+#define CC_GE       0x8D
+#define CC_LE       0x8E
+#define CC_G        0x8F
+
+/* Jump with its rel32 left to patch_jump(); returns the rel32 field */
+static uint8_t *emit_jump(uint8_t **p, uint8_t cc) {
+    if (cc == CC_ALWAYS) {
+        emit_u8(p, 0xE9);
+    } else {
+        emit_u8(p, 0x0F);
+        emit_u8(p, cc);
+    }
+    uint8_t *field = *p;
+    emit_u32(p, 0);
+    return field;
+}
+
+static void patch_jump(uint8_t *field, const uint8_t *target) {
+    int32_t rel = (int32_t)(target - (field + 4));
+    memcpy(field, &rel, 4);
+}
+
+/* mov <reg>, imm64 (reg 0 = rax, 1 = rcx, 6 = rsi) */
+static void emit_mov_imm64(uint8_t **p, uint8_t reg, const void *value) {
+    emit_u8(p, 0x48);
+    emit_u8(p, (uint8_t)(0xB8 + reg));
+    emit_u64(p, (uint64_t)(uintptr_t)value);
+}
+
+/* mov rax, fn; call rax */
+static void emit_call(uint8_t **p, uint64_t fn) {
+    emit_u8(p, 0x48); emit_u8(p, 0xB8);
+    emit_u64(p, fn);
+    emit_u8(p, 0xFF); emit_u8(p, 0xD0);
+}
+
+/* op [rbx + disp32] with a ModRM reg field of reg (state fields) */
+static void emit_state_modrm(uint8_t **p, uint8_t reg, size_t field) {
+    emit_u8(p, (uint8_t)(0x83 | (reg << 3)));
+    emit_u32(p, (uint32_t)field);
+}
+
+/* op [r12 + disp32] with a ModRM reg field of reg (FOR stack fields) */
+static void emit_entry_modrm(uint8_t **p, uint8_t reg, size_t field) {
+    emit_u8(p, (uint8_t)(0x84 | (reg << 3)));
+    emit_u8(p, 0x24);
+    emit_u32(p, (uint32_t)field);
+}
+
+/* Address of a function as an immediate */
+#define FN_ADDR(fn) jit_fn_addr((void (*)(void))(fn))
+
+static uint64_t jit_fn_addr(void (*fn)(void)) {
+    uint64_t addr;
+    memcpy(&addr, &fn, sizeof(addr));
+    return addr;
+}
+
+
+/*============================================================================
+ * TEMPLATES
+ *
+ * Statements of a few shapes are emitted as native code working directly
+ * on variable slots resolved at compile time, calling the same mbf_*
+ * functions the parser would:
+ *
+ * - `V = number`, `V = W` and `V = a op b` (a, b each a numeric simple
+ *   variable or a number, op one of + - * /)
+ * - `NEXT V` of an integer loop (see stmt_next_var()): counted in native
+ *   integers while the variable holds what the last NEXT stored
+ *
+ * Each one first checks that its slots still hold the variables (CLEAR
+ * empties the table without a program change) and, for NEXT, that the
+ * innermost FOR is this variable's integer loop. Anything else takes
+ * the statement's slow path: the usual call to jit_thunk().
+ *============================================================================*/
+
+/* Template kinds */
+#define TEMPLATE_CALL   0   /* jit_thunk() only */
+#define TEMPLATE_LET    1   /* V = a [op b] */
+#define TEMPLATE_NEXT   2   /* NEXT V, integer loop */
+
+/** A variable slot baked into native code */
+typedef struct {
+    uint16_t index;         /**< Slot number in the variable table */
+    uint16_t key;           /**< Name bytes the slot must still hold */
+    uint8_t *slot;          /**< Address of the slot */
+} jit_slot_t;
+
+/** A LET operand: a variable slot, or a number */
+typedef struct {
+    bool is_var;
+    jit_slot_t var;
+    mbf_t value;
+} jit_operand_t;
+
+typedef struct {
+    int kind;               /**< TEMPLATE_* */
+    jit_slot_t target;      /**< LET target, NEXT variable */
+    jit_operand_t a, b;     /**< LET operands (b unused without op) */
+    uint64_t op;            /**< LET: mbf_add/sub/mul/div, or 0 for a copy */
+} jit_template_t;
+
+/* Variable name at pos, as the parser reads it: two significant characters */
+static size_t template_name(const uint8_t *text, size_t pos, size_t len, char name[3]) {
+    memset(name, 0, 3);
+    if (!(pos < len && isalpha(text[pos]))) return pos;
+    name[0] = (char)toupper(text[pos++]);
+    if (pos < len && isalnum(text[pos])) {
+        name[1] = (char)toupper(text[pos++]);
+    }
+    while (pos < len && isalnum(text[pos])) pos++;
+    return pos;
+}
+
+/* Existing numeric simple variable name, as a slot */
+static bool template_slot(basic_state_t *state, const char *name, jit_slot_t *slot) {
+    uint8_t *p = var_find(state, name);
+    if (!p) return false;
+    slot->index = (uint16_t)((size_t)(p - (state->memory + state->var_start)) / VAR_SIZE);
+    slot->key = (uint16_t)(p[0] | (p[1] << 8));
+    slot->slot = p;
+    return true;
+}
+
+/*
+ * Operand at pos: an existing numeric simple variable, or a number
+ * (read like literal_value() in quicken.c). Returns its end, or pos if
+ * it is neither.
+ */
+static size_t template_operand(basic_state_t *state, const uint8_t *text, size_t pos,
+                               size_t len, jit_operand_t *operand) {
+    size_t start = pos;
+    char name[3];
+    size_t end = template_name(text, pos, len, name);
+    if (end > pos) {
+        if (end < len && (text[end] == '$' || text[end] == '(')) return start;
+        if (!template_slot(state, name, &operand->var)) return start;
+        operand->is_var = true;
+        return end;
+    }
+
+    if (!(pos < len && (isdigit(text[pos]) || text[pos] == '.'))) return start;
+    while (pos < len) {
+        uint8_t c = text[pos];
+        if (isdigit(c) || c == '.' || c == 'E' || c == 'e') {
+            pos++;
+        } else if ((c == '+' || c == '-' || c == TOK_PLUS || c == TOK_MINUS) &&
+                   (text[pos - 1] == 'E' || text[pos - 1] == 'e')) {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    if (pos - start > 63) return start;
+
+    size_t consumed;
+    basic_error_t err;
+    operand->value = eval_expression(NULL, text + start, pos - start, &consumed, &err);
+    if (err != ERR_NONE || consumed != pos - start) return start;
+    operand->is_var = false;
+    return pos;
+}
+
+static size_t skip_blanks(const uint8_t *text, size_t pos, size_t len) {
+    while (pos < len && text[pos] == ' ') pos++;
+    return pos;
+}
+
+/* Pick the template for a statement; TEMPLATE_CALL if none fits */
+static void template_match(basic_state_t *state, const jit_stmt_t *stmt, jit_template_t *t) {
+    const uint8_t *text = state->memory + stmt->offset;
+    size_t len = stmt->len;
+    char name[3];
+
+    memset(t, 0, sizeof(*t));
+    t->kind = TEMPLATE_CALL;
+
+    size_t pos = skip_blanks(text, 0, len);
+    if (pos < len && text[pos] == TOK_NEXT) {
+        /* NEXT V */
+        pos = skip_blanks(text, pos + 1, len);
+        size_t end = template_name(text, pos, len, name);
+        if (end == pos || skip_blanks(text, end, len) != len) return;
+        if (!template_slot(state, name, &t->target)) return;
+        t->kind = TEMPLATE_NEXT;
+        return;
+    }
+
+    /* [LET] V = a [op b] */
+    if (pos < len && text[pos] == TOK_LET) pos = skip_blanks(text, pos + 1, len);
+    size_t end = template_name(text, pos, len, name);
+    if (end == pos || (end < len && (text[end] == '$' || text[end] == '('))) return;
+    pos = skip_blanks(text, end, len);
+    if (pos >= len || text[pos] != TOK_EQ) return;
+    if (!template_slot(state, name, &t->target)) return;
+
+    pos = skip_blanks(text, pos + 1, len);
+    end = template_operand(state, text, pos, len, &t->a);
+    if (end == pos) return;
+    pos = skip_blanks(text, end, len);
+
+    if (pos < len) {
+        switch (text[pos]) {
+            case TOK_PLUS:  t->op = FN_ADDR(mbf_add); break;
+            case TOK_MINUS: t->op = FN_ADDR(mbf_sub); break;
+            case TOK_MUL:   t->op = FN_ADDR(mbf_mul); break;
+            case TOK_DIV:   t->op = FN_ADDR(mbf_div); break;
+            default:        return;
+        }
+        pos = skip_blanks(text, pos + 1, len);
+        end = template_operand(state, text, pos, len, &t->b);
+        if (end == pos || skip_blanks(text, end, len) != len) return;
+    }
+    t->kind = TEMPLATE_LET;
+}
+
+/*
+ * Guard for a slot: the table has not moved and the slot still holds the
+ * variable. Jumps to the slow path (fields collected in slow[]) if not.
+ */
+static void emit_slot_guard(uint8_t **p, const jit_slot_t *var, uint16_t var_start,
+                            uint8_t **slow, int *slow_count) {
+    /* cmp word [rbx + var_start], imm16; jne slow */
+    emit_u8(p, 0x66); emit_u8(p, 0x81);
+    emit_state_modrm(p, 7, offsetof(basic_state_t, var_start));
+    emit_u8(p, (uint8_t)var_start); emit_u8(p, (uint8_t)(var_start >> 8));
+    slow[(*slow_count)++] = emit_jump(p, CC_NE);
+
+    /* cmp word [rbx + var_count_], index; jbe slow */
+    emit_u8(p, 0x66); emit_u8(p, 0x81);
+    emit_state_modrm(p, 7, offsetof(basic_state_t, var_count_));
+    emit_u8(p, (uint8_t)var->index); emit_u8(p, (uint8_t)(var->index >> 8));
+    slow[(*slow_count)++] = emit_jump(p, CC_BE);
+
+    /* mov rax, slot; cmp word [rax], key; jne slow */
+    emit_mov_imm64(p, 0, var->slot);
+    emit_u8(p, 0x66); emit_u8(p, 0x81); emit_u8(p, 0x38);
+    emit_u8(p, (uint8_t)var->key); emit_u8(p, (uint8_t)(var->key >> 8));
+    slow[(*slow_count)++] = emit_jump(p, CC_NE);
+}
+
+/* Dirty page marks for the 4 value bytes of a slot, as mem_mark_dirty() */
+static void emit_mark_dirty(uint8_t **p, basic_state_t *state, const jit_slot_t *var) {
+    uint32_t offset = (uint32_t)(var->slot + 2 - state->memory);
+    uint32_t last = (offset + 3) / CHECKPOINT_PAGE_SIZE;
+    for (uint32_t page = offset / CHECKPOINT_PAGE_SIZE; page <= last; page++) {
+        /* mov rcx, bit; or [rbx + dirty_pages + word], rcx */
+        uint64_t bit = (uint64_t)1 << (page % 64);
+        emit_u8(p, 0x48); emit_u8(p, 0xB9);
+        emit_u64(p, bit);
+        emit_u8(p, 0x48); emit_u8(p, 0x09);
+        emit_state_modrm(p, 1, offsetof(basic_state_t, dirty_pages) + (page / 64) * 8);
+    }
+}
+
+/* Load an operand into edi (reg 7) or esi (reg 6) */
+static void emit_operand(uint8_t **p, uint8_t reg, const jit_operand_t *operand) {
+    if (operand->is_var) {
+        /* mov rax, slot; mov reg, [rax + 2] */
+        emit_mov_imm64(p, 0, operand->var.slot);
+        emit_u8(p, 0x8B); emit_u8(p, (uint8_t)(0x40 | (reg << 3))); emit_u8(p, 2);
+    } else {
+        emit_u8(p, (uint8_t)(0xB8 + reg));
+        emit_u32(p, operand->value.raw);
+    }
+}
+
+/* V = a [op b]: guards, value into eax, store */
+static void emit_let(uint8_t **p, basic_state_t *state, const jit_template_t *t,
+                     uint8_t **slow, int *slow_count) {
+    emit_slot_guard(p, &t->target, state->var_start, slow, slow_count);
+    if (t->a.is_var) emit_slot_guard(p, &t->a.var, state->var_start, slow, slow_count);
+    if (t->op && t->b.is_var) emit_slot_guard(p, &t->b.var, state->var_start, slow, slow_count);
+
+    if (t->op) {
+        emit_operand(p, 7, &t->a);
+        emit_operand(p, 6, &t->b);
+        emit_call(p, t->op);
+    } else {
+        emit_operand(p, 0, &t->a);  /* Into eax directly */
+    }
+
+    /* mov rcx, slot; mov [rcx + 2], eax */
+    emit_mov_imm64(p, 1, t->target.slot);
+    emit_u8(p, 0x89); emit_u8(p, 0x41); emit_u8(p, 2);
+    emit_mark_dirty(p, state, &t->target);
+}
+
+/*
+ * NEXT V of an integer loop, as stmt_next_var(): V must be the innermost
+ * FOR, and still hold the bits the last NEXT stored. Loops back through
+ * exit (THUNK_EXIT); falls through when the loop ends.
+ */
+static void emit_next(uint8_t **p, basic_state_t *state, const jit_template_t *t,
+                      uint8_t **slow, int *slow_count, uint8_t **exits, int *exit_count) {
+    const size_t entry_size = sizeof(for_entry_t);
+    const size_t stack = offsetof(basic_state_t, for_stack);
+
+    emit_slot_guard(p, &t->target, state->var_start, slow, slow_count);
+
+    /* mov eax, [rbx + for_sp]; test eax, eax; jle slow */
+    emit_u8(p, 0x8B);
+    emit_state_modrm(p, 0, offsetof(basic_state_t, for_sp));
+    emit_u8(p, 0x85); emit_u8(p, 0xC0);
+    slow[(*slow_count)++] = emit_jump(p, CC_LE);
+
+    /* rdx = &for_stack[for_sp - 1]: dec eax; imul eax, eax, size; lea rdx, [rbx + rax + stack] */
+    emit_u8(p, 0xFF); emit_u8(p, 0xC8);
+    emit_u8(p, 0x69); emit_u8(p, 0xC0); emit_u32(p, (uint32_t)entry_size);
+    emit_u8(p, 0x48); emit_u8(p, 0x8D); emit_u8(p, 0x94); emit_u8(p, 0x03);
+    emit_u32(p, (uint32_t)stack);
+
+    /* mov rax, slot; cmp [rdx + var], rax; jne slow */
+    emit_mov_imm64(p, 0, t->target.slot);
+    emit_u8(p, 0x48); emit_u8(p, 0x39); emit_u8(p, 0x82);
+    emit_u32(p, (uint32_t)offsetof(for_entry_t, var));
+    slow[(*slow_count)++] = emit_jump(p, CC_NE);
+
+    /* cmp byte [rdx + int_loop], 0; je slow */
+    emit_u8(p, 0x80); emit_u8(p, 0xBA);
+    emit_u32(p, (uint32_t)offsetof(for_entry_t, int_loop));
+    emit_u8(p, 0);
+    slow[(*slow_count)++] = emit_jump(p, CC_E);
+
+    /* mov ecx, [rax + 2]; cmp ecx, [rdx + int_bits]; jne slow */
+    emit_u8(p, 0x8B); emit_u8(p, 0x48); emit_u8(p, 2);
+    emit_u8(p, 0x3B); emit_u8(p, 0x8A);
+    emit_u32(p, (uint32_t)offsetof(for_entry_t, int_bits));
+    slow[(*slow_count)++] = emit_jump(p, CC_NE);
+
+    /* ecx = int_value + int_step, within +-JIT_INT_RANGE */
+    emit_u8(p, 0x8B); emit_u8(p, 0x8A);
+    emit_u32(p, (uint32_t)offsetof(for_entry_t, int_value));
+    emit_u8(p, 0x03); emit_u8(p, 0x8A);
+    emit_u32(p, (uint32_t)offsetof(for_entry_t, int_step));
+    emit_u8(p, 0x81); emit_u8(p, 0xF9); emit_u32(p, (uint32_t)JIT_INT_RANGE);
+    slow[(*slow_count)++] = emit_jump(p, CC_GE);
+    emit_u8(p, 0x81); emit_u8(p, 0xF9); emit_u32(p, (uint32_t)-JIT_INT_RANGE);
+    slow[(*slow_count)++] = emit_jump(p, CC_LE);
+
+    /* r12 = entry, r13d = sum; eax = mbf_from_int32(sum) */
+    static const uint8_t keep[] = {0x49, 0x89, 0xD4, 0x41, 0x89, 0xCD, 0x89, 0xCF};
+    emit_bytes(p, keep, sizeof(keep));
+    emit_call(p, FN_ADDR(mbf_from_int32));
+
+    /* Store into the variable, int_bits and int_value */
+    emit_mov_imm64(p, 1, t->target.slot);
+    emit_u8(p, 0x89); emit_u8(p, 0x41); emit_u8(p, 2);
+    emit_mark_dirty(p, state, &t->target);
+    emit_u8(p, 0x41); emit_u8(p, 0x89);
+    emit_entry_modrm(p, 0, offsetof(for_entry_t, int_bits));
+    emit_u8(p, 0x45); emit_u8(p, 0x89);
+    emit_entry_modrm(p, 5, offsetof(for_entry_t, int_value));
+
+    /* Continue while sum <= limit (step >= 0) or sum >= limit (step < 0) */
+    emit_u8(p, 0x41); emit_u8(p, 0x83);
+    emit_entry_modrm(p, 7, offsetof(for_entry_t, int_step));
+    emit_u8(p, 0);
+    uint8_t *negative = emit_jump(p, CC_L);
+    emit_u8(p, 0x45); emit_u8(p, 0x3B);
+    emit_entry_modrm(p, 5, offsetof(for_entry_t, int_limit));
+    uint8_t *ends_up = emit_jump(p, CC_G);
+    uint8_t *loops_up = emit_jump(p, CC_ALWAYS);
+    patch_jump(negative, *p);
+    emit_u8(p, 0x45); emit_u8(p, 0x3B);
+    emit_entry_modrm(p, 5, offsetof(for_entry_t, int_limit));
+    uint8_t *ends_down = emit_jump(p, CC_L);
+
+    /* Loop: current_line and text_ptr from the entry */
+    patch_jump(loops_up, *p);
+    emit_u8(p, 0x41); emit_u8(p, 0x0F); emit_u8(p, 0xB7);
+    emit_entry_modrm(p, 0, offsetof(for_entry_t, line_number));
+    emit_u8(p, 0x66); emit_u8(p, 0x89);
+    emit_state_modrm(p, 0, offsetof(basic_state_t, current_line));
+    emit_u8(p, 0x41); emit_u8(p, 0x0F); emit_u8(p, 0xB7);
+    emit_entry_modrm(p, 0, offsetof(for_entry_t, text_ptr));
+    emit_u8(p, 0x66); emit_u8(p, 0x89);
+    emit_state_modrm(p, 0, offsetof(basic_state_t, text_ptr));
+
+    /* Even when that is this NEXT (an empty body): the main loop resumes there */
+    emit_u8(p, 0xB8); emit_u32(p, THUNK_EXIT);
+    exits[(*exit_count)++] = emit_jump(p, CC_ALWAYS);
+
+    /* Loop over: pop the entry (dec dword [rbx + for_sp]) */
+    patch_jump(ends_up, *p);
+    patch_jump(ends_down, *p);
+    emit_u8(p, 0xFF);
+    emit_state_modrm(p, 1, offsetof(basic_state_t, for_sp));
+}
+
+/*
+ * Split a line into statements the same way basic_run_program() does.
+ * Returns the number of statements, or -1 if the line must stay in the
+ * interpreter.
+ */
+static int jit_scan_line(basic_state_t *state, uint16_t line_offset,
+                         jit_stmt_t *out, int max_stmts) {
+    const uint8_t *mem = state->memory;
+    uint16_t link = (uint16_t)(mem[line_offset] | (mem[line_offset + 1] << 8));
+    uint16_t pos = (uint16_t)(line_offset + 4);
+    int count = 0;
+
+    while (mem[pos] != '\0') {
+        uint16_t start = pos;
+        uint16_t skip = start;
+        while (mem[skip] == ' ') skip++;
+
+        uint8_t cmd = mem[skip];
+        if (cmd == TOK_REM) {
+            /* REM runs to end of line and does nothing */
+            break;
+        }
+
+        switch (cmd) {
+            case TOK_RUN: case TOK_CONT: case TOK_LIST: case TOK_NEW:
+            case TOK_CLOAD: case TOK_CSAVE: case TOK_INPUT:
+                return -1;
+            default:
+                break;
+        }
+
+        while (mem[pos] != '\0' && mem[pos] != ':') {
+            /* Strings deopt */
+            if (mem[pos] == '"' || mem[pos] == '$' || TOK_IS_STRING_FUNC(mem[pos])) {
+                return -1;
+            }
+            pos++;
+        }
+
+        uint16_t len = (uint16_t)(pos - start);
+        uint16_t resume;
+        if (mem[pos] == ':') {
+            resume = (uint16_t)(pos + 1);
+        } else {
+            resume = link ? (uint16_t)(link + 4) : start;
+        }
+
+        /* Empty statements and DATA are no-ops at run time */
+        if (skip < pos && cmd != TOK_DATA) {
+            if (count >= max_stmts) return -1;
+            out[count].offset = start;
+            out[count].len = len;
+            out[count].resume = resume;
+            count++;
+        }
+
+        if (mem[pos] == ':') pos++;
+    }
+
+    return count;
+}
+
+/* The slow path of a statement: mov rdi, rbx; mov rsi, stmt; call jit_thunk; test; jnz exit */
+static void emit_thunk_call(uint8_t **p, const jit_stmt_t *stmt, uint8_t **exits,
+                            int *exit_count) {
+    int (*thunk)(basic_state_t *, const jit_stmt_t *) = jit_thunk;
+    uint64_t thunk_addr;
+    memcpy(&thunk_addr, &thunk, sizeof(thunk_addr));
+
+    emit_u8(p, 0x48); emit_u8(p, 0x89); emit_u8(p, 0xDF);
+    emit_mov_imm64(p, 6, stmt);
+    emit_call(p, thunk_addr);
+    emit_u8(p, 0x85); emit_u8(p, 0xC0);
+    exits[(*exit_count)++] = emit_jump(p, CC_NE);
+}
+
+static bool jit_compile(basic_state_t *state, jit_line_t *entry) {
+    struct basic_jit *jit = state->jit;
+    jit_stmt_t scratch[64];
+
+    int n = jit_scan_line(state, entry->line_offset, scratch, 64);
+    if (n < 0 || jit->stmt_count + n > JIT_MAX_STMTS) return false;
+
+    jit_stmt_t *stmts = &jit->stmts[jit->stmt_count];
+    memcpy(stmts, scratch, (size_t)n * sizeof(jit_stmt_t));
+
+    /* Emitted into line_code first: jumps are relative, calls absolute */
+    uint8_t *start = jit->line_code;
+    uint8_t *p = start;
+    uint8_t *exits[2 * 64];
+    int exit_count = 0;
+
+    /* A line of nothing but calls back into the interpreter gains nothing */
+    jit_template_t templates[64];
+    bool any = false;
+    for (int i = 0; i < n; i++) {
+        template_match(state, &stmts[i], &templates[i]);
+        any |= templates[i].kind != TEMPLATE_CALL;
+    }
+    if (!any) return false;
+
+    static const uint8_t prologue[] = {
+        0x53, 0x41, 0x54, 0x41, 0x55,   /* push rbx; push r12; push r13 */
+        0x48, 0x89, 0xFB                /* mov rbx, rdi */
+    };
+    emit_bytes(&p, prologue, sizeof(prologue));
+
+    for (int i = 0; i < n; i++) {
+        if ((size_t)(p - start) + JIT_STMT_BYTES > JIT_LINE_BYTES) return false;
+
+        const jit_template_t *t = &templates[i];
+        if (t->kind == TEMPLATE_CALL) {
+            emit_thunk_call(&p, &stmts[i], exits, &exit_count);
+            continue;
+        }
+
+        uint8_t *slow[16];
+        int slow_count = 0;
+        if (t->kind == TEMPLATE_LET) {
+            emit_let(&p, state, t, slow, &slow_count);
+        } else {
+            emit_next(&p, state, t, slow, &slow_count, exits, &exit_count);
+        }
+        uint8_t *next = emit_jump(&p, CC_ALWAYS);
+
+        for (int j = 0; j < slow_count; j++) patch_jump(slow[j], p);
+        emit_thunk_call(&p, &stmts[i], exits, &exit_count);
+        patch_jump(next, p);
+    }
+
+    static const uint8_t epilogue[] = {
+        0x31, 0xC0,                     /* xor eax, eax */
+        0x41, 0x5D, 0x41, 0x5C, 0x5B,   /* exit: pop r13; pop r12; pop rbx */
+        0xC3                            /* ret */
+    };
+    emit_bytes(&p, epilogue, sizeof(epilogue));
+    for (int j = 0; j < exit_count; j++) patch_jump(exits[j], p - 6);
+
+    size_t need = (size_t)(p - start);
+    if (jit->code_used + need > JIT_CODE_SIZE) return false;
+
+    uint8_t *code = jit->code + jit->code_used;
+    if (mprotect(jit->code, JIT_CODE_SIZE, PROT_READ | PROT_WRITE) != 0) return false;
+    memcpy(code, start, need);
+    if (mprotect(jit->code, JIT_CODE_SIZE, PROT_READ | PROT_EXEC) != 0) return false;
+
+    memcpy(&entry->code, &code, sizeof(entry->code));
+    jit->code_used += need;
+    jit->stmt_count += n;
+    jit->compiled++;
+    return true;
+}
+
+
+/*============================================================================
+ * PUBLIC API
+ *============================================================================*/
+
+bool jit_available(void) {
+    return true;
+}
+
+bool jit_init(basic_state_t *state) {
+    if (!state) return false;
+    if (state->jit) return true;
+
+    struct basic_jit *jit = calloc(1, sizeof(struct basic_jit));
+    if (!jit) return false;
+
+    void *code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_EXEC,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        free(jit);
+        return false;
+    }
+
+    jit->code = code;
+    jit_flush(jit, state->program_gen);
+    state->jit = jit;
+    return true;
+}
+
+void jit_free(basic_state_t *state) {
+    if (!state || !state->jit) return;
+    munmap(state->jit->code, JIT_CODE_SIZE);
+    free(state->jit);
+    state->jit = NULL;
+}
+
+int jit_run_line(basic_state_t *state, uint16_t line_offset, basic_error_t *error) {
+    struct basic_jit *jit = state ? state->jit : NULL;
+    if (!jit) return JIT_MISS;
+
+    if (jit->program_gen != state->program_gen) {
+        jit_flush(jit, state->program_gen);
+    }
+
+    jit_line_t *entry = jit_lookup(jit, line_offset);
+    if (!entry || entry->status == JIT_REJECTED) return JIT_DECLINED;
+
+    if (entry->status == JIT_COLD) {
+        if (++entry->count < JIT_HOT_THRESHOLD) return JIT_MISS;
+        if (!jit_compile(state, entry)) {
+            entry->status = JIT_REJECTED;
+            return JIT_DECLINED;
+        }
+        entry->status = JIT_COMPILED;
+    }
+
+    int rc = entry->code(state);
+    if (rc == THUNK_NEXT) return JIT_LINE_DONE;
+    if (rc == THUNK_EXIT) return JIT_EXIT;
+
+    /* Deoptimize: interpret this line from now on */
+    entry->status = JIT_REJECTED;
+    if (error) *error = jit->error;
+    return JIT_ERROR;
+}
+
+int jit_compiled_lines(const basic_state_t *state) {
+    if (!state || !state->jit) return 0;
+    if (state->jit->program_gen != state->program_gen) return 0;
+    return state->jit->compiled;
+}
+
+#else /* !JIT_SUPPORTED */
+
+bool jit_available(void) {
+    return false;
+}
+
+bool jit_init(basic_state_t *state) {
+    (void)state;
+    return false;
+}
+
+void jit_free(basic_state_t *state) {
+    (void)state;
+}
+
+int jit_run_line(basic_state_t *state, uint16_t line_offset, basic_error_t *error) {
+    (void)state;
+    (void)line_offset;
+    (void)error;
+    return JIT_MISS;
+}
+
+int jit_compiled_lines(const basic_state_t *state) {
+    (void)state;
+    return 0;
+}
+
+#endif /* JIT_SUPPORTED */
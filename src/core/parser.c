@@ -87,6 +87,8 @@
  * - eval_expression(): Evaluate a numeric expression
  * - eval_string_expression(): Evaluate a string expression (returns char*)
  * - eval_string_desc(): Evaluate a string expression (returns string_desc_t)
+ * - eval_int_operand(): Integer argument that is a lone variable or number
+ * - eval_power(): One ^ step, with the errors parse_power() raises
  */
 
 #include "basic/basic.h"
@@ -118,6 +120,11 @@ typedef struct {
     size_t len;             /**< Total length of input */
     basic_state_t *basic;   /**< Interpreter state for variable lookup */
     basic_error_t error;    /**< Error code if parsing failed */
+    bool foldable;          /**< text is program text (see CONSTANT FOLDING) */
+    uint16_t base;          /**< Offset of text in memory[] when foldable */
+    bool impure;            /**< Current span read something that can change */
+    bool folds;             /**< A span worth folding was found or used */
+    bool unrecorded;        /**< A span's outcome could not be recorded */
 } parse_state_t;
 
 
@@ -138,9 +145,11 @@ static mbf_t parse_additive(parse_state_t *ps);
 static mbf_t parse_multiplicative(parse_state_t *ps);
 static mbf_t parse_power(parse_state_t *ps);
 static mbf_t parse_unary(parse_state_t *ps);
+static mbf_t parse_signed(parse_state_t *ps);
 static mbf_t parse_primary(parse_state_t *ps);
 static mbf_t parse_number(parse_state_t *ps);
 static mbf_t parse_function(parse_state_t *ps, uint8_t token);
+static int16_t parse_int_operand(parse_state_t *ps, bool *overflow);
 static string_desc_t parse_string_term(parse_state_t *ps);
 static string_desc_t parse_string_arg(parse_state_t *ps);
 static string_desc_t parse_string_function(parse_state_t *ps);
@@ -196,6 +205,137 @@ static bool expect(parse_state_t *ps, uint8_t expected) {
 }
 
 
+/*============================================================================
+ * CONSTANT FOLDING
+ *
+ * When the text being evaluated is program text, operands (FOLD_UNARY)
+ * and the leading operands of * / and + - chains (FOLD_MUL, FOLD_ADD)
+ * are checked against the fold table (core/fold.c). A constant span is
+ * skipped and its stored value used instead; a chain then carries on
+ * with its remaining operators exactly as if it had parsed the prefix.
+ *
+ * The first time a span is evaluated it is tracked: ps->impure is set by
+ * anything whose value can change (variables, FN, RND, PEEK, FRE, POS,
+ * USR, INP, strings), and the outcome is recorded either way. Spans that
+ * raised an error are not recorded.
+ *
+ * An expression whose every span is recorded and none is worth folding
+ * (a lone number is not: looking it up costs as much as converting it)
+ * is marked plain by parse_finish(). parse_init() turns folding off for
+ * it, so it costs no more than it did before folding.
+ *============================================================================*/
+
+/** Tracking state for one span */
+typedef struct {
+    bool track;             /**< First evaluation: record the outcome */
+    bool outer_impure;      /**< ps->impure of the enclosing span */
+    size_t start;           /**< Position of the span's first byte */
+} fold_span_t;
+
+/* Is the constant span text[start, end) more than a lone number? */
+static bool fold_worthwhile(const parse_state_t *ps, size_t start, size_t end) {
+    uint8_t c = ps->text[start];
+    if (!isdigit(c) && c != '.') return true;
+    for (size_t i = start; i < end; i++) {
+        if (ps->text[i] == TOK_POW) return true;
+    }
+    return false;
+}
+
+/* Could a span starting with c be constant? (Variables never are.) */
+static bool fold_candidate(uint8_t c) {
+    return isdigit(c) || c == '.' || c == '(' ||
+           c == TOK_PLUS || c == TOK_MINUS || TOK_IS_FUNCTION(c);
+}
+
+/*
+ * Start a span at the current position. Returns true with *value set and
+ * the position moved past the span if it is a known constant.
+ */
+static bool fold_enter(parse_state_t *ps, uint8_t level, fold_span_t *span,
+                       mbf_t *value) {
+    span->track = false;
+    if (!ps->foldable) return false;
+
+    skip_space(ps);
+    if (!fold_candidate(peek(ps))) return false;
+    span->start = ps->pos;
+
+    uint16_t end;
+    if (fold_lookup(ps->basic, (uint16_t)(ps->base + ps->pos), level, &end, value)) {
+        /* Known not to be constant, or longer than this expression */
+        if (end == 0) return false;
+        if ((size_t)(end - ps->base) > ps->len) {
+            ps->unrecorded = true;
+            return false;
+        }
+        if (!ps->folds) {
+            ps->folds = fold_worthwhile(ps, ps->pos, (size_t)(end - ps->base));
+        }
+        ps->pos = (size_t)(end - ps->base);
+        return true;
+    }
+
+    span->track = true;
+    span->outer_impure = ps->impure;
+    ps->impure = false;
+    return false;
+}
+
+/*
+ * Finish a span. end is where its constant part stops (0 if it has
+ * none); value is the result of parsing up to there.
+ */
+static void fold_leave(parse_state_t *ps, uint8_t level, fold_span_t *span,
+                       size_t end, mbf_t value) {
+    if (!span->track) return;
+
+    /*
+     * A span cut short by the end of the expression text (rather than by
+     * a terminator) might continue in a longer one, so it is not recorded.
+     */
+    bool cut = end == ps->len && ps->text[end] != '\0' && ps->text[end] != ':';
+
+    if (ps->error == ERR_NONE && !cut) {
+        uint16_t stored_end = (!ps->impure && end > span->start)
+                              ? (uint16_t)(ps->base + end) : 0;
+        fold_store(ps->basic, (uint16_t)(ps->base + span->start), level,
+                   stored_end, value);
+        if (stored_end && !ps->folds) {
+            ps->folds = fold_worthwhile(ps, span->start, end);
+        }
+    } else {
+        ps->unrecorded = true;
+    }
+    ps->impure |= span->outer_impure;
+}
+
+/* Set up parser state; program text can take part in constant folding */
+static void parse_init(parse_state_t *ps, basic_state_t *state,
+                       const uint8_t *text, size_t len) {
+    *ps = (parse_state_t){
+        .text = text,
+        .pos = 0,
+        .len = len,
+        .basic = state,
+        .error = ERR_NONE
+    };
+
+    if (state && text >= state->memory + state->program_start &&
+        text < state->memory + state->program_end) {
+        ps->base = (uint16_t)(text - state->memory);
+        ps->foldable = !fold_plain(state, ps->base);
+    }
+}
+
+/* After a complete evaluation: mark the expression plain if it is */
+static void parse_finish(parse_state_t *ps) {
+    if (ps->foldable && !ps->folds && !ps->unrecorded && ps->error == ERR_NONE) {
+        fold_store_plain(ps->basic, ps->base);
+    }
+}
+
+
 /*============================================================================
  * STRING EXPRESSION PARSING
  *
@@ -220,6 +360,7 @@ static bool expect(parse_state_t *ps, uint8_t expected) {
  */
 static string_desc_t parse_string_term(parse_state_t *ps) {
     string_desc_t result = {0};
+    ps->impure = true;  /* Strings use string space */
     skip_space(ps);
 
     uint8_t c = peek(ps);
@@ -432,9 +573,8 @@ static string_desc_t parse_string_function(parse_state_t *ps) {
 
         case TOK_CHR: {
             /* CHR$(n) */
-            mbf_t code = parse_expression(ps);
             bool overflow;
-            int16_t c = mbf_to_int16(code, &overflow);
+            int16_t c = parse_int_operand(ps, &overflow);
 
             if (!expect(ps, ')')) {
                 ps->error = ERR_SN;
@@ -471,6 +611,66 @@ static string_desc_t parse_string_function(parse_state_t *ps) {
 }
 
 
+/*============================================================================
+ * INTEGER OPERANDS
+ *
+ * Subscripts and the other arguments used as 16-bit integers (CHR$, TAB,
+ * SPC) are nearly always a loop variable or a small literal. Those are
+ * read directly (variable bits, literal digits) and converted with
+ * mbf_to_index() without a trip through the whole precedence chain; the
+ * result is exactly what mbf_to_int16(parse_expression()) gives.
+ *
+ * No decoded integer copy of a variable is kept beside it: for the usual
+ * small positive value the decode is a shift, and a copy would have to be
+ * refreshed by every store (LET, NEXT, INPUT, READ, JIT and compiled code).
+ *============================================================================*/
+
+bool eval_int_operand(basic_state_t *state, const uint8_t *text, size_t len,
+                      size_t *consumed, int16_t *value, bool *overflow) {
+    if (!state || len == 0) return false;
+
+    size_t pos = 0;
+    if (isdigit(text[0])) {
+        /* Integer literal below 32768 */
+        int32_t n = 0;
+        while (pos < len && isdigit(text[pos])) {
+            n = n * 10 + (text[pos++] - '0');
+            if (n > INT16_MAX) return false;
+        }
+        if (pos >= len || (text[pos] != ')' && text[pos] != ',')) return false;
+        *value = (int16_t)n;
+        *overflow = false;
+    } else if (isalpha(text[0])) {
+        /* Numeric simple variable, looked up as parse_primary() does */
+        char var_name[3] = {0};
+        var_name[0] = (char)text[pos++];
+        if (pos < len && isalnum(text[pos])) {
+            var_name[1] = (char)text[pos++];
+        }
+        while (pos < len && isalnum(text[pos])) pos++;
+        if (pos >= len || (text[pos] != ')' && text[pos] != ',')) return false;
+        *value = mbf_to_index(var_get_numeric(state, var_name), overflow);
+    } else {
+        return false;
+    }
+
+    *consumed = pos;
+    return true;
+}
+
+/* mbf_to_int16() of an expression: the fast forms above, else parsed */
+static int16_t parse_int_operand(parse_state_t *ps, bool *overflow) {
+    size_t consumed;
+    int16_t value;
+    if (eval_int_operand(ps->basic, ps->text + ps->pos, ps->len - ps->pos,
+                         &consumed, &value, overflow)) {
+        ps->pos += consumed;
+        return value;
+    }
+    return mbf_to_index(parse_expression(ps), overflow);
+}
+
+
 /*============================================================================
  * NUMERIC EXPRESSION PARSING
  *
@@ -577,24 +777,54 @@ static bool is_string_expr_start(parse_state_t *ps) {
 }
 
 /*
- * Compare two strings.
- * Returns: -1 if s1 < s2, 0 if s1 == s2, 1 if s1 > s2
+ * INSTR as typed: the tokenizer has no keyword for it, so it arrives as
+ * letters (any case) followed by '('.
  */
-static int string_cmp(basic_state_t *state, string_desc_t s1, string_desc_t s2) {
-    const char *p1 = (s1.ptr > 0 && state) ? (const char *)(state->memory + s1.ptr) : "";
-    const char *p2 = (s2.ptr > 0 && state) ? (const char *)(state->memory + s2.ptr) : "";
-    size_t len1 = s1.length;
-    size_t len2 = s2.length;
-    size_t min_len = len1 < len2 ? len1 : len2;
-
-    for (size_t i = 0; i < min_len; i++) {
-        if ((unsigned char)p1[i] < (unsigned char)p2[i]) return -1;
-        if ((unsigned char)p1[i] > (unsigned char)p2[i]) return 1;
+static bool is_instr(parse_state_t *ps) {
+    static const char name[] = "INSTR(";
+    if (ps->len - ps->pos < sizeof(name) - 1) return false;
+    for (size_t i = 0; i < sizeof(name) - 1; i++) {
+        if (toupper(ps->text[ps->pos + i]) != name[i]) return false;
     }
+    return true;
+}
 
-    if (len1 < len2) return -1;
-    if (len1 > len2) return 1;
-    return 0;
+/*
+ * INSTR([start,] main$, search$): position of search$ in main$ from start
+ * (default 1), or 0. FC if start is not 1..255, as for MID$.
+ */
+static mbf_t parse_instr(parse_state_t *ps) {
+    ps->pos += 6;   /* INSTR( */
+
+    int16_t start = 1;
+    if (!is_string_expr_start(ps)) {
+        bool overflow;
+        start = parse_int_operand(ps, &overflow);
+        if (ps->error != ERR_NONE) return MBF_ZERO;
+        if (overflow || start < 1 || start > 255) {
+            ps->error = ERR_FC;
+            return MBF_ZERO;
+        }
+        if (!expect(ps, ',')) {
+            ps->error = ERR_SN;
+            return MBF_ZERO;
+        }
+    }
+
+    string_desc_t main_str = parse_string_arg(ps);
+    if (ps->error != ERR_NONE) return MBF_ZERO;
+    if (!expect(ps, ',')) {
+        ps->error = ERR_SN;
+        return MBF_ZERO;
+    }
+    string_desc_t search_str = parse_string_arg(ps);
+    if (ps->error != ERR_NONE) return MBF_ZERO;
+    if (!expect(ps, ')')) {
+        ps->error = ERR_SN;
+        return MBF_ZERO;
+    }
+
+    return fn_instr(ps->basic, start, main_str, search_str);
 }
 
 /*
@@ -642,19 +872,19 @@ static mbf_t parse_relational(parse_state_t *ps) {
             string_desc_t right = parse_string_arg(ps);
             if (ps->error != ERR_NONE) return MBF_ZERO;
 
-            int cmp = string_cmp(ps->basic, left, right);
+            int cmp = string_compare(ps->basic, left, right);
 
-            int result = 0;
+            bool result = false;
             switch (cmp_type) {
-                case 0: result = (cmp == 0) ? -1 : 0; break;  /* = */
-                case 1: result = (cmp < 0) ? -1 : 0; break;   /* < */
-                case 2: result = (cmp > 0) ? -1 : 0; break;   /* > */
-                case 3: result = (cmp <= 0) ? -1 : 0; break;  /* <= */
-                case 4: result = (cmp >= 0) ? -1 : 0; break;  /* >= */
-                case 5: result = (cmp != 0) ? -1 : 0; break;  /* <> */
+                case 0: result = cmp == 0; break;  /* = */
+                case 1: result = cmp < 0; break;   /* < */
+                case 2: result = cmp > 0; break;   /* > */
+                case 3: result = cmp <= 0; break;  /* <= */
+                case 4: result = cmp >= 0; break;  /* >= */
+                case 5: result = cmp != 0; break;  /* <> */
             }
 
-            return mbf_from_int16((int16_t)result);
+            return result ? MBF_TRUE : MBF_ZERO;
         }
 
         /* String expression without comparison - error in numeric context */
@@ -674,43 +904,29 @@ static mbf_t parse_relational(parse_state_t *ps) {
 
         /* Check for compound operators: <>, <=, >= */
         uint8_t op2 = peek(ps);
-        int cmp_type = 0;  /* 0=eq, 1=lt, 2=gt, 3=le, 4=ge, 5=ne */
+        eval_relation_t relation = REL_EQ;
 
-        if (op == TOK_EQ) {
-            cmp_type = 0;  /* = */
-        } else if (op == TOK_LT) {
+        if (op == TOK_LT) {
             if (op2 == TOK_GT) {
                 consume(ps);
-                cmp_type = 5;  /* <> (not equal) */
+                relation = REL_NE;
             } else if (op2 == TOK_EQ) {
                 consume(ps);
-                cmp_type = 3;  /* <= */
+                relation = REL_LE;
             } else {
-                cmp_type = 1;  /* < */
+                relation = REL_LT;
             }
         } else if (op == TOK_GT) {
             if (op2 == TOK_EQ) {
                 consume(ps);
-                cmp_type = 4;  /* >= */
+                relation = REL_GE;
             } else {
-                cmp_type = 2;  /* > */
+                relation = REL_GT;
             }
         }
 
         mbf_t right = parse_additive(ps);
-        int cmp = mbf_cmp(left, right);
-
-        int result = 0;
-        switch (cmp_type) {
-            case 0: result = (cmp == 0) ? -1 : 0; break;  /* = */
-            case 1: result = (cmp < 0) ? -1 : 0; break;   /* < */
-            case 2: result = (cmp > 0) ? -1 : 0; break;   /* > */
-            case 3: result = (cmp <= 0) ? -1 : 0; break;  /* <= */
-            case 4: result = (cmp >= 0) ? -1 : 0; break;  /* >= */
-            case 5: result = (cmp != 0) ? -1 : 0; break;  /* <> */
-        }
-
-        return mbf_from_int16((int16_t)result);
+        return eval_compare(left, right, relation);
     }
 
     return left;
@@ -720,7 +936,15 @@ static mbf_t parse_relational(parse_state_t *ps) {
  * Parse additive expression: multiplicative ((+|-) multiplicative)*
  */
 static mbf_t parse_additive(parse_state_t *ps) {
-    mbf_t left = parse_multiplicative(ps);
+    fold_span_t span;
+    mbf_t left;
+    if (!fold_enter(ps, FOLD_ADD, &span, &left)) {
+        left = parse_multiplicative(ps);
+    }
+
+    /* Longest constant prefix with at least one operator */
+    size_t const_end = 0;
+    mbf_t const_value = MBF_ZERO;
 
     for (;;) {
         skip_space(ps);
@@ -737,8 +961,14 @@ static mbf_t parse_additive(parse_state_t *ps) {
         } else {
             break;
         }
+
+        if (span.track && !ps->impure) {
+            const_end = ps->pos;
+            const_value = left;
+        }
     }
 
+    fold_leave(ps, FOLD_ADD, &span, const_end, const_value);
     return left;
 }
 
@@ -746,7 +976,15 @@ static mbf_t parse_additive(parse_state_t *ps) {
  * Parse multiplicative expression: unary ((*|/) unary)*
  */
 static mbf_t parse_multiplicative(parse_state_t *ps) {
-    mbf_t left = parse_unary(ps);
+    fold_span_t span;
+    mbf_t left;
+    if (!fold_enter(ps, FOLD_MUL, &span, &left)) {
+        left = parse_unary(ps);
+    }
+
+    /* Longest constant prefix with at least one operator */
+    size_t const_end = 0;
+    mbf_t const_value = MBF_ZERO;
 
     for (;;) {
         skip_space(ps);
@@ -763,8 +1001,14 @@ static mbf_t parse_multiplicative(parse_state_t *ps) {
         } else {
             break;
         }
+
+        if (span.track && !ps->impure) {
+            const_end = ps->pos;
+            const_value = left;
+        }
     }
 
+    fold_leave(ps, FOLD_MUL, &span, const_end, const_value);
     return left;
 }
 
@@ -778,29 +1022,16 @@ static mbf_t parse_power(parse_state_t *ps) {
 
     while (peek(ps) == TOK_POW) {
         consume(ps);
+
+        /* The exponent may carry its own sign: X^-1 */
+        skip_space(ps);
+        uint8_t sign = peek(ps);
+        if (sign == TOK_MINUS || sign == TOK_PLUS) consume(ps);
         mbf_t right = parse_primary(ps);
+        if (sign == TOK_MINUS) right = mbf_neg(right);
 
-        /* Exponentiation: a^b = exp(b * log(a)) */
-        /* TODO: Use proper MBF implementation */
-        /* For now, use a simple approximation */
-        if (mbf_is_zero(left)) {
-            left = MBF_ZERO;
-        } else {
-            bool overflow;
-            int32_t exp_int = mbf_to_int32(right, &overflow);
-            if (!overflow && exp_int >= 0 && exp_int <= 10) {
-                /* Small positive integer exponent - use repeated multiplication */
-                mbf_t result = mbf_from_int16(1);
-                for (int32_t i = 0; i < exp_int; i++) {
-                    result = mbf_mul(result, left);
-                }
-                left = result;
-            } else {
-                /* TODO: implement general exponentiation */
-                ps->error = ERR_OV;
-                left = MBF_ZERO;
-            }
-        }
+        left = eval_power(left, right, &ps->error);
+        if (ps->error != ERR_NONE) return MBF_ZERO;
     }
 
     return left;
@@ -810,7 +1041,7 @@ static mbf_t parse_power(parse_state_t *ps) {
  * Parse unary expression: (+|-)? power
  * Unary - has LOWER precedence than ^, so -3^2 = -(3^2) = -9
  */
-static mbf_t parse_unary(parse_state_t *ps) {
+static mbf_t parse_signed(parse_state_t *ps) {
     skip_space(ps);
     uint8_t op = peek(ps);
 
@@ -826,6 +1057,22 @@ static mbf_t parse_unary(parse_state_t *ps) {
     return parse_power(ps);
 }
 
+/*
+ * Parse one operand of * and /, using its folded value if it is a
+ * known constant.
+ */
+static mbf_t parse_unary(parse_state_t *ps) {
+    fold_span_t span;
+    mbf_t value;
+    if (fold_enter(ps, FOLD_UNARY, &span, &value)) {
+        return value;
+    }
+
+    value = parse_signed(ps);
+    fold_leave(ps, FOLD_UNARY, &span, ps->pos, value);
+    return value;
+}
+
 /*
  * Parse primary expression: number | variable | function | (expr)
  */
@@ -862,6 +1109,7 @@ static mbf_t parse_primary(parse_state_t *ps) {
                   ps->pos + 2 < ps->len &&
                   isalpha(ps->text[ps->pos + 2]));
     if (is_fn) {
+        ps->impure = true;
         char fn_name;
         if (c == TOK_FN) {
             consume(ps);  /* Consume FN token */
@@ -899,6 +1147,17 @@ static mbf_t parse_primary(parse_state_t *ps) {
             return MBF_ZERO;
         }
 
+        /* Parsed at DEF time: bind and evaluate directly */
+        mbf_t result;
+        basic_error_t err;
+        if (stmt_fn_call(ps->basic, fn_idx, arg_value, &result, &err)) {
+            if (err != ERR_NONE) {
+                ps->error = err;
+                return MBF_ZERO;
+            }
+            return result;
+        }
+
         /* Get function definition pointer */
         uint16_t def_ptr = ps->basic->user_funcs[fn_idx].ptr;
         const uint8_t *def_text = ps->basic->memory + def_ptr;
@@ -949,9 +1208,8 @@ static mbf_t parse_primary(parse_state_t *ps) {
         }
 
         /* Evaluate expression */
-        basic_error_t err;
         size_t consumed;
-        mbf_t result = eval_expression(ps->basic, def_text + dp, def_len, &consumed, &err);
+        result = eval_expression(ps->basic, def_text + dp, def_len, &consumed, &err);
 
         /* Restore parameter */
         var_set_numeric(ps->basic, param_name, saved_value);
@@ -964,8 +1222,15 @@ static mbf_t parse_primary(parse_state_t *ps) {
         return result;
     }
 
+    /* INSTR([start,] a$, b$) when enabled */
+    if (ps->basic && ps->basic->instr_enabled && is_instr(ps)) {
+        ps->impure = true;
+        return parse_instr(ps);
+    }
+
     /* Variable lookup */
     if (isalpha(c)) {
+        ps->impure = true;
         char var_name[3] = {0};
         var_name[0] = (char)consume(ps);
 
@@ -992,15 +1257,13 @@ static mbf_t parse_primary(parse_state_t *ps) {
             consume(ps);  /* Consume ( */
 
             /* Parse first index */
-            mbf_t idx1_val = parse_expression(ps);
             bool overflow;
-            int idx1 = mbf_to_int16(idx1_val, &overflow);
+            int idx1 = parse_int_operand(ps, &overflow);
 
             int idx2 = -1;  /* -1 indicates 1D array */
             if (peek(ps) == ',') {
                 consume(ps);
-                mbf_t idx2_val = parse_expression(ps);
-                idx2 = mbf_to_int16(idx2_val, &overflow);
+                idx2 = parse_int_operand(ps, &overflow);
             }
 
             if (!expect(ps, ')')) {
@@ -1134,6 +1397,12 @@ static mbf_t parse_function(parse_state_t *ps, uint8_t token) {
         return MBF_ZERO;
     }
 
+    /* Functions whose result does not depend only on the argument */
+    if (token == TOK_RND || token == TOK_PEEK || token == TOK_FRE ||
+        token == TOK_POS || token == TOK_USR || token == TOK_INP) {
+        ps->impure = true;
+    }
+
     /* Dispatch based on function token */
     switch (token) {
         case TOK_ABS:
@@ -1253,15 +1522,11 @@ static mbf_t parse_function(parse_state_t *ps, uint8_t token) {
  */
 mbf_t eval_expression(basic_state_t *state, const uint8_t *text, size_t len,
                       size_t *consumed, basic_error_t *error) {
-    parse_state_t ps = {
-        .text = text,
-        .pos = 0,
-        .len = len,
-        .basic = state,
-        .error = ERR_NONE
-    };
+    parse_state_t ps;
+    parse_init(&ps, state, text, len);
 
     mbf_t result = parse_expression(&ps);
+    parse_finish(&ps);
 
     if (consumed) *consumed = ps.pos;
     if (error) *error = ps.error;
@@ -1288,15 +1553,11 @@ mbf_t eval_expression(basic_state_t *state, const uint8_t *text, size_t len,
 const char *eval_string_expression(basic_state_t *state, const uint8_t *text,
                                    size_t len, size_t *consumed,
                                    basic_error_t *error) {
-    parse_state_t ps = {
-        .text = text,
-        .pos = 0,
-        .len = len,
-        .basic = state,
-        .error = ERR_NONE
-    };
+    parse_state_t ps;
+    parse_init(&ps, state, text, len);
 
     string_desc_t result = parse_string_arg(&ps);
+    parse_finish(&ps);
 
     if (consumed) *consumed = ps.pos;
     if (error) *error = ps.error;
@@ -1308,21 +1569,34 @@ const char *eval_string_expression(basic_state_t *state, const uint8_t *text,
     return (const char *)(state->memory + result.ptr);
 }
 
+/*
+ * One ^ step. OV on overflow, FC for a negative number to a fractional
+ * power; nothing is computed once an error is pending.
+ */
+mbf_t eval_power(mbf_t base, mbf_t exponent, basic_error_t *error) {
+    if (*error != ERR_NONE) return MBF_ZERO;
+
+    mbf_clear_error();
+    mbf_t result = mbf_pow(base, exponent);
+    mbf_error_t err = mbf_get_error();
+    if (err == MBF_OVERFLOW || err == MBF_DOMAIN) {
+        *error = err == MBF_OVERFLOW ? ERR_OV : ERR_FC;
+        return MBF_ZERO;
+    }
+    return result;
+}
+
 /*
  * Evaluate a string expression and return descriptor.
  */
 string_desc_t eval_string_desc(basic_state_t *state, const uint8_t *text,
                                size_t len, size_t *consumed,
                                basic_error_t *error) {
-    parse_state_t ps = {
-        .text = text,
-        .pos = 0,
-        .len = len,
-        .basic = state,
-        .error = ERR_NONE
-    };
+    parse_state_t ps;
+    parse_init(&ps, state, text, len);
 
     string_desc_t result = parse_string_arg(&ps);
+    parse_finish(&ps);
 
     if (consumed) *consumed = ps.pos;
     if (error) *error = ps.error;
@@ -0,0 +1,1360 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file quicken.c
+ * @brief Lazy Per-Statement Decoding ("quickening")
+ *
+ * Before running a statement the main loop used to find the line that
+ * contains text_ptr (a walk over every line from the top of the program)
+ * and scan for the statement's end. Then execute_statement() re-parsed it
+ * from its first byte. None of that changes between executions unless the
+ * program is edited.
+ *
+ * This module does the work once per statement. The first time a
+ * statement runs it is decoded into a quick_stmt_t kept in an
+ * open-addressed table keyed by statement offset:
+ *
+ * - owning line and line number, statement length (for every statement)
+ * - `GOTO n` / `GOSUB n`: the target line's text offset and, for GOSUB,
+ *   the return position
+ * - `V = expr` on a numeric simple variable: the variable name, its table
+ *   slot (cached on first store) and the expression offset, or the value
+ *   itself when the right-hand side is a lone number literal
+ * - `V = V + number` / `V = V - number`: the literal, added to the cached
+ *   slot without parsing; `V = W` and `A$ = B$`: both slots cached, the
+ *   value (or string descriptor) copied across
+ * - `A(V) = expr`, `A(V,W) = expr`: the array name, the subscript
+ *   variables' slots, and where the array's elements start and its
+ *   dimensions (re-checked against state->array_gen and the header)
+ * - `PRINT` / `?`: a print plan, recorded by the first run that completes
+ *   (see print_execute()) and replayed after that
+ * - `NEXT` / `NEXT V`: the variable's table slot and the FOR stack entry
+ *   it matched last time
+ * - `IF expr THEN ...`: where THEN and its clause are, the target of
+ *   `THEN n`, and the start of the next line for a false condition
+ * - `ON expr GOTO/GOSUB n,...`: a table of target offsets indexed by the
+ *   selector, plus the GOSUB return position, and the variable's table
+ *   slot when the selector is a lone variable
+ * - `FOR V = ...` directly followed by `A(V) = number`, `A(V) = B(V)`,
+ *   `A(V) = B(V) op C(V)` (op one of + - *) or `A(V) = f(B(V))` (f one of
+ *   SQR SIN COS TAN ATN LOG EXP) and then `NEXT` / `NEXT V`:
+ *   the body's kind, the array names and where the NEXT is. After FOR
+ *   has run normally, the whole loop is done as one pass over the arrays
+ *   with the batched MBF operations, when run_array_loop() can show the
+ *   result is the same as iterating
+ *
+ * The table remembers state->program_gen and empties itself when the
+ * program changes (line entry, NEW, CLOAD, POKE into program text), so
+ * there is no up-front cost in an interactive session where the program
+ * is edited between runs.
+ *
+ * ## Exactness
+ *
+ * Records are only specialised when the statement is exactly the shape
+ * described; everything else is QUICK_GENERIC and runs through
+ * execute_statement() as before. The specialised paths perform the same
+ * operations in the same order as the generic code, including the
+ * errors they can raise (OM for a full variable table, OM for GOSUB
+ * nesting).
+ */
+
+#include "basic/basic.h"
+#include "basic/tokens.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Initial number of table slots (power of two) */
+#define QUICK_INITIAL_SLOTS 256
+
+/** Size of a simple variable entry */
+#define VAR_SIZE 6
+
+/** Most targets an ON statement takes, as in exec_on() */
+#define ON_MAX_TARGETS 16
+
+/** Decoded target list of one ON statement */
+typedef struct {
+    uint16_t line[ON_MAX_TARGETS];      /**< Line numbers as written */
+    uint16_t target[ON_MAX_TARGETS];    /**< Text offsets, 0 if undefined */
+} quick_on_t;
+
+/**
+ * Statement table: open addressing with linear probing. Keys are stored
+ * as offset + 1 so that 0 marks an empty slot.
+ */
+struct basic_quick {
+    uint32_t gen;               /**< program_gen the records belong to */
+    size_t capacity;            /**< Number of slots (power of two) */
+    size_t count;               /**< Slots in use */
+    uint32_t *keys;             /**< offset + 1, or 0 for an empty slot */
+    quick_stmt_t *records;
+    quick_on_t *on_lists;       /**< ON target lists, indexed by on_table */
+    size_t on_count;            /**< Lists in use */
+    size_t on_capacity;         /**< Lists allocated */
+    print_plan_t *plans;        /**< PRINT plans, indexed by plan */
+    size_t plan_count;          /**< Plans in use */
+    size_t plan_capacity;       /**< Plans allocated */
+};
+
+
+/*============================================================================
+ * DECODING
+ *============================================================================*/
+
+/* Find the line containing offset, exactly like the main loop */
+static bool find_owning_line(basic_state_t *state, uint16_t offset,
+                             uint16_t *line, uint16_t *line_num) {
+    uint8_t *ptr = state->memory + state->program_start;
+    uint8_t *end = state->memory + state->program_end;
+
+    while (ptr < end) {
+        uint16_t link = (uint16_t)(ptr[0] | (ptr[1] << 8));
+        uint8_t *line_text = ptr + 4;
+        uint8_t *line_end = (link > 0) ? state->memory + link : end;
+
+        if (offset >= (uint16_t)(line_text - state->memory) &&
+            offset < (uint16_t)(line_end - state->memory)) {
+            *line = (uint16_t)(ptr - state->memory);
+            *line_num = (uint16_t)(ptr[2] | (ptr[3] << 8));
+            return true;
+        }
+
+        if (link == 0) break;
+        ptr = state->memory + link;
+    }
+    return false;
+}
+
+/* Statement length, split exactly like the main loop */
+static uint16_t statement_length(const uint8_t *text) {
+    size_t len = 0;
+    size_t skip = 0;
+    while (text[skip] == ' ') skip++;
+
+    if (text[skip] == TOK_REM) {
+        while (text[len] != '\0') len++;
+    } else {
+        bool in_string = false;
+        while (text[len] != '\0') {
+            if (text[len] == '"') {
+                in_string = !in_string;
+            } else if (text[len] == ':' && !in_string) {
+                break;
+            }
+            len++;
+        }
+    }
+    return (uint16_t)len;
+}
+
+/*
+ * If text[pos..len) is a lone number literal (plus trailing spaces),
+ * return true with its value as the expression parser would produce it.
+ */
+static bool literal_value(const uint8_t *text, size_t pos, size_t len, mbf_t *value) {
+    size_t start = pos;
+    if (!(pos < len && (isdigit(text[pos]) || text[pos] == '.'))) return false;
+    while (pos < len) {
+        uint8_t c = text[pos];
+        if (isdigit(c) || c == '.' || c == 'E' || c == 'e') {
+            pos++;
+        } else if ((c == '+' || c == '-' || c == TOK_PLUS || c == TOK_MINUS) &&
+                   pos > start && (text[pos - 1] == 'E' || text[pos - 1] == 'e')) {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    if (pos == start || pos - start > 63) return false;
+
+    size_t end = pos;
+    while (pos < len && text[pos] == ' ') pos++;
+    if (pos != len) return false;
+
+    /* A number needs no interpreter state, so this has no side effects */
+    size_t consumed;
+    basic_error_t err;
+    *value = eval_expression(NULL, text + start, end - start, &consumed, &err);
+    return err == ERR_NONE && consumed == end - start;
+}
+
+/* Variable or array name at pos: the two significant characters, uppercased */
+static size_t scan_name(const uint8_t *text, size_t pos, size_t len, char name[3]) {
+    memset(name, 0, 3);
+    if (!(pos < len && isalpha(text[pos]))) return pos;
+    name[0] = (char)toupper(text[pos++]);
+    if (pos < len && isalnum(text[pos])) {
+        name[1] = (char)toupper(text[pos++]);
+    }
+    while (pos < len && isalnum(text[pos])) pos++;
+    return pos;
+}
+
+/* Where RETURN continues after a GOSUB at q: same scan as execute_statement() */
+static uint16_t return_position(basic_state_t *state, const quick_stmt_t *q) {
+    const uint8_t *p = state->memory + q->offset;
+    while (*p != '\0' && *p != ':') p++;
+    if (*p == ':') {
+        return (uint16_t)(p + 1 - state->memory);
+    }
+    uint16_t link = (uint16_t)(state->memory[q->line] | (state->memory[q->line + 1] << 8));
+    return link > 0 ? (uint16_t)(link + 4) : state->program_end;
+}
+
+/* GOTO n / GOSUB n with n a literal naming an existing line */
+static void decode_jump(basic_state_t *state, quick_stmt_t *q, size_t pos, quick_op_t op) {
+    const uint8_t *text = state->memory + q->offset;
+    mbf_t value;
+
+    while (pos < q->len && text[pos] == ' ') pos++;
+    if (pos >= q->len || !isdigit(text[pos])) return;
+    if (!literal_value(text, pos, q->len, &value)) return;
+
+    bool overflow;
+    int16_t line_num = mbf_to_int16(value, &overflow);
+    if (overflow || line_num < 0) return;   /* UL via the generic path */
+
+    const uint8_t *target = program_get_line(state, (uint16_t)line_num, NULL);
+    if (!target) return;                    /* UL via the generic path */
+
+    q->target = (uint16_t)(target - state->memory);
+    q->target_line = (uint16_t)line_num;
+
+    if (op == QUICK_GOSUB) {
+        q->return_ptr = return_position(state, q);
+    }
+    q->op = (uint8_t)op;
+}
+
+/* ON expr GOTO/GOSUB n[,n...] */
+static void decode_on(basic_state_t *state, quick_stmt_t *q, size_t pos) {
+    struct basic_quick *quick = state->quick;
+    const uint8_t *text = state->memory + q->offset;
+    size_t len = q->len;
+    if (!quick) return;
+
+    /* The selector can only end at the first GOTO/GOSUB outside a string */
+    size_t keyword = pos;
+    bool in_string = false;
+    while (keyword < len &&
+           (in_string || (text[keyword] != TOK_GOTO && text[keyword] != TOK_GOSUB))) {
+        if (text[keyword] == '"') in_string = !in_string;
+        keyword++;
+    }
+    if (keyword >= len) return;     /* SN via the generic path */
+
+    /* A lone variable as selector is read from its slot */
+    size_t sel = pos;
+    while (sel < keyword && text[sel] == ' ') sel++;
+    size_t sel_end = scan_name(text, sel, keyword, q->var_name);
+    while (sel_end < keyword && text[sel_end] == ' ') sel_end++;
+    if (sel_end == sel || sel_end != keyword) {
+        memset(q->var_name, 0, sizeof(q->var_name));
+    }
+    q->var_key[0] = (uint8_t)q->var_name[0];
+    q->var_key[1] = (uint8_t)q->var_name[1];
+    q->var_index = UINT16_MAX;
+
+    if (quick->on_count == quick->on_capacity) {
+        size_t capacity = quick->on_capacity ? quick->on_capacity * 2 : 8;
+        quick_on_t *lists = realloc(quick->on_lists, capacity * sizeof(*lists));
+        if (!lists) return;
+        quick->on_lists = lists;
+        quick->on_capacity = capacity;
+    }
+    quick_on_t *list = &quick->on_lists[quick->on_count];
+    q->expr = (uint16_t)pos;
+
+    /* Same scan as exec_on() */
+    uint8_t count = 0;
+    pos = keyword + 1;
+    while (pos < len && count < ON_MAX_TARGETS) {
+        while (pos < len && text[pos] == ' ') pos++;
+        if (pos >= len || !isdigit(text[pos])) break;
+
+        uint16_t line_num = 0;
+        while (pos < len && isdigit(text[pos])) {
+            line_num = (uint16_t)(line_num * 10 + (uint16_t)(text[pos] - '0'));
+            pos++;
+        }
+        const uint8_t *target = program_get_line(state, line_num, NULL);
+        list->line[count] = line_num;
+        list->target[count] = target ? (uint16_t)(target - state->memory) : 0;
+        count++;
+
+        while (pos < len && text[pos] == ' ') pos++;
+        if (pos < len && text[pos] == ',') {
+            pos++;
+        } else {
+            break;
+        }
+    }
+
+    q->on_keyword = (uint16_t)keyword;
+    q->on_table = (uint16_t)quick->on_count++;
+    q->on_count = count;
+    if (text[keyword] == TOK_GOSUB) {
+        q->return_ptr = return_position(state, q);
+        q->op = QUICK_ON_GOSUB;
+    } else {
+        q->op = QUICK_ON_GOTO;
+    }
+}
+
+/*
+ * Variable name at pos followed by '$' if is_string, then spaces, and
+ * nothing else before len. Returns false if the text is anything else.
+ */
+static bool lone_variable(const uint8_t *text, size_t pos, size_t len, bool is_string,
+                          char name[3], uint8_t key[2]) {
+    size_t end = scan_name(text, pos, len, name);
+    if (end == pos) return false;
+    if (is_string) {
+        if (end >= len || text[end] != '$') return false;
+        end++;
+    }
+    while (end < len && text[end] == ' ') end++;
+    if (end != len) return false;
+
+    key[0] = (uint8_t)name[0];
+    key[1] = (uint8_t)(name[1] | (is_string ? 0x80 : 0));
+    return true;
+}
+
+/*
+ * A(V) = expr or A(V,W) = expr, with exactly that written (the generic
+ * path reads a subscript of that form as a lone variable, anything else
+ * is parsed).
+ */
+static void decode_let_element(quick_stmt_t *q, const uint8_t *text, size_t pos,
+                               const char name[3]) {
+    size_t len = q->len;
+    char index[3], second[3] = {0};
+
+    size_t end = scan_name(text, pos, len, index);
+    if (end == pos || end >= len) return;
+    if (text[end] == ',') {
+        pos = end + 1;
+        end = scan_name(text, pos, len, second);
+        if (end == pos || end >= len) return;
+    }
+    if (text[end] != ')') return;
+    pos = end + 1;
+    while (pos < len && text[pos] == ' ') pos++;
+    if (pos >= len || text[pos] != TOK_EQ) return;
+    pos++;
+    while (pos < len && text[pos] == ' ') pos++;
+
+    q->arrays[0][0] = (char)toupper((unsigned char)name[0]);
+    q->arrays[0][1] = (char)toupper((unsigned char)name[1]);
+    memcpy(q->var_name, index, sizeof(index));
+    q->var_key[0] = (uint8_t)index[0];
+    q->var_key[1] = (uint8_t)index[1];
+    q->var_index = UINT16_MAX;
+    q->subscripts = 1;
+    if (second[0]) {
+        memcpy(q->src_name, second, sizeof(second));
+        q->src_key[0] = (uint8_t)second[0];
+        q->src_key[1] = (uint8_t)second[1];
+        q->src_index = UINT16_MAX;
+        q->subscripts = 2;
+    }
+    q->array_gen = UINT32_MAX;
+    q->expr = (uint16_t)pos;
+    q->op = QUICK_LET_ELEMENT;
+}
+
+/*
+ * [LET] V = expr with V a numeric simple variable, and the common
+ * shapes of it: V = number, V = V + number, V = V - number, V = W.
+ * Also A$ = B$ and A(V) = expr.
+ */
+static void decode_let(basic_state_t *state, quick_stmt_t *q, size_t pos) {
+    const uint8_t *text = state->memory + q->offset;
+    size_t len = q->len;
+
+    if (text[pos] == TOK_LET) pos++;
+    while (pos < len && text[pos] == ' ') pos++;
+    if (!(pos < len && isalpha(text[pos]))) return;
+
+    char name[3] = {0};
+    name[0] = (char)text[pos++];
+    if (pos < len && isalnum(text[pos])) {
+        name[1] = (char)text[pos++];
+    }
+    while (pos < len && isalnum(text[pos])) pos++;
+
+    bool is_string = pos < len && text[pos] == '$';
+    if (is_string) pos++;
+
+    /* Other array assignments keep the generic path */
+    if (pos < len && text[pos] == '(') {
+        if (!is_string) decode_let_element(q, text, pos + 1, name);
+        return;
+    }
+
+    while (pos < len && text[pos] == ' ') pos++;
+    if (pos >= len || text[pos] != TOK_EQ) return;
+    pos++;
+    while (pos < len && text[pos] == ' ') pos++;
+
+    memcpy(q->var_name, name, sizeof(name));
+    q->var_key[0] = (uint8_t)toupper((unsigned char)name[0]);
+    q->var_key[1] = (uint8_t)(toupper((unsigned char)name[1]) | (is_string ? 0x80 : 0));
+    q->var_index = UINT16_MAX;
+    q->src_index = UINT16_MAX;
+    q->expr = (uint16_t)pos;
+
+    if (is_string) {
+        if (lone_variable(text, pos, len, true, q->src_name, q->src_key)) {
+            q->op = QUICK_LET_STRING;
+        }
+        return;
+    }
+
+    if (literal_value(text, pos, len, &q->value)) {
+        q->op = QUICK_LET_CONST;
+    } else if (lone_variable(text, pos, len, false, q->src_name, q->src_key)) {
+        q->op = QUICK_LET_VAR;
+    } else {
+        q->op = QUICK_LET;
+
+        /* V + number or V - number, V the target itself */
+        char src[3];
+        size_t end = scan_name(text, pos, len, src);
+        if (end == pos || (uint8_t)src[0] != q->var_key[0] ||
+            (uint8_t)src[1] != q->var_key[1]) {
+            return;
+        }
+        while (end < len && text[end] == ' ') end++;
+        if (end >= len || (text[end] != TOK_PLUS && text[end] != TOK_MINUS)) return;
+        uint8_t op = text[end++];
+        while (end < len && text[end] == ' ') end++;
+        if (literal_value(text, end, len, &q->value)) {
+            q->op = op == TOK_PLUS ? QUICK_LET_INC : QUICK_LET_DEC;
+        }
+    }
+}
+
+/* PRINT or ?: an empty plan, filled in by the first complete run */
+static void decode_print(basic_state_t *state, quick_stmt_t *q, size_t pos) {
+    struct basic_quick *quick = state->quick;
+    if (!quick) return;
+
+    if (quick->plan_count == quick->plan_capacity) {
+        size_t capacity = quick->plan_capacity ? quick->plan_capacity * 2 : 8;
+        print_plan_t *plans = realloc(quick->plans, capacity * sizeof(*plans));
+        if (!plans) return;
+        quick->plans = plans;
+        quick->plan_capacity = capacity;
+    }
+    quick->plans[quick->plan_count].status = PRINT_PLAN_NONE;
+    quick->plans[quick->plan_count].count = 0;
+
+    q->expr = (uint16_t)pos;
+    q->plan = (uint16_t)quick->plan_count++;
+    q->op = QUICK_PRINT;
+}
+
+/* NEXT or NEXT V (a list of variables keeps the generic path) */
+static void decode_next(basic_state_t *state, quick_stmt_t *q, size_t pos) {
+    const uint8_t *text = state->memory + q->offset;
+    size_t len = q->len;
+
+    while (pos < len && text[pos] == ' ') pos++;
+    if (pos < len && isalpha(text[pos])) {
+        q->var_name[0] = (char)text[pos++];
+        if (pos < len && isalnum(text[pos])) {
+            q->var_name[1] = (char)text[pos++];
+        }
+        while (pos < len && isalnum(text[pos])) pos++;
+        while (pos < len && text[pos] == ' ') pos++;
+    }
+    if (pos != len) return;
+
+    q->var_key[0] = (uint8_t)toupper((unsigned char)q->var_name[0]);
+    q->var_key[1] = (uint8_t)toupper((unsigned char)q->var_name[1]);
+    q->var_index = UINT16_MAX;
+    q->for_index = UINT8_MAX;
+    q->op = QUICK_NEXT;
+}
+
+/* IF expr THEN clause */
+static void decode_if(basic_state_t *state, quick_stmt_t *q, size_t pos) {
+    const uint8_t *text = state->memory + q->offset;
+    size_t len = q->len;
+
+    /* The condition can only end at the first THEN outside a string */
+    size_t then_pos = pos;
+    bool in_string = false;
+    while (then_pos < len && (in_string || text[then_pos] != TOK_THEN)) {
+        if (text[then_pos] == '"') in_string = !in_string;
+        then_pos++;
+    }
+    if (then_pos >= len) return;    /* SN via the generic path */
+
+    size_t clause = then_pos + 1;
+    while (clause < len && text[clause] == ' ') clause++;
+
+    /* THEN n: same digit scan as exec_if(), target resolved if it exists */
+    if (clause < len && isdigit(text[clause])) {
+        uint16_t line_num = 0;
+        for (size_t i = clause; i < len && isdigit(text[i]); i++) {
+            line_num = (uint16_t)(line_num * 10 + (uint16_t)(text[i] - '0'));
+        }
+        const uint8_t *target = program_get_line(state, line_num, NULL);
+        q->target = target ? (uint16_t)(target - state->memory) : 0;
+        q->target_line = line_num;
+    }
+
+    /* A false condition skips the rest of the line */
+    const uint8_t *p = text;
+    while (*p != '\0') p++;
+    uint16_t link = (uint16_t)(state->memory[q->line] | (state->memory[q->line + 1] << 8));
+    q->skip_ptr = link > 0 ? (uint16_t)(link + 4) : (uint16_t)(p - state->memory);
+
+    q->expr = (uint16_t)pos;
+    q->then_pos = (uint16_t)then_pos;
+    q->clause = (uint16_t)clause;
+    q->op = QUICK_IF;
+}
+
+/*
+ * Offset (and line number) of the statement after the one at offset,
+ * split like the main loop. False at the end of the program.
+ */
+static bool following_statement(basic_state_t *state, uint16_t offset, uint16_t len,
+                                uint16_t *line, uint16_t *next) {
+    const uint8_t *text = state->memory + offset;
+    if (text[len] == ':') {
+        *next = (uint16_t)(offset + len + 1);
+        return true;
+    }
+    uint16_t link = (uint16_t)(state->memory[*line] | (state->memory[*line + 1] << 8));
+    if (link == 0) return false;
+    *line = link;
+    *next = (uint16_t)(link + 4);
+    return true;
+}
+
+/*
+ * N(V) with N a numeric array and V the loop variable, then spaces.
+ * Returns the position after it, or 0 if the text is anything else.
+ */
+static size_t scan_element(const uint8_t *text, size_t pos, size_t len,
+                           const uint8_t key[2], char name[3]) {
+    char index[3];
+    size_t end = scan_name(text, pos, len, name);
+    if (end == pos || end >= len || text[end] != '(') return 0;
+
+    pos = end + 1;
+    while (pos < len && text[pos] == ' ') pos++;
+    end = scan_name(text, pos, len, index);
+    if (end == pos || (uint8_t)index[0] != key[0] || (uint8_t)index[1] != key[1]) return 0;
+
+    pos = end;
+    while (pos < len && text[pos] == ' ') pos++;
+    if (pos >= len || text[pos] != ')') return 0;
+    pos++;
+    while (pos < len && text[pos] == ' ') pos++;
+    return pos;
+}
+
+/* Functions with a batched form, which the parser evaluates without side effects */
+static bool batched_function(uint8_t token) {
+    return token == TOK_SQR || token == TOK_SIN || token == TOK_COS || token == TOK_TAN ||
+           token == TOK_ATN || token == TOK_LOG || token == TOK_EXP;
+}
+
+/* [LET] A(V) = number | B(V) | B(V) op C(V) | f(B(V)), op one of + - * */
+static bool decode_array_body(basic_state_t *state, quick_stmt_t *q) {
+    const uint8_t *text = state->memory + q->body;
+    size_t len = statement_length(text);
+    size_t pos = 0;
+
+    while (pos < len && text[pos] == ' ') pos++;
+    if (pos < len && text[pos] == TOK_LET) pos++;
+    while (pos < len && text[pos] == ' ') pos++;
+
+    pos = scan_element(text, pos, len, q->var_key, q->arrays[0]);
+    if (pos == 0 || pos >= len || text[pos] != TOK_EQ) return false;
+    pos++;
+    while (pos < len && text[pos] == ' ') pos++;
+
+    if (literal_value(text, pos, len, &q->value)) {
+        q->idiom = QUICK_IDIOM_FILL;
+        return true;
+    }
+
+    if (pos < len && batched_function(text[pos])) {
+        q->func = text[pos++];
+        while (pos < len && text[pos] == ' ') pos++;
+        if (pos >= len || text[pos] != '(') return false;
+        pos++;
+        while (pos < len && text[pos] == ' ') pos++;
+        pos = scan_element(text, pos, len, q->var_key, q->arrays[1]);
+        if (pos == 0 || pos >= len || text[pos] != ')') return false;
+        pos++;
+        while (pos < len && text[pos] == ' ') pos++;
+        if (pos != len) return false;
+        q->idiom = QUICK_IDIOM_FUNC;
+        return true;
+    }
+
+    pos = scan_element(text, pos, len, q->var_key, q->arrays[1]);
+    if (pos == 0) return false;
+    if (pos == len) {
+        q->idiom = QUICK_IDIOM_COPY;
+        return true;
+    }
+
+    uint8_t op = text[pos++];
+    while (pos < len && text[pos] == ' ') pos++;
+    pos = scan_element(text, pos, len, q->var_key, q->arrays[2]);
+    if (pos != len) return false;
+
+    if (op == TOK_PLUS) {
+        q->idiom = QUICK_IDIOM_ADD;
+    } else if (op == TOK_MINUS) {
+        q->idiom = QUICK_IDIOM_SUB;
+    } else if (op == TOK_MUL) {
+        q->idiom = QUICK_IDIOM_MUL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/*
+ * FOR V = ... whose body is a single element-wise array assignment
+ * followed directly by NEXT or NEXT V. Other loops stay generic.
+ */
+static void decode_for(basic_state_t *state, quick_stmt_t *q, size_t pos) {
+    const uint8_t *text = state->memory + q->offset;
+    char name[3];
+
+    while (pos < q->len && text[pos] == ' ') pos++;
+    if (scan_name(text, pos, q->len, name) == pos) return;
+    memcpy(q->var_name, name, sizeof(name));
+    q->var_key[0] = (uint8_t)name[0];
+    q->var_key[1] = (uint8_t)name[1];
+    q->var_index = UINT16_MAX;
+
+    uint16_t line = q->line;
+    if (!following_statement(state, q->offset, q->len, &line, &q->body)) return;
+    if (!decode_array_body(state, q)) return;
+
+    uint16_t body_len = statement_length(state->memory + q->body);
+    if (!following_statement(state, q->body, body_len, &line, &q->next_stmt)) return;
+    q->next_line = (uint16_t)(state->memory[line + 2] | (state->memory[line + 3] << 8));
+
+    /* NEXT or NEXT V */
+    const uint8_t *next = state->memory + q->next_stmt;
+    size_t next_len = statement_length(next);
+    pos = 0;
+    while (pos < next_len && next[pos] == ' ') pos++;
+    if (pos >= next_len || next[pos] != TOK_NEXT) return;
+    pos++;
+    while (pos < next_len && next[pos] == ' ') pos++;
+    size_t end = scan_name(next, pos, next_len, name);
+    if (end != pos && ((uint8_t)name[0] != q->var_key[0] ||
+                       (uint8_t)name[1] != q->var_key[1])) {
+        return;
+    }
+    while (end < next_len && next[end] == ' ') end++;
+    if (end != next_len) return;
+
+    q->op = QUICK_FOR_ARRAY;
+}
+
+/* Fill in a record for the statement at offset */
+static bool decode(basic_state_t *state, uint16_t offset, quick_stmt_t *q) {
+    memset(q, 0, sizeof(*q));
+    q->offset = offset;
+    if (!find_owning_line(state, offset, &q->line, &q->line_num)) {
+        return false;
+    }
+
+    const uint8_t *text = state->memory + offset;
+    q->len = statement_length(text);
+    q->op = QUICK_GENERIC;
+
+    size_t pos = 0;
+    while (pos < q->len && text[pos] == ' ') pos++;
+
+    uint8_t cmd = pos < q->len ? text[pos] : 0;
+    if (cmd == 0 || cmd == TOK_REM || cmd == TOK_DATA) {
+        q->op = QUICK_NOP;
+    } else if (cmd == TOK_GOTO) {
+        decode_jump(state, q, pos + 1, QUICK_GOTO);
+    } else if (cmd == TOK_GOSUB) {
+        decode_jump(state, q, pos + 1, QUICK_GOSUB);
+    } else if (cmd == TOK_NEXT) {
+        decode_next(state, q, pos + 1);
+    } else if (cmd == TOK_FOR) {
+        decode_for(state, q, pos + 1);
+    } else if (cmd == TOK_IF) {
+        decode_if(state, q, pos + 1);
+    } else if (cmd == TOK_ON) {
+        decode_on(state, q, pos + 1);
+    } else if (cmd == TOK_PRINT || cmd == '?') {
+        decode_print(state, q, pos);
+    } else if (state->mat_enabled && stmt_mat_match(text + pos, q->len - pos)) {
+        q->op = QUICK_GENERIC;
+    } else if (isalpha(cmd) || cmd == TOK_LET) {
+        decode_let(state, q, pos);
+    }
+    return true;
+}
+
+
+/*============================================================================
+ * STATEMENT TABLE
+ *============================================================================*/
+
+static size_t slot_for(uint16_t offset, size_t capacity) {
+    return ((size_t)offset * 40503u) & (capacity - 1);
+}
+
+/* (Re)allocate the table with the given capacity, dropping all records */
+static bool table_reset(struct basic_quick *quick, size_t capacity) {
+    uint32_t *keys = calloc(capacity, sizeof(*keys));
+    quick_stmt_t *records = malloc(capacity * sizeof(*records));
+    if (!keys || !records) {
+        free(keys);
+        free(records);
+        return false;
+    }
+    free(quick->keys);
+    free(quick->records);
+    quick->keys = keys;
+    quick->records = records;
+    quick->capacity = capacity;
+    quick->count = 0;
+    return true;
+}
+
+/* Double the table, keeping its records */
+static bool table_grow(struct basic_quick *quick) {
+    struct basic_quick bigger = {
+        .gen = quick->gen,
+        .on_lists = quick->on_lists,
+        .on_count = quick->on_count,
+        .on_capacity = quick->on_capacity,
+        .plans = quick->plans,
+        .plan_count = quick->plan_count,
+        .plan_capacity = quick->plan_capacity
+    };
+    if (!table_reset(&bigger, quick->capacity * 2)) return false;
+
+    for (size_t i = 0; i < quick->capacity; i++) {
+        if (!quick->keys[i]) continue;
+        size_t slot = slot_for(quick->records[i].offset, bigger.capacity);
+        while (bigger.keys[slot]) slot = (slot + 1) & (bigger.capacity - 1);
+        bigger.keys[slot] = quick->keys[i];
+        bigger.records[slot] = quick->records[i];
+        bigger.count++;
+    }
+
+    free(quick->keys);
+    free(quick->records);
+    *quick = bigger;
+    return true;
+}
+
+quick_stmt_t *quick_lookup(basic_state_t *state, uint16_t offset, quick_stmt_t *scratch) {
+    if (!state) return NULL;
+
+    struct basic_quick *quick = state->quick;
+    if (!quick) {
+        quick = calloc(1, sizeof(*quick));
+        if (quick && !table_reset(quick, QUICK_INITIAL_SLOTS)) {
+            free(quick);
+            quick = NULL;
+        }
+        if (!quick) {
+            return decode(state, offset, scratch) ? scratch : NULL;
+        }
+        quick->gen = state->program_gen;
+        state->quick = quick;
+    }
+
+    /* Any program change invalidates every record */
+    if (quick->gen != state->program_gen) {
+        memset(quick->keys, 0, quick->capacity * sizeof(*quick->keys));
+        quick->count = 0;
+        quick->on_count = 0;
+        quick->plan_count = 0;
+        quick->gen = state->program_gen;
+    }
+
+    size_t mask = quick->capacity - 1;
+    size_t slot = slot_for(offset, quick->capacity);
+    while (quick->keys[slot]) {
+        if (quick->keys[slot] == (uint32_t)offset + 1) {
+            return &quick->records[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    /* First execution: decode and remember */
+    if (!decode(state, offset, scratch)) return NULL;
+
+    if ((quick->count + 1) * 2 > quick->capacity) {
+        if (!table_grow(quick)) return scratch;
+        mask = quick->capacity - 1;
+        slot = slot_for(offset, quick->capacity);
+        while (quick->keys[slot]) slot = (slot + 1) & mask;
+    }
+
+    quick->keys[slot] = (uint32_t)offset + 1;
+    quick->records[slot] = *scratch;
+    quick->count++;
+    return &quick->records[slot];
+}
+
+void quick_free(basic_state_t *state) {
+    if (!state || !state->quick) return;
+    free(state->quick->keys);
+    free(state->quick->records);
+    free(state->quick->on_lists);
+    free(state->quick->plans);
+    free(state->quick);
+    state->quick = NULL;
+}
+
+size_t quick_decoded_statements(const basic_state_t *state) {
+    if (!state || !state->quick || state->quick->gen != state->program_gen) {
+        return 0;
+    }
+    return state->quick->count;
+}
+
+
+/*============================================================================
+ * EXECUTION
+ *============================================================================*/
+
+/* Variable slot at index if it still holds key, else NULL */
+static uint8_t *cached_slot(basic_state_t *state, uint16_t index, const uint8_t key[2]) {
+    if (index < state->var_count_) {
+        uint8_t *p = state->memory + state->var_start + index * VAR_SIZE;
+        if (p[0] == key[0] && p[1] == key[1]) return p;
+    }
+    return NULL;
+}
+
+static uint16_t slot_index(basic_state_t *state, const uint8_t *p) {
+    return (uint16_t)((size_t)(p - (state->memory + state->var_start)) / VAR_SIZE);
+}
+
+/* Cached variable slot of a record, or NULL if stale */
+static uint8_t *cached_var(basic_state_t *state, const quick_stmt_t *q) {
+    return cached_slot(state, q->var_index, q->var_key);
+}
+
+static void remember_var(basic_state_t *state, quick_stmt_t *q, const uint8_t *p) {
+    q->var_index = slot_index(state, p);
+}
+
+/*
+ * Slot of the LET_VAR / LET_STRING source, or NULL if it does not exist
+ * (it then reads as 0 or "", and is not created, as in the parser).
+ */
+static uint8_t *let_source(basic_state_t *state, quick_stmt_t *q) {
+    uint8_t *p = cached_slot(state, q->src_index, q->src_key);
+    if (p) return p;
+
+    char name[4] = {q->src_name[0], q->src_name[1], 0, 0};
+    if (q->src_key[1] & 0x80) name[name[1] ? 2 : 1] = '$';
+    p = var_find(state, name);
+    if (p) q->src_index = slot_index(state, p);
+    return p;
+}
+
+/* Slot of the LET target, creating the variable like var_set_numeric() */
+static uint8_t *let_target(basic_state_t *state, quick_stmt_t *q) {
+    uint8_t *p = cached_var(state, q);
+    if (p) return p;
+
+    char name[4] = {q->var_name[0], q->var_name[1], 0, 0};
+    if (q->var_key[1] & 0x80) name[name[1] ? 2 : 1] = '$';
+    p = var_get_or_create(state, name);
+    if (p) remember_var(state, q, p);
+    return p;
+}
+
+/*
+ * First element of the LET_ELEMENT target, using the position cached in
+ * the record while it still holds: the array area has not been emptied
+ * since (array_gen) and the header is still there, as it is when arrays
+ * were only added or moved up by a new variable. NULL if the array does
+ * not exist yet or has another number of subscripts.
+ */
+static uint8_t *element_base(basic_state_t *state, quick_stmt_t *q) {
+    uint16_t area = (uint16_t)(state->var_start + state->var_count_ * VAR_SIZE);
+    size_t header = q->subscripts == 1 ? 5 : 7;
+    if (q->array_gen == state->array_gen &&
+        q->array_at < (uint16_t)(state->array_start - area)) {
+        uint8_t *elem = state->memory + area + q->array_at;
+        const uint8_t *arr = elem - header;
+        if (arr[0] == (uint8_t)q->arrays[0][0] && arr[1] == (uint8_t)q->arrays[0][1]) {
+            return elem;
+        }
+    }
+
+    uint8_t *arr = array_find(state, q->arrays[0]);
+    if (!arr || arr[2] != q->subscripts) return NULL;
+    q->array_dims[0] = (uint16_t)(arr[3] | (arr[4] << 8));
+    if (q->subscripts == 2) q->array_dims[1] = (uint16_t)(arr[5] | (arr[6] << 8));
+    q->array_at = (uint16_t)(arr + header - (state->memory + area));
+    q->array_gen = state->array_gen;
+    return arr + header;
+}
+
+/* Value of a subscript variable (0 if it does not exist), as int16 */
+static bool subscript_of(const uint8_t *var, int16_t *index) {
+    mbf_t subscript = MBF_ZERO;
+    if (var) memcpy(&subscript.raw, var + 2, 4);
+
+    bool overflow;
+    *index = mbf_to_int16(subscript, &overflow);
+    return !overflow;
+}
+
+/*
+ * A(V) or A(V,W) = expr, as the generic LET: subscripts, then value, then
+ * store. The element is addressed from the cached first element and
+ * dimensions; a missing array is left to array_set_numeric() to create.
+ */
+static basic_error_t quick_let_element(basic_state_t *state, quick_stmt_t *q) {
+    uint8_t *var = cached_var(state, q);
+    if (!var) {
+        var = var_find(state, q->var_name);
+        if (var) remember_var(state, q, var);
+    }
+    int16_t index1, index2 = -1;
+    if (!subscript_of(var, &index1)) return ERR_BS;
+
+    if (q->subscripts == 2) {
+        uint8_t *var2 = cached_slot(state, q->src_index, q->src_key);
+        if (!var2) {
+            var2 = var_find(state, q->src_name);
+            if (var2) q->src_index = slot_index(state, var2);
+        }
+        if (!subscript_of(var2, &index2)) return ERR_BS;
+    }
+
+    basic_error_t err;
+    size_t consumed;
+    mbf_t value = eval_expression(state, state->memory + q->offset + q->expr,
+                                  (size_t)(q->len - q->expr), &consumed, &err);
+    if (err != ERR_NONE) return err;
+
+    uint8_t *elem = element_base(state, q);
+    if (!elem) {
+        if (!array_set_numeric(state, q->arrays[0], index1, index2, value)) return ERR_BS;
+        return ERR_NONE;
+    }
+
+    if (index1 < 0 || index1 > q->array_dims[0]) return ERR_BS;
+    size_t at = (size_t)index1;
+    if (q->subscripts == 2) {
+        if (index2 < 0 || index2 > q->array_dims[1]) return ERR_BS;
+        at = at * (size_t)(q->array_dims[1] + 1) + (size_t)index2;
+    }
+    elem += at * 4;
+    memcpy(elem, &value.raw, 4);
+    mem_mark_dirty_at(state, elem, 4);
+    return ERR_NONE;
+}
+
+/* IF, as exec_if() */
+static basic_error_t quick_if(basic_state_t *state, const quick_stmt_t *q) {
+    const uint8_t *text = state->memory + q->offset;
+    basic_error_t err;
+    size_t consumed;
+    mbf_t condition = eval_expression(state, text + q->expr, (size_t)(q->len - q->expr),
+                                      &consumed, &err);
+    if (err != ERR_NONE) return err;
+
+    size_t pos = q->expr + consumed;
+    while (pos < q->len && text[pos] == ' ') pos++;
+    if (pos != q->then_pos) return ERR_SN;
+
+    if (!stmt_if_eval(condition)) {
+        state->text_ptr = q->skip_ptr;
+        return ERR_NONE;
+    }
+
+    if (q->clause < q->len && isdigit(text[q->clause])) {
+        if (!q->target) return stmt_goto(state, q->target_line);   /* UL */
+        state->current_line = q->target_line;
+        state->text_ptr = q->target;
+        return ERR_NONE;
+    }
+
+    if (q->clause >= q->len) return ERR_NONE;
+    return basic_execute_statement(state, (uint16_t)(q->offset + q->clause),
+                                   (size_t)(q->len - q->clause));
+}
+
+/* ON expr GOTO/GOSUB, as exec_on() */
+static basic_error_t quick_on(basic_state_t *state, quick_stmt_t *q) {
+    const uint8_t *text = state->memory + q->offset;
+    mbf_t selector = MBF_ZERO;
+    bool overflow;
+    int16_t value;
+
+    if (q->var_name[0]) {
+        /* Lone variable: no parse, a missing one reads as 0 */
+        uint8_t *var = cached_var(state, q);
+        if (!var && (var = var_find(state, q->var_name)) != NULL) {
+            remember_var(state, q, var);
+        }
+        if (var) memcpy(&selector.raw, var + 2, 4);
+        value = mbf_to_int16(selector, &overflow);
+        if (overflow) return ERR_FC;
+    } else {
+        basic_error_t err;
+        size_t consumed;
+        selector = eval_expression(state, text + q->expr, (size_t)(q->len - q->expr),
+                                   &consumed, &err);
+        if (err != ERR_NONE) return err;
+
+        value = mbf_to_int16(selector, &overflow);
+        if (overflow) return ERR_FC;
+
+        size_t pos = q->expr + consumed;
+        while (pos < q->len && text[pos] == ' ') pos++;
+        if (pos != q->on_keyword) return ERR_SN;
+    }
+
+    if (q->on_count == 0) return ERR_FC;
+    if (value < 1 || value > q->on_count) return ERR_NONE;   /* Falls through */
+
+    const quick_on_t *list = &state->quick->on_lists[q->on_table];
+    uint16_t line_num = list->line[value - 1];
+    uint16_t target = list->target[value - 1];
+
+    if (q->op == QUICK_ON_GOSUB) {
+        if (!target) {
+            return stmt_gosub(state, line_num, state->current_line, q->return_ptr);
+        }
+        if (state->gosub_sp >= 16) return ERR_OM;
+        state->gosub_stack[state->gosub_sp].line_number = state->current_line;
+        state->gosub_stack[state->gosub_sp].text_ptr = q->return_ptr;
+        state->gosub_sp++;
+    } else if (!target) {
+        return stmt_goto(state, line_num);      /* UL */
+    }
+
+    state->current_line = line_num;
+    state->text_ptr = target;
+    return ERR_NONE;
+}
+
+/*
+ * True if every statement from body up to the NEXT at next is empty, REM
+ * or DATA, so going round the loop runs nothing but the NEXT.
+ */
+static bool loop_body_empty(basic_state_t *state, uint16_t body, uint16_t next) {
+    uint16_t line, line_num;
+    if (!find_owning_line(state, body, &line, &line_num)) return false;
+
+    uint16_t offset = body;
+    while (offset != next) {
+        const uint8_t *text = state->memory + offset;
+        uint16_t len = statement_length(text);
+        size_t pos = 0;
+        while (pos < len && text[pos] == ' ') pos++;
+        if (pos < len && text[pos] != TOK_REM && text[pos] != TOK_DATA) return false;
+        if (!following_statement(state, offset, len, &line, &offset)) return false;
+    }
+    return true;
+}
+
+/*
+ * NEXT [V], as exec_next() for a single variable. When the loop goes
+ * round again over a body with nothing to run, the rest of the loop is
+ * finished here and execution continues after the NEXT.
+ */
+static basic_error_t quick_next(basic_state_t *state, quick_stmt_t *q) {
+    uint8_t *var = NULL;
+    if (q->var_name[0]) {
+        var = cached_var(state, q);
+        if (!var) {
+            var = var_find(state, q->var_name);
+            if (!var) return ERR_NF;
+            remember_var(state, q, var);
+        }
+    }
+
+    bool continue_loop;
+    basic_error_t err = stmt_next_var(state, var, &q->for_index, &continue_loop);
+    if (err != ERR_NONE) return err;
+    if (!continue_loop) {
+        /* The next loop through here may be one that can be finished */
+        q->body = 0;
+        return ERR_NONE;
+    }
+
+    if (q->body != state->text_ptr) {
+        q->body = state->text_ptr;
+        q->body_empty = loop_body_empty(state, q->body, q->offset);
+    }
+    if (q->body_empty) {
+        if (!stmt_next_finish(state)) {
+            /* Not an exact integer loop: don't ask again until it ends */
+            q->body_empty = false;
+            return ERR_NONE;
+        }
+        /* Carry on after this NEXT, as when the loop ends */
+        state->current_line = q->line_num;
+        state->text_ptr = q->offset;
+        state->loop_to_self = false;
+    }
+    return ERR_NONE;
+}
+
+/* Elements per batch, staged through aligned buffers */
+#define IDIOM_CHUNK 256
+
+/* a[i] = f(a[i]) for a FUNC body's function token */
+static void apply_function(uint8_t func, mbf_t *a, size_t n) {
+    switch (func) {
+        case TOK_SQR: mbf_sqr_n(a, a, n); break;
+        case TOK_SIN: mbf_sin_n(a, a, n); break;
+        case TOK_COS: mbf_cos_n(a, a, n); break;
+        case TOK_TAN: mbf_tan_n(a, a, n); break;
+        case TOK_ATN: mbf_atn_n(a, a, n); break;
+        case TOK_LOG: mbf_log_n(a, a, n); break;
+        default:      mbf_exp_n(a, a, n); break;
+    }
+}
+
+/*
+ * First element of numeric 1D array name for subscript first, if the
+ * array exists and last is in range.
+ */
+static uint8_t *idiom_elements(basic_state_t *state, const char *name, int32_t first,
+                               int32_t last) {
+    uint8_t *arr = array_find(state, name);
+    if (!arr || arr[2] != 1) return NULL;
+    int32_t dim = arr[3] | (arr[4] << 8);
+    if (last > dim) return NULL;
+    return arr + 5 + (size_t)first * 4;
+}
+
+/*
+ * The whole loop of a FOR_ARRAY record, after FOR itself has run.
+ *
+ * Only taken when it cannot differ from running body and NEXT one
+ * iteration at a time: the loop counts up by 1 in exact integers from a
+ * start of 0 or more, the arrays already exist (so nothing is created or
+ * moved), and every subscript the loop will use is in range (so nothing
+ * can fail part way). The body runs for start..max(start, limit), every
+ * element gets the same bits the parser would compute, and the variable
+ * is left holding the last value with text_ptr on the NEXT, which then
+ * steps past the limit and ends the loop as usual.
+ */
+static void run_array_loop(basic_state_t *state, quick_stmt_t *q) {
+    uint8_t *var = cached_var(state, q);
+    if (!var) {
+        var = var_find(state, q->var_name);
+        if (!var) return;
+        remember_var(state, q, var);
+    }
+
+    /* A bare NEXT closes the innermost loop, which must be this one */
+    if (state->for_sp == 0) return;
+    const for_entry_t *entry = &state->for_stack[state->for_sp - 1];
+    if (entry->var != var || !entry->int_loop || entry->int_step != 1) return;
+
+    mbf_t current;
+    memcpy(&current.raw, var + 2, 4);
+    bool overflow;
+    int32_t first = mbf_to_int32(current, &overflow);
+    if (overflow || first < 0 || first > INT16_MAX ||
+        mbf_from_int32(first).raw != current.raw) {
+        return;
+    }
+    int32_t last = entry->int_limit > first ? entry->int_limit : first;
+
+    int sources = q->idiom == QUICK_IDIOM_FILL ? 0
+                : q->idiom == QUICK_IDIOM_COPY || q->idiom == QUICK_IDIOM_FUNC ? 1 : 2;
+    uint8_t *elem[3];
+    for (int i = 0; i <= sources; i++) {
+        elem[i] = idiom_elements(state, q->arrays[i], first, last);
+        if (!elem[i]) return;
+    }
+
+    mbf_t a[IDIOM_CHUNK], b[IDIOM_CHUNK];
+    size_t total = (size_t)(last - first) + 1;
+    mem_mark_dirty_at(state, elem[0], (uint32_t)(total * 4));
+    for (size_t done = 0; done < total; done += IDIOM_CHUNK) {
+        size_t n = total - done < IDIOM_CHUNK ? total - done : IDIOM_CHUNK;
+        uint8_t *dst = elem[0] + done * 4;
+
+        if (q->idiom == QUICK_IDIOM_FILL) {
+            for (size_t i = 0; i < n; i++) memcpy(dst + i * 4, &q->value.raw, 4);
+        } else if (q->idiom == QUICK_IDIOM_COPY) {
+            memmove(dst, elem[1] + done * 4, n * 4);
+        } else if (q->idiom == QUICK_IDIOM_FUNC) {
+            memcpy(a, elem[1] + done * 4, n * 4);
+            apply_function(q->func, a, n);
+            memcpy(dst, a, n * 4);
+        } else {
+            memcpy(a, elem[1] + done * 4, n * 4);
+            memcpy(b, elem[2] + done * 4, n * 4);
+            if (q->idiom == QUICK_IDIOM_MUL) {
+                mbf_mul_n(a, a, b, n);
+            } else {
+                if (q->idiom == QUICK_IDIOM_SUB) {
+                    for (size_t i = 0; i < n; i++) b[i] = mbf_neg(b[i]);
+                }
+                mbf_add_n(a, a, b, n);
+            }
+            memcpy(dst, a, n * 4);
+        }
+    }
+
+    mbf_t value = mbf_from_int32(last);
+    memcpy(var + 2, &value.raw, 4);
+    mem_mark_dirty_at(state, var + 2, 4);
+    state->current_line = q->next_line;
+    state->text_ptr = q->next_stmt;
+}
+
+/* FOR, then the loop in one pass when run_array_loop() allows it */
+static basic_error_t quick_for_array(basic_state_t *state, quick_stmt_t *q) {
+    basic_error_t err = basic_execute_statement(state, q->offset, q->len);
+    if (err != ERR_NONE || state->text_ptr != q->offset) return err;
+
+    run_array_loop(state, q);
+    return ERR_NONE;
+}
+
+bool quick_execute(basic_state_t *state, quick_stmt_t *q, basic_error_t *error) {
+    mbf_t value;
+    uint8_t *var;
+
+    switch ((quick_op_t)q->op) {
+        case QUICK_NOP:
+            *error = ERR_NONE;
+            return true;
+
+        case QUICK_GOTO:
+            state->current_line = q->target_line;
+            state->text_ptr = q->target;
+            *error = ERR_NONE;
+            return true;
+
+        case QUICK_GOSUB:
+            if (state->gosub_sp >= 16) {
+                *error = ERR_OM;
+                return true;
+            }
+            state->gosub_stack[state->gosub_sp].line_number = state->current_line;
+            state->gosub_stack[state->gosub_sp].text_ptr = q->return_ptr;
+            state->gosub_sp++;
+            state->current_line = q->target_line;
+            state->text_ptr = q->target;
+            *error = ERR_NONE;
+            return true;
+
+        case QUICK_LET: {
+            size_t consumed;
+            value = eval_expression(state, state->memory + q->offset + q->expr,
+                                    (size_t)(q->len - q->expr), &consumed, error);
+            if (*error != ERR_NONE) return true;
+            break;
+        }
+
+        case QUICK_LET_CONST:
+            value = q->value;
+            break;
+
+        case QUICK_LET_INC:
+        case QUICK_LET_DEC:
+            var = let_target(state, q);
+            if (!var) {
+                *error = ERR_OM;
+                return true;
+            }
+            memcpy(&value.raw, var + 2, 4);
+            value = q->op == QUICK_LET_INC ? mbf_add(value, q->value) : mbf_sub(value, q->value);
+            memcpy(var + 2, &value.raw, 4);
+            mem_mark_dirty_at(state, var + 2, 4);
+            *error = ERR_NONE;
+            return true;
+
+        case QUICK_LET_VAR:
+            var = let_source(state, q);
+            value = MBF_ZERO;
+            if (var) memcpy(&value.raw, var + 2, 4);
+            break;
+
+        case QUICK_LET_STRING: {
+            /* The descriptor is shared, as stmt_let_string() does */
+            uint8_t desc[4] = {0};
+            var = let_source(state, q);
+            if (var) memcpy(desc, var + 2, 4);
+            var = let_target(state, q);
+            if (!var) {
+                *error = ERR_OM;
+                return true;
+            }
+            memcpy(var + 2, desc, 4);
+            mem_mark_dirty_at(state, var + 2, 4);
+            *error = ERR_NONE;
+            return true;
+        }
+
+        case QUICK_LET_ELEMENT:
+            *error = quick_let_element(state, q);
+            return true;
+
+        case QUICK_NEXT:
+            *error = quick_next(state, q);
+            return true;
+
+        case QUICK_IF:
+            *error = quick_if(state, q);
+            return true;
+
+        case QUICK_FOR_ARRAY:
+            *error = quick_for_array(state, q);
+            return true;
+
+        case QUICK_ON_GOTO:
+        case QUICK_ON_GOSUB:
+            *error = quick_on(state, q);
+            return true;
+
+        case QUICK_PRINT:
+            *error = print_execute(state, state->memory + q->offset, q->len, q->expr,
+                                   &state->quick->plans[q->plan]);
+            return true;
+
+        case QUICK_GENERIC:
+        default:
+            return false;
+    }
+
+    /* Numeric store, as stmt_let_numeric() */
+    var = let_target(state, q);
+    if (!var) {
+        *error = ERR_OM;
+        return true;
+    }
+    memcpy(var + 2, &value.raw, 4);
+    mem_mark_dirty_at(state, var + 2, 4);
+    *error = ERR_NONE;
+    return true;
+}
@@ -38,23 +38,17 @@
  *
  * This file also contains `mbf_to_double()` and `mbf_from_double()` which
  * convert between Microsoft Binary Format and IEEE 754 double precision.
- * These are used for transcendental functions which currently use the
- * C math library rather than the original polynomial approximations.
+ * Both work on the bit fields directly (no pow() or frexp()).
  *
  * ## Implementation Notes
  *
- * The transcendental functions (SIN, COS, TAN, ATN, LOG, EXP) currently
- * convert MBF to IEEE double, call the C math library, and convert back.
- * This produces results that are close but not byte-for-byte identical
- * to the original 8K BASIC which used Chebyshev polynomial approximations.
- *
- * For exact compatibility, these could be replaced with the original
- * polynomial implementations from 8kbas_src.mac.
+ * The transcendental functions use the MBF polynomial kernels in
+ * mbf_trig.c, which follow the original 8K BASIC routines.
  */
 
 #include "basic/basic.h"
 #include "basic/errors.h"
-#include <math.h>
+#include <string.h>
 
 /*
  * SGN function - returns sign of number.
@@ -80,41 +74,21 @@ mbf_t fn_abs(mbf_t value) {
 }
 
 /*
- * SQR function - square root.
- * Uses Newton-Raphson iteration.
+ * SQR function - square root, as X^.5.
  */
 mbf_t fn_sqr(mbf_t value) {
-    if (mbf_is_zero(value)) {
-        return MBF_ZERO;
-    }
-
     if (mbf_is_negative(value)) {
         mbf_set_error(MBF_DOMAIN);
         return MBF_ZERO;
     }
-
-    /* Convert to IEEE, compute sqrt, convert back */
-    /* This is a working implementation - exact matching to original
-     * would require implementing the original Newton-Raphson algorithm */
-    double x = mbf_to_double(value);
-    double result = sqrt(x);
-    return mbf_from_double(result);
+    return mbf_sqr(value);
 }
 
 /*
  * EXP function - e raised to a power.
  */
 mbf_t fn_exp(mbf_t value) {
-    double x = mbf_to_double(value);
-
-    /* Check for overflow */
-    if (x > 88.0) {
-        mbf_set_error(MBF_OVERFLOW);
-        return MBF_ZERO;
-    }
-
-    double result = exp(x);
-    return mbf_from_double(result);
+    return mbf_exp(value);
 }
 
 /*
@@ -125,46 +99,35 @@ mbf_t fn_log(mbf_t value) {
         mbf_set_error(MBF_DOMAIN);
         return MBF_ZERO;
     }
-
-    double x = mbf_to_double(value);
-    double result = log(x);
-    return mbf_from_double(result);
+    return mbf_log(value);
 }
 
 /*
  * SIN function - sine (radians).
  */
 mbf_t fn_sin(mbf_t value) {
-    double x = mbf_to_double(value);
-    double result = sin(x);
-    return mbf_from_double(result);
+    return mbf_sin(value);
 }
 
 /*
  * COS function - cosine (radians).
  */
 mbf_t fn_cos(mbf_t value) {
-    double x = mbf_to_double(value);
-    double result = cos(x);
-    return mbf_from_double(result);
+    return mbf_cos(value);
 }
 
 /*
  * TAN function - tangent (radians).
  */
 mbf_t fn_tan(mbf_t value) {
-    double x = mbf_to_double(value);
-    double result = tan(x);
-    return mbf_from_double(result);
+    return mbf_tan(value);
 }
 
 /*
  * ATN function - arctangent (returns radians).
  */
 mbf_t fn_atn(mbf_t value) {
-    double x = mbf_to_double(value);
-    double result = atan(x);
-    return mbf_from_double(result);
+    return mbf_atn(value);
 }
 
 /*
@@ -227,47 +190,53 @@ mbf_t fn_inp(basic_state_t *state, mbf_t port) {
 
 /*
  * Helper to convert MBF to IEEE double.
+ *
+ * Both formats store a sign, a biased exponent and the fraction below an
+ * implicit leading 1, so the double is assembled directly from the bits
+ * (always exact: MBF has fewer mantissa bits and a narrower exponent).
  */
 double mbf_to_double(mbf_t a) {
     if (mbf_is_zero(a)) return 0.0;
 
-    bool negative = mbf_is_negative(a);
-    uint32_t mantissa = mbf_get_mantissa24(a);
-    int exponent = a.bytes.exponent - MBF_BIAS;
-
-    /* Mantissa has implicit 1 at bit 23, so it represents 1.xxxxx... */
-    /* Convert to double: value = mantissa * 2^(exponent - 23) */
-    double result = (double)mantissa * pow(2.0, (double)(exponent - 23));
+    /* MBF 1.0 has exponent 129, IEEE 1.0 has 1023 */
+    uint64_t bits = (uint64_t)(a.bytes.exponent + 1023 - MBF_BIAS) << 52;
+    bits |= (uint64_t)(a.raw & 0x7FFFFF) << 29;
+    if (mbf_is_negative(a)) bits |= (uint64_t)1 << 63;
 
-    return negative ? -result : result;
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
 }
 
 /*
  * Helper to convert IEEE double to MBF.
+ *
+ * The 52-bit fraction is rounded to 23 bits, half away from zero, and the
+ * exponent rebiased. Values too large for MBF (and infinities or NaNs) set
+ * MBF_OVERFLOW and give zero; values too small underflow to zero.
  */
 mbf_t mbf_from_double(double x) {
-    if (x == 0.0) return MBF_ZERO;
-
-    bool negative = (x < 0);
-    if (negative) x = -x;
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
 
-    /* Get exponent and mantissa */
-    int exp;
-    double mant = frexp(x, &exp);  /* x = mant * 2^exp, 0.5 <= mant < 1 */
-
-    /* Adjust to MBF format: mantissa with bit 23 set */
-    mant *= 2.0;   /* Now 1.0 <= mant < 2.0 */
-    exp--;
+    bool negative = (bits >> 63) != 0;
+    int exp = (int)((bits >> 52) & 0x7FF);
+    if (exp == 0x7FF) {
+        mbf_set_error(MBF_OVERFLOW);
+        return MBF_ZERO;
+    }
+    if (exp == 0) return MBF_ZERO;  /* Zero or far below MBF range */
 
-    /* Convert to 24-bit integer mantissa with rounding */
-    uint32_t mantissa = (uint32_t)(mant * (double)(1 << 23) + 0.5);
+    /* 1.f as a 53-bit integer, rounded to 24 bits */
+    uint64_t fraction = (bits & (((uint64_t)1 << 52) - 1)) | ((uint64_t)1 << 52);
+    uint32_t mantissa = (uint32_t)((fraction + ((uint64_t)1 << 28)) >> 29);
+    int mbf_exp = exp - 1023 + MBF_BIAS;
     if (mantissa >= (1u << 24)) {
         mantissa >>= 1;
-        exp++;
+        mbf_exp++;
     }
 
     /* Check for overflow/underflow */
-    int mbf_exp = exp + MBF_BIAS;
     if (mbf_exp > 255) {
         mbf_set_error(MBF_OVERFLOW);
         return MBF_ZERO;
@@ -23,6 +23,8 @@
  *
  * ## String Search
  * - INSTR([start,] main$, search$) - Find substring, returns 1-based position
+ *   (only parsed when basic_config_t.enable_instr is set; 8K BASIC has no
+ *   INSTR, and a program may use INSTR as a variable name)
  *
  * ## String/Number Conversion
  * - STR$(n) - Convert number to string (with leading space for positive)
@@ -176,18 +178,17 @@ mbf_t fn_instr(basic_state_t *state, int start,
         return MBF_ZERO;
     }
 
-    /* Search for substring */
-    for (int i = idx; i <= main_str.length - search_str.length; i++) {
-        bool match = true;
-        for (int j = 0; j < search_str.length; j++) {
-            if (main_data[i + j] != search_data[j]) {
-                match = false;
-                break;
-            }
-        }
-        if (match) {
-            return mbf_from_int16((int16_t)(i + 1));  /* 1-based */
+    /* Candidates from memchr() on the first byte, confirmed by memcmp() */
+    const char *end = main_data + main_str.length;
+    const char *p = main_data + idx;
+    size_t n = search_str.length;
+    while ((size_t)(end - p) >= n) {
+        p = memchr(p, search_data[0], (size_t)(end - p) - n + 1);
+        if (!p) break;
+        if (memcmp(p + 1, search_data + 1, n - 1) == 0) {
+            return mbf_from_int16((int16_t)(p - main_data + 1));  /* 1-based */
         }
+        p++;
     }
 
     return MBF_ZERO;  /* Not found */
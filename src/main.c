@@ -20,6 +20,9 @@
  *   basic8k -m 32768 game.bas  # Run with 32KB memory
  *   basic8k -w 80 program.bas  # Set 80-column terminal width
  *   basic8k -n program.bas     # Load without running (for debugging)
+ *   basic8k -j program.bas     # Compile hot lines to native code
+ *   basic8k -x matrix.bas      # Accept extended MAT statements
+ *   basic8k -i words.bas       # Accept the INSTR function
  * ```
  *
  * ## Command Line Options
@@ -27,6 +30,10 @@
  * - `-m SIZE` : Set memory size in bytes (default: 65536)
  * - `-w WIDTH` : Set terminal width in columns (default: 72)
  * - `-n` : Load file but don't run (just enter interactive mode)
+ * - `-j` : Enable the hot-line JIT (x86-64 only, off by default)
+ * - `-s` : After running a file, print DEF FN memo statistics to stderr
+ * - `-x` : Accept the extended MAT statements (off by default)
+ * - `-i` : Accept INSTR([start,] a$, b$) (off by default)
  * - `-h` : Show help
  *
  * ## Startup Sequence
@@ -68,6 +75,10 @@ static void print_usage(const char *program) {
     fprintf(stderr, "\nOptions:\n");
     fprintf(stderr, "  -m SIZE    Set memory size in bytes (default: 65536)\n");
     fprintf(stderr, "  -w WIDTH   Set terminal width (default: 72)\n");
+    fprintf(stderr, "  -j         Compile hot lines to native code (x86-64)\n");
+    fprintf(stderr, "  -s         Print DEF FN cache statistics after running\n");
+    fprintf(stderr, "  -x         Accept extended MAT statements\n");
+    fprintf(stderr, "  -i         Accept the INSTR function\n");
     fprintf(stderr, "  -h         Show this help\n");
     fprintf(stderr, "\nExamples:\n");
     fprintf(stderr, "  %s                    Start interactive interpreter\n", program);
@@ -75,6 +86,18 @@ static void print_usage(const char *program) {
     fprintf(stderr, "  %s -m 32768 game.bas  Run with 32KB memory\n", program);
 }
 
+/* Hit rates of the memoized (pure) user functions */
+static void print_fn_stats(const basic_state_t *state) {
+    for (int i = 0; i < 26; i++) {
+        uint32_t hits, misses;
+        if (!stmt_fn_memo_stats(state, i, &hits, &misses)) continue;
+        uint32_t calls = hits + misses;
+        fprintf(stderr, "FN%c: %u calls, %u hits (%.1f%%)\n", 'A' + i,
+                (unsigned)calls, (unsigned)hits,
+                calls ? 100.0 * hits / calls : 0.0);
+    }
+}
+
 int main(int argc, char *argv[]) {
     basic_config_t config = {
         .memory_size = BASIC8K_DEFAULT_MEMORY,
@@ -86,6 +109,7 @@ int main(int argc, char *argv[]) {
 
     const char *load_file = NULL;
     bool run_after_load = true;
+    bool show_stats = false;
 
     /* Parse command line arguments */
     for (int i = 1; i < argc; i++) {
@@ -104,6 +128,22 @@ int main(int argc, char *argv[]) {
                 case 'n':
                     run_after_load = false;
                     break;
+                case 'j':
+                    if (jit_available()) {
+                        config.enable_jit = true;
+                    } else {
+                        fprintf(stderr, "Warning: JIT not available on this platform\n");
+                    }
+                    break;
+                case 's':
+                    show_stats = true;
+                    break;
+                case 'x':
+                    config.enable_mat = true;
+                    break;
+                case 'i':
+                    config.enable_instr = true;
+                    break;
                 case 'h':
                     print_usage(argv[0]);
                     return 0;
@@ -142,6 +182,7 @@ int main(int argc, char *argv[]) {
                 basic_print_error(state, err, 0xFFFF);
             }
             basic_print_ok(state);
+            if (show_stats) print_fn_stats(state);
             /* Exit after running file - don't enter interactive mode */
             basic_free(state);
             return 0;
@@ -93,57 +93,10 @@ void mbf_set_error(mbf_error_t err) {
  * MANTISSA ACCESS
  *
  * The mantissa is stored in 3 bytes with an implicit leading 1 bit.
- * These functions provide convenient access to the full 24-bit mantissa.
+ * mbf_get_mantissa24() and mbf_make() are inline in mbf.h; normalization
+ * lives here.
  *============================================================================*/
 
-/**
- * @brief Get the 24-bit mantissa with implicit leading 1 bit
- *
- * Reconstructs the full mantissa from the stored bytes and adds
- * the implicit leading 1 bit (bit 23).
- *
- * For zero values (exponent = 0), returns 0.
- *
- * @param a MBF value
- * @return 24-bit mantissa with bit 23 set (0x800000 to 0xFFFFFF)
- */
-uint32_t mbf_get_mantissa24(mbf_t a) {
-    if (a.bytes.exponent == 0) {
-        return 0;  /* Zero */
-    }
-    /* Mantissa with implicit 1 bit set and sign bit cleared */
-    uint32_t m = ((uint32_t)(a.bytes.mantissa_hi | 0x80) << 16) |
-                 ((uint32_t)a.bytes.mantissa_mid << 8) |
-                 (uint32_t)a.bytes.mantissa_lo;
-    /* Clear the sign bit position (bit 23 becomes implicit 1) */
-    return m | 0x800000;
-}
-
-/*
- * Create an MBF number from components.
- * mantissa24 should have bit 23 set (the implicit 1).
- */
-mbf_t mbf_make(bool negative, uint8_t exponent, uint32_t mantissa24) {
-    mbf_t result;
-
-    if (exponent == 0) {
-        /* Zero */
-        result.raw = 0;
-        return result;
-    }
-
-    result.bytes.exponent = exponent;
-    result.bytes.mantissa_lo = (uint8_t)(mantissa24 & 0xFF);
-    result.bytes.mantissa_mid = (uint8_t)((mantissa24 >> 8) & 0xFF);
-    /* High byte: bits 16-22 of mantissa, bit 7 = sign */
-    result.bytes.mantissa_hi = (uint8_t)((mantissa24 >> 16) & 0x7F);
-    if (negative) {
-        result.bytes.mantissa_hi |= 0x80;
-    }
-
-    return result;
-}
-
 /*
  * Normalize a number - shift mantissa left until MSB is 1, adjust exponent.
  * This matches the 'normal' routine in 8kbas_src.mac (lines 3339-3365).
@@ -180,30 +133,6 @@ mbf_t mbf_normalize(mbf_t a) {
  * SIGN OPERATIONS
  *============================================================================*/
 
-/**
- * @brief Negate an MBF number
- *
- * Flips the sign bit. Zero remains zero (sign of zero is undefined).
- *
- * @param a Value to negate
- * @return -a
- */
-mbf_t mbf_neg(mbf_t a) {
-    if (mbf_is_zero(a)) {
-        return a;  /* -0 = 0 */
-    }
-    a.bytes.mantissa_hi ^= 0x80;  /* Flip sign bit */
-    return a;
-}
-
-/*
- * Absolute value.
- */
-mbf_t mbf_abs(mbf_t a) {
-    a.bytes.mantissa_hi &= 0x7F;  /* Clear sign bit */
-    return a;
-}
-
 /*
  * Return sign: -1 (negative), 0 (zero), or 1 (positive).
  * This matches the RST 5 (FTestSign) in the original.
@@ -225,46 +154,18 @@ int mbf_sign(mbf_t a) {
  *
  * Three-way comparison like strcmp().
  *
- * Algorithm:
- * 1. Compare signs (negative < zero < positive)
- * 2. If same sign, compare exponents
- * 3. If same exponent, compare mantissas
+ * Negative < zero < positive; for the same sign the exponent and then
+ * the mantissa decide. mbf_order_key() encodes exactly that order, so
+ * this is a single signed compare with no branches on sign or exponent.
  *
  * @param a First value
  * @param b Second value
  * @return -1 if a < b, 0 if a == b, 1 if a > b
  */
 int mbf_cmp(mbf_t a, mbf_t b) {
-    int sign_a = mbf_sign(a);
-    int sign_b = mbf_sign(b);
-
-    /* Handle sign differences */
-    if (sign_a != sign_b) {
-        return (sign_a > sign_b) ? 1 : -1;
-    }
-
-    /* Both zero */
-    if (sign_a == 0) {
-        return 0;
-    }
-
-    /* Same sign - compare magnitudes */
-    /* First compare exponents */
-    if (a.bytes.exponent != b.bytes.exponent) {
-        int exp_cmp = (a.bytes.exponent > b.bytes.exponent) ? 1 : -1;
-        return (sign_a > 0) ? exp_cmp : -exp_cmp;
-    }
-
-    /* Same exponent - compare mantissas (ignoring sign bit) */
-    uint32_t mant_a = mbf_get_mantissa24(a);
-    uint32_t mant_b = mbf_get_mantissa24(b);
-
-    if (mant_a == mant_b) {
-        return 0;
-    }
-
-    int mant_cmp = (mant_a > mant_b) ? 1 : -1;
-    return (sign_a > 0) ? mant_cmp : -mant_cmp;
+    int32_t ka = mbf_order_key(a);
+    int32_t kb = mbf_order_key(b);
+    return (ka > kb) - (ka < kb);
 }
 
 
@@ -333,8 +234,12 @@ mbf_t mbf_from_int32(int32_t n) {
     bool negative = (n < 0);
     uint32_t value = negative ? (uint32_t)(-n) : (uint32_t)n;
 
-    /* Find the highest bit */
+    /* Find the highest bit, a byte at a time while that is safe */
     uint8_t exponent = MBF_BIAS + 31;
+    while ((value & 0xFF000000) == 0 && exponent > MBF_BIAS + 7) {
+        value <<= 8;
+        exponent -= 8;
+    }
     while ((value & 0x80000000) == 0 && exponent > MBF_BIAS) {
         value <<= 1;
         exponent--;
@@ -24,9 +24,11 @@
  *
  * ### Addition
  * 1. Handle zero cases (a+0 = a, 0+b = b)
- * 2. Align mantissas by shifting the smaller value right
+ * 2. Align mantissas by shifting the smaller value right, keeping the
+ *    8 bits shifted out in a rounding byte
  * 3. Add or subtract mantissas based on signs
- * 4. Normalize the result
+ * 4. Normalize the result, then round up if bit 7 of the rounding
+ *    byte is set
  *
  * ### Multiplication
  * 1. Handle zero cases (a*0 = 0, 0*b = 0)
@@ -40,7 +42,7 @@
  * 1. Check for division by zero
  * 2. Handle zero dividend
  * 3. Subtract exponents, add bias once
- * 4. Divide mantissas
+ * 4. Divide mantissas to 25 bits; the last one rounds
  * 5. XOR signs for result sign
  * 6. Normalize
  *
@@ -99,55 +101,64 @@ mbf_t mbf_add(mbf_t a, mbf_t b) {
         return mbf_make(neg_a, exp_a, mant_a);
     }
 
-    /* Use 32-bit math for the addition with room for carry */
-    uint32_t aligned_b = mant_b >> exp_diff;
+    /*
+     * Work in 32 bits: the 24-bit mantissa above the 8080's rounding
+     * byte. Aligning b shifts its next 8 bits into that byte; bits below
+     * those are lost, as on the 8080.
+     */
+    uint32_t aligned_b = (uint32_t)(((uint64_t)mant_b << 8) >> exp_diff);
+    uint32_t sum = mant_a << 8;
 
-    uint32_t result_mant;
     bool result_neg;
-    uint8_t result_exp = exp_a;
+    int result_exp = exp_a;
 
     if (neg_a == neg_b) {
-        /* Same sign: add magnitudes */
-        result_mant = mant_a + aligned_b;
         result_neg = neg_a;
-
-        /* Handle carry (overflow of 24-bit mantissa) */
-        if (result_mant & 0x1000000) {
-            result_mant >>= 1;
+        uint64_t wide = (uint64_t)sum + aligned_b;
+        if (wide >> 32) {
+            /* Carry out: shift right, the low bit of the rounding byte drops */
+            wide >>= 1;
             result_exp++;
-            if (result_exp == 0) {
-                /* Overflow */
-                mbf_set_error(MBF_OVERFLOW);
-                return mbf_make(result_neg, 0xFF, 0xFFFFFF);
-            }
         }
+        sum = (uint32_t)wide;
     } else {
-        /* Different signs: subtract smaller from larger */
-        if (mant_a >= aligned_b) {
-            result_mant = mant_a - aligned_b;
+        if (sum >= aligned_b) {
+            sum -= aligned_b;
             result_neg = neg_a;
         } else {
-            result_mant = aligned_b - mant_a;
+            sum = aligned_b - sum;
             result_neg = neg_b;
         }
-
-        /* Result might be zero */
-        if (result_mant == 0) {
+        if (sum == 0) {
             return MBF_ZERO;
         }
 
-        /* Normalize: shift left until MSB is 1 */
-        while ((result_mant & 0x800000) == 0) {
-            result_mant <<= 1;
+        /* Normalize: shift left (rounding byte included) until MSB is 1 */
+        while (!(sum & 0x80000000u)) {
+            sum <<= 1;
             result_exp--;
-            if (result_exp == 0) {
-                /* Underflow to zero */
-                return MBF_ZERO;
-            }
         }
+        if (result_exp < 1) {
+            /* Underflow to zero */
+            return MBF_ZERO;
+        }
+    }
+
+    /* Round up on bit 7 of the rounding byte, carrying into the exponent */
+    uint32_t result_mant = sum >> 8;
+    if (sum & 0x80) {
+        result_mant++;
+        if (result_mant & 0x1000000) {
+            result_mant >>= 1;
+            result_exp++;
+        }
+    }
+    if (result_exp > MBF_MAX_EXP) {
+        mbf_set_error(MBF_OVERFLOW);
+        return mbf_make(result_neg, 0xFF, 0xFFFFFF);
     }
 
-    return mbf_make(result_neg, result_exp, result_mant);
+    return mbf_make(result_neg, (uint8_t)result_exp, result_mant);
 }
 
 
@@ -192,6 +203,10 @@ mbf_t mbf_sub(mbf_t a, mbf_t b) {
  * The key is that RAR rotates THROUGH the carry flag, so the carry from
  * the addition becomes the new MSB after shifting.
  *
+ * The result of that loop is computed here in closed form from one
+ * 64-bit product; tests/unit/test_mbf.c keeps the register-level
+ * simulation and checks the two agree.
+ *
  * @param a First operand (FAC - the value being multiplied)
  * @param b Second operand (multiplicand from memory)
  * @return Product a * b
@@ -234,169 +249,32 @@ mbf_t mbf_mul(mbf_t a, mbf_t b) {
     }
 
     /*
-     * Get mantissas with implicit bit.
-     * 'a' is the FAC (multiplier) - we process its bits one by one.
-     * 'b' is the multiplicand - we add it when FAC bits are 1.
-     */
-    uint32_t fac_mant = mbf_get_mantissa24(a);
-    uint32_t mult_mant = mbf_get_mantissa24(b);
-
-    /*
-     * 8080 register simulation:
-     *   C = product_hi (8 bits)
-     *   H = product_mid (8 bits)
-     *   L = product_lo (8 bits)
-     *   B = rounding byte (8 bits)
-     *   carry = carry flag (1 bit)
-     *
-     * Multiplicand is in DE with high byte stored separately:
-     *   mult_lo = mult_mant & 0xFF
-     *   mult_mid = (mult_mant >> 8) & 0xFF
-     *   mult_hi = (mult_mant >> 16) & 0xFF
-     */
-    uint8_t C = 0, H = 0, L = 0, B = 0;
-    uint8_t carry = 0;
-
-    uint8_t mult_lo = mult_mant & 0xFF;
-    uint8_t mult_mid = (mult_mant >> 8) & 0xFF;
-    uint8_t mult_hi = (mult_mant >> 16) & 0xFF;
-
-    /* FAC mantissa bytes (processed lo, mid, hi) */
-    uint8_t fac_bytes[3] = {
-        (uint8_t)(fac_mant & 0xFF),
-        (uint8_t)((fac_mant >> 8) & 0xFF),
-        (uint8_t)((fac_mant >> 16) & 0xFF)
-    };
-
-    for (int byte_idx = 0; byte_idx < 3; byte_idx++) {
-        uint8_t fac_byte = fac_bytes[byte_idx];
-
-        if (fac_byte == 0) {
-            /*
-             * fmult3: Shift product right by 8 (optimization)
-             * mov b,e; mov e,d; mov d,c; mov c,a (where a=0)
-             */
-            B = L;
-            L = H;
-            H = C;
-            C = 0;
-        } else {
-            /*
-             * fmult4 loop: Process 8 bits of FAC byte
-             *
-             * IMPORTANT: The 8080's 'ora a' instruction (which tests if
-             * the byte is zero) also CLEARS the carry flag! We must do
-             * the same before entering the bit loop.
-             */
-            carry = 0;  /* ora a clears carry */
-            for (int bit = 0; bit < 8; bit++) {
-                /*
-                 * RAR: Rotate A right through carry
-                 * New carry = bit 0 of A
-                 * Bit 7 of A = old carry
-                 */
-                uint8_t new_carry = fac_byte & 1;
-                fac_byte = (uint8_t)((fac_byte >> 1) | (carry << 7));
-                carry = new_carry;
-
-                if (carry) {
-                    /*
-                     * Add multiplicand to C,H,L:
-                     * dad d: HL = HL + DE (add mult_lo/mid to H/L)
-                     * aci 0: C = C + 0 + carry
-                     */
-                    uint16_t hl = (uint16_t)(((uint16_t)H << 8) | L);
-                    uint16_t de = (uint16_t)(((uint16_t)mult_mid << 8) | mult_lo);
-                    uint32_t sum = hl + de;
-                    L = sum & 0xFF;
-                    H = (sum >> 8) & 0xFF;
-                    carry = (sum >> 16) & 1;
-
-                    /* aci 00H: C = C + carry + mult_hi */
-                    uint16_t c_sum = (uint16_t)C + (uint16_t)mult_hi + carry;
-                    C = c_sum & 0xFF;
-                    carry = (c_sum >> 8) & 1;
-                }
-
-                /*
-                 * RAR through C, H, L, B:
-                 * Each RAR rotates right through carry
-                 */
-                uint8_t new_c_carry = C & 1;
-                C = (uint8_t)((C >> 1) | (carry << 7));
-                carry = new_c_carry;
-
-                uint8_t new_h_carry = H & 1;
-                H = (uint8_t)((H >> 1) | (carry << 7));
-                carry = new_h_carry;
-
-                uint8_t new_l_carry = L & 1;
-                L = (uint8_t)((L >> 1) | (carry << 7));
-                carry = new_l_carry;
-
-                uint8_t new_b_carry = B & 1;
-                B = (uint8_t)((B >> 1) | (carry << 7));
-                carry = new_b_carry;
-            }
-        }
-    }
-
-    /*
-     * After multiplication:
-     *   C,H,L = 24-bit mantissa result
-     *   B = rounding byte (extended precision)
-     *
-     * The 8080's 'normal' function includes B in the shift loop:
-     *   - L = B (rounding byte), H = original L (low product byte)
-     *   - Shift C,D,H,L together, so B's bits flow into the product
-     *   - After shifting, round based on the new extended precision bits
-     */
-
-    /*
-     * 8080-style normalization with extended precision byte.
-     * We shift the full 32 bits (C << 24 | H << 16 | L << 8 | B).
-     * After each shift, B's bits flow into L, L's into H, etc.
+     * The 8080 loop adds the multiplicand (or nothing) into C,H,L and
+     * shifts C,H,L,B right once per FAC bit, dropping B's low bit. The
+     * nested truncating halvings equal one truncating division, so after
+     * 24 steps the register holds the top 32 bits of the 48-bit product:
+     * C,H,L the mantissa and B the rounding byte. (The byte-at-a-time
+     * shift for a zero FAC byte is the same eight steps adding nothing.)
      */
-    while ((C & 0x80) == 0 && (C != 0 || H != 0 || L != 0) && result_exp > 0) {
-        /* Shift C,H,L,B left together */
-        uint8_t shift_carry = (B >> 7) & 1;
-        B = (uint8_t)(B << 1);
-
-        uint8_t next_carry = (L >> 7) & 1;
-        L = (uint8_t)((L << 1) | shift_carry);
-        shift_carry = next_carry;
-
-        next_carry = (H >> 7) & 1;
-        H = (uint8_t)((H << 1) | shift_carry);
-        shift_carry = next_carry;
-
-        C = (uint8_t)((C << 1) | shift_carry);
+    uint64_t product = (uint64_t)mbf_get_mantissa24(a) * mbf_get_mantissa24(b);
+    uint32_t reg = (uint32_t)(product >> 16);
 
+    /* Normalize: the product of two normalized mantissas needs at most one shift */
+    if (!(reg & 0x80000000u)) {
+        reg <<= 1;
         result_exp--;
     }
 
-    /*
-     * Rounding: The 8080 tests bit 7 of B (the extended precision byte)
-     * after the shift loop completes. Since we simulated the exact shift
-     * behavior (including B), we test bit 7 of the current B value.
-     */
-    if (B & 0x80) {
-        /* rounda: increment L, propagate carry through H and C */
-        L++;
-        if (L == 0) {
-            H++;
-            if (H == 0) {
-                C++;
-                if (C == 0) {
-                    C = 0x80;
-                    result_exp++;
-                }
-            }
+    /* Rounding: bit 7 of B rounds up, carrying into the exponent */
+    uint32_t result_mant = reg >> 8;
+    if (reg & 0x80) {
+        result_mant++;
+        if (result_mant & 0x1000000) {
+            result_mant = 0x800000;
+            result_exp++;
         }
     }
 
-    uint32_t result_mant = ((uint32_t)C << 16) | ((uint32_t)H << 8) | L;
-
     if (result_exp < 1 || result_mant == 0) {
         return MBF_ZERO;
     }
@@ -451,35 +329,30 @@ mbf_t mbf_div(mbf_t a, mbf_t b) {
     uint32_t mant_b = mbf_get_mantissa24(b);
 
     /*
-     * Divide using 64-bit arithmetic for precision.
-     * Shift dividend left by 24 bits before dividing to get 24 bits of quotient.
+     * Long division as the 8080 does it: 24 quotient bits plus one more,
+     * which rounds. Shifting the dividend left by 25 gives those 25 bits
+     * (with one extra when mant_a >= mant_b, i.e. the ratio is >= 1.0).
      */
-    uint64_t dividend = (uint64_t)mant_a << 24;
+    uint64_t dividend = (uint64_t)mant_a << 25;
     uint32_t quotient = (uint32_t)(dividend / mant_b);
 
-    /*
-     * The quotient might need normalization.
-     * quotient = (mant_a / mant_b) * 2^24
-     *
-     * If mant_a >= mant_b (ratio >= 1.0): quotient >= 2^24, bit 24 is set.
-     *   Shift right to normalize, exponent stays the same.
-     *
-     * If mant_a < mant_b (ratio < 1.0): quotient < 2^24, bit 24 is clear.
-     *   Quotient has bit 23 set (since ratio > 0.5 for normalized inputs).
-     *   Decrement exponent to compensate for ratio < 1.0.
-     */
-    if (quotient & 0x1000000) {
-        /* Bit 24 set: shift right to normalize, keep exponent */
+    if (quotient & 0x2000000) {
+        /* Ratio >= 1.0: drop the extra bit, keep exponent */
         quotient >>= 1;
     } else {
-        /* Bit 24 clear: mantissa ratio < 1.0, decrement exponent */
+        /* Ratio < 1.0: decrement exponent to compensate */
         result_exp--;
     }
 
-    /* Normalize (safety net for edge cases) */
-    while ((quotient & 0x800000) == 0 && result_exp > 0) {
-        quotient <<= 1;
-        result_exp--;
+    /* Round up on the 25th bit, carrying into the exponent */
+    bool round_up = quotient & 1;
+    quotient >>= 1;
+    if (round_up) {
+        quotient++;
+        if (quotient & 0x1000000) {
+            quotient >>= 1;
+            result_exp++;
+        }
     }
 
     /* Check for overflow/underflow */
@@ -0,0 +1,647 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file mbf_batch.c
+ * @brief Batched MBF Operations over Contiguous Values
+ *
+ * mbf_add_n(), mbf_mul_n(), mbf_cmp_n() and mbf_from_int16_n() apply the
+ * scalar operation to n values at once. Each has three implementations:
+ *
+ * - scalar: a loop over mbf_add() and friends (the reference);
+ * - SSE2: four values per step;
+ * - AVX2: eight values per step.
+ *
+ * The fastest one the CPU supports is chosen on first use;
+ * mbf_batch_use() selects one explicitly (the tests run all of them).
+ *
+ * ## Exactness
+ *
+ * The vector code computes what the scalar code computes, lane by lane,
+ * with no floating point arithmetic (float conversion is only used to
+ * find the highest set bit of small integers, which it does exactly):
+ *
+ * - Addition aligns, adds or subtracts, renormalizes and rounds exactly
+ *   like mbf_add(), working on the 32-bit mantissa and rounding byte,
+ *   including returning the larger operand unchanged when the exponents
+ *   differ by more than 24.
+ * - mbf_mul() simulates the 8080 shift-and-add loop. Every step adds the
+ *   multiplicand (or nothing) to a 32-bit register and shifts it right,
+ *   dropping the low bit; nested truncating halvings equal one
+ *   truncating division, so the register ends up holding
+ *   (mant_a * mant_b) >> 16. The vector code computes that product with
+ *   32x32->64 bit multiplies and applies the same normalize and round.
+ *
+ * ## Error flags
+ *
+ * The scalar operations set MBF_OVERFLOW/MBF_UNDERFLOW as they go, each
+ * replacing the last. The batch calls leave the flag as the scalar loop
+ * would: set by the last element that reported an error, untouched if
+ * none did.
+ *
+ * ## Aliasing
+ *
+ * out may be the same array as an input (element i is read before it is
+ * written); other overlaps are not supported.
+ */
+
+#include "basic/mbf.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MBF_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+
+/*============================================================================
+ * SCALAR REFERENCE
+ *============================================================================*/
+
+static void add_scalar(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_add(a[i], b[i]);
+}
+
+static void mul_scalar(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_mul(a[i], b[i]);
+}
+
+static void cmp_scalar(int8_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = (int8_t)mbf_cmp(a[i], b[i]);
+}
+
+static void from_int16_scalar(mbf_t *out, const int16_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_from_int16(in[i]);
+}
+
+
+#ifdef MBF_BATCH_X86
+
+/*============================================================================
+ * ERROR FLAGS
+ *
+ * Kernels produce a per-lane error code (0 = none). The flag is set from
+ * the last lane with one, after all vector steps and before the scalar
+ * tail, so the order matches the scalar loop.
+ *============================================================================*/
+
+/* Last error among lanes codes[0..count) into *last */
+static void note_errors(const int32_t *codes, int count, mbf_error_t *last) {
+    for (int i = count - 1; i >= 0; i--) {
+        if (codes[i]) {
+            *last = (mbf_error_t)codes[i];
+            return;
+        }
+    }
+}
+
+
+/*============================================================================
+ * SSE2 (4 lanes)
+ *
+ * SSE2 has no per-lane shifts, so those are done in five conditional
+ * steps of 1, 2, 4, 8 and 16 bits.
+ *============================================================================*/
+
+#define SSE2 __attribute__((target("sse2")))
+
+static SSE2 __m128i sse2_select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static SSE2 __m128i sse2_k(uint32_t k) {
+    return _mm_set1_epi32((int)k);
+}
+
+/* x >> count per lane (count 0..31) */
+static SSE2 __m128i sse2_srlv(__m128i x, __m128i count) {
+    __m128i m;
+#define STEP(k) \
+    m = _mm_cmpeq_epi32(_mm_and_si128(count, sse2_k(k)), sse2_k(k)); \
+    x = sse2_select(m, _mm_srli_epi32(x, k), x)
+    STEP(1); STEP(2); STEP(4); STEP(8); STEP(16);
+#undef STEP
+    return x;
+}
+
+/* x << count per lane (count 0..31) */
+static SSE2 __m128i sse2_sllv(__m128i x, __m128i count) {
+    __m128i m;
+#define STEP(k) \
+    m = _mm_cmpeq_epi32(_mm_and_si128(count, sse2_k(k)), sse2_k(k)); \
+    x = sse2_select(m, _mm_slli_epi32(x, k), x)
+    STEP(1); STEP(2); STEP(4); STEP(8); STEP(16);
+#undef STEP
+    return x;
+}
+
+/* Index of the highest set bit of x (1 <= x < 2^24) */
+static SSE2 __m128i sse2_log2(__m128i x) {
+    __m128i bits = _mm_castps_si128(_mm_cvtepi32_ps(x));
+    return _mm_sub_epi32(_mm_srli_epi32(bits, 23), sse2_k(127));
+}
+
+/* Raw MBF from sign bit (bit 23), exponent and 24-bit mantissa */
+static SSE2 __m128i sse2_make(__m128i sign, __m128i exp, __m128i mant) {
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(exp, 24), sign),
+                        _mm_and_si128(mant, sse2_k(0x7FFFFF)));
+}
+
+static SSE2 __m128i sse2_mantissa(__m128i v) {
+    return _mm_or_si128(_mm_and_si128(v, sse2_k(0x7FFFFF)), sse2_k(0x800000));
+}
+
+static SSE2 __m128i sse2_add(__m128i va, __m128i vb, __m128i *err) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i za = _mm_cmpeq_epi32(_mm_srli_epi32(va, 24), zero);
+    __m128i zb = _mm_cmpeq_epi32(_mm_srli_epi32(vb, 24), zero);
+
+    /* hi has the larger exponent (a on ties) */
+    __m128i swap = _mm_cmpgt_epi32(_mm_srli_epi32(vb, 24), _mm_srli_epi32(va, 24));
+    __m128i hi = sse2_select(swap, vb, va);
+    __m128i lo = sse2_select(swap, va, vb);
+    __m128i e1 = _mm_srli_epi32(hi, 24);
+    __m128i m1 = sse2_mantissa(hi), m2 = sse2_mantissa(lo);
+    __m128i s1 = _mm_and_si128(hi, sse2_k(0x800000));
+    __m128i s2 = _mm_and_si128(lo, sse2_k(0x800000));
+
+    /* Aligned mantissa and its rounding byte */
+    __m128i d = _mm_sub_epi32(e1, _mm_srli_epi32(lo, 24));
+    __m128i far = _mm_cmpgt_epi32(d, sse2_k(24));
+    __m128i al = sse2_srlv(m2, d);
+    __m128i rb = _mm_and_si128(sse2_srlv(_mm_slli_epi32(m2, 8), d), sse2_k(0xFF));
+    __m128i same = _mm_cmpeq_epi32(s1, s2);
+
+    /* Same signs: add, shift the carry back in through the rounding byte */
+    __m128i sum = _mm_add_epi32(m1, al);
+    __m128i carry = _mm_cmpgt_epi32(sum, sse2_k(0xFFFFFF));
+    __m128i rc = _mm_or_si128(_mm_srli_epi32(rb, 1),
+                              _mm_slli_epi32(_mm_and_si128(sum, sse2_k(1)), 7));
+    __m128i x_same = _mm_or_si128(_mm_slli_epi32(sse2_select(carry, _mm_srli_epi32(sum, 1), sum), 8),
+                                  sse2_select(carry, rc, rb));
+    __m128i e_same = _mm_sub_epi32(e1, carry);
+
+    /* Different signs: subtract 32-bit values, renormalize, flush to zero */
+    __m128i big = _mm_slli_epi32(m1, 8);
+    __m128i small = _mm_or_si128(_mm_slli_epi32(al, 8), rb);
+    __m128i lt = _mm_or_si128(_mm_cmpgt_epi32(al, m1),
+                              _mm_andnot_si128(_mm_cmpeq_epi32(rb, zero), _mm_cmpeq_epi32(al, m1)));
+    __m128i r = sse2_select(lt, _mm_sub_epi32(small, big), _mm_sub_epi32(big, small));
+    __m128i sr = sse2_select(lt, s2, s1);
+    __m128i top = _mm_srli_epi32(r, 8);
+    __m128i lg = sse2_select(_mm_cmpeq_epi32(top, zero), sse2_log2(_mm_and_si128(r, sse2_k(0xFF))),
+                             _mm_add_epi32(sse2_log2(top), sse2_k(8)));
+    __m128i lz = _mm_sub_epi32(sse2_k(31), lg);
+    __m128i gone = _mm_andnot_si128(same, _mm_or_si128(_mm_cmpeq_epi32(r, zero),
+                                    _mm_cmpgt_epi32(_mm_add_epi32(lz, sse2_k(1)), e1)));
+
+    /* Round on bit 7 of the rounding byte, carrying into the exponent */
+    __m128i x = sse2_select(same, x_same, sse2_sllv(r, lz));
+    __m128i e = sse2_select(same, e_same, _mm_sub_epi32(e1, lz));
+    __m128i s = sse2_select(same, s1, sr);
+    __m128i m = _mm_add_epi32(_mm_srli_epi32(x, 8), _mm_and_si128(_mm_srli_epi32(x, 7), sse2_k(1)));
+    __m128i wrap = _mm_cmpeq_epi32(m, sse2_k(0x1000000));
+    m = sse2_select(wrap, sse2_k(0x800000), m);
+    e = _mm_sub_epi32(e, wrap);
+    __m128i ovf = _mm_andnot_si128(gone, _mm_cmpgt_epi32(e, sse2_k(255)));
+
+    __m128i res = sse2_select(ovf, _mm_or_si128(sse2_k(0xFF7FFFFF), s), sse2_make(s, e, m));
+    res = _mm_andnot_si128(gone, res);
+    res = sse2_select(far, hi, res);
+    res = sse2_select(zb, va, res);
+    res = sse2_select(za, vb, res);
+
+    __m128i live = _mm_andnot_si128(_mm_or_si128(_mm_or_si128(za, zb), far), ovf);
+    *err = _mm_and_si128(live, sse2_k(MBF_OVERFLOW));
+    return res;
+}
+
+/* (ma * mb) >> 16 per lane */
+static SSE2 __m128i sse2_mul_hi(__m128i ma, __m128i mb) {
+    __m128i even = _mm_srli_epi64(_mm_mul_epu32(ma, mb), 16);
+    __m128i odd = _mm_slli_epi64(_mm_mul_epu32(_mm_srli_epi64(ma, 32),
+                                               _mm_srli_epi64(mb, 32)), 16);
+    __m128i lo32 = _mm_set_epi32(0, -1, 0, -1);
+    return _mm_or_si128(_mm_and_si128(even, lo32), _mm_andnot_si128(lo32, odd));
+}
+
+static SSE2 __m128i sse2_mul(__m128i va, __m128i vb, __m128i *err) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i ea = _mm_srli_epi32(va, 24), eb = _mm_srli_epi32(vb, 24);
+    __m128i z = _mm_or_si128(_mm_cmpeq_epi32(ea, zero), _mm_cmpeq_epi32(eb, zero));
+    __m128i s = _mm_and_si128(_mm_xor_si128(va, vb), sse2_k(0x800000));
+    __m128i maxed = _mm_or_si128(sse2_k(0xFF7FFFFF), s);
+
+    __m128i e = _mm_sub_epi32(_mm_add_epi32(ea, eb), sse2_k(128));
+    __m128i ovf1 = _mm_cmpgt_epi32(e, sse2_k(255));
+    __m128i unf1 = _mm_cmpgt_epi32(sse2_k(1), e);
+
+    /* Product register; bit 30 or 31 is its top bit */
+    __m128i r = sse2_mul_hi(sse2_mantissa(va), sse2_mantissa(vb));
+    __m128i shift = _mm_cmpeq_epi32(_mm_srai_epi32(r, 31), zero);
+    r = sse2_select(shift, _mm_slli_epi32(r, 1), r);
+    e = _mm_add_epi32(e, shift);
+
+    /* Round on bit 7, carrying into the exponent */
+    __m128i round = _mm_srli_epi32(_mm_and_si128(r, sse2_k(0x80)), 7);
+    __m128i m = _mm_add_epi32(_mm_srli_epi32(r, 8), round);
+    __m128i wrap = _mm_cmpeq_epi32(m, sse2_k(0x1000000));
+    m = sse2_select(wrap, sse2_k(0x800000), m);
+    e = _mm_sub_epi32(e, wrap);
+
+    __m128i ovf2 = _mm_cmpgt_epi32(e, sse2_k(255));
+    __m128i unf2 = _mm_cmpgt_epi32(sse2_k(1), e);
+    __m128i res = sse2_select(ovf2, maxed, _mm_andnot_si128(unf2, sse2_make(s, e, m)));
+    res = sse2_select(ovf1, maxed, _mm_andnot_si128(unf1, res));
+    res = _mm_andnot_si128(z, res);
+
+    __m128i ovf = _mm_or_si128(ovf1, _mm_andnot_si128(unf1, ovf2));
+    *err = _mm_andnot_si128(z, _mm_or_si128(_mm_and_si128(ovf, sse2_k(MBF_OVERFLOW)),
+                                            _mm_and_si128(unf1, sse2_k(MBF_UNDERFLOW))));
+    return res;
+}
+
+/* Signed key ordered like mbf_cmp() */
+static SSE2 __m128i sse2_key(__m128i v) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i e = _mm_srli_epi32(v, 24);
+    __m128i key = _mm_or_si128(_mm_slli_epi32(e, 23), _mm_and_si128(v, sse2_k(0x7FFFFF)));
+    __m128i neg = _mm_cmpeq_epi32(_mm_and_si128(v, sse2_k(0x800000)), sse2_k(0x800000));
+    key = sse2_select(neg, _mm_sub_epi32(zero, key), key);
+    return _mm_andnot_si128(_mm_cmpeq_epi32(e, zero), key);
+}
+
+static SSE2 __m128i sse2_from_int16(__m128i n) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i neg = _mm_cmpgt_epi32(zero, n);
+    __m128i v = _mm_sub_epi32(_mm_xor_si128(n, neg), neg);
+    __m128i lg = sse2_log2(v);
+    __m128i m = sse2_sllv(v, _mm_sub_epi32(sse2_k(23), lg));
+    __m128i res = sse2_make(_mm_and_si128(neg, sse2_k(0x800000)),
+                            _mm_add_epi32(lg, sse2_k(MBF_BIAS)), m);
+    return _mm_andnot_si128(_mm_cmpeq_epi32(n, zero), res);
+}
+
+static SSE2 void add_sse2(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    mbf_error_t last = MBF_OK;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i err;
+        __m128i r = sse2_add(_mm_loadu_si128((const __m128i *)(const void *)(a + i)),
+                             _mm_loadu_si128((const __m128i *)(const void *)(b + i)), &err);
+        _mm_storeu_si128((__m128i *)(void *)(out + i), r);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(err, _mm_setzero_si128())) != 0xFFFF) {
+            int32_t codes[4];
+            _mm_storeu_si128((__m128i *)(void *)codes, err);
+            note_errors(codes, 4, &last);
+        }
+    }
+    if (last != MBF_OK) mbf_set_error(last);
+    add_scalar(out + i, a + i, b + i, n - i);
+}
+
+static SSE2 void mul_sse2(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    mbf_error_t last = MBF_OK;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i err;
+        __m128i r = sse2_mul(_mm_loadu_si128((const __m128i *)(const void *)(a + i)),
+                             _mm_loadu_si128((const __m128i *)(const void *)(b + i)), &err);
+        _mm_storeu_si128((__m128i *)(void *)(out + i), r);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(err, _mm_setzero_si128())) != 0xFFFF) {
+            int32_t codes[4];
+            _mm_storeu_si128((__m128i *)(void *)codes, err);
+            note_errors(codes, 4, &last);
+        }
+    }
+    if (last != MBF_OK) mbf_set_error(last);
+    mul_scalar(out + i, a + i, b + i, n - i);
+}
+
+static SSE2 void cmp_sse2(int8_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i ka = sse2_key(_mm_loadu_si128((const __m128i *)(const void *)(a + i)));
+        __m128i kb = sse2_key(_mm_loadu_si128((const __m128i *)(const void *)(b + i)));
+        __m128i c = _mm_sub_epi32(_mm_cmpgt_epi32(kb, ka), _mm_cmpgt_epi32(ka, kb));
+        c = _mm_packs_epi16(_mm_packs_epi32(c, c), c);
+        int32_t bytes = _mm_cvtsi128_si32(c);
+        memcpy(out + i, &bytes, 4);
+    }
+    cmp_scalar(out + i, a + i, b + i, n - i);
+}
+
+static SSE2 void from_int16_sse2(mbf_t *out, const int16_t *in, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(const void *)(in + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_si128((__m128i *)(void *)(out + i), sse2_from_int16(lo));
+        _mm_storeu_si128((__m128i *)(void *)(out + i + 4), sse2_from_int16(hi));
+    }
+    from_int16_scalar(out + i, in + i, n - i);
+}
+
+#undef SSE2
+
+
+/*============================================================================
+ * AVX2 (8 lanes)
+ *
+ * The same lane algorithms with native per-lane shifts.
+ *============================================================================*/
+
+#define AVX2 __attribute__((target("avx2")))
+
+static AVX2 __m256i avx2_select(__m256i mask, __m256i a, __m256i b) {
+    return _mm256_blendv_epi8(b, a, mask);
+}
+
+static AVX2 __m256i avx2_k(uint32_t k) {
+    return _mm256_set1_epi32((int)k);
+}
+
+static AVX2 __m256i avx2_log2(__m256i x) {
+    __m256i bits = _mm256_castps_si256(_mm256_cvtepi32_ps(x));
+    return _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), avx2_k(127));
+}
+
+static AVX2 __m256i avx2_make(__m256i sign, __m256i exp, __m256i mant) {
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(exp, 24), sign),
+                           _mm256_and_si256(mant, avx2_k(0x7FFFFF)));
+}
+
+static AVX2 __m256i avx2_mantissa(__m256i v) {
+    return _mm256_or_si256(_mm256_and_si256(v, avx2_k(0x7FFFFF)), avx2_k(0x800000));
+}
+
+static AVX2 __m256i avx2_add(__m256i va, __m256i vb, __m256i *err) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i za = _mm256_cmpeq_epi32(_mm256_srli_epi32(va, 24), zero);
+    __m256i zb = _mm256_cmpeq_epi32(_mm256_srli_epi32(vb, 24), zero);
+
+    __m256i swap = _mm256_cmpgt_epi32(_mm256_srli_epi32(vb, 24), _mm256_srli_epi32(va, 24));
+    __m256i hi = avx2_select(swap, vb, va);
+    __m256i lo = avx2_select(swap, va, vb);
+    __m256i e1 = _mm256_srli_epi32(hi, 24);
+    __m256i m1 = avx2_mantissa(hi), m2 = avx2_mantissa(lo);
+    __m256i s1 = _mm256_and_si256(hi, avx2_k(0x800000));
+    __m256i s2 = _mm256_and_si256(lo, avx2_k(0x800000));
+
+    __m256i d = _mm256_sub_epi32(e1, _mm256_srli_epi32(lo, 24));
+    __m256i far = _mm256_cmpgt_epi32(d, avx2_k(24));
+    __m256i al = _mm256_srlv_epi32(m2, d);
+    __m256i rb = _mm256_and_si256(_mm256_srlv_epi32(_mm256_slli_epi32(m2, 8), d), avx2_k(0xFF));
+    __m256i same = _mm256_cmpeq_epi32(s1, s2);
+
+    __m256i sum = _mm256_add_epi32(m1, al);
+    __m256i carry = _mm256_cmpgt_epi32(sum, avx2_k(0xFFFFFF));
+    __m256i rc = _mm256_or_si256(_mm256_srli_epi32(rb, 1),
+                                 _mm256_slli_epi32(_mm256_and_si256(sum, avx2_k(1)), 7));
+    __m256i x_same = _mm256_or_si256(
+        _mm256_slli_epi32(avx2_select(carry, _mm256_srli_epi32(sum, 1), sum), 8),
+        avx2_select(carry, rc, rb));
+    __m256i e_same = _mm256_sub_epi32(e1, carry);
+
+    __m256i big = _mm256_slli_epi32(m1, 8);
+    __m256i small = _mm256_or_si256(_mm256_slli_epi32(al, 8), rb);
+    __m256i lt = _mm256_or_si256(_mm256_cmpgt_epi32(al, m1),
+                                 _mm256_andnot_si256(_mm256_cmpeq_epi32(rb, zero),
+                                                     _mm256_cmpeq_epi32(al, m1)));
+    __m256i r = avx2_select(lt, _mm256_sub_epi32(small, big), _mm256_sub_epi32(big, small));
+    __m256i sr = avx2_select(lt, s2, s1);
+    __m256i top = _mm256_srli_epi32(r, 8);
+    __m256i lg = avx2_select(_mm256_cmpeq_epi32(top, zero),
+                             avx2_log2(_mm256_and_si256(r, avx2_k(0xFF))),
+                             _mm256_add_epi32(avx2_log2(top), avx2_k(8)));
+    __m256i lz = _mm256_sub_epi32(avx2_k(31), lg);
+    __m256i gone = _mm256_andnot_si256(same, _mm256_or_si256(_mm256_cmpeq_epi32(r, zero),
+                                       _mm256_cmpgt_epi32(_mm256_add_epi32(lz, avx2_k(1)), e1)));
+
+    __m256i x = avx2_select(same, x_same, _mm256_sllv_epi32(r, lz));
+    __m256i e = avx2_select(same, e_same, _mm256_sub_epi32(e1, lz));
+    __m256i s = avx2_select(same, s1, sr);
+    __m256i m = _mm256_add_epi32(_mm256_srli_epi32(x, 8),
+                                 _mm256_and_si256(_mm256_srli_epi32(x, 7), avx2_k(1)));
+    __m256i wrap = _mm256_cmpeq_epi32(m, avx2_k(0x1000000));
+    m = avx2_select(wrap, avx2_k(0x800000), m);
+    e = _mm256_sub_epi32(e, wrap);
+    __m256i ovf = _mm256_andnot_si256(gone, _mm256_cmpgt_epi32(e, avx2_k(255)));
+
+    __m256i res = avx2_select(ovf, _mm256_or_si256(avx2_k(0xFF7FFFFF), s), avx2_make(s, e, m));
+    res = _mm256_andnot_si256(gone, res);
+    res = avx2_select(far, hi, res);
+    res = avx2_select(zb, va, res);
+    res = avx2_select(za, vb, res);
+
+    __m256i live = _mm256_andnot_si256(_mm256_or_si256(_mm256_or_si256(za, zb), far), ovf);
+    *err = _mm256_and_si256(live, avx2_k(MBF_OVERFLOW));
+    return res;
+}
+
+static AVX2 __m256i avx2_mul_hi(__m256i ma, __m256i mb) {
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(ma, mb), 16);
+    __m256i odd = _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(ma, 32),
+                                                     _mm256_srli_epi64(mb, 32)), 16);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+static AVX2 __m256i avx2_mul(__m256i va, __m256i vb, __m256i *err) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i ea = _mm256_srli_epi32(va, 24), eb = _mm256_srli_epi32(vb, 24);
+    __m256i z = _mm256_or_si256(_mm256_cmpeq_epi32(ea, zero), _mm256_cmpeq_epi32(eb, zero));
+    __m256i s = _mm256_and_si256(_mm256_xor_si256(va, vb), avx2_k(0x800000));
+    __m256i maxed = _mm256_or_si256(avx2_k(0xFF7FFFFF), s);
+
+    __m256i e = _mm256_sub_epi32(_mm256_add_epi32(ea, eb), avx2_k(128));
+    __m256i ovf1 = _mm256_cmpgt_epi32(e, avx2_k(255));
+    __m256i unf1 = _mm256_cmpgt_epi32(avx2_k(1), e);
+
+    __m256i r = avx2_mul_hi(avx2_mantissa(va), avx2_mantissa(vb));
+    __m256i shift = _mm256_cmpeq_epi32(_mm256_srai_epi32(r, 31), zero);
+    r = avx2_select(shift, _mm256_slli_epi32(r, 1), r);
+    e = _mm256_add_epi32(e, shift);
+
+    __m256i round = _mm256_srli_epi32(_mm256_and_si256(r, avx2_k(0x80)), 7);
+    __m256i m = _mm256_add_epi32(_mm256_srli_epi32(r, 8), round);
+    __m256i wrap = _mm256_cmpeq_epi32(m, avx2_k(0x1000000));
+    m = avx2_select(wrap, avx2_k(0x800000), m);
+    e = _mm256_sub_epi32(e, wrap);
+
+    __m256i ovf2 = _mm256_cmpgt_epi32(e, avx2_k(255));
+    __m256i unf2 = _mm256_cmpgt_epi32(avx2_k(1), e);
+    __m256i res = avx2_select(ovf2, maxed, _mm256_andnot_si256(unf2, avx2_make(s, e, m)));
+    res = avx2_select(ovf1, maxed, _mm256_andnot_si256(unf1, res));
+    res = _mm256_andnot_si256(z, res);
+
+    __m256i ovf = _mm256_or_si256(ovf1, _mm256_andnot_si256(unf1, ovf2));
+    *err = _mm256_andnot_si256(z, _mm256_or_si256(
+        _mm256_and_si256(ovf, avx2_k(MBF_OVERFLOW)),
+        _mm256_and_si256(unf1, avx2_k(MBF_UNDERFLOW))));
+    return res;
+}
+
+static AVX2 __m256i avx2_key(__m256i v) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i e = _mm256_srli_epi32(v, 24);
+    __m256i key = _mm256_or_si256(_mm256_slli_epi32(e, 23),
+                                  _mm256_and_si256(v, avx2_k(0x7FFFFF)));
+    __m256i neg = _mm256_cmpeq_epi32(_mm256_and_si256(v, avx2_k(0x800000)),
+                                     avx2_k(0x800000));
+    key = avx2_select(neg, _mm256_sub_epi32(zero, key), key);
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(e, zero), key);
+}
+
+static AVX2 __m256i avx2_from_int16(__m256i n) {
+    __m256i zero = _mm256_setzero_si256();
+    __m256i v = _mm256_abs_epi32(n);
+    __m256i lg = avx2_log2(v);
+    __m256i m = _mm256_sllv_epi32(v, _mm256_sub_epi32(avx2_k(23), lg));
+    __m256i sign = _mm256_and_si256(_mm256_cmpgt_epi32(zero, n), avx2_k(0x800000));
+    __m256i res = avx2_make(sign, _mm256_add_epi32(lg, avx2_k(MBF_BIAS)), m);
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(n, zero), res);
+}
+
+static AVX2 void add_avx2(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    mbf_error_t last = MBF_OK;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i err;
+        __m256i r = avx2_add(_mm256_loadu_si256((const __m256i *)(const void *)(a + i)),
+                             _mm256_loadu_si256((const __m256i *)(const void *)(b + i)), &err);
+        _mm256_storeu_si256((__m256i *)(void *)(out + i), r);
+        if (!_mm256_testz_si256(err, err)) {
+            int32_t codes[8];
+            _mm256_storeu_si256((__m256i *)(void *)codes, err);
+            note_errors(codes, 8, &last);
+        }
+    }
+    if (last != MBF_OK) mbf_set_error(last);
+    add_scalar(out + i, a + i, b + i, n - i);
+}
+
+static AVX2 void mul_avx2(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    mbf_error_t last = MBF_OK;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i err;
+        __m256i r = avx2_mul(_mm256_loadu_si256((const __m256i *)(const void *)(a + i)),
+                             _mm256_loadu_si256((const __m256i *)(const void *)(b + i)), &err);
+        _mm256_storeu_si256((__m256i *)(void *)(out + i), r);
+        if (!_mm256_testz_si256(err, err)) {
+            int32_t codes[8];
+            _mm256_storeu_si256((__m256i *)(void *)codes, err);
+            note_errors(codes, 8, &last);
+        }
+    }
+    if (last != MBF_OK) mbf_set_error(last);
+    mul_scalar(out + i, a + i, b + i, n - i);
+}
+
+static AVX2 void cmp_avx2(int8_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i ka = avx2_key(_mm256_loadu_si256((const __m256i *)(const void *)(a + i)));
+        __m256i kb = avx2_key(_mm256_loadu_si256((const __m256i *)(const void *)(b + i)));
+        __m256i c = _mm256_sub_epi32(_mm256_cmpgt_epi32(kb, ka), _mm256_cmpgt_epi32(ka, kb));
+        __m128i c16 = _mm_packs_epi32(_mm256_castsi256_si128(c),
+                                      _mm256_extracti128_si256(c, 1));
+        _mm_storel_epi64((__m128i *)(void *)(out + i), _mm_packs_epi16(c16, c16));
+    }
+    cmp_scalar(out + i, a + i, b + i, n - i);
+}
+
+static AVX2 void from_int16_avx2(mbf_t *out, const int16_t *in, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_cvtepi16_epi32(
+            _mm_loadu_si128((const __m128i *)(const void *)(in + i)));
+        _mm256_storeu_si256((__m256i *)(void *)(out + i), avx2_from_int16(v));
+    }
+    from_int16_scalar(out + i, in + i, n - i);
+}
+
+#undef AVX2
+
+#endif /* MBF_BATCH_X86 */
+
+
+/*============================================================================
+ * DISPATCH
+ *============================================================================*/
+
+/** One implementation of the batch operations */
+typedef struct {
+    void (*add)(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n);
+    void (*mul)(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n);
+    void (*cmp)(int8_t *out, const mbf_t *a, const mbf_t *b, size_t n);
+    void (*from_int16)(mbf_t *out, const int16_t *in, size_t n);
+} batch_ops_t;
+
+static const batch_ops_t batch_impls[] = {
+    [MBF_BATCH_SCALAR] = { add_scalar, mul_scalar, cmp_scalar, from_int16_scalar },
+#ifdef MBF_BATCH_X86
+    [MBF_BATCH_SSE2] = { add_sse2, mul_sse2, cmp_sse2, from_int16_sse2 },
+    [MBF_BATCH_AVX2] = { add_avx2, mul_avx2, cmp_avx2, from_int16_avx2 },
+#endif
+};
+
+static const batch_ops_t *batch_ops;
+static mbf_batch_level_t batch_level;
+
+bool mbf_batch_supported(mbf_batch_level_t level) {
+    switch (level) {
+        case MBF_BATCH_SCALAR:
+            return true;
+#ifdef MBF_BATCH_X86
+        case MBF_BATCH_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case MBF_BATCH_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+bool mbf_batch_use(mbf_batch_level_t level) {
+    if (!mbf_batch_supported(level)) return false;
+    batch_level = level;
+    batch_ops = &batch_impls[level];
+    return true;
+}
+
+/* Current implementation, picking the best one on first use */
+static const batch_ops_t *ops(void) {
+    if (!batch_ops) {
+        if (!mbf_batch_use(MBF_BATCH_AVX2) && !mbf_batch_use(MBF_BATCH_SSE2)) {
+            mbf_batch_use(MBF_BATCH_SCALAR);
+        }
+    }
+    return batch_ops;
+}
+
+mbf_batch_level_t mbf_batch_level(void) {
+    ops();
+    return batch_level;
+}
+
+void mbf_add_n(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    ops()->add(out, a, b, n);
+}
+
+void mbf_mul_n(mbf_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    ops()->mul(out, a, b, n);
+}
+
+void mbf_cmp_n(int8_t *out, const mbf_t *a, const mbf_t *b, size_t n) {
+    ops()->cmp(out, a, b, n);
+}
+
+void mbf_from_int16_n(mbf_t *out, const int16_t *in, size_t n) {
+    ops()->from_int16(out, in, n);
+}
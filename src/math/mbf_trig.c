@@ -16,36 +16,116 @@
  * - ATN(x) - Arctangent (returns radians)
  * - LOG(x) - Natural logarithm
  * - EXP(x) - e^x (exponential)
+ * - X^Y     - Exponentiation (mbf_pow)
  *
- * ## Implementation Strategy
+ * Each function also has a batched form (mbf_sin_n() etc.) applying it
+ * to n contiguous values, used for element-wise array loops.
  *
- * Currently, these use the C math library via MBF<->double conversion.
- * This is simpler but may not produce byte-for-byte identical results
- * to the original BASIC.
+ * ## Implementation Strategy
  *
- * For exact compatibility, these should be replaced with the original
- * polynomial approximations from 8kbas_src.mac:
- * - SIN/COS: Chebyshev polynomial approximation
- * - ATN: Polynomial approximation
- * - LOG: Series expansion
- * - EXP: Series expansion
+ * Each function evaluates the ROM's polynomial from 8kbas_src.mac in MBF
+ * arithmetic, one rounded mbf_add()/mbf_mul() per step, so results match
+ * the 8080 bit for bit:
+ * - SIN: odd polynomial on the argument folded to a quarter turn;
+ *   COS and TAN are built from it
+ * - ATN: odd polynomial, with the reciprocal above 1
+ * - LOG: odd series in (M-SQR(.5))/(M+SQR(.5)) plus the binary exponent
+ * - EXP: polynomial for 2^F plus the integer part added to the exponent
+ * - SQR: EXP(.5*LOG(X)), as the ROM computes X^.5
  *
  * ## Error Handling
  *
  * - SQR of negative: Returns 0, caller should generate FC error
  * - LOG of zero/negative: Returns 0, caller should generate FC error
  * - EXP overflow: Returns 0, caller should generate OV error
+ * - X^Y with X negative and Y fractional: Returns 0, sets MBF_DOMAIN
  */
 
 #include "basic/mbf.h"
-#include <math.h>
+
+
+/*============================================================================
+ * CONSTANTS AND POLYNOMIAL TABLES
+ *
+ * Raw MBF bits of the ROM's constants. Coefficients are listed highest
+ * power first, in the order the ROM's Horner loop consumes them.
+ *============================================================================*/
+
+#define MBF_CONST(bits) ((mbf_t){.raw = (bits)})
+
+#define MBF_QUARTER     MBF_CONST(0x7F000000)   /* .25 */
+#define MBF_HALF        MBF_CONST(0x80000000)   /* .5 */
+#define MBF_MINUS_HALF  MBF_CONST(0x80800000)   /* -.5 */
+#define MBF_PI_HALF     MBF_CONST(0x81490FDB)   /* 1.5708 */
+#define MBF_TWO_PI      MBF_CONST(0x83490FDB)   /* 6.2832 */
+#define MBF_SQR_HALF    MBF_CONST(0x803504F3)   /* .707107 */
+#define MBF_SQR_TWO     MBF_CONST(0x813504F3)   /* 1.41421 */
+#define MBF_LN2         MBF_CONST(0x80317218)   /* .693147 */
+#define MBF_LOG2_E      MBF_CONST(0x8138AA3B)   /* 1.4427 */
+
+/* SIN(2*PI*X) for X in [-.25,.25], odd in X */
+static const uint32_t sin_table[] = {
+    0x861ED7BA,     /*  39.71 */
+    0x87992664,     /* -76.575 */
+    0x87233458,     /*  81.602 */
+    0x86A55DE0,     /* -41.342 */
+    0x83490FDA,     /*  6.2832 */
+};
+
+/* ATN(X) for X in [0,1], odd in X */
+static const uint32_t atn_table[] = {
+    0x783BD74A,     /*  .002866226 */
+    0x7B846E02,     /* -.01616574 */
+    0x7C2FC1FE,     /*  .04290961 */
+    0x7D9A3174,     /* -.07528964 */
+    0x7D5A3D84,     /*  .1065626 */
+    0x7E917FC8,     /* -.142089 */
+    0x7E4CBBE4,     /*  .1999355 */
+    0x7FAAAA6C,     /* -.3333315 */
+    0x81000000,     /*  1 */
+};
+
+/* LOG2((1+T)/(1-T)*SQR(.5)) + .5, odd in T */
+static const uint32_t log_table[] = {
+    0x801956AA,     /*  .598979 */
+    0x807622F1,     /*  .961471 */
+    0x8238AA45,     /*  2.88539 */
+};
+
+/* 2^X for X in [0,1) */
+static const uint32_t exp_table[] = {
+    0x7134583E,     /*  2.14988E-05 */
+    0x74167EB3,     /*  1.43523E-04 */
+    0x772FEEE4,     /*  1.34226E-03 */
+    0x7A1D841C,     /*  9.61402E-03 */
+    0x7C635958,     /*  .0555051 */
+    0x7E75FDE8,     /*  .240226 */
+    0x80317218,     /*  .693147 */
+    0x81000000,     /*  1 */
+};
+
+#define TABLE_SIZE(t) (sizeof(t) / sizeof((t)[0]))
+
+/* c[0]*x^(n-1) + ... + c[n-1] by Horner's rule, one MBF step at a time */
+static mbf_t poly(mbf_t x, const uint32_t *coef, size_t n) {
+    mbf_t result = MBF_CONST(coef[0]);
+    for (size_t i = 1; i < n; i++) {
+        result = mbf_add(mbf_mul(result, x), MBF_CONST(coef[i]));
+    }
+    return result;
+}
+
+/* x * poly(x*x): the odd series used by SIN, ATN and LOG */
+static mbf_t poly_odd(mbf_t x, const uint32_t *coef, size_t n) {
+    return mbf_mul(x, poly(mbf_mul(x, x), coef, n));
+}
 
 
 /*============================================================================
  * SQUARE ROOT
  *============================================================================*/
 
-/* Square root using Newton-Raphson iteration in MBF format */
+/* SQR(X) is X^.5, which the ROM evaluates as EXP(.5*LOG(X)) */
 mbf_t mbf_sqr(mbf_t a) {
     /* Negative numbers are illegal for SQR */
     if (mbf_is_negative(a)) {
@@ -57,55 +137,257 @@ mbf_t mbf_sqr(mbf_t a) {
         return MBF_ZERO;
     }
 
-    /* Convert to double, compute sqrt, convert back */
-    double val = mbf_to_double(a);
-    double result = sqrt(val);
-    return mbf_from_double(result);
+    return mbf_exp(mbf_mul(mbf_log(a), MBF_HALF));
 }
 
+
+/*============================================================================
+ * TRIGONOMETRIC FUNCTIONS
+ *============================================================================*/
+
+/*
+ * The argument is reduced to a fraction of a turn, X/(2*PI) - INT(X/(2*PI)),
+ * and folded into [-.25,.25] with the same sequence of subtractions and
+ * negations as the ROM so that the rounding matches too.
+ */
 mbf_t mbf_sin(mbf_t a) {
-    double val = mbf_to_double(a);
-    double result = sin(val);
-    return mbf_from_double(result);
+    mbf_t x = mbf_div(a, MBF_TWO_PI);
+    x = mbf_sub(x, mbf_int(x));
+
+    x = mbf_sub(MBF_QUARTER, x);
+    bool negative = mbf_is_negative(x);
+    if (negative) {
+        x = mbf_add(x, MBF_HALF);
+        if (!mbf_is_negative(x)) {
+            x = mbf_neg(x);
+        }
+    } else {
+        x = mbf_neg(x);
+    }
+    x = mbf_add(x, MBF_QUARTER);
+    if (negative) {
+        x = mbf_neg(x);
+    }
+
+    return poly_odd(x, sin_table, TABLE_SIZE(sin_table));
 }
 
+/* COS(X) = SIN(X+PI/2) */
 mbf_t mbf_cos(mbf_t a) {
-    double val = mbf_to_double(a);
-    double result = cos(val);
-    return mbf_from_double(result);
+    return mbf_sin(mbf_add(a, MBF_PI_HALF));
 }
 
+/* TAN(X) = SIN(X)/COS(X) */
 mbf_t mbf_tan(mbf_t a) {
-    double val = mbf_to_double(a);
-    double result = tan(val);
-    return mbf_from_double(result);
+    return mbf_div(mbf_sin(a), mbf_cos(a));
 }
 
+/* ATN(X) for |X| > 1 is PI/2 - ATN(1/|X|), with the sign restored last */
 mbf_t mbf_atn(mbf_t a) {
-    double val = mbf_to_double(a);
-    double result = atan(val);
-    return mbf_from_double(result);
+    bool negative = mbf_is_negative(a);
+    mbf_t x = mbf_abs(a);
+
+    bool reciprocal = x.bytes.exponent >= MBF_BIAS;
+    if (reciprocal) {
+        x = mbf_div(MBF_ONE, x);
+    }
+    x = poly_odd(x, atn_table, TABLE_SIZE(atn_table));
+    if (reciprocal) {
+        x = mbf_sub(MBF_PI_HALF, x);
+    }
+
+    return negative ? mbf_neg(x) : x;
 }
 
+
+/*============================================================================
+ * LOGARITHM AND EXPONENTIAL
+ *============================================================================*/
+
+/*
+ * X = M * 2^E with M in [.5,1). LOG2(M) comes from the series in
+ * T = (M-SQR(.5))/(M+SQR(.5)), computed as 1 - SQR(2)/(M+SQR(.5)); E is
+ * added and the sum scaled by LN(2).
+ */
 mbf_t mbf_log(mbf_t a) {
     /* LOG of negative or zero is illegal */
     if (mbf_is_zero(a) || mbf_is_negative(a)) {
         return MBF_ZERO;  /* Should trigger FC error in caller */
     }
 
-    double val = mbf_to_double(a);
-    double result = log(val);
-    return mbf_from_double(result);
+    int16_t e = (int16_t)(a.bytes.exponent - (MBF_BIAS - 1));
+    mbf_t x = a;
+    x.bytes.exponent = MBF_BIAS - 1;
+
+    x = mbf_sub(MBF_ONE, mbf_div(MBF_SQR_TWO, mbf_add(x, MBF_SQR_HALF)));
+    x = poly_odd(x, log_table, TABLE_SIZE(log_table));
+    x = mbf_add(x, MBF_MINUS_HALF);
+    x = mbf_add(x, mbf_from_int16(e));
+    return mbf_mul(x, MBF_LN2);
 }
 
+/*
+ * EXP(X) = 2^Y with Y = X*LOG2(E). 2^(Y-INT(Y)) comes from the series and
+ * INT(Y) is added to its exponent.
+ */
 mbf_t mbf_exp(mbf_t a) {
-    double val = mbf_to_double(a);
-    double result = exp(val);
+    mbf_t y = mbf_mul(a, MBF_LOG2_E);
+
+    /* |Y| >= 128 is out of range: zero if negative, overflow otherwise */
+    if (y.bytes.exponent >= MBF_BIAS + 7) {
+        if (mbf_is_negative(y)) {
+            return MBF_ZERO;
+        }
+        mbf_set_error(MBF_OVERFLOW);
+        return MBF_ZERO;  /* Should trigger OV error */
+    }
 
-    /* Check for overflow */
-    if (isinf(result) || result > 1e38) {
+    bool overflow;
+    mbf_t whole = mbf_int(y);
+    int exponent = mbf_to_int16(whole, &overflow);
+    mbf_t x = poly(mbf_sub(y, whole), exp_table, TABLE_SIZE(exp_table));
+
+    exponent += x.bytes.exponent;
+    if (exponent > MBF_MAX_EXP) {
+        mbf_set_error(MBF_OVERFLOW);
         return MBF_ZERO;  /* Should trigger OV error */
     }
+    if (exponent < 1) {
+        return MBF_ZERO;
+    }
+    x.bytes.exponent = (uint8_t)exponent;
+    return x;
+}
+
+
+/*============================================================================
+ * EXPONENTIATION
+ *============================================================================*/
+
+/*
+ * base^n for an integer n when the result is exactly representable.
+ *
+ * base is +/-m * 2^e with m odd. base^n is exact when m^|n| fits in 24
+ * bits (always for powers of two), and is then built directly from m^|n|
+ * and e*n. Every partial product of X*X*...*X is exact in that case too,
+ * so this gives the same bits as repeated mbf_mul(). Negative n is only
+ * taken for powers of two, whose reciprocals are exact.
+ */
+static bool pow_exact(mbf_t base, int32_t n, mbf_t *result) {
+    uint32_t m = mbf_get_mantissa24(base);
+    int64_t e = (int64_t)base.bytes.exponent - MBF_BIAS - 23;
+    while (!(m & 1)) {
+        m >>= 1;
+        e++;
+    }
+    if (n < 0 && m != 1) return false;
+
+    /* m^|n| by square-and-multiply, giving up past 24 bits */
+    uint64_t k = n < 0 ? (uint64_t)(-(int64_t)n) : (uint64_t)n;
+    uint64_t p = 1, square = m;
+    for (uint64_t bits = k; bits; bits >>= 1) {
+        if (bits & 1) {
+            p *= square;
+            if (p >= (1u << 24)) return false;
+        }
+        if (bits > 1) {
+            square *= square;
+            if (square >= (1u << 24)) return false;
+        }
+    }
+
+    /* Value is p * 2^(e*n); p has 'len' significant bits */
+    int len = 0;
+    while ((p >> len) != 0) len++;
+    int64_t exponent = e * n + len + MBF_BIAS - 1;
+    bool negative = mbf_is_negative(base) && (k & 1);
+
+    if (exponent > MBF_MAX_EXP) {
+        mbf_set_error(MBF_OVERFLOW);
+        *result = mbf_make(negative, 0xFF, 0xFFFFFF);
+    } else if (exponent < 1) {
+        mbf_set_error(MBF_UNDERFLOW);
+        *result = MBF_ZERO;
+    } else {
+        *result = mbf_make(negative, (uint8_t)exponent, (uint32_t)(p << (24 - len)));
+    }
+    return true;
+}
+
+/*
+ * X^Y as the original evaluates it, EXP(Y*LOG(X)), with these cases:
+ * - Y = 0 gives 1 and otherwise 0^Y gives 0;
+ * - exactly representable integer powers are computed exactly;
+ * - other powers 1..10 multiply repeatedly, as this interpreter always has;
+ * - the rest are EXP(Y*LOG(ABS(X))), negated for a negative X and an odd
+ *   Y; a negative X with a fractional Y is MBF_DOMAIN.
+ */
+mbf_t mbf_pow(mbf_t base, mbf_t exponent) {
+    if (mbf_is_zero(exponent)) return MBF_ONE;
+    if (mbf_is_zero(base)) return MBF_ZERO;
+
+    bool overflow;
+    int32_t n = mbf_to_int32(exponent, &overflow);
+    bool integer = mbf_int(exponent).raw == exponent.raw;
+    if (!overflow && integer) {
+        mbf_t result;
+        if (pow_exact(base, n, &result)) return result;
+        if (n >= 1 && n <= 10) {
+            result = base;
+            for (int32_t i = 1; i < n; i++) {
+                result = mbf_mul(result, base);
+            }
+            return result;
+        }
+    }
+
+    bool negative = false;
+    if (mbf_is_negative(base)) {
+        if (!integer) {
+            mbf_set_error(MBF_DOMAIN);
+            return MBF_ZERO;
+        }
+        /* Integers past INT32 range have no fraction bits left: even */
+        negative = !overflow && (n & 1);
+    }
+
+    mbf_t result = mbf_exp(mbf_mul(exponent, mbf_log(mbf_abs(base))));
+    return negative ? mbf_neg(result) : result;
+}
+
+
+/*============================================================================
+ * BATCHED VARIANTS
+ *
+ * out[i] = f(in[i]) with the scalar functions above, so results are the
+ * same bits. Keeping the loop here lets the compiler inline the
+ * kernels into it.
+ *============================================================================*/
+
+void mbf_sqr_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_sqr(in[i]);
+}
+
+void mbf_sin_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_sin(in[i]);
+}
+
+void mbf_cos_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_cos(in[i]);
+}
+
+void mbf_tan_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_tan(in[i]);
+}
+
+void mbf_atn_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_atn(in[i]);
+}
+
+void mbf_log_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_log(in[i]);
+}
 
-    return mbf_from_double(result);
+void mbf_exp_n(mbf_t *out, const mbf_t *in, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = mbf_exp(in[i]);
 }
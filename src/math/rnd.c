@@ -210,28 +210,9 @@ void rnd_seed_from_mbf(rnd_state_t *state, mbf_t arg) {
 }
 
 /*
- * Generate next random number.
- *
- * RND(X) behavior:
- * - X < 0: Reseed using argument bits and return scrambled value
- * - X = 0: Return last value
- * - X > 0: Generate next random number
+ * Advance the generator one step (the RND(positive) path).
  */
-mbf_t rnd_next(rnd_state_t *state, mbf_t arg) {
-    int arg_sign = mbf_sign(arg);
-
-    /* RND(0) - return last value unchanged */
-    if (arg_sign == 0) {
-        return state->last_value;
-    }
-
-    /* RND(negative) - reseed */
-    if (arg_sign < 0) {
-        rnd_seed_from_mbf(state, arg);
-        return state->last_value;
-    }
-
-    /* RND(positive) - generate next value */
+static mbf_t rnd_step(rnd_state_t *state) {
     mbf_t seed = state->last_value;
 
     /*
@@ -305,6 +286,182 @@ mbf_t rnd_next(rnd_state_t *state, mbf_t arg) {
     return result;
 }
 
+/*
+ * Generate next random number.
+ *
+ * RND(X) behavior:
+ * - X < 0: Reseed using argument bits and return scrambled value
+ * - X = 0: Return last value
+ * - X > 0: Generate next random number
+ */
+mbf_t rnd_next(rnd_state_t *state, mbf_t arg) {
+    int arg_sign = mbf_sign(arg);
+
+    /* RND(0) - return last value unchanged */
+    if (arg_sign == 0) {
+        return state->last_value;
+    }
+
+    /* RND(negative) - reseed */
+    if (arg_sign < 0) {
+        rnd_seed_from_mbf(state, arg);
+        return state->last_value;
+    }
+
+    /* RND(positive) - generate next value */
+    return rnd_step(state);
+}
+
+/*
+ * Batched generation and skip-ahead.
+ *
+ * The generator is a function of its state (three counters and the last
+ * value), and that state space is small: every orbit measured ends in a
+ * short cycle. From rnd_init() stepping with RND(1) there is a tail of
+ * 80802 values followed by a cycle of 90288 (the counters alone repeat
+ * every 4104 steps); seeds from negative arguments join cycles of 90288
+ * or 1368 after tails of a few thousand to ~85000 steps. So a skip of N
+ * steps only needs to walk the tail and N mod the cycle length.
+ *
+ * Finding the tail and cycle costs around half a million steps, so
+ * shorter skips are simply stepped, and the last few orbits found are
+ * cached. Each also remembers where its last skip ended, on the cycle,
+ * so a chain of skips searches once.
+ */
+
+/** Skips up to this long are stepped directly (about one cycle search) */
+#define RND_SKIP_DIRECT (1u << 19)
+
+/** Give up looking for a cycle after this many steps */
+#define RND_SKIP_SEARCH (1u << 24)
+
+/** Orbits remembered by rnd_skip() */
+#define RND_SKIP_CACHE 4
+
+/** An orbit: from start, mu steps reach cycle_start, which recurs every lambda */
+typedef struct {
+    rnd_state_t start;
+    uint64_t mu;
+    uint64_t lambda;
+    rnd_state_t cycle_start;
+    rnd_state_t landing;    /**< Where the last skip along it ended (on the cycle) */
+} rnd_orbit_t;
+
+/*
+ * Orbits depend only on the generator state, so one cache serves every
+ * interpreter on a thread. Like the MBF error flag it is per thread, so
+ * interpreters on different threads never share it.
+ */
+static _Thread_local rnd_orbit_t rnd_orbits[RND_SKIP_CACHE];
+static _Thread_local unsigned rnd_orbit_count;
+
+static bool rnd_same(const rnd_state_t *a, const rnd_state_t *b) {
+    return a->last_value.raw == b->last_value.raw &&
+           a->counter1 == b->counter1 &&
+           a->counter2 == b->counter2 &&
+           a->counter3 == b->counter3;
+}
+
+/*
+ * Find the tail length (mu) and cycle length (lambda) of the orbit
+ * starting at start (Brent's algorithm). On success *cycle_start is the
+ * first state on the cycle.
+ */
+static bool rnd_find_cycle(const rnd_state_t *start, uint64_t *mu,
+                           uint64_t *lambda, rnd_state_t *cycle_start) {
+    rnd_state_t tortoise = *start;
+    rnd_state_t hare = *start;
+    uint64_t power = 1, lam = 1, steps = 1;
+
+    rnd_step(&hare);
+    while (!rnd_same(&tortoise, &hare)) {
+        if (power == lam) {
+            tortoise = hare;
+            power *= 2;
+            lam = 0;
+        }
+        if (++steps > RND_SKIP_SEARCH) return false;
+        rnd_step(&hare);
+        lam++;
+    }
+
+    /* Hare lambda steps ahead of the tortoise; they meet at the cycle */
+    tortoise = *start;
+    hare = *start;
+    for (uint64_t i = 0; i < lam; i++) rnd_step(&hare);
+    uint64_t tail = 0;
+    while (!rnd_same(&tortoise, &hare)) {
+        rnd_step(&tortoise);
+        rnd_step(&hare);
+        tail++;
+    }
+
+    *mu = tail;
+    *lambda = lam;
+    *cycle_start = tortoise;
+    return true;
+}
+
+/*
+ * Advance the generator n steps, leaving it exactly as n calls of
+ * RND(1) would.
+ */
+void rnd_skip(rnd_state_t *state, uint64_t n) {
+    if (n <= RND_SKIP_DIRECT) {
+        while (n--) rnd_step(state);
+        return;
+    }
+
+    /* A cached start, or where a cached skip ended: no tail from there */
+    unsigned cached = rnd_orbit_count < RND_SKIP_CACHE ? rnd_orbit_count : RND_SKIP_CACHE;
+    rnd_orbit_t *orbit = NULL;
+    uint64_t mu = 0;
+    for (unsigned i = 0; i < cached && !orbit; i++) {
+        if (rnd_same(&rnd_orbits[i].start, state)) {
+            orbit = &rnd_orbits[i];
+            mu = orbit->mu;
+            *state = orbit->cycle_start;
+        } else if (rnd_same(&rnd_orbits[i].landing, state)) {
+            orbit = &rnd_orbits[i];
+        }
+    }
+
+    if (!orbit) {
+        rnd_state_t cycle_start;
+        uint64_t lambda;
+        if (!rnd_find_cycle(state, &mu, &lambda, &cycle_start)) {
+            while (n--) rnd_step(state);
+            return;
+        }
+        orbit = &rnd_orbits[rnd_orbit_count++ % RND_SKIP_CACHE];
+        orbit->start = *state;
+        orbit->mu = mu;
+        orbit->lambda = lambda;
+        orbit->cycle_start = cycle_start;
+        orbit->landing = cycle_start;
+        *state = cycle_start;
+    }
+
+    /* state is mu steps along: on the cycle, or still at the start of the tail */
+    if (n < mu) {
+        *state = orbit->start;
+        while (n--) rnd_step(state);
+        return;
+    }
+    n = (n - mu) % orbit->lambda;
+    while (n--) rnd_step(state);
+    orbit->landing = *state;
+}
+
+/*
+ * Store the next n values in out, as n calls of RND(1) would return.
+ */
+void rnd_fill(rnd_state_t *state, mbf_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = rnd_step(state);
+    }
+}
+
 /*
  * Public interface function for the BASIC interpreter.
  */
@@ -217,6 +217,7 @@ uint8_t *array_create(basic_state_t *state, const char *name, int dim1, int dim2
     size_t header = (dims == 1) ? ARRAY_HEADER_1D : ARRAY_HEADER_2D;
     size_t data_size = total_size - header;
     memset(ptr + header, 0, data_size);
+    mem_mark_dirty(state, state->array_start, (uint32_t)total_size);
 
     /* Update pointer */
     state->array_start += (uint16_t)total_size;
@@ -278,6 +279,7 @@ bool array_set_numeric(basic_state_t *state, const char *name,
     if (!elem) return false;
 
     memcpy(elem, &value.raw, 4);
+    mem_mark_dirty_at(state, elem, 4);
     return true;
 }
 
@@ -309,6 +311,7 @@ bool array_set_string(basic_state_t *state, const char *name,
     elem[1] = desc._reserved;
     elem[2] = (uint8_t)(desc.ptr & 0xFF);
     elem[3] = (uint8_t)(desc.ptr >> 8);
+    mem_mark_dirty_at(state, elem, 4);
     return true;
 }
 
@@ -0,0 +1,192 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file checkpoint.c
+ * @brief Incremental Checkpoints of an Interpreter
+ *
+ * Everything a BASIC session owns lives in memory[] (program, variables,
+ * arrays, strings) plus a few hundred bytes of registers in basic_state_t.
+ * Copying all of memory[] for each checkpoint is wasteful when a program
+ * only touched a handful of variables since the last one.
+ *
+ * memory[] is divided into CHECKPOINT_PAGE_SIZE byte pages. Every store
+ * into memory[] (variables, array elements, string space, program edits,
+ * POKE) marks its pages in state->dirty_pages through mem_mark_dirty().
+ * A checkpoint copies the marked pages and the registers, then clears the
+ * marks:
+ *
+ * ```
+ *   basic_checkpoint(full)  ->  [regs][page 3][page 4][page 250]...
+ *   basic_restore(chain)    ->  full image, deltas applied in order,
+ *                               registers of the last checkpoint
+ * ```
+ *
+ * A new state starts with every page marked, so its first checkpoint is
+ * full. Restoring bumps program_gen, which discards every cache derived
+ * from the program (quickened statements, JIT code, folded constants,
+ * the DATA index, compiled DEF FN bodies).
+ */
+
+#include "basic/basic.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Number of pages covering memory[] (the last may be partial) */
+static uint32_t page_total(uint32_t memory_size) {
+    return (memory_size + CHECKPOINT_PAGE_SIZE - 1) / CHECKPOINT_PAGE_SIZE;
+}
+
+/* Bytes of memory[] in a page */
+static size_t page_bytes(uint32_t memory_size, uint32_t page) {
+    size_t start = (size_t)page * CHECKPOINT_PAGE_SIZE;
+    size_t left = memory_size - start;
+    return left < CHECKPOINT_PAGE_SIZE ? left : CHECKPOINT_PAGE_SIZE;
+}
+
+static void save_regs(const basic_state_t *state, checkpoint_regs_t *regs) {
+    regs->program_start = state->program_start;
+    regs->program_end = state->program_end;
+    regs->var_start = state->var_start;
+    regs->array_start = state->array_start;
+    regs->string_start = state->string_start;
+    regs->string_end = state->string_end;
+    regs->var_count = state->var_count_;
+    regs->current_line = state->current_line;
+    regs->text_ptr = state->text_ptr;
+    regs->data_line = state->data_line;
+    regs->data_ptr = state->data_ptr;
+    regs->rnd = state->rnd;
+
+    regs->for_sp = state->for_sp;
+    for (int i = 0; i < 16; i++) {
+        regs->for_stack[i] = state->for_stack[i];
+        regs->for_stack[i].var = NULL;
+        regs->for_var[i] = state->for_stack[i].var
+            ? (uint16_t)(state->for_stack[i].var - state->memory) : 0;
+    }
+    regs->gosub_sp = state->gosub_sp;
+    memcpy(regs->gosub_stack, state->gosub_stack, sizeof(regs->gosub_stack));
+
+    for (int i = 0; i < 26; i++) {
+        regs->fn_name[i] = state->user_funcs[i].name;
+        regs->fn_line[i] = state->user_funcs[i].line;
+        regs->fn_ptr[i] = state->user_funcs[i].ptr;
+    }
+
+    regs->terminal_x = state->terminal_x;
+    regs->can_continue = state->can_continue;
+    regs->cont_line = state->cont_line;
+    regs->cont_ptr = state->cont_ptr;
+}
+
+static void load_regs(basic_state_t *state, const checkpoint_regs_t *regs) {
+    state->program_start = regs->program_start;
+    state->program_end = regs->program_end;
+    state->var_start = regs->var_start;
+    state->array_start = regs->array_start;
+    state->array_gen++;
+    state->string_start = regs->string_start;
+    state->string_end = regs->string_end;
+    state->var_count_ = regs->var_count;
+    state->current_line = regs->current_line;
+    state->text_ptr = regs->text_ptr;
+    state->data_line = regs->data_line;
+    state->data_ptr = regs->data_ptr;
+    state->rnd = regs->rnd;
+
+    state->for_sp = regs->for_sp;
+    for (int i = 0; i < 16; i++) {
+        state->for_stack[i] = regs->for_stack[i];
+        state->for_stack[i].var = i < regs->for_sp
+            ? state->memory + regs->for_var[i] : NULL;
+    }
+    state->gosub_sp = regs->gosub_sp;
+    memcpy(state->gosub_stack, regs->gosub_stack, sizeof(state->gosub_stack));
+
+    /* Definitions are parsed again by the next DEF or call */
+    memset(state->user_funcs, 0, sizeof(state->user_funcs));
+    for (int i = 0; i < 26; i++) {
+        state->user_funcs[i].name = regs->fn_name[i];
+        state->user_funcs[i].line = regs->fn_line[i];
+        state->user_funcs[i].ptr = regs->fn_ptr[i];
+    }
+
+    state->terminal_x = regs->terminal_x;
+    state->can_continue = regs->can_continue;
+    state->cont_line = regs->cont_line;
+    state->cont_ptr = regs->cont_ptr;
+}
+
+/*
+ * Copy the marked pages (or all of them) into a new checkpoint.
+ * The checkpoint, its page list and its data are one allocation.
+ */
+basic_checkpoint_t *basic_checkpoint(basic_state_t *state, bool full) {
+    if (!state) return NULL;
+
+    uint32_t total = page_total(state->memory_size);
+    uint32_t count = 0;
+    for (uint32_t page = 0; page < total; page++) {
+        if (full || (state->dirty_pages[page / 64] >> (page % 64) & 1)) count++;
+    }
+
+    size_t pages_offset = sizeof(basic_checkpoint_t);
+    size_t data_offset = pages_offset + (size_t)count * sizeof(uint16_t);
+    basic_checkpoint_t *cp =
+        malloc(data_offset + (size_t)count * CHECKPOINT_PAGE_SIZE);
+    if (!cp) return NULL;
+
+    cp->memory_size = state->memory_size;
+    cp->full = (count == total);
+    cp->page_count = (uint16_t)count;
+    cp->pages = (uint16_t *)((uint8_t *)cp + pages_offset);
+    cp->data = (uint8_t *)cp + data_offset;
+
+    uint32_t n = 0;
+    for (uint32_t page = 0; page < total; page++) {
+        if (!full && !(state->dirty_pages[page / 64] >> (page % 64) & 1)) continue;
+        cp->pages[n] = (uint16_t)page;
+        memcpy(cp->data + (size_t)n * CHECKPOINT_PAGE_SIZE,
+               state->memory + (size_t)page * CHECKPOINT_PAGE_SIZE,
+               page_bytes(state->memory_size, page));
+        n++;
+    }
+    save_regs(state, &cp->regs);
+
+    memset(state->dirty_pages, 0, sizeof(state->dirty_pages));
+    return cp;
+}
+
+/*
+ * Apply a full checkpoint and the deltas after it, then load the
+ * registers of the last one.
+ */
+bool basic_restore(basic_state_t *state, basic_checkpoint_t *const *chain, size_t count) {
+    if (!state || !chain || count == 0 || !chain[0] || !chain[0]->full) return false;
+    for (size_t i = 0; i < count; i++) {
+        if (!chain[i] || chain[i]->memory_size != state->memory_size) return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const basic_checkpoint_t *cp = chain[i];
+        for (uint32_t n = 0; n < cp->page_count; n++) {
+            uint32_t page = cp->pages[n];
+            memcpy(state->memory + (size_t)page * CHECKPOINT_PAGE_SIZE,
+                   cp->data + (size_t)n * CHECKPOINT_PAGE_SIZE,
+                   page_bytes(state->memory_size, page));
+        }
+    }
+    load_regs(state, &chain[count - 1]->regs);
+
+    memset(state->dirty_pages, 0, sizeof(state->dirty_pages));
+    state->program_gen++;
+    return true;
+}
+
+void basic_checkpoint_free(basic_checkpoint_t *checkpoint) {
+    free(checkpoint);
+}
@@ -96,6 +96,7 @@ bool program_insert_line(basic_state_t *state, uint16_t line_num,
     uint8_t *curr_line = NULL;
     uint8_t *ptr = state->memory + state->program_start;
     uint8_t *prog_end = state->memory + state->program_end;
+    uint16_t old_end = state->program_end;
 
     while (ptr < prog_end) {
         uint16_t num = (uint16_t)(ptr[2] | (ptr[3] << 8));
@@ -238,12 +239,19 @@ bool program_insert_line(basic_state_t *state, uint16_t line_num,
         }
     }
 
+    /* Links after the edit point moved too: mark the whole program area */
+    mem_mark_dirty(state, state->program_start,
+                   (uint32_t)((old_end > state->program_end ? old_end : state->program_end)
+                              - state->program_start));
+
     /* Update var_start and array_start */
     state->var_start = state->program_end;
     state->array_start = state->var_start;
+    state->array_gen++;
 
     /* Can't continue after modifying program */
     state->can_continue = false;
+    state->program_gen++;
 
     return true;
 }
@@ -377,6 +385,34 @@ void program_clear(basic_state_t *state) {
     state->program_end = state->program_start;
     state->var_start = state->program_end;
     state->array_start = state->var_start;
+    state->array_gen++;
     state->var_count_ = 0;
     state->can_continue = false;
+    state->program_gen++;
+}
+
+/*
+ * Replace the program with a pre-built image of linked lines.
+ * Returns true on success, false on out of memory.
+ */
+bool program_load_image(basic_state_t *state, const uint8_t *image, size_t size) {
+    if (!state || (!image && size > 0)) return false;
+
+    program_clear(state);
+
+    if (size > (size_t)(state->string_start - state->array_start)) {
+        return false;  /* Out of memory */
+    }
+
+    if (size > 0) {
+        memcpy(state->memory + state->program_start, image, size);
+        mem_mark_dirty(state, state->program_start, (uint32_t)size);
+    }
+    state->program_end = (uint16_t)(state->program_start + size);
+    state->var_start = state->program_end;
+    state->array_start = state->var_start;
+    state->array_gen++;
+    state->program_gen++;
+
+    return true;
 }
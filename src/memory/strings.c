@@ -95,6 +95,9 @@ uint16_t string_alloc(basic_state_t *state, uint8_t length) {
     /* Allocate from top of free space, growing down */
     state->string_start -= length;
 
+    /* Callers fill the whole block */
+    mem_mark_dirty(state, state->string_start, length);
+
     return state->string_start;
 }
 
@@ -215,36 +218,26 @@ string_desc_t string_concat(basic_state_t *state, string_desc_t a, string_desc_t
 }
 
 /*
- * Compare two strings.
+ * Compare two strings: unsigned bytes, then length (a prefix sorts
+ * first). The one comparison core for relations and anything else that
+ * orders strings; memcmp() does the byte loop.
  * Returns: -1 if a < b, 0 if a == b, 1 if a > b.
  */
 int string_compare(basic_state_t *state, string_desc_t a, string_desc_t b) {
-    /* Both empty */
-    if (a.length == 0 && b.length == 0) return 0;
-
-    /* One empty */
-    if (a.length == 0) return -1;
-    if (b.length == 0) return 1;
-
+    /* Missing data (empty, or no interpreter state) compares as "" */
     const char *data_a = string_get_data(state, a);
     const char *data_b = string_get_data(state, b);
+    size_t len_a = data_a ? a.length : 0;
+    size_t len_b = data_b ? b.length : 0;
 
-    if (!data_a && !data_b) return 0;
-    if (!data_a) return -1;
-    if (!data_b) return 1;
-
-    /* Compare character by character */
-    uint8_t min_len = (a.length < b.length) ? a.length : b.length;
-
-    for (uint8_t i = 0; i < min_len; i++) {
-        if ((unsigned char)data_a[i] < (unsigned char)data_b[i]) return -1;
-        if ((unsigned char)data_a[i] > (unsigned char)data_b[i]) return 1;
+    size_t min_len = len_a < len_b ? len_a : len_b;
+    if (min_len > 0) {
+        int cmp = memcmp(data_a, data_b, min_len);
+        if (cmp != 0) return cmp < 0 ? -1 : 1;
     }
 
     /* Common prefix matches - shorter string is "less" */
-    if (a.length < b.length) return -1;
-    if (a.length > b.length) return 1;
-    return 0;
+    return (len_a > len_b) - (len_a < len_b);
 }
 
 /*
@@ -440,6 +433,8 @@ void string_garbage_collect(basic_state_t *state) {
                     /* Update descriptor pointer */
                     ptr[4] = (uint8_t)(new_string_start & 0xFF);
                     ptr[5] = (uint8_t)(new_string_start >> 8);
+                    mem_mark_dirty(state, new_string_start, len);
+                    mem_mark_dirty_at(state, ptr + 4, 2);
                 }
             }
         }
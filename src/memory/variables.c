@@ -152,6 +152,7 @@ uint8_t *var_create(basic_state_t *state, const char *name) {
         memmove(state->memory + var_end + VAR_SIZE,
                 state->memory + var_end,
                 array_bytes);
+        mem_mark_dirty(state, var_end + VAR_SIZE, (uint32_t)array_bytes);
     }
 
     /* Add variable at end of variable area */
@@ -162,6 +163,7 @@ uint8_t *var_create(basic_state_t *state, const char *name) {
 
     /* Initialize value to zero */
     memset(ptr + 2, 0, 4);
+    mem_mark_dirty(state, var_end, VAR_SIZE);
 
     /* Update pointers */
     state->var_count_++;
@@ -208,6 +210,7 @@ bool var_set_numeric(basic_state_t *state, const char *name, mbf_t value) {
 
     /* Store MBF value in bytes 2-5 */
     memcpy(var + 2, &value.raw, 4);
+    mem_mark_dirty_at(state, var + 2, 4);
     return true;
 }
 
@@ -245,6 +248,7 @@ bool var_set_string(basic_state_t *state, const char *name, string_desc_t desc)
     var[3] = desc._reserved;
     var[4] = (uint8_t)(desc.ptr & 0xFF);
     var[5] = (uint8_t)(desc.ptr >> 8);
+    mem_mark_dirty_at(state, var + 2, 4);
     return true;
 }
 
@@ -258,6 +262,7 @@ void var_clear_all(basic_state_t *state) {
     /* Reset variable area - arrays stay but are also cleared */
     state->var_start = state->program_end;
     state->array_start = state->var_start;
+    state->array_gen++;
     state->var_count_ = 0;
 }
 
@@ -150,6 +150,30 @@ basic_error_t stmt_return(basic_state_t *state) {
     return ERR_NONE;
 }
 
+/** Integer loops stay below this magnitude, where MBF sums are exact */
+#define FOR_INT_RANGE 0x1000000
+
+/*
+ * Integer value of an MBF number that is exactly a small integer.
+ * The round trip check rejects fractions and non-canonical encodings.
+ */
+static bool for_exact_int(mbf_t value, int32_t range, int32_t *out) {
+    bool overflow;
+    int32_t n = mbf_to_int32(value, &overflow);
+    if (overflow || n <= -range || n >= range) return false;
+    if (mbf_from_int32(n).raw != value.raw) return false;
+    *out = n;
+    return true;
+}
+
+/* Set up the integer fast path for a (re)initialised loop entry */
+static void for_prepare_int(for_entry_t *entry) {
+    entry->int_loop = for_exact_int(entry->step, FOR_INT_RANGE / 2, &entry->int_step) &&
+                      for_exact_int(entry->limit, FOR_INT_RANGE, &entry->int_limit);
+    entry->int_bits = 0;
+    entry->int_value = 0;
+}
+
 /*
  * Execute FOR statement.
  * Initializes loop variable and pushes loop parameters.
@@ -184,6 +208,7 @@ basic_error_t stmt_for(basic_state_t *state, const char *var_name,
             state->for_stack[i].text_ptr = next_ptr;
             state->for_stack[i].limit = limit;
             state->for_stack[i].step = step;
+            for_prepare_int(&state->for_stack[i]);
             return ERR_NONE;
         }
     }
@@ -195,6 +220,7 @@ basic_error_t stmt_for(basic_state_t *state, const char *var_name,
     entry->var = var;
     entry->limit = limit;
     entry->step = step;
+    for_prepare_int(entry);
     state->for_sp++;
 
     return ERR_NONE;
@@ -210,21 +236,58 @@ basic_error_t stmt_next(basic_state_t *state, const char *var_name, bool *contin
 
     *continue_loop = false;
 
-    /* Find the FOR entry */
-    int idx = state->for_sp - 1;
-
+    uint8_t *var = NULL;
     if (var_name && var_name[0]) {
         /* Find FOR with specific variable */
-        uint8_t *var = var_find(state, var_name);
+        var = var_find(state, var_name);
         if (!var) {
             return ERR_NF;  /* NEXT without FOR */
         }
+    }
 
-        while (idx >= 0 && state->for_stack[idx].var != var) {
-            idx--;
-        }
-        if (idx < 0) {
-            return ERR_NF;  /* NEXT without FOR */
+    uint8_t hint = 0xFF;
+    return stmt_next_var(state, var, &hint, continue_loop);
+}
+
+/*
+ * value + step for an integer loop, if the variable still holds what the
+ * last NEXT stored (or any exact small integer) and the sum is exact.
+ */
+static bool for_int_step(for_entry_t *entry, mbf_t current, int32_t *sum) {
+    int32_t value;
+    if (current.raw == entry->int_bits) {
+        value = entry->int_value;
+    } else if (!for_exact_int(current, FOR_INT_RANGE, &value)) {
+        return false;
+    }
+
+    *sum = value + entry->int_step;
+    return *sum > -FOR_INT_RANGE && *sum < FOR_INT_RANGE;
+}
+
+/*
+ * NEXT for a resolved variable. A FOR stack entry is unique per variable
+ * (stmt_for reuses it), so the entry found last time is still the right
+ * one if it holds the same variable.
+ */
+basic_error_t stmt_next_var(basic_state_t *state, uint8_t *var, uint8_t *hint,
+                            bool *continue_loop) {
+    *continue_loop = false;
+
+    /* Find the FOR entry */
+    int idx = state->for_sp - 1;
+
+    if (var) {
+        if (*hint < state->for_sp && state->for_stack[*hint].var == var) {
+            idx = *hint;
+        } else {
+            while (idx >= 0 && state->for_stack[idx].var != var) {
+                idx--;
+            }
+            if (idx < 0) {
+                return ERR_NF;  /* NEXT without FOR */
+            }
+            *hint = (uint8_t)idx;
         }
 
         /* Pop any inner loops */
@@ -243,24 +306,41 @@ basic_error_t stmt_next(basic_state_t *state, const char *var_name, bool *contin
     mbf_t current;
     memcpy(&current.raw, var_ptr + 2, 4);
 
-    /* Add step */
-    mbf_t new_value = mbf_add(current, entry->step);
-    memcpy(var_ptr + 2, &new_value.raw, 4);
-
-    /* Check termination */
-    int step_sign = mbf_sign(entry->step);
-    int cmp = mbf_cmp(new_value, entry->limit);
-
-    if (step_sign >= 0) {
-        /* Positive step: continue while value <= limit */
-        *continue_loop = (cmp <= 0);
+    int32_t sum;
+    if (entry->int_loop && for_int_step(entry, current, &sum)) {
+        /* Exact integer loop: same bits as mbf_add(), native compare */
+        mbf_t new_value = mbf_from_int32(sum);
+        memcpy(var_ptr + 2, &new_value.raw, 4);
+        mem_mark_dirty_at(state, var_ptr + 2, 4);
+        entry->int_bits = new_value.raw;
+        entry->int_value = sum;
+
+        *continue_loop = (entry->int_step >= 0) ? (sum <= entry->int_limit)
+                                                : (sum >= entry->int_limit);
     } else {
-        /* Negative step: continue while value >= limit */
-        *continue_loop = (cmp >= 0);
+        /* Add step */
+        mbf_t new_value = mbf_add(current, entry->step);
+        memcpy(var_ptr + 2, &new_value.raw, 4);
+        mem_mark_dirty_at(state, var_ptr + 2, 4);
+
+        /* Check termination */
+        int step_sign = mbf_sign(entry->step);
+        int cmp = mbf_cmp(new_value, entry->limit);
+
+        if (step_sign >= 0) {
+            /* Positive step: continue while value <= limit */
+            *continue_loop = (cmp <= 0);
+        } else {
+            /* Negative step: continue while value >= limit */
+            *continue_loop = (cmp >= 0);
+        }
     }
 
     if (*continue_loop) {
         /* Loop continues - go back to after FOR */
+        if (entry->text_ptr == state->text_ptr) {
+            state->loop_to_self = true;
+        }
         state->current_line = entry->line_number;
         state->text_ptr = entry->text_ptr;
     } else {
@@ -271,6 +351,46 @@ basic_error_t stmt_next(basic_state_t *state, const char *var_name, bool *contin
     return ERR_NONE;
 }
 
+/*
+ * Finish the innermost loop at once, for a NEXT that has just decided to
+ * go round again over a body with nothing to run. Every remaining NEXT
+ * would only add the step, so the variable is set to the first value
+ * past the limit and the entry popped. Only integer loops that stay
+ * exact are finished this way (STEP 0 never ends); anything else returns
+ * false and is left to ordinary NEXTs.
+ */
+bool stmt_next_finish(basic_state_t *state) {
+    if (state->for_sp == 0) return false;
+
+    for_entry_t *entry = &state->for_stack[state->for_sp - 1];
+    if (!entry->int_loop || entry->int_step == 0) return false;
+
+    uint8_t *var_ptr = entry->var;
+    mbf_t current;
+    memcpy(&current.raw, var_ptr + 2, 4);
+
+    int32_t value;
+    if (current.raw == entry->int_bits) {
+        value = entry->int_value;
+    } else if (!for_exact_int(current, FOR_INT_RANGE, &value)) {
+        return false;
+    }
+
+    /* value is within the limit; step k more times to pass it */
+    int64_t step = entry->int_step;
+    int64_t k = step > 0 ? ((int64_t)entry->int_limit - value) / step + 1
+                         : ((int64_t)value - entry->int_limit) / -step + 1;
+    int64_t last = value + k * step;
+    if (k < 1 || last <= -FOR_INT_RANGE || last >= FOR_INT_RANGE) return false;
+
+    /* Intermediate values lie between value and last: all exact */
+    mbf_t new_value = mbf_from_int32((int32_t)last);
+    memcpy(var_ptr + 2, &new_value.raw, 4);
+    mem_mark_dirty_at(state, var_ptr + 2, 4);
+    state->for_sp--;
+    return true;
+}
+
 /*
  * Execute IF statement evaluation.
  * Returns true if condition is true (non-zero), false otherwise.
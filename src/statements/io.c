@@ -98,12 +98,54 @@ void io_putchar(basic_state_t *state, char ch) {
 
 /*
  * Output a string to the terminal.
+ *
+ * Same result as io_putchar() for each character, but runs of ordinary
+ * characters up to the wrap column go out in one write.
  */
 void io_print_string(basic_state_t *state, const char *str, size_t len) {
-    if (!state || !str) return;
+    if (!state || !str || state->output_suppressed) return;
+
+    size_t i = 0;
+    while (i < len) {
+        char ch = str[i];
+        if (ch == '\r' || ch == '\n' || ch == '\t') {
+            io_putchar(state, ch);
+            i++;
+            continue;
+        }
+
+        /* A column at or past the width wraps after one character */
+        size_t room = state->terminal_x < state->terminal_width
+            ? (size_t)(state->terminal_width - state->terminal_x) : 1;
+        size_t run = 1;
+        while (run < room && i + run < len &&
+               str[i + run] != '\r' && str[i + run] != '\n' && str[i + run] != '\t') {
+            run++;
+        }
+        fwrite(str + i, 1, run, state->output);
+        i += run;
+
+        if (run == room) {
+            /* Auto line wrap */
+            fputc('\r', state->output);
+            fputc('\n', state->output);
+            state->terminal_x = 0;
+        } else {
+            state->terminal_x = (uint8_t)(state->terminal_x + run);
+        }
+    }
+}
 
-    for (size_t i = 0; i < len; i++) {
-        io_putchar(state, str[i]);
+/*
+ * Output count spaces, as io_print_string() does.
+ */
+static void io_spaces(basic_state_t *state, int count) {
+    static const char spaces[64] =
+        "                                                                ";
+    while (count > 0) {
+        int n = count < (int)sizeof(spaces) ? count : (int)sizeof(spaces);
+        io_print_string(state, spaces, (size_t)n);
+        count -= n;
     }
 }
 
@@ -135,18 +177,14 @@ void io_newline(basic_state_t *state) {
 void io_print_number(basic_state_t *state, mbf_t value) {
     if (!state) return;
 
-    char buf[32];
-    size_t len = mbf_to_string(value, buf, sizeof(buf));
+    /* Leading space for positive numbers, trailing space always */
+    char buf[34];
+    size_t start = mbf_is_negative(value) ? 1 : 0;
+    buf[0] = ' ';
+    size_t len = mbf_to_string(value, buf + 1, sizeof(buf) - 2);
+    buf[1 + len] = ' ';
 
-    /* Leading space for positive numbers */
-    if (!mbf_is_negative(value)) {
-        io_putchar(state, ' ');
-    }
-
-    io_print_string(state, buf, len);
-
-    /* Trailing space */
-    io_putchar(state, ' ');
+    io_print_string(state, buf + start, len + 2 - start);
 }
 
 /*
@@ -166,8 +204,8 @@ void io_tab(basic_state_t *state, int column) {
     }
 
     /* Space to target column */
-    while (state->terminal_x < column) {
-        io_putchar(state, ' ');
+    if (state->terminal_x < column) {
+        io_spaces(state, column - state->terminal_x);
     }
 }
 
@@ -177,8 +215,22 @@ void io_tab(basic_state_t *state, int column) {
 void io_spc(basic_state_t *state, int count) {
     if (!state) return;
 
-    for (int i = 0; i < count; i++) {
-        io_putchar(state, ' ');
+    io_spaces(state, count);
+}
+
+/*
+ * Comma in PRINT: space to the next 14-column zone. A zone that would
+ * not fit on the line ends it, through the automatic wrap.
+ */
+void io_zone(basic_state_t *state) {
+    if (!state) return;
+
+    int col = state->terminal_x;
+    int next_zone = ((col / 14) + 1) * 14;
+    if (next_zone < state->terminal_width) {
+        io_spaces(state, next_zone - col);
+    } else {
+        io_spaces(state, col < state->terminal_width ? state->terminal_width - col : 1);
     }
 }
 
@@ -263,6 +315,15 @@ basic_error_t stmt_restore(basic_state_t *state) {
 basic_error_t stmt_restore_line(basic_state_t *state, uint16_t line_num) {
     if (!state) return ERR_FC;
 
+    /* Binary search of the line table */
+    uint16_t found, text;
+    if (data_index_find_line(state, line_num, &found, &text)) {
+        if (!text) return ERR_UL;
+        state->data_line = found;
+        state->data_ptr = text;
+        return ERR_NONE;
+    }
+
     /* Find the line */
     uint8_t *ptr = state->memory + state->program_start;
     uint8_t *end = state->memory + state->program_end;
@@ -288,8 +349,9 @@ basic_error_t stmt_restore_line(basic_state_t *state, uint16_t line_num) {
  * Find next DATA item.
  * Scans forward in program looking for DATA statements.
  * Returns pointer to the data item, or NULL if out of data.
+ * *crossed is set if data_line was updated on the way.
  */
-static const uint8_t *find_next_data(basic_state_t *state) {
+static const uint8_t *scan_next_data(basic_state_t *state, bool *crossed) {
     if (!state) return NULL;
 
     uint8_t *ptr;
@@ -338,6 +400,7 @@ static const uint8_t *find_next_data(basic_state_t *state) {
 
                 /* Update data line number */
                 state->data_line = (uint16_t)(ptr[2] | (ptr[3] << 8));
+                *crossed = true;
 
                 /* Move to start of line text */
                 ptr += 4;
@@ -367,6 +430,30 @@ static const uint8_t *find_next_data(basic_state_t *state) {
     return NULL;
 }
 
+/*
+ * Find next DATA item, through the DATA index when this position has
+ * been scanned from before.
+ */
+static const uint8_t *find_next_data(basic_state_t *state) {
+    if (!state) return NULL;
+
+    uint16_t from = state->data_ptr;
+    uint16_t item, line;
+    bool crossed = false;
+    if (data_index_next(state, from, &item, &crossed, &line)) {
+        if (crossed) state->data_line = line;
+        state->data_ptr = item;
+        return state->memory + item;
+    }
+
+    const uint8_t *data = scan_next_data(state, &crossed);
+    if (data) {
+        data_index_store_next(state, from, (uint16_t)(data - state->memory),
+                              crossed, state->data_line);
+    }
+    return data;
+}
+
 /*
  * READ numeric value from DATA.
  */
@@ -378,6 +465,14 @@ basic_error_t io_read_numeric(basic_state_t *state, mbf_t *value) {
         return ERR_OD;  /* Out of data */
     }
 
+    /* Converted before */
+    uint16_t item = (uint16_t)(data - state->memory);
+    uint16_t end;
+    if (data_index_value(state, item, value, &end)) {
+        state->data_ptr = end;
+        return ERR_NONE;
+    }
+
     /* Skip leading spaces */
     while (*data == ' ') data++;
 
@@ -391,6 +486,7 @@ basic_error_t io_read_numeric(basic_state_t *state, mbf_t *value) {
     const uint8_t *p = data;
     while (*p && *p != ',' && *p != ':') p++;
     state->data_ptr = (uint16_t)(p - state->memory);
+    data_index_store_value(state, item, *value, state->data_ptr);
 
     return ERR_NONE;
 }
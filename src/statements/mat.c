@@ -0,0 +1,451 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/**
+ * @file mat.c
+ * @brief MAT Statements (extended dialect)
+ *
+ * Whole-array statements from extended BASICs, so a program can write
+ * `MAT C=A*B` instead of three nested FOR loops. They are not part of
+ * Altair 8K BASIC and are only accepted when the interpreter was started
+ * with basic_config_t.enable_mat (`basic8k -x`):
+ *
+ * - MAT READ A[,B...]       fill arrays from DATA, row by row
+ * - MAT PRINT A[,|;B...]    print arrays a row per line (`;` packs)
+ * - MAT A=ZER / CON / IDN   all zeros / all ones / identity
+ * - MAT A=B                 copy
+ * - MAT A=B+C / B-C         element-wise sum / difference
+ * - MAT A=B*C               matrix product
+ * - MAT A=(expr)*B          scalar multiple
+ * - MAT A=TRN(B)            transpose
+ *
+ * ## Shapes
+ *
+ * As in the BASICs MAT comes from, subscripts start at 1: a DIM A(3,4)
+ * array is a 3x4 matrix and row 0 and column 0 are left alone. A 1D
+ * array is a column vector. Shapes must agree exactly (no implicit
+ * redimensioning); a mismatch is a BS error. An array that does not
+ * exist yet is created with the default dimension, as A(I) would.
+ *
+ * ## Arithmetic
+ *
+ * The kernels work directly on array storage and use the same MBF
+ * operations, in the same order, as the equivalent FOR loops, so
+ * results are bit for bit those of:
+ *
+ * - `A(I,J)=B(I,J)+C(I,J)` for sums, differences and copies;
+ * - `A(I,J)=X*B(I,J)` for scalar multiples;
+ * - `S=0: FOR K=1 TO N: S=S+B(I,K)*C(K,J): NEXT K: A(I,J)=S` for
+ *   products.
+ *
+ * Products and transposes are built in a scratch buffer first, so
+ * `MAT A=A*A` and `MAT A=TRN(A)` read only the original values.
+ *
+ * ## Recognition
+ *
+ * MAT is not a keyword token (that would change how existing programs
+ * tokenize), so a statement is a MAT statement when it starts with the
+ * letters MAT followed by PRINT, READ, or an array name and `=`. With
+ * MAT enabled, an assignment such as `MATA=1` therefore means
+ * `MAT A=1`.
+ */
+
+#include "basic/basic.h"
+#include "basic/tokens.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Default array dimension, as in arrays.c */
+#define DEFAULT_DIM 10
+
+/** A numeric array seen as a matrix */
+typedef struct {
+    uint8_t *data;      /**< Element (0,0) */
+    int rows;           /**< Rows 1..rows */
+    int cols;           /**< Columns 1..cols (1 for a vector) */
+    size_t stride;      /**< Elements per stored row */
+    int col0;           /**< Stored column of logical column 1, minus 1 */
+} mat_view_t;
+
+/* Element (i, j), 1-based */
+static uint8_t *mat_elem(const mat_view_t *m, int i, int j) {
+    return m->data + ((size_t)i * m->stride + (size_t)(m->col0 + j)) * 4;
+}
+
+static mbf_t mat_get(const mat_view_t *m, int i, int j) {
+    mbf_t v;
+    memcpy(&v.raw, mat_elem(m, i, j), 4);
+    return v;
+}
+
+static void mat_put(const mat_view_t *m, int i, int j, mbf_t v) {
+    memcpy(mat_elem(m, i, j), &v.raw, 4);
+}
+
+/* Record that every element of a target may be stored */
+static void mat_mark_dirty(basic_state_t *state, const mat_view_t *m) {
+    mem_mark_dirty_at(state, m->data, (uint32_t)((size_t)(m->rows + 1) * m->stride * 4));
+}
+
+static bool mat_same_shape(const mat_view_t *a, const mat_view_t *b) {
+    return a->rows == b->rows && a->cols == b->cols;
+}
+
+static size_t skip_spaces(const uint8_t *text, size_t len, size_t pos) {
+    while (pos < len && text[pos] == ' ') pos++;
+    return pos;
+}
+
+static bool at_end(const uint8_t *text, size_t len, size_t pos) {
+    return pos >= len || text[pos] == '\0' || text[pos] == ':';
+}
+
+/* Length of the MAT prefix (with trailing spaces) at text, or 0 */
+static size_t mat_prefix(const uint8_t *text, size_t len) {
+    size_t pos = skip_spaces(text, len, 0);
+    if (pos + 3 > len || toupper(text[pos]) != 'M' || toupper(text[pos + 1]) != 'A' ||
+        toupper(text[pos + 2]) != 'T') {
+        return 0;
+    }
+    return skip_spaces(text, len, pos + 3);
+}
+
+/* Parse an array name at pos; returns false if there is none */
+static bool parse_name(const uint8_t *text, size_t len, size_t *pos,
+                       char name[4], bool *is_string) {
+    size_t p = *pos;
+    if (!(p < len && isalpha(text[p]))) return false;
+
+    memset(name, 0, 4);
+    name[0] = (char)text[p++];
+    if (p < len && isalnum(text[p])) name[1] = (char)text[p++];
+    while (p < len && isalnum(text[p])) p++;
+
+    *is_string = p < len && text[p] == '$';
+    if (*is_string) {
+        name[strlen(name)] = '$';
+        p++;
+    }
+    *pos = p;
+    return true;
+}
+
+/* Find (or create with the default dimension) the array called name */
+static basic_error_t mat_view(basic_state_t *state, const char *name, mat_view_t *m) {
+    uint8_t *arr = array_find(state, name);
+    if (!arr) {
+        arr = array_create(state, name, DEFAULT_DIM, -1);
+        if (!arr) return ERR_OM;
+    }
+
+    int dim1 = arr[3] | (arr[4] << 8);
+    if (arr[2] == 1) {
+        m->data = arr + 5;
+        m->rows = dim1;
+        m->cols = 1;
+        m->stride = 1;
+        m->col0 = -1;
+    } else {
+        int dim2 = arr[5] | (arr[6] << 8);
+        m->data = arr + 7;
+        m->rows = dim1;
+        m->cols = dim2;
+        m->stride = (size_t)dim2 + 1;
+        m->col0 = 0;
+    }
+    return ERR_NONE;
+}
+
+/* Parse a numeric array name at pos and look the array up */
+static basic_error_t parse_array(basic_state_t *state, const uint8_t *text, size_t len,
+                                 size_t *pos, mat_view_t *m) {
+    char name[4];
+    bool is_string;
+    *pos = skip_spaces(text, len, *pos);
+    if (!parse_name(text, len, pos, name, &is_string)) return ERR_SN;
+    if (is_string) return ERR_TM;
+    *pos = skip_spaces(text, len, *pos);
+    return mat_view(state, name, m);
+}
+
+bool stmt_mat_match(const uint8_t *text, size_t len) {
+    size_t pos = mat_prefix(text, len);
+    if (pos == 0 || pos >= len) return false;
+    if (text[pos] == TOK_PRINT || text[pos] == TOK_READ) return true;
+
+    char name[4];
+    bool is_string;
+    if (!parse_name(text, len, &pos, name, &is_string)) return false;
+    pos = skip_spaces(text, len, pos);
+    return pos < len && text[pos] == TOK_EQ;
+}
+
+
+/*============================================================================
+ * KERNELS
+ *============================================================================*/
+
+/* Every element of a set to value */
+static void mat_fill(const mat_view_t *a, mbf_t value) {
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) mat_put(a, i, j, value);
+    }
+}
+
+/* a = identity (a is square) */
+static void mat_identity(const mat_view_t *a) {
+    mbf_t one = mbf_from_int16(1);
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) mat_put(a, i, j, i == j ? one : MBF_ZERO);
+    }
+}
+
+/* a = b op c element by element; op is TOK_PLUS or TOK_MINUS */
+static void mat_addsub(const mat_view_t *a, const mat_view_t *b, const mat_view_t *c,
+                       uint8_t op) {
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) {
+            mbf_t x = mat_get(b, i, j), y = mat_get(c, i, j);
+            mat_put(a, i, j, op == TOK_PLUS ? mbf_add(x, y) : mbf_sub(x, y));
+        }
+    }
+}
+
+/* a = b, element by element (same index, so a and b may be one array) */
+static void mat_copy(const mat_view_t *a, const mat_view_t *b) {
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) mat_put(a, i, j, mat_get(b, i, j));
+    }
+}
+
+/* a = s * b */
+static void mat_scale(const mat_view_t *a, mbf_t s, const mat_view_t *b) {
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) mat_put(a, i, j, mbf_mul(s, mat_get(b, i, j)));
+    }
+}
+
+/* Store a rows x cols result, row-major, into a */
+static void mat_store(const mat_view_t *a, const mbf_t *result) {
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) mat_put(a, i, j, *result++);
+    }
+}
+
+/* a = b * c, accumulated in k order from zero */
+static basic_error_t mat_multiply(const mat_view_t *a, const mat_view_t *b,
+                                  const mat_view_t *c) {
+    mbf_t *result = malloc((size_t)a->rows * (size_t)a->cols * sizeof(*result) + 1);
+    if (!result) return ERR_OM;
+
+    mbf_t *r = result;
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) {
+            mbf_t sum = MBF_ZERO;
+            for (int k = 1; k <= b->cols; k++) {
+                sum = mbf_add(sum, mbf_mul(mat_get(b, i, k), mat_get(c, k, j)));
+            }
+            *r++ = sum;
+        }
+    }
+
+    mat_store(a, result);
+    free(result);
+    return ERR_NONE;
+}
+
+/* a = transpose of b */
+static basic_error_t mat_transpose(const mat_view_t *a, const mat_view_t *b) {
+    mbf_t *result = malloc((size_t)a->rows * (size_t)a->cols * sizeof(*result) + 1);
+    if (!result) return ERR_OM;
+
+    mbf_t *r = result;
+    for (int i = 1; i <= a->rows; i++) {
+        for (int j = 1; j <= a->cols; j++) *r++ = mat_get(b, j, i);
+    }
+
+    mat_store(a, result);
+    free(result);
+    return ERR_NONE;
+}
+
+
+/*============================================================================
+ * STATEMENTS
+ *============================================================================*/
+
+/* MAT READ A[,B...] */
+static basic_error_t mat_read(basic_state_t *state, const uint8_t *text, size_t len,
+                              size_t pos) {
+    for (;;) {
+        mat_view_t m;
+        basic_error_t err = parse_array(state, text, len, &pos, &m);
+        if (err != ERR_NONE) return err;
+        mat_mark_dirty(state, &m);
+
+        for (int i = 1; i <= m.rows; i++) {
+            for (int j = 1; j <= m.cols; j++) {
+                mbf_t value;
+                err = io_read_numeric(state, &value);
+                if (err != ERR_NONE) return err;
+                mat_put(&m, i, j, value);
+            }
+        }
+
+        if (at_end(text, len, pos)) return ERR_NONE;
+        if (text[pos] != ',') return ERR_SN;
+        pos++;
+    }
+}
+
+/* MAT PRINT A[{,|;}B...] */
+static basic_error_t mat_print(basic_state_t *state, const uint8_t *text, size_t len,
+                               size_t pos) {
+    for (;;) {
+        mat_view_t m;
+        basic_error_t err = parse_array(state, text, len, &pos, &m);
+        if (err != ERR_NONE) return err;
+
+        bool packed = pos < len && text[pos] == ';';
+        if (!at_end(text, len, pos) && text[pos] != ',' && !packed) return ERR_SN;
+
+        /* A vector prints as one row */
+        int rows = m.cols == 1 ? 1 : m.rows;
+        int cols = m.cols == 1 ? m.rows : m.cols;
+        for (int i = 1; i <= rows; i++) {
+            for (int j = 1; j <= cols; j++) {
+                io_print_number(state, m.cols == 1 ? mat_get(&m, j, 1) : mat_get(&m, i, j));
+                if (packed || j == cols) continue;
+
+                /* Next print zone, as a comma in PRINT */
+                int next_zone = ((state->terminal_x / 14) + 1) * 14;
+                while (state->terminal_x < next_zone) io_putchar(state, ' ');
+            }
+            io_newline(state);
+        }
+        io_newline(state);
+
+        if (at_end(text, len, pos)) return ERR_NONE;
+        pos = skip_spaces(text, len, pos + 1);
+        if (at_end(text, len, pos)) return ERR_NONE;
+    }
+}
+
+/* MAT A = ... */
+static basic_error_t mat_assign(basic_state_t *state, const uint8_t *text, size_t len,
+                                size_t pos) {
+    mat_view_t a;
+    size_t target = pos;
+    basic_error_t err = parse_array(state, text, len, &pos, &a);
+    if (err != ERR_NONE) return err;
+    if (pos >= len || text[pos] != TOK_EQ) return ERR_SN;
+    mat_mark_dirty(state, &a);
+    pos = skip_spaces(text, len, pos + 1);
+
+    /* ZER, CON (tokenized as C ON) and IDN */
+    const uint8_t *p = text + pos;
+    size_t rest = len - pos;
+    int fill = -1;
+    size_t word = 0;
+    if (rest >= 3 && toupper(p[0]) == 'Z' && toupper(p[1]) == 'E' && toupper(p[2]) == 'R') {
+        fill = 0;
+        word = 3;
+    } else if (rest >= 2 && toupper(p[0]) == 'C' && p[1] == TOK_ON) {
+        fill = 1;
+        word = 2;
+    } else if (rest >= 3 && toupper(p[0]) == 'I' && toupper(p[1]) == 'D' &&
+               toupper(p[2]) == 'N') {
+        fill = 2;
+        word = 3;
+    }
+    if (fill >= 0) {
+        pos = skip_spaces(text, len, pos + word);
+        if (!at_end(text, len, pos)) return ERR_SN;
+        if (fill == 2) {
+            if (a.rows != a.cols || a.col0 < 0) return ERR_BS;
+            mat_identity(&a);
+        } else {
+            mat_fill(&a, fill ? mbf_from_int16(1) : MBF_ZERO);
+        }
+        return ERR_NONE;
+    }
+
+    /* TRN(B) */
+    if (rest >= 4 && toupper(p[0]) == 'T' && toupper(p[1]) == 'R' &&
+        toupper(p[2]) == 'N') {
+        pos = skip_spaces(text, len, pos + 3);
+        if (pos >= len || text[pos] != '(') return ERR_SN;
+        mat_view_t b;
+        pos++;
+        err = parse_array(state, text, len, &pos, &b);
+        if (err != ERR_NONE) return err;
+        if (pos >= len || text[pos] != ')') return ERR_SN;
+        pos = skip_spaces(text, len, pos + 1);
+        if (!at_end(text, len, pos)) return ERR_SN;
+        if (a.rows != b.cols || a.cols != b.rows) return ERR_BS;
+        return mat_transpose(&a, &b);
+    }
+
+    /* (expr)*B */
+    if (pos < len && text[pos] == '(') {
+        size_t consumed;
+        mbf_t scale = eval_expression(state, text + pos + 1, len - pos - 1, &consumed, &err);
+        if (err != ERR_NONE) return err;
+        pos = skip_spaces(text, len, pos + 1 + consumed);
+        if (pos >= len || text[pos] != ')') return ERR_SN;
+        pos = skip_spaces(text, len, pos + 1);
+        if (pos >= len || text[pos] != TOK_MUL) return ERR_SN;
+        pos++;
+
+        mat_view_t b;
+        err = parse_array(state, text, len, &pos, &b);
+        if (err != ERR_NONE) return err;
+        if (!at_end(text, len, pos)) return ERR_SN;
+
+        /* The expression may have created a variable, moving the arrays */
+        err = parse_array(state, text, len, &target, &a);
+        if (err != ERR_NONE) return err;
+        if (!mat_same_shape(&a, &b)) return ERR_BS;
+        mat_scale(&a, scale, &b);
+        return ERR_NONE;
+    }
+
+    /* B, B+C, B-C, B*C */
+    mat_view_t b;
+    err = parse_array(state, text, len, &pos, &b);
+    if (err != ERR_NONE) return err;
+    if (at_end(text, len, pos)) {
+        if (!mat_same_shape(&a, &b)) return ERR_BS;
+        mat_copy(&a, &b);
+        return ERR_NONE;
+    }
+
+    uint8_t op = text[pos];
+    if (op != TOK_PLUS && op != TOK_MINUS && op != TOK_MUL) return ERR_SN;
+    pos++;
+    mat_view_t c;
+    err = parse_array(state, text, len, &pos, &c);
+    if (err != ERR_NONE) return err;
+    if (!at_end(text, len, pos)) return ERR_SN;
+
+    if (op == TOK_MUL) {
+        if (b.cols != c.rows || a.rows != b.rows || a.cols != c.cols) return ERR_BS;
+        return mat_multiply(&a, &b, &c);
+    }
+    if (!mat_same_shape(&a, &b) || !mat_same_shape(&a, &c)) return ERR_BS;
+    mat_addsub(&a, &b, &c, op);
+    return ERR_NONE;
+}
+
+basic_error_t stmt_mat(basic_state_t *state, const uint8_t *text, size_t len) {
+    size_t pos = mat_prefix(text, len);
+    if (pos == 0 || pos >= len) return ERR_SN;
+
+    if (text[pos] == TOK_READ) return mat_read(state, text, len, pos + 1);
+    if (text[pos] == TOK_PRINT) return mat_print(state, text, len, pos + 1);
+    return mat_assign(state, text, len, pos);
+}
@@ -60,8 +60,13 @@
 
 #include "basic/basic.h"
 #include "basic/errors.h"
+#include "basic/tokens.h"
+#include <ctype.h>
 #include <string.h>
 
+/** Size of a simple variable entry */
+#define VAR_SIZE 6
+
 /*
  * Execute LET statement (assignment).
  * Note: LET is optional in 8K BASIC syntax.
@@ -155,10 +160,185 @@ basic_error_t stmt_def_fn(basic_state_t *state, char fn_name,
     state->user_funcs[(int)fn_name].name = fn_name + 'A';
     state->user_funcs[(int)fn_name].line = line;
     state->user_funcs[(int)fn_name].ptr = ptr;
+    stmt_fn_compile(state, fn_name);
 
     return ERR_NONE;
 }
 
+/*
+ * Whether an FN body reads nothing but its parameter: numbers, operators,
+ * parentheses, the parameter and numeric functions with no outside input.
+ * Strings, other variables, arrays and FN calls make it impure.
+ */
+static bool fn_body_is_pure(const uint8_t *text, size_t len, const char *param) {
+    size_t pos = 0;
+    while (pos < len) {
+        uint8_t c = text[pos];
+        if (c == ' ' || c == '(' || c == ')' ||
+            (c >= TOK_PLUS && c <= TOK_LT) || c == TOK_NOT ||
+            c == '+' || c == '-' || c == '*' || c == '/' || c == '^' ||
+            c == '=' || c == '<' || c == '>') {
+            pos++;
+        } else if (isdigit(c) || c == '.') {
+            /* Number, including an exponent (whose E is not a variable) */
+            while (pos < len && (isdigit(text[pos]) || text[pos] == '.')) pos++;
+            if (pos < len && (text[pos] == 'E' || text[pos] == 'e')) {
+                pos++;
+                if (pos < len && (text[pos] == '+' || text[pos] == '-' ||
+                                  text[pos] == TOK_PLUS || text[pos] == TOK_MINUS)) {
+                    pos++;
+                }
+                while (pos < len && isdigit(text[pos])) pos++;
+            }
+        } else if (isalpha(c)) {
+            /* Only the parameter itself, as a simple numeric variable */
+            char name[3] = {0};
+            name[0] = (char)toupper(c);
+            pos++;
+            if (pos < len && isalnum(text[pos])) {
+                name[1] = (char)toupper(text[pos++]);
+            }
+            while (pos < len && isalnum(text[pos])) pos++;
+            if (name[0] != toupper((unsigned char)param[0]) ||
+                name[1] != toupper((unsigned char)param[1])) {
+                return false;
+            }
+            size_t next = pos;
+            while (next < len && text[next] == ' ') next++;
+            if (next < len && (text[next] == '$' || text[next] == '(')) return false;
+        } else if (TOK_IS_FUNCTION(c) && !TOK_IS_STRING_FUNC(c) &&
+                   c != TOK_RND && c != TOK_USR && c != TOK_FRE &&
+                   c != TOK_INP && c != TOK_POS && c != TOK_PEEK &&
+                   c != TOK_LEN && c != TOK_VAL && c != TOK_ASC) {
+            pos++;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Parse "(P) = expr" at the definition pointer, as a call would.
+ * Only text inside the program is parsed: it cannot change without
+ * program_gen changing too, so the result stays valid until then.
+ */
+void stmt_fn_compile(basic_state_t *state, int fn_idx) {
+    if (!state || fn_idx < 0 || fn_idx >= 26) return;
+
+    state->user_funcs[fn_idx].compiled = false;
+    uint16_t ptr = state->user_funcs[fn_idx].ptr;
+    if (ptr < state->program_start || ptr >= state->program_end) return;
+
+    const uint8_t *def_text = state->memory + ptr;
+    size_t dp = 0;
+    char param[3] = {0};
+
+    if (def_text[dp++] != '(') return;
+    if (!isalpha(def_text[dp])) return;
+    param[0] = (char)def_text[dp++];
+    if (isalnum(def_text[dp])) {
+        param[1] = (char)def_text[dp++];
+    }
+    if (def_text[dp++] != ')') return;
+    while (def_text[dp] == ' ') dp++;
+    if (def_text[dp] != '=' && def_text[dp] != TOK_EQ) return;
+    dp++;
+
+    size_t def_len = 0;
+    while (def_text[dp + def_len] != '\0' && def_text[dp + def_len] != ':') {
+        def_len++;
+    }
+
+    memcpy(state->user_funcs[fn_idx].param, param, sizeof(param));
+    state->user_funcs[fn_idx].param_index = UINT16_MAX;
+    state->user_funcs[fn_idx].body = (uint16_t)(ptr + dp);
+    state->user_funcs[fn_idx].body_len = (uint16_t)def_len;
+    state->user_funcs[fn_idx].gen = state->program_gen;
+    state->user_funcs[fn_idx].compiled = true;
+
+    state->user_funcs[fn_idx].pure = fn_body_is_pure(def_text + dp, def_len, param);
+    state->user_funcs[fn_idx].memo_valid = 0;
+    state->user_funcs[fn_idx].memo_next = 0;
+    state->user_funcs[fn_idx].memo_hits = 0;
+    state->user_funcs[fn_idx].memo_misses = 0;
+}
+
+
+/*
+ * Bind the argument straight into the parameter's variable slot, evaluate
+ * the body, then restore the previous value. The parameter is created on
+ * first use, as var_set_numeric() would.
+ */
+bool stmt_fn_call(basic_state_t *state, int fn_idx, mbf_t arg,
+                  mbf_t *result, basic_error_t *error) {
+    if (!state->user_funcs[fn_idx].compiled ||
+        state->user_funcs[fn_idx].gen != state->program_gen) {
+        return false;
+    }
+
+    /* A pure body gives the same bits for the same argument bits */
+    if (state->user_funcs[fn_idx].pure) {
+        for (unsigned i = 0; i < FN_MEMO_SLOTS; i++) {
+            if ((state->user_funcs[fn_idx].memo_valid & (1u << i)) &&
+                state->user_funcs[fn_idx].memo[i].arg == arg.raw) {
+                state->user_funcs[fn_idx].memo_hits++;
+                *result = state->user_funcs[fn_idx].memo[i].value;
+                *error = ERR_NONE;
+                return true;
+            }
+        }
+        state->user_funcs[fn_idx].memo_misses++;
+    }
+
+    const char *param = state->user_funcs[fn_idx].param;
+    uint16_t index = state->user_funcs[fn_idx].param_index;
+    uint8_t *slot = state->memory + state->var_start + index * VAR_SIZE;
+    if (index >= state->var_count_ ||
+        slot[0] != toupper((unsigned char)param[0]) ||
+        slot[1] != toupper((unsigned char)param[1])) {
+        slot = var_get_or_create(state, param);
+        if (!slot) return false;
+        index = (uint16_t)((size_t)(slot - (state->memory + state->var_start)) / VAR_SIZE);
+        state->user_funcs[fn_idx].param_index = index;
+    }
+
+    mbf_t saved;
+    memcpy(&saved.raw, slot + 2, 4);
+    memcpy(slot + 2, &arg.raw, 4);
+    mem_mark_dirty_at(state, slot + 2, 4);
+
+    size_t consumed;
+    *result = eval_expression(state, state->memory + state->user_funcs[fn_idx].body,
+                              state->user_funcs[fn_idx].body_len, &consumed, error);
+
+    /* The body may have created variables; the slot index still holds */
+    slot = state->memory + state->var_start + index * VAR_SIZE;
+    memcpy(slot + 2, &saved.raw, 4);
+
+    /* Only successful results are remembered, so errors recur */
+    if (state->user_funcs[fn_idx].pure && *error == ERR_NONE) {
+        unsigned i = state->user_funcs[fn_idx].memo_next;
+        state->user_funcs[fn_idx].memo[i].arg = arg.raw;
+        state->user_funcs[fn_idx].memo[i].value = *result;
+        state->user_funcs[fn_idx].memo_valid |= (uint8_t)(1u << i);
+        state->user_funcs[fn_idx].memo_next = (uint8_t)((i + 1) % FN_MEMO_SLOTS);
+    }
+    return true;
+}
+
+bool stmt_fn_memo_stats(const basic_state_t *state, int fn_idx,
+                        uint32_t *hits, uint32_t *misses) {
+    if (!state || fn_idx < 0 || fn_idx >= 26 ||
+        !state->user_funcs[fn_idx].name || !state->user_funcs[fn_idx].compiled ||
+        !state->user_funcs[fn_idx].pure) {
+        return false;
+    }
+    if (hits) *hits = state->user_funcs[fn_idx].memo_hits;
+    if (misses) *misses = state->user_funcs[fn_idx].memo_misses;
+    return true;
+}
+
 /*
  * Look up a user function.
  * Returns the definition location, or error if undefined.
@@ -194,6 +374,12 @@ basic_error_t stmt_poke(basic_state_t *state, uint16_t address, uint8_t value) {
     }
 
     state->memory[address] = value;
+    mem_mark_dirty(state, address, 1);
+
+    /* Patching program text invalidates anything decoded from it */
+    if (address < state->program_end) {
+        state->program_gen++;
+    }
     return ERR_NONE;
 }
 
@@ -0,0 +1,8 @@
+10 REM EXPRESSION BENCHMARK: ARITHMETIC WITH NOTHING TO FOLD
+20 K=3: J=7: L=2
+30 FOR I=1 TO 100000
+40 S=S+I*K-J/L+(I-K)*J
+50 T = T + I * ( K - 1 ) / 3 + ( I - 2 ) * 4 - I / ( 1 + K )
+60 IF S<K THEN S=K
+70 NEXT I
+80 PRINT S;T
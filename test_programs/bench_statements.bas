@@ -0,0 +1,16 @@
+10 REM STATEMENT DISPATCH BENCHMARK: A MIX OF HOT STATEMENTS
+20 DIM A(10)
+30 S=0: K=0
+40 FOR I=1 TO 20000
+50 J=I-INT(I/4)*4
+60 IF J=0 THEN K=K+1
+70 ON J+1 GOSUB 200,210,220,230
+80 A(J)=A(J)+I
+90 NEXT I
+100 PRINT S;K;A(0);A(3)
+110 END
+200 S=S+1: RETURN
+210 S=S+2: RETURN
+220 GOTO 240
+230 REM NOTHING
+240 RETURN
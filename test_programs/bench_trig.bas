@@ -0,0 +1,7 @@
+10 REM TRIG BENCHMARK: EVERY TRANSCENDENTAL FUNCTION IN THE INNER LOOP
+20 FOR I=1 TO 20000
+30 X=I/1000
+40 S=S+SIN(X)*COS(X)+ATN(X)+TAN(X/7)
+50 T=T+LOG(X)+EXP(-X)+SQR(X)
+60 NEXT I
+70 PRINT S/I;T/I
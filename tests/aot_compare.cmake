@@ -0,0 +1,19 @@
+# aot_compare.cmake - Run a program interpreted and compiled, compare output
+#
+# Usage: cmake -DINTERPRETER=... -DCOMPILED=... -DPROGRAM=... -P aot_compare.cmake
+
+execute_process(COMMAND ${INTERPRETER} ${PROGRAM}
+                INPUT_FILE ${PROGRAM}
+                OUTPUT_VARIABLE interpreted
+                RESULT_VARIABLE interpreted_rc)
+execute_process(COMMAND ${COMPILED}
+                INPUT_FILE ${PROGRAM}
+                OUTPUT_VARIABLE compiled
+                RESULT_VARIABLE compiled_rc)
+
+if(NOT interpreted_rc EQUAL compiled_rc)
+    message(FATAL_ERROR "Exit status differs: ${interpreted_rc} vs ${compiled_rc}")
+endif()
+if(NOT interpreted STREQUAL compiled)
+    message(FATAL_ERROR "Output differs\n--- interpreted ---\n${interpreted}\n--- compiled ---\n${compiled}")
+endif()
@@ -0,0 +1,25 @@
+10 REM EXPRESSIONS THE COMPILER TRANSLATES OR HANDS TO THE PARSER
+20 DEF FNA(X)=X*X+1
+30 DIM A(10),B(3,3)
+40 FOR I=0 TO 10: A(I)=I^2: NEXT I
+50 B(1,2)=2^-1: B(3,3)=A(2+1)
+60 X=2: Y=3
+70 PRINT X^Y;X^-Y;-X^2;(X+1)^(Y-1);2^8;3.14159/180
+80 PRINT FNA(3)+1;FNA(X)*FNA(Y);A(FNA(1));B(1,2);B(3,3)
+90 A$="HELLO": B$="WORLD"
+100 IF A$<B$ THEN PRINT "LESS"
+110 IF A$+B$="HELLOWORLD" AND X=2 THEN PRINT "JOINED"
+120 IF NOT A$=B$ OR 0 THEN PRINT "DIFFERENT"
+130 L=LEN(A$)+ASC(B$)+VAL("12")
+140 PRINT L;LEN(A$+B$)*2
+150 Z=1+A$: PRINT Z
+160 PRINT ABS(-3)+SGN(-2)+INT(2.5)+SQR(16);SIN(0)+COS(0);ATN(1)*4;LOG(EXP(1))
+170 PRINT 1=1;1<2;2<=1;3>=3;4<>4;NOT 0;5 AND 3;5 OR 2
+180 IF X^2=4 THEN PRINT "SQUARE"
+190 IF 2^3^2=64 THEN PRINT "CHAIN"
+200 GOTO 190+20
+210 PRINT "SKIPPED"
+220 ON X GOSUB 300,300
+230 C=(-8)^(1/3)
+240 PRINT "NOT REACHED"
+300 PRINT "SUB": RETURN
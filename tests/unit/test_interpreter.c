@@ -0,0 +1,687 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/*
+ * test_interpreter.c - Program-level tests for the execution engine
+ *
+ * Runs small BASIC programs end to end and checks their output. Used to
+ * prove that execution shortcuts (JIT, caches) produce exactly the same
+ * output as plain interpretation.
+ */
+
+#include "test_harness.h"
+#include "basic/basic.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Helper: load a program (lines separated by '\n'), RUN it, capture output */
+static size_t run_with_config(const char *source, basic_config_t config,
+                              char *out, size_t out_size, basic_state_t **keep) {
+    FILE *output = tmpfile();
+    if (!output) return 0;
+
+    config.output = output;
+    basic_state_t *state = basic_init(&config);
+    if (!state) {
+        fclose(output);
+        return 0;
+    }
+
+    char line[256];
+    const char *p = source;
+    while (*p) {
+        size_t n = 0;
+        while (*p && *p != '\n' && n < sizeof(line) - 1) line[n++] = *p++;
+        line[n] = '\0';
+        if (*p == '\n') p++;
+        basic_execute_line(state, line);
+    }
+    basic_execute_line(state, "RUN");
+
+    fflush(output);
+    rewind(output);
+    size_t len = fread(out, 1, out_size - 1, output);
+    out[len] = '\0';
+    fclose(output);
+
+    if (keep) {
+        state->output = stdout;
+        *keep = state;
+    } else {
+        basic_free(state);
+    }
+    return len;
+}
+
+/* Helper: run_with_config() with the default configuration */
+static size_t run_program(const char *source, bool enable_jit,
+                          char *out, size_t out_size, basic_state_t **keep) {
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .want_trig = true,
+        .input = stdin,
+        .enable_jit = enable_jit
+    };
+    return run_with_config(source, config, out, out_size, keep);
+}
+
+/* Helper: program output must not depend on the JIT */
+static int same_with_jit(const char *source) {
+    static char plain[16384], jitted[16384];
+    run_program(source, false, plain, sizeof(plain), NULL);
+    run_program(source, true, jitted, sizeof(jitted), NULL);
+    if (strcmp(plain, jitted) != 0) {
+        printf("\n--- interpreted ---\n%s--- jit ---\n%s", plain, jitted);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Helper: best CPU time of a program with and without the JIT, in
+ * seconds. Runs alternate so a noisy spell hits both sides.
+ */
+static void best_run_times(const char *source, double *plain, double *jitted) {
+    static char out[256];
+    *plain = *jitted = 0.0;
+    for (int i = 0; i < 14; i++) {
+        bool enable_jit = (i & 1) != 0;
+        clock_t start = clock();
+        run_program(source, enable_jit, out, sizeof(out), NULL);
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+        double *best = enable_jit ? jitted : plain;
+        if (i < 2 || elapsed < *best) *best = elapsed;
+    }
+}
+
+/* Test basic program output */
+TEST(test_run_simple) {
+    char out[256];
+    run_program("10 PRINT 1+2\n20 PRINT \"HI\"", false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, " 3 \r\nHI\r\n");
+}
+
+/* Test JIT compiles hot lines and matches the interpreter */
+TEST(test_jit_loops) {
+    const char *prog =
+        "10 S=0\n"
+        "20 FOR I=1 TO 200\n"
+        "30 S=S+I*I/3: T=T-1\n"
+        "40 NEXT I\n"
+        "50 PRINT S;T;I\n";
+    ASSERT(same_with_jit(prog));
+
+    if (jit_available()) {
+        char out[256];
+        basic_state_t *state = NULL;
+        run_program(prog, true, out, sizeof(out), &state);
+        ASSERT(state != NULL);
+        ASSERT(jit_compiled_lines(state) > 0);
+        basic_free(state);
+    }
+}
+
+/* Test GOSUB, ON...GOTO and IF inside compiled lines */
+TEST(test_jit_flow) {
+    ASSERT(same_with_jit(
+        "10 FOR I=1 TO 100\n"
+        "20 ON I-INT(I/3)*3+1 GOSUB 100,200,300\n"
+        "30 IF I>95 THEN PRINT I;K: IF I=99 THEN 50\n"
+        "40 NEXT I\n"
+        "50 PRINT \"DONE\"\n"
+        "60 END\n"
+        "100 K=K+1: RETURN\n"
+        "200 K=K+2: RETURN\n"
+        "300 K=K*1.5: RETURN\n"));
+}
+
+/* Test errors raised from compiled lines are reported the same way */
+TEST(test_jit_error_deopt) {
+    ASSERT(same_with_jit(
+        "10 DIM A(50)\n"
+        "20 FOR I=1 TO 60\n"
+        "30 A(I)=I: X=1/(50-I)\n"
+        "40 NEXT I\n"));
+}
+
+/* Test STOP inside a compiled line stops at the same place */
+TEST(test_jit_stop) {
+    ASSERT(same_with_jit(
+        "10 FOR I=1 TO 100\n"
+        "20 X=X+I: IF I=80 THEN STOP\n"
+        "30 NEXT I\n"
+        "40 PRINT X\n"));
+}
+
+/* Test native LET/NEXT templates and their slow paths */
+TEST(test_jit_templates) {
+    /* Integer loops up and down, a fractional step, a last step to 2^24 */
+    ASSERT(same_with_jit(
+        "10 FOR I=1 TO 60: X=X+1: Y=I*2-X: NEXT I\n"
+        "20 FOR J=60 TO 1 STEP -3: Z=Z-J: NEXT J\n"
+        "30 FOR K=0 TO 5 STEP 0.25: W=W+K: NEXT K\n"
+        "40 FOR L=16777200 TO 16777215: V=L: NEXT L\n"
+        "50 PRINT I;J;K;L;X;Y;Z;W;V\n"));
+
+    /* Loop variable written in the body, NEXT of an outer loop */
+    ASSERT(same_with_jit(
+        "10 FOR I=1 TO 40: FOR J=1 TO 3: NEXT J\n"
+        "20 IF I=20 THEN I=I+0.5\n"
+        "30 A=A+I: NEXT I\n"
+        "40 PRINT A;I;J\n"));
+
+    /* CLEAR empties the slots a compiled line resolved */
+    ASSERT(same_with_jit(
+        "10 FOR N=1 TO 3\n"
+        "20 FOR I=1 TO 40: X=X+I: NEXT I\n"
+        "30 PRINT X: CLEAR\n"
+        "40 NEXT N\n"));
+
+    /* A line of nothing but calls stays in the interpreter */
+    if (jit_available()) {
+        char out[256];
+        basic_state_t *state = NULL;
+        run_program("10 FOR I=1 TO 100: PRINT ;: NEXT\n", true,
+                    out, sizeof(out), &state);
+        ASSERT(state != NULL);
+        ASSERT(jit_compiled_lines(state) == 0);
+        basic_free(state);
+    }
+}
+
+/*
+ * Test the JIT is not slower than the interpreter on hot loops: a
+ * FOR/LET/IF loop and test_programs/bench_statements.bas. The margin
+ * only absorbs timer noise. Timing is too noisy on shared machines to
+ * gate every run, so this only runs with BASIC8K_PERF_TESTS set.
+ */
+TEST(test_jit_not_slower) {
+    static const char *programs[] = {
+        "10 FOR I=1 TO 30000\n"
+        "20 X=X+1: Y=X*2: IF Y>10 THEN Z=Z+1\n"
+        "30 NEXT I\n"
+        "40 PRINT X;Y;Z\n",
+
+        "20 DIM A(10)\n"
+        "30 S=0: K=0\n"
+        "40 FOR I=1 TO 20000\n"
+        "50 J=I-INT(I/4)*4\n"
+        "60 IF J=0 THEN K=K+1\n"
+        "70 ON J+1 GOSUB 200,210,220,230\n"
+        "80 A(J)=A(J)+I\n"
+        "90 NEXT I\n"
+        "100 PRINT S;K;A(0);A(3)\n"
+        "110 END\n"
+        "200 S=S+1: RETURN\n"
+        "210 S=S+2: RETURN\n"
+        "220 GOTO 240\n"
+        "230 REM NOTHING\n"
+        "240 RETURN\n"
+    };
+    if (!jit_available() || !getenv("BASIC8K_PERF_TESTS")) return;
+
+    for (size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++) {
+        double plain, jitted;
+        best_run_times(programs[i], &plain, &jitted);
+        ASSERT(jitted <= plain * 1.2);
+    }
+}
+
+/* Test quickened GOTO/GOSUB/LET give the interpreter's results */
+TEST(test_quick_statements) {
+    char out[256];
+    basic_state_t *state = NULL;
+    run_program(
+        "10 A=5: B=A*2: GOSUB 100\n"
+        "20 IF A<8 THEN A=A+1: GOTO 20\n"
+        "30 PRINT A;B;C\n"
+        "40 GOTO 200\n"
+        "100 C=C+1: RETURN\n"
+        "200 REM DONE: PRINT \"NO\"\n",
+        false, out, sizeof(out), &state);
+    ASSERT_STR_EQ(out, " 8  10  1 \r\n");
+    ASSERT(state != NULL);
+    ASSERT(quick_decoded_statements(state) > 0);
+    basic_free(state);
+}
+
+/* Test the quickened LET shapes: V=V+n, V=W, A$=B$, A(V)=expr */
+TEST(test_quick_let) {
+    char out[256];
+    run_program(
+        "10 E=5: X=E: PRINT X\n"
+        "20 I=I+1: I=I+1: J=J-2.5: K=I: M=L: PRINT I;J;K;M\n"
+        "30 A$=\"HI\": B$=A$: C$=D$: PRINT B$;LEN(C$);A$\n"
+        "40 DIM Q(5): FOR I=0 TO 5: Q(I)=I*I: NEXT: W=W+1E3: PRINT Q(5);W\n"
+        "50 N=3: Q(N)=-1: Q(N)=Q(N)-1: PRINT Q(3)\n"
+        "60 CLEAR: X=X+1: B$=A$: PRINT X;LEN(B$)\n"
+        "70 N=11: Q(N)=1\n",
+        false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out,
+        " 5 \r\n 2 -2.5  2  0 \r\nHI 0 HI\r\n 25  1000 \r\n-2 \r\n 1  0 \r\n"
+        "\n?BS ERROR IN 70\n");
+}
+
+/* Test quickened A(V,W)=expr with the array moved, cleared and re-DIMmed */
+TEST(test_quick_let_element) {
+    const char *prog =
+        "10 DIM B(2),A(3,4)\n"
+        "20 FOR I=0 TO 3: FOR J=0 TO 4: A(I,J)=I*10+J: Z=1: NEXT J,I\n"
+        "30 PRINT A(3,4);A(2,1);A(0,0)\n"
+        "40 I=1: J=2: GOSUB 100: PRINT A(1,2)\n"
+        "50 CLEAR: DIM C(20),A(2,2): I=1: J=2: GOSUB 100: PRINT A(1,2);A(2,2);C(0)\n"
+        "60 M(2,3)=5: PRINT M(2,3);M(10,10)\n"
+        "70 C(I,J)=1\n"
+        "100 A(I,J)=-7: RETURN\n";
+    char out[256];
+    run_program(prog, false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out,
+        " 34  21  0 \r\n-7 \r\n-7  0  0 \r\n 5  0 \r\n\n?BS ERROR IN 70\n");
+    ASSERT(same_with_jit(prog));
+
+    run_program("10 DIM A(2,2): I=1: J=3: A(I,J)=1\n", false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, "\n?BS ERROR IN 10\n");
+}
+
+/* Test PRINT plans replay the first run's output, with wrap and zones */
+TEST(test_print_plans) {
+    const char *prog =
+        "10 A$=\"AB\"\n"
+        "20 FOR K=1 TO 2\n"
+        "30 PRINT \"X\";K,A$;A$=\"AB\";TAB(3);\"T\";SPC(2);\"S\";\n"
+        "40 PRINT \"0123456789\",K\n"
+        "50 NEXT\n"
+        "60 PRINT TAB(15);\"Z\",\n"
+        "70 ? \"END\"\n";
+    char out[256];
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = 20,
+        .input = stdin
+    };
+    run_with_config(prog, config, out, sizeof(out), NULL);
+
+    /* A zone past the width ends the line instead of spacing forever */
+    ASSERT_STR_EQ(out,
+        "X 1           AB-1 \r\n   T  S0123456789   \r\n 1 \r\n"
+        "X 2           AB-1 \r\n   T  S0123456789   \r\n 2 \r\n"
+        "               Z    \r\nEND\r\n");
+}
+
+/* Test editing the program drops decoded statements */
+TEST(test_quick_edit) {
+    char out[256];
+    basic_state_t *state = NULL;
+    run_program("10 X=1\n20 GOTO 40\n30 X=2\n40 PRINT X",
+                false, out, sizeof(out), &state);
+    ASSERT_STR_EQ(out, " 1 \r\n");
+    ASSERT(state != NULL);
+
+    FILE *output = tmpfile();
+    ASSERT(output != NULL);
+    state->output = output;
+    basic_execute_line(state, "20 GOTO 30");
+    basic_execute_line(state, "10 X=3");
+    basic_execute_line(state, "RUN");
+    basic_execute_line(state, "RUN");
+
+    fflush(output);
+    rewind(output);
+    size_t len = fread(out, 1, sizeof(out) - 1, output);
+    out[len] = '\0';
+    fclose(output);
+    ASSERT_STR_EQ(out, " 2 \r\n 2 \r\n");
+    basic_free(state);
+}
+
+/* Test FOR/NEXT: integer and fractional steps, past 2^24, edited counter */
+TEST(test_for_next) {
+    char out[512];
+    run_program(
+        "10 FOR I=1 TO 10: S=S+I: NEXT I: PRINT S;I\n"
+        "20 FOR I=10 TO 1 STEP -3: PRINT I;: NEXT: PRINT\n"
+        "30 FOR X=0 TO 1 STEP .3: PRINT X;: NEXT X: PRINT\n"
+        "40 FOR I=16777200 TO 16777230 STEP 7: PRINT I-16777000;: NEXT: PRINT\n"
+        "50 FOR I=1 TO 9: I=I+2.5: PRINT I;: NEXT I: PRINT\n"
+        "60 FOR I=1 TO 3: FOR J=1 TO 2: PRINT I*J;: NEXT J,I: PRINT\n"
+        "70 FOR I=1 TO 4: FOR J=1 TO 9: NEXT I: PRINT J\n",
+        false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out,
+        " 55  11 \r\n"
+        " 10  7  4  1 \r\n"
+        " 0  .3  .6  .9 \r\n"
+        " 200  207  214  222  230 \r\n"
+        " 3.5  7  10.5 \r\n"
+        " 1  2  2  4  3  6 \r\n"
+        " 1 \r\n");
+
+    run_program("10 NEXT A", false, out, sizeof(out), NULL);
+    ASSERT(strstr(out, "NF") != NULL);
+}
+
+/* Test loops with nothing in the body end where stepping would leave them */
+TEST(test_for_empty_body) {
+    const char *prog =
+        "10 FOR I=1 TO 10000000: NEXT I: PRINT I-1E7\n"
+        "20 FOR I=5 TO -7 STEP -5\n"
+        "30 REM NOTHING\n"
+        "40 DATA 1,2\n"
+        "50 NEXT: PRINT I\n"
+        "60 FOR I=1 TO 3: FOR J=1 TO 10 STEP 4: NEXT J: NEXT I: PRINT I;J\n"
+        "70 FOR I=16777200 TO 16777230 STEP 7: NEXT: PRINT I-16777000\n"
+        "80 FOR X=0 TO 1 STEP .3: NEXT X: PRINT X\n"
+        "90 FOR I=1 TO 0: NEXT I: PRINT I\n";
+    const char *expected =
+        " 1 \r\n"
+        "-10 \r\n"
+        " 4  13 \r\n"
+        " 238 \r\n"
+        " 1.2 \r\n"
+        " 2 \r\n";
+    char out[512];
+    run_program(prog, false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, expected);
+    if (jit_available()) {
+        run_program(prog, true, out, sizeof(out), NULL);
+        ASSERT_STR_EQ(out, expected);
+    }
+}
+
+/* Test IF: true and false clauses, THEN n, nested IF, missing line */
+TEST(test_if_then) {
+    char out[256];
+    run_program(
+        "10 A=1: B$=\"THEN\"\n"
+        "20 IF A=1 THEN PRINT \"T1\";: PRINT \"T2\";\n"
+        "30 IF A=2 THEN PRINT \"NO\": PRINT \"NO\"\n"
+        "40 IF B$=\"THEN\" THEN IF A THEN PRINT \"N\";\n"
+        "50 IF A<3 THEN 70\n"
+        "60 PRINT \"SKIP\";\n"
+        "70 PRINT A;: A=A+1: IF A<5 THEN 50\n"
+        "80 PRINT: IF A THEN 999\n",
+        false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, "T1T2N 1  2 SKIP 3 SKIP 4 \r\n\n?UL ERROR IN 80\n");
+}
+
+/* Test DEF FN: parameter binding and restore, nesting, created variable */
+TEST(test_def_fn) {
+    char out[256];
+    run_program(
+        "10 X=5: DEF FNA(X)=X*X+Y: Y=1\n"
+        "20 PRINT FNA(3);X;FNA(FNA(2))\n"
+        "30 DEF FNB(Q)=Q+FNA(Q)\n"
+        "40 PRINT FNB(2);Q\n"
+        "50 PRINT FNZ(1)\n",
+        false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, " 10  5  26 \r\n 7  0 \r\n\n?UF ERROR IN 50\n");
+}
+
+/* Test pure FN bodies are memoized and impure ones are not */
+TEST(test_def_fn_memo) {
+    char out[256];
+    basic_state_t *state = NULL;
+    run_program(
+        "10 DEF FNR(X)=INT(X*100+.5)/100: DEF FNA(X)=X+Y\n"
+        "20 FOR I=1 TO 40: S=S+FNR(I/4-INT(I/4))+FNA(1): Y=Y+1: NEXT\n"
+        "30 PRINT S\n",
+        false, out, sizeof(out), &state);
+    ASSERT_STR_EQ(out, " 835 \r\n");
+    ASSERT(state != NULL);
+
+    uint32_t hits = 0, misses = 0;
+    ASSERT(stmt_fn_memo_stats(state, 'R' - 'A', &hits, &misses));
+    ASSERT_EQ_INT(misses, 4);
+    ASSERT_EQ_INT(hits, 36);
+    ASSERT(!stmt_fn_memo_stats(state, 'A' - 'A', &hits, &misses));
+    basic_free(state);
+}
+
+/* Test ON GOTO/GOSUB: every selector, out of range, undefined target */
+TEST(test_on_jump) {
+    char out[256];
+    run_program(
+        "10 FOR I=0 TO 4: ON I GOSUB 100,200,300: PRINT \"R\";: NEXT: PRINT\n"
+        "20 FOR I=1 TO 3: ON I GOTO 40,50: PRINT \"F\";I;: GOTO 60\n"
+        "40 PRINT \"A\";: GOTO 60\n"
+        "50 PRINT \"B\";\n"
+        "60 NEXT: PRINT\n"
+        "70 ON 2 GOTO 100, 999\n"
+        "100 PRINT 1;: RETURN\n"
+        "200 PRINT 2;: RETURN\n"
+        "300 PRINT 3;: RETURN\n",
+        false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, "R 1 R 2 R 3 RR\r\nABF 3 \r\n\n?UL ERROR IN 70\n");
+}
+
+/* Test integer arguments given as a lone variable or number */
+TEST(test_int_operands) {
+    char out[256];
+    run_program(
+        "10 X=65.7: Y=-3: PRINT CHR$(X);CHR$(66);TAB(X-60);\"T\";SPC(X/20);\"S\"\n"
+        "20 PRINT TAB(Y);\"A\";SPC(Y);\"B\";CHR$(Y);\"C\";\n"
+        "30 ON Q GOTO 40: PRINT \"Q\";: Z=2.9: ON Z GOTO 40,50\n"
+        "40 PRINT \"X\"\n"
+        "50 PRINT TAB(Z);\"Z\": W=1E6: ON W GOTO 40\n",
+        false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, "AB   T   S\r\nABCQ\r\n  Z\r\n\n?FC ERROR IN 50\n");
+}
+
+/* Test READ/RESTORE through the DATA index, including type mismatches */
+TEST(test_data_index) {
+    char out[256];
+    basic_state_t *state = NULL;
+    run_program(
+        "10 DATA 1, 2.5,\"A,B\", -3E2\n"
+        "20 PRINT 5;: DATA 7,X\n"
+        "30 FOR K=1 TO 2\n"
+        "40 READ A,B,C$,D: PRINT A;B;C$;D\n"
+        "50 READ E,F$: PRINT E;F$\n"
+        "60 RESTORE 20: READ G,H: PRINT G;H\n"
+        "70 RESTORE: READ A,B,C,D: PRINT A;B;C;D\n"
+        "80 RESTORE: NEXT K\n",
+        false, out, sizeof(out), &state);
+    ASSERT_STR_EQ(out,
+        " 5  1  2.5 A,B-300 \r\n 7 X\r\n 7  0 \r\n 1  2.5  0  0 \r\n"
+        " 1  2.5 A,B-300 \r\n 7 X\r\n 7  0 \r\n 1  2.5  0  0 \r\n");
+    ASSERT(state != NULL);
+    ASSERT(data_index_items(state) > 0);
+
+    /* Editing the program drops the index */
+    basic_execute_line(state, "10 DATA 9");
+    ASSERT_EQ_INT(data_index_items(state), 0);
+    basic_free(state);
+}
+
+/* Test MAT statements: only with the dialect flag, matching FOR loops */
+TEST(test_mat) {
+    const char *prog =
+        "10 DIM A(2,3),C(3,2),D(2,2),V(3),W(2)\n"
+        "20 MAT READ A,C: DATA 1,2,3,4,5,6,.5,1.5,-2,0,7,.25\n"
+        "30 MAT D=A*C: MAT PRINT D;\n"
+        "40 MAT C=TRN(A): MAT V=CON: MAT W=A*V: MAT PRINT C;W;\n"
+        "50 X=1/3: MAT A=(X)*A: N=0\n"
+        "60 FOR I=1 TO 2: FOR J=1 TO 3: IF A(I,J)<>X*C(J,I) THEN N=N+1\n"
+        "70 NEXT J,I: MAT D=IDN: MAT D=D+D: PRINT N;D(1,1);D(1,2);D(0,0)\n"
+        "80 MAT D=A\n";
+    char out[512];
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .want_trig = true,
+        .input = stdin,
+        .enable_mat = true
+    };
+    run_with_config(prog, config, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out,
+        " 17.5  2.25 \r\n 34  7.5 \r\n\r\n"
+        " 1  4 \r\n 2  5 \r\n 3  6 \r\n\r\n 6  15 \r\n\r\n"
+        " 0  2  0  0 \r\n\n?BS ERROR IN 80\n");
+
+    /* Without the flag MAT is not a statement */
+    run_program(prog, false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, "\n?SN ERROR IN 20\n");
+}
+
+/* Element-wise array loops run in one pass with the same results */
+TEST(test_array_loops) {
+    const char *prog =
+        "10 DIM A(300),B(300),C(300),D(300): N=0\n"
+        "20 FOR I=0 TO 300: B(I)=SIN(I)*1E3: C(I)=I/7-20: NEXT\n"
+        "30 FOR I=1 TO 300: A(I)=B(I)+C(I): NEXT I\n"
+        "40 FOR I=1 TO 300: D(I)=B(I)+C(I): Z=0: NEXT: GOSUB 200\n"
+        "50 FOR I=1 TO 300\n60 A(I)=B(I)-C(I)\n70 NEXT\n"
+        "80 FOR I=1 TO 300: D(I)=B(I)-C(I): Z=0: NEXT: GOSUB 200\n"
+        "90 FOR I=1 TO 300: A(I)=B(I)*C(I): NEXT: GOSUB 300: GOSUB 200\n"
+        "100 FOR I=7 TO 3: A(I)=B(I): NEXT: PRINT I;A(7)=B(7);A(8)=B(8)\n"
+        "102 FOR I=1 TO 300: A(I)=LOG(C(I)): NEXT\n"
+        "103 FOR J=1 TO 300: D(J)=LOG(C(J)): Z=0: NEXT: GOSUB 200\n"
+        "104 FOR I=1 TO 300: LET A(I) = SQR( B(I) ): NEXT I\n"
+        "105 FOR J=1 TO 300: D(J)=SQR(B(J)): Z=0: NEXT: GOSUB 200\n"
+        "106 FOR I=1 TO 300: A(I)=ATN(B(I)): NEXT: FOR I=1 TO 300: A(I)=COS(A(I)): NEXT\n"
+        "107 FOR J=1 TO 300: D(J)=COS(ATN(B(J))): Z=0: NEXT: GOSUB 200\n"
+        "110 FOR I=1 TO 300: A(I)=2.5: NEXT: PRINT I;A(300);A(0);N\n"
+        "120 FOR I=1 TO 20: Q(I)=1: NEXT\n"
+        "200 FOR J=1 TO 300: IF A(J)<>D(J) THEN N=N+1\n"
+        "210 NEXT: RETURN\n"
+        "300 FOR J=1 TO 300: D(J)=B(J)*C(J): Z=0: NEXT J: RETURN\n";
+    char out[256];
+    run_program(prog, false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out,
+        " 8 -1  0 \r\n"
+        " 301  2.5  0  0 \r\n"
+        "\n?BS ERROR IN 120\n");
+}
+
+/* Test INSTR: only with the dialect flag, otherwise the array IN() */
+TEST(test_instr) {
+    const char *prog =
+        "10 A$=\"HELLO WORLD\": B$=\"O\"\n"
+        "20 PRINT INSTR(A$,B$);INSTR(6,A$,B$);INSTR(A$,\"\");INSTR(A$,\"XYZ\")\n"
+        "30 PRINT Instr(A$,\"WORLD\");INSTR(11,A$,\"D\");INSTR(12,A$,\"D\")\n"
+        "40 PRINT INSTR(0,A$,B$)\n";
+    char out[256];
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .want_trig = true,
+        .input = stdin,
+        .enable_instr = true
+    };
+    run_with_config(prog, config, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out,
+        " 5  8  1  0 \r\n 7  11  0 \r\n\n?FC ERROR IN 40\n");
+
+    /* Without the flag INSTR(3) reads element 3 of IN() */
+    run_program("10 IN(3)=7: PRINT INSTR(3)\n", false, out, sizeof(out), NULL);
+    ASSERT_STR_EQ(out, " 7 \r\n");
+}
+
+/* Helper: run a direct-mode line, capture output */
+static void run_line(basic_state_t *state, const char *line, char *out, size_t out_size) {
+    FILE *output = tmpfile();
+    out[0] = '\0';
+    if (!output) return;
+    state->output = output;
+    basic_execute_line(state, line);
+    fflush(output);
+    rewind(output);
+    size_t len = fread(out, 1, out_size - 1, output);
+    out[len] = '\0';
+    fclose(output);
+    state->output = stdout;
+}
+
+/* Test checkpoints: a full one, a small delta, restored into a new session */
+TEST(test_checkpoint) {
+    const char *prog =
+        "10 DIM A(300): FOR I=0 TO 300: A(I)=I*I: NEXT I: B$=\"X\": J=0\n"
+        "20 DEF FNS(X)=X+A(9): GOSUB 100: STOP\n"
+        "30 FOR J=1 TO 3: A(7)=-J: C=C+1: B$=B$+\"Y\": IF J=2 THEN STOP\n"
+        "40 NEXT J: PRINT A(7);A(8);C;B$;FNS(1);PEEK(30000)\n"
+        "50 END\n"
+        "100 C=10: RETURN\n";
+    char out[256], expect[256];
+    basic_state_t *state = NULL;
+    run_program(prog, false, out, sizeof(out), &state);
+    ASSERT(state != NULL);
+    ASSERT_STR_EQ(out, "");
+
+    basic_checkpoint_t *chain[2];
+    chain[0] = basic_checkpoint(state, false);
+    ASSERT(chain[0] != NULL);
+    ASSERT(chain[0]->full);
+
+    /* Stores to existing variables and a POKE touch a few pages only */
+    run_line(state, "CONT", out, sizeof(out));
+    ASSERT_STR_EQ(out, "");
+    run_line(state, "POKE 30000,9", out, sizeof(out));
+    chain[1] = basic_checkpoint(state, false);
+    ASSERT(chain[1] != NULL);
+    ASSERT(!chain[1]->full);
+    ASSERT(chain[1]->page_count > 0 && chain[1]->page_count <= 4);
+
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .want_trig = true,
+        .input = stdin
+    };
+    basic_state_t *copy = basic_init(&config);
+    ASSERT(copy != NULL);
+    ASSERT(!basic_restore(copy, chain + 1, 1));  /* Starts with a delta */
+    ASSERT(basic_restore(copy, chain, 2));
+    ASSERT(memcmp(copy->memory, state->memory, state->memory_size) == 0);
+
+    /* Both sessions carry on the same way */
+    run_line(state, "CONT", expect, sizeof(expect));
+    ASSERT_STR_EQ(expect, "-3  64  13 XYYY 82  9 \r\n");
+    run_line(copy, "CONT", out, sizeof(out));
+    ASSERT_STR_EQ(out, expect);
+
+    /* Sizes must match */
+    config.memory_size = 16384;
+    basic_state_t *small = basic_init(&config);
+    ASSERT(small != NULL);
+    ASSERT(!basic_restore(small, chain, 2));
+
+    basic_free(small);
+    basic_free(copy);
+    basic_free(state);
+    basic_checkpoint_free(chain[0]);
+    basic_checkpoint_free(chain[1]);
+}
+
+/* Run all tests */
+void run_tests(void) {
+    RUN_TEST(test_run_simple);
+    RUN_TEST(test_jit_loops);
+    RUN_TEST(test_jit_flow);
+    RUN_TEST(test_jit_error_deopt);
+    RUN_TEST(test_jit_stop);
+    RUN_TEST(test_jit_templates);
+    RUN_TEST(test_jit_not_slower);
+    RUN_TEST(test_quick_statements);
+    RUN_TEST(test_quick_let);
+    RUN_TEST(test_quick_let_element);
+    RUN_TEST(test_quick_edit);
+    RUN_TEST(test_print_plans);
+    RUN_TEST(test_for_next);
+    RUN_TEST(test_for_empty_body);
+    RUN_TEST(test_if_then);
+    RUN_TEST(test_def_fn);
+    RUN_TEST(test_def_fn_memo);
+    RUN_TEST(test_on_jump);
+    RUN_TEST(test_int_operands);
+    RUN_TEST(test_data_index);
+    RUN_TEST(test_mat);
+    RUN_TEST(test_array_loops);
+    RUN_TEST(test_instr);
+    RUN_TEST(test_checkpoint);
+}
+
+TEST_MAIN()
@@ -10,6 +10,7 @@
 
 #include "test_harness.h"
 #include "basic/mbf.h"
+#include <math.h>
 
 /* Test MBF zero representation */
 TEST(test_mbf_zero) {
@@ -113,6 +114,97 @@ TEST(test_mbf_sub) {
     ASSERT_EQ_INT(value, 70);
 }
 
+/* Test addition rounds on the 8 bits shifted out, as the 8080 does */
+TEST(test_mbf_add_round) {
+    /* 16777221 needs 25 bits: the carry shifts a 1 into the rounding byte */
+    ASSERT_MBF_EQ(mbf_add(mbf_from_int32(16777214), mbf_from_int16(7)),
+                  mbf_from_int32(16777222));
+    ASSERT_MBF_EQ(mbf_add(mbf_from_int32(16777216), MBF_ONE), mbf_from_int32(16777218));
+
+    /* Half a unit in the last place rounds up */
+    ASSERT_MBF_EQ(mbf_add(MBF_ONE, mbf_from_double(ldexp(1.0, -24))),
+                  mbf_from_double(1.0 + ldexp(1.0, -23)));
+
+    /* Bits shifted out come back when subtraction renormalizes */
+    ASSERT_MBF_EQ(mbf_sub(mbf_from_int16(2), mbf_from_double(1.0 + ldexp(1.0, -23))),
+                  mbf_from_double(1.0 - ldexp(1.0, -23)));
+}
+
+/*
+ * The 8080 multiply loop (fmult2/fmult4) register by register: for each
+ * FAC bit, add the multiplicand into C,H,L if the bit is set, then rotate
+ * carry,C,H,L,B right. mbf_mul() computes the same thing in closed form.
+ */
+static mbf_t mul_8080(mbf_t a, mbf_t b) {
+    if (mbf_is_zero(a) || mbf_is_zero(b)) return MBF_ZERO;
+    bool negative = mbf_is_negative(a) != mbf_is_negative(b);
+    int exp = (int)a.bytes.exponent + (int)b.bytes.exponent - 128;
+    if (exp > 255) return mbf_make(negative, 0xFF, 0xFFFFFF);
+    if (exp < 1) return MBF_ZERO;
+
+    uint32_t fac = mbf_get_mantissa24(a), mult = mbf_get_mantissa24(b);
+    uint8_t C = 0, H = 0, L = 0, B = 0, carry;
+    for (int byte_idx = 0; byte_idx < 3; byte_idx++) {
+        uint8_t fac_byte = (uint8_t)(fac >> (8 * byte_idx));
+        if (fac_byte == 0) {
+            B = L; L = H; H = C; C = 0;
+            continue;
+        }
+        carry = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            uint8_t out = fac_byte & 1;
+            fac_byte = (uint8_t)((fac_byte >> 1) | (carry << 7));
+            carry = out;
+            if (carry) {
+                uint32_t sum = ((uint32_t)C << 16 | (uint32_t)H << 8 | L) + mult;
+                C = (uint8_t)(sum >> 16); H = (uint8_t)(sum >> 8); L = (uint8_t)sum;
+                carry = (uint8_t)(sum >> 24);
+            }
+            uint8_t *regs[4] = { &C, &H, &L, &B };
+            for (int r = 0; r < 4; r++) {
+                out = *regs[r] & 1;
+                *regs[r] = (uint8_t)((*regs[r] >> 1) | (carry << 7));
+                carry = out;
+            }
+        }
+    }
+
+    uint32_t reg = (uint32_t)C << 24 | (uint32_t)H << 16 | (uint32_t)L << 8 | B;
+    while (!(reg & 0x80000000u) && reg != 0 && exp > 0) {
+        reg <<= 1;
+        exp--;
+    }
+    uint32_t mant = reg >> 8;
+    if ((reg & 0x80) && ++mant == 0x1000000) {
+        mant = 0x800000;
+        exp++;
+    }
+    if (exp < 1 || mant == 0) return MBF_ZERO;
+    if (exp > 255) return mbf_make(negative, 0xFF, 0xFFFFFF);
+    return mbf_make(negative, (uint8_t)exp, mant);
+}
+
+/* Test multiplication gives the bits of the 8080 loop */
+TEST(test_mbf_mul_8080) {
+    uint32_t seed = 4242;
+    for (int i = 0; i < 1000000; i++) {
+        mbf_t a, b;
+        seed = seed * 1103515245u + 12345u;
+        a.raw = seed;
+        seed = seed * 1103515245u + 12345u;
+        b.raw = seed;
+        /* Mantissas with zero bytes, all-ones mantissas, nearby exponents */
+        if (i % 4 == 1) a.raw &= 0xFFFFFF00u;
+        if (i % 4 == 2) a.raw &= 0xFFFF00FFu;
+        if (i % 8 == 3) b.raw |= 0x007FFFFFu;
+        if (i % 3 == 0) {
+            a.bytes.exponent = (uint8_t)(0x70 + (a.bytes.exponent & 0x1F));
+            b.bytes.exponent = (uint8_t)(0x70 + (b.bytes.exponent & 0x1F));
+        }
+        ASSERT_MBF_EQ(mbf_mul(a, b), mul_8080(a, b));
+    }
+}
+
 /* Test multiplication: simple case */
 TEST(test_mbf_mul_simple) {
     mbf_t a = mbf_from_int16(6);
@@ -170,6 +262,16 @@ TEST(test_mbf_div_simple) {
     ASSERT_EQ_INT(value, 20);
 }
 
+/* Test division rounds on the 25th quotient bit */
+TEST(test_mbf_div_round) {
+    mbf_t third = mbf_div(MBF_ONE, mbf_from_int16(3));
+    ASSERT_EQ_HEX(third.raw, 0x7F2AAAAB);
+    mbf_t two_thirds = mbf_div(mbf_from_int16(2), mbf_from_int16(3));
+    ASSERT_EQ_HEX(two_thirds.raw, 0x802AAAAB);
+    mbf_t seventh = mbf_div(MBF_ONE, mbf_from_int16(7));
+    ASSERT_EQ_HEX(seventh.raw, 0x7E124925);
+}
+
 /* Test division by zero */
 TEST(test_mbf_div_by_zero) {
     mbf_t a = mbf_from_int16(100);
@@ -225,6 +327,42 @@ TEST(test_mbf_cmp) {
     ASSERT_EQ_INT(mbf_cmp(d, a), -1);  /* d < a */
 }
 
+/* Three-way compare of the exact values, as an independent reference */
+static int cmp_by_value(mbf_t a, mbf_t b) {
+    double x = mbf_to_double(a);
+    double y = mbf_to_double(b);
+    return (x > y) - (x < y);
+}
+
+/* Test mbf_cmp() ordering over sampled bit pattern pairs */
+TEST(test_mbf_cmp_order) {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < (1 << 22); i++) {
+        /* xorshift64*: one 64-bit sample per pair */
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        uint64_t r = state * 0x2545F4914F6CDD1Dull;
+
+        mbf_t a, b;
+        a.raw = (uint32_t)r;
+        b.raw = (uint32_t)(r >> 32);
+        /* Often share the exponent, or the exponent and sign */
+        if (i & 1) b.raw = (b.raw & 0x00FFFFFF) | (a.raw & 0xFF000000);
+        if (i & 2) b.raw = (b.raw & 0x007FFFFF) | (a.raw & 0xFF800000);
+        /* Some zeros with mantissa bits set */
+        if ((i & 0x3C) == 0) a.raw &= 0x00FFFFFF;
+
+        int expect = cmp_by_value(a, b);
+        ASSERT_EQ_INT(mbf_cmp(a, b), expect);
+        ASSERT_EQ_INT(mbf_cmp(b, a), -expect);
+        ASSERT_EQ_INT(mbf_cmp(a, a), 0);
+    }
+
+    ASSERT_EQ_INT(mbf_cmp((mbf_t){.raw = 0x00800001}, MBF_ZERO), 0);
+    ASSERT_EQ_HEX(MBF_TRUE.raw, mbf_from_int16(-1).raw);
+}
+
 /* Test INT function */
 TEST(test_mbf_int) {
     /* Test with positive value */
@@ -258,6 +396,158 @@ TEST(test_mbf_mul_large) {
     ASSERT_EQ_INT(value, 10000);
 }
 
+/* Test ^: exact integer powers, the old multiply loop, EXP(LOG) and errors */
+TEST(test_mbf_pow) {
+    /* Powers 1..10 give exactly the bits of repeated mbf_mul() */
+    uint32_t seed = 12345;
+    for (int i = 0; i < 200000; i++) {
+        mbf_t base;
+        if (i < 2000) {
+            base = mbf_from_int16((int16_t)(i - 1000));
+        } else if (i < 4000) {
+            base = mbf_div(mbf_from_int16((int16_t)(i - 3000)), mbf_from_int16(64));
+        } else {
+            seed = seed * 1103515245u + 12345u;
+            base.raw = (seed & 0x80FFFFFF) | (uint32_t)(112 + (seed >> 27)) << 24;
+        }
+        if (mbf_is_zero(base)) continue;
+        mbf_t product = base;
+        for (int n = 1; n <= 10; n++) {
+            mbf_clear_error();
+            ASSERT_MBF_EQ(mbf_pow(base, mbf_from_int16((int16_t)n)), product);
+            product = mbf_mul(product, base);
+        }
+    }
+
+    /* Powers of two, either sign of exponent, far beyond 10 */
+    for (int n = -128; n <= 126; n++) {
+        mbf_clear_error();
+        ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(2), mbf_from_int16((int16_t)n)),
+                      mbf_from_double(ldexp(1.0, n)));
+        ASSERT_EQ_INT(mbf_get_error(), MBF_OK);
+    }
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(-2), mbf_from_int16(61)),
+                  mbf_from_double(-ldexp(1.0, 61)));
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(3), mbf_from_int16(15)), mbf_from_int32(14348907));
+
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(-3), mbf_from_int16(11)), mbf_from_double(-177147.0));
+
+    /* Everything else is EXP(Y*LOG(X)), sign restored for odd Y */
+    mbf_t half = mbf_from_double(0.5);
+    mbf_t ten = mbf_from_int16(10), minus_two = mbf_from_int16(-2);
+    mbf_t x11 = mbf_from_double(1.1), twenty = mbf_from_int16(20);
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(2), half),
+                  mbf_exp(mbf_mul(half, mbf_log(mbf_from_int16(2)))));
+    ASSERT_MBF_EQ(mbf_pow(ten, minus_two), mbf_exp(mbf_mul(minus_two, mbf_log(ten))));
+    ASSERT_MBF_EQ(mbf_pow(x11, twenty), mbf_exp(mbf_mul(twenty, mbf_log(x11))));
+    ASSERT_MBF_EQ(mbf_pow(mbf_neg(x11), twenty), mbf_pow(x11, twenty));
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_double(-1.1), mbf_from_int16(21)),
+                  mbf_neg(mbf_pow(x11, mbf_from_int16(21))));
+    ASSERT(fabs(mbf_to_double(mbf_pow(x11, twenty)) - pow(1.1, 20)) < 1e-5 * pow(1.1, 20));
+
+    /* X^0 = 1 (even 0^0), 0^Y = 0 */
+    ASSERT_MBF_EQ(mbf_pow(MBF_ZERO, MBF_ZERO), MBF_ONE);
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(-7), MBF_ZERO), MBF_ONE);
+    ASSERT_MBF_EQ(mbf_pow(MBF_ZERO, mbf_from_int16(-3)), MBF_ZERO);
+
+    /* Errors */
+    mbf_clear_error();
+    mbf_pow(mbf_from_int16(-8), mbf_from_double(1.0 / 3.0));
+    ASSERT_EQ_INT(mbf_get_error(), MBF_DOMAIN);
+    mbf_clear_error();
+    mbf_pow(mbf_from_int16(2), mbf_from_int16(127));
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+    mbf_clear_error();
+    mbf_pow(mbf_from_int16(10), mbf_from_int16(39));
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+    mbf_clear_error();
+    ASSERT_MBF_EQ(mbf_pow(mbf_from_int16(2), mbf_from_int16(-129)), MBF_ZERO);
+    mbf_clear_error();
+}
+
+/* Test the polynomial kernels: exact points, accuracy, error cases */
+TEST(test_mbf_transcendental) {
+    ASSERT_MBF_EQ(mbf_sin(MBF_ZERO), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_cos(MBF_ZERO), MBF_ONE);
+    ASSERT_MBF_EQ(mbf_tan(MBF_ZERO), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_atn(MBF_ZERO), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_log(MBF_ONE), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_exp(MBF_ZERO), MBF_ONE);
+    ASSERT_MBF_EQ(mbf_sqr(mbf_from_int16(16)), mbf_from_int16(4));
+
+    /* Within a few units of the single precision result */
+    for (int i = -2000; i <= 2000; i++) {
+        mbf_t x = mbf_from_double(i / 200.0);
+        double v = mbf_to_double(x);
+        ASSERT(fabs(mbf_to_double(mbf_sin(x)) - sin(v)) < 1e-6);
+        ASSERT(fabs(mbf_to_double(mbf_cos(x)) - cos(v)) < 1e-6);
+        ASSERT(fabs(mbf_to_double(mbf_atn(x)) - atan(v)) <= 1e-6 * fabs(atan(v)));
+        ASSERT(fabs(mbf_to_double(mbf_exp(x)) - exp(v)) <= 1e-5 * exp(v));
+
+        mbf_t y = mbf_from_double(ldexp(i + 2001, i / 100));
+        v = mbf_to_double(y);
+        ASSERT(fabs(mbf_to_double(mbf_log(y)) - log(v)) < 3e-6);
+        ASSERT(fabs(mbf_to_double(mbf_sqr(y)) - sqrt(v)) <= 2e-6 * sqrt(v));
+    }
+
+    /* Domain errors give 0 for the caller to report */
+    ASSERT_MBF_EQ(mbf_log(MBF_ZERO), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_log(mbf_from_int16(-1)), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_sqr(mbf_from_int16(-4)), MBF_ZERO);
+
+    /* EXP overflows above about 88 and underflows to 0 below -88 */
+    mbf_clear_error();
+    ASSERT_MBF_EQ(mbf_exp(mbf_from_int16(89)), MBF_ZERO);
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+    mbf_clear_error();
+    ASSERT_MBF_EQ(mbf_exp(mbf_from_int16(-89)), MBF_ZERO);
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OK);
+    ASSERT(fabs(mbf_to_double(mbf_exp(mbf_from_int16(88))) / exp(88.0) - 1) < 1e-5);
+}
+
+/* Test MBF <-> double: exact one way, rounded half away from zero back */
+TEST(test_mbf_double_conversion) {
+    /* Every exponent and sign round-trips, and has the value m * 2^(e-152) */
+    uint32_t seed = 777;
+    for (uint32_t exp = 1; exp <= 255; exp++) {
+        for (int i = 0; i < 64; i++) {
+            seed = seed * 1103515245u + 12345u;
+            mbf_t a;
+            a.raw = (exp << 24) | (seed & 0x00FFFFFF);
+            double x = mbf_to_double(a);
+            double expect = ldexp((double)((a.raw & 0x7FFFFF) | 0x800000), (int)exp - 152);
+            ASSERT(x == (mbf_is_negative(a) ? -expect : expect));
+            mbf_clear_error();
+            ASSERT_MBF_EQ(mbf_from_double(x), a);
+            ASSERT_EQ_INT(mbf_get_error(), MBF_OK);
+        }
+    }
+    ASSERT(mbf_to_double(MBF_ZERO) == 0.0);
+    ASSERT_MBF_EQ(mbf_from_double(0.0), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_from_double(-0.0), MBF_ZERO);
+
+    /* Halfway between two MBF values rounds away from zero, with carry */
+    double half = ldexp(1.0, -24);
+    ASSERT_MBF_EQ(mbf_from_double(1.0 + half), mbf_make(false, 129, 0x800001));
+    ASSERT_MBF_EQ(mbf_from_double(-(1.0 + half)), mbf_make(true, 129, 0x800001));
+    ASSERT_MBF_EQ(mbf_from_double(1.0 + half * 0.99), MBF_ONE);
+    ASSERT_MBF_EQ(mbf_from_double(2.0 - half), mbf_from_int16(2));
+
+    /* Out of range */
+    ASSERT_MBF_EQ(mbf_from_double(ldexp(1.0, -129)), MBF_ZERO);
+    ASSERT_MBF_EQ(mbf_from_double(1e-300), MBF_ZERO);
+    mbf_clear_error();
+    ASSERT_MBF_EQ(mbf_from_double(ldexp(1.0, 127)), MBF_ZERO);
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+    mbf_clear_error();
+    mbf_from_double(INFINITY);
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+    mbf_clear_error();
+    mbf_from_double(NAN);
+    ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+    mbf_clear_error();
+}
+
 /* Run all tests */
 void run_tests(void) {
     RUN_TEST(test_mbf_zero);
@@ -268,19 +558,26 @@ void run_tests(void) {
     RUN_TEST(test_mbf_add_positive);
     RUN_TEST(test_mbf_add_mixed);
     RUN_TEST(test_mbf_add_to_zero);
+    RUN_TEST(test_mbf_add_round);
     RUN_TEST(test_mbf_sub);
+    RUN_TEST(test_mbf_mul_8080);
     RUN_TEST(test_mbf_mul_simple);
     RUN_TEST(test_mbf_mul_negative);
     RUN_TEST(test_mbf_mul_both_negative);
     RUN_TEST(test_mbf_mul_zero);
     RUN_TEST(test_mbf_div_simple);
+    RUN_TEST(test_mbf_div_round);
     RUN_TEST(test_mbf_div_by_zero);
     RUN_TEST(test_mbf_neg);
     RUN_TEST(test_mbf_abs);
     RUN_TEST(test_mbf_cmp);
+    RUN_TEST(test_mbf_cmp_order);
     RUN_TEST(test_mbf_int);
     RUN_TEST(test_mbf_sign);
     RUN_TEST(test_mbf_mul_large);
+    RUN_TEST(test_mbf_pow);
+    RUN_TEST(test_mbf_transcendental);
+    RUN_TEST(test_mbf_double_conversion);
 }
 
 TEST_MAIN()
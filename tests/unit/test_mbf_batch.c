@@ -0,0 +1,262 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Copyright (c) 2025 Tim Buchalka
+ * Based on Altair 8K BASIC 4.0, Copyright (c) 1976 Microsoft
+ */
+
+/*
+ * test_mbf_batch.c - Batched MBF operations against the scalar functions
+ *
+ * Every implementation this CPU supports (scalar, SSE2, AVX2) must give
+ * bit-identical results and leave the same error flag as a loop over
+ * mbf_add(), mbf_mul(), mbf_cmp() and mbf_from_int16(). Inputs cover
+ * every exponent pair, mantissas at the rounding and carry edges, and a
+ * large random sample; batch lengths vary so the scalar tails run too.
+ * The batched transcendentals (mbf_sin_n() etc.) are checked the same way.
+ */
+
+#include "test_harness.h"
+#include "basic/mbf.h"
+#include <stdlib.h>
+
+/* Values per checked batch (not a multiple of 4 or 8) */
+#define BATCH 61
+
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Mantissa patterns at the edges of rounding, carries and cancellation */
+static const uint32_t edge_mantissas[] = {
+    0x000000, 0x7FFFFF, 0x000001, 0x400000, 0x7FFF80, 0x00007F, 0x000080, 0x555555
+};
+#define EDGES (sizeof(edge_mantissas) / sizeof(edge_mantissas[0]))
+
+static mbf_t make_raw(uint32_t exp, uint32_t sign, uint32_t mant) {
+    mbf_t v;
+    v.raw = (exp << 24) | (sign << 23) | (mant & 0x7FFFFF);
+    return v;
+}
+
+/* Compare one batch of each binary operation against the scalar loop */
+static int check_batch(const mbf_t *a, const mbf_t *b, size_t n) {
+    mbf_t expect[BATCH], got[BATCH];
+    int8_t cmp_expect[BATCH], cmp_got[BATCH];
+
+    mbf_clear_error();
+    for (size_t i = 0; i < n; i++) expect[i] = mbf_add(a[i], b[i]);
+    mbf_error_t err_expect = mbf_get_error();
+    mbf_clear_error();
+    mbf_add_n(got, a, b, n);
+    if (mbf_get_error() != err_expect) return 0;
+    for (size_t i = 0; i < n; i++) {
+        if (got[i].raw != expect[i].raw) {
+            printf("\n  add %08X + %08X: %08X, expected %08X",
+                   a[i].raw, b[i].raw, got[i].raw, expect[i].raw);
+            return 0;
+        }
+    }
+
+    mbf_clear_error();
+    for (size_t i = 0; i < n; i++) expect[i] = mbf_mul(a[i], b[i]);
+    err_expect = mbf_get_error();
+    mbf_clear_error();
+    mbf_mul_n(got, a, b, n);
+    if (mbf_get_error() != err_expect) return 0;
+    for (size_t i = 0; i < n; i++) {
+        if (got[i].raw != expect[i].raw) {
+            printf("\n  mul %08X * %08X: %08X, expected %08X",
+                   a[i].raw, b[i].raw, got[i].raw, expect[i].raw);
+            return 0;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) cmp_expect[i] = (int8_t)mbf_cmp(a[i], b[i]);
+    mbf_cmp_n(cmp_got, a, b, n);
+    for (size_t i = 0; i < n; i++) {
+        if (cmp_got[i] != cmp_expect[i]) return 0;
+    }
+    return 1;
+}
+
+/* All exponent pairs, edge mantissas and both signs */
+static int check_exponent_pairs(void) {
+    mbf_t a[BATCH], b[BATCH];
+    size_t n = 0;
+    for (uint32_t ea = 0; ea < 256; ea++) {
+        for (uint32_t eb = 0; eb < 256; eb++) {
+            uint32_t r = rng();
+            a[n] = make_raw(ea, r & 1, edge_mantissas[(r >> 1) % EDGES]);
+            b[n] = make_raw(eb, (r >> 8) & 1, edge_mantissas[(r >> 9) % EDGES]);
+            if (++n == BATCH) {
+                if (!check_batch(a, b, n)) return 0;
+                n = 0;
+            }
+        }
+    }
+    return n == 0 || check_batch(a, b, n);
+}
+
+/* Nearby exponents (where addition cancels or carries), random mantissas */
+static int check_close_exponents(void) {
+    mbf_t a[BATCH], b[BATCH];
+    for (int round = 0; round < 4000; round++) {
+        size_t n = 1 + rng() % BATCH;
+        for (size_t i = 0; i < n; i++) {
+            uint32_t r = rng();
+            uint32_t ea = 1 + r % 255;
+            int eb = (int)ea + (int)((r >> 8) % 53) - 26;
+            if (eb < 0) eb = 0;
+            if (eb > 255) eb = 255;
+            a[i] = make_raw(ea, (r >> 16) & 1, rng());
+            b[i] = make_raw((uint32_t)eb, (r >> 17) & 1, rng());
+            if ((r >> 18) % 4 == 0) b[i].raw = (b[i].raw & 0xFF000000u) | (a[i].raw & 0xFFFFFF);
+        }
+        if (!check_batch(a, b, n)) return 0;
+    }
+    return 1;
+}
+
+/* Uniformly random bit patterns */
+static int check_random(void) {
+    mbf_t a[BATCH], b[BATCH];
+    for (int round = 0; round < 4000; round++) {
+        size_t n = 1 + rng() % BATCH;
+        for (size_t i = 0; i < n; i++) {
+            a[i].raw = rng();
+            b[i].raw = rng();
+        }
+        if (!check_batch(a, b, n)) return 0;
+    }
+    return 1;
+}
+
+/* Test add/mul/cmp with every supported implementation */
+TEST(test_batch_binary) {
+    for (int level = MBF_BATCH_SCALAR; level <= MBF_BATCH_AVX2; level++) {
+        if (!mbf_batch_use((mbf_batch_level_t)level)) continue;
+        rng_state = 0x12345678u;
+        ASSERT(check_exponent_pairs());
+        ASSERT(check_close_exponents());
+        ASSERT(check_random());
+    }
+    mbf_batch_use(MBF_BATCH_SCALAR);
+}
+
+/* Test every int16 value with every supported implementation */
+TEST(test_batch_from_int16) {
+    static int16_t in[65536];
+    static mbf_t out[65536];
+    for (int i = 0; i < 65536; i++) in[i] = (int16_t)(i - 32768);
+
+    for (int level = MBF_BATCH_SCALAR; level <= MBF_BATCH_AVX2; level++) {
+        if (!mbf_batch_use((mbf_batch_level_t)level)) continue;
+        mbf_from_int16_n(out, in, 65536);
+        for (int i = 0; i < 65536; i++) {
+            ASSERT_MBF_EQ(out[i], mbf_from_int16(in[i]));
+        }
+
+        /* Odd lengths end in the scalar tail */
+        mbf_from_int16_n(out, in + 7, 13);
+        for (int i = 0; i < 13; i++) {
+            ASSERT_MBF_EQ(out[i], mbf_from_int16(in[i + 7]));
+        }
+    }
+    mbf_batch_use(MBF_BATCH_SCALAR);
+}
+
+/* Test that the error flag ends as the last failing element leaves it */
+TEST(test_batch_error_order) {
+    mbf_t big = make_raw(0xFF, 0, 0x7FFFFF);
+    mbf_t tiny = make_raw(0x01, 0, 0);
+    mbf_t one = MBF_ONE;
+    mbf_t a[16], b[16], out[16];
+
+    for (int level = MBF_BATCH_SCALAR; level <= MBF_BATCH_AVX2; level++) {
+        if (!mbf_batch_use((mbf_batch_level_t)level)) continue;
+
+        /* Overflow at 2, underflow at 5, plain products after */
+        for (int i = 0; i < 16; i++) {
+            a[i] = one;
+            b[i] = one;
+        }
+        a[2] = big;  b[2] = big;
+        a[5] = tiny; b[5] = tiny;
+        mbf_clear_error();
+        mbf_mul_n(out, a, b, 16);
+        ASSERT_EQ_INT(mbf_get_error(), MBF_UNDERFLOW);
+
+        /* And the other way round */
+        a[2] = tiny; b[2] = tiny;
+        a[5] = big;  b[5] = big;
+        mbf_clear_error();
+        mbf_mul_n(out, a, b, 16);
+        ASSERT_EQ_INT(mbf_get_error(), MBF_OVERFLOW);
+
+        /* No errors leave an earlier flag alone, out may alias a */
+        mbf_set_error(MBF_DIV_ZERO);
+        mbf_add_n(a, a, a, 2);
+        ASSERT_EQ_INT(mbf_get_error(), MBF_DIV_ZERO);
+        ASSERT_MBF_EQ(a[0], mbf_from_int16(2));
+    }
+    mbf_clear_error();
+    mbf_batch_use(MBF_BATCH_SCALAR);
+}
+
+/* Test the batched transcendentals against their scalar functions */
+TEST(test_batch_functions) {
+    static mbf_t (*const scalar[])(mbf_t) = {
+        mbf_sqr, mbf_sin, mbf_cos, mbf_tan, mbf_atn, mbf_log, mbf_exp
+    };
+    static void (*const batched[])(mbf_t *, const mbf_t *, size_t) = {
+        mbf_sqr_n, mbf_sin_n, mbf_cos_n, mbf_tan_n, mbf_atn_n, mbf_log_n, mbf_exp_n
+    };
+    mbf_t in[BATCH], got[BATCH];
+
+    rng_state = 0x12345678u;
+    for (int round = 0; round < 200; round++) {
+        /* Exponents around 1.0 (and some zeros), both signs */
+        for (size_t i = 0; i < BATCH; i++) {
+            uint32_t r = rng();
+            uint32_t exp = (r >> 24) % 16 == 0 ? 0 : 110 + (r >> 24) % 40;
+            in[i] = make_raw(exp, r & 1, r >> 1);
+        }
+        for (size_t f = 0; f < sizeof(scalar) / sizeof(scalar[0]); f++) {
+            mbf_clear_error();
+            mbf_t expect_last = MBF_ZERO;
+            for (size_t i = 0; i < BATCH; i++) expect_last = scalar[f](in[i]);
+            mbf_error_t err_expect = mbf_get_error();
+
+            mbf_clear_error();
+            batched[f](got, in, BATCH);
+            ASSERT_EQ_INT(mbf_get_error(), err_expect);
+            ASSERT_MBF_EQ(got[BATCH - 1], expect_last);
+            for (size_t i = 0; i < BATCH; i++) {
+                ASSERT_MBF_EQ(got[i], scalar[f](in[i]));
+            }
+        }
+    }
+
+    /* out may be the same array as in */
+    in[0] = MBF_ZERO;
+    in[1] = mbf_from_int16(4);
+    mbf_sqr_n(in, in, 2);
+    ASSERT_MBF_EQ(in[0], MBF_ZERO);
+    ASSERT_MBF_EQ(in[1], mbf_from_int16(2));
+    mbf_clear_error();
+}
+
+/* Run all tests */
+void run_tests(void) {
+    RUN_TEST(test_batch_binary);
+    RUN_TEST(test_batch_from_int16);
+    RUN_TEST(test_batch_error_order);
+    RUN_TEST(test_batch_functions);
+}
+
+TEST_MAIN()
@@ -291,6 +291,12 @@ TEST(test_string_compare) {
     ASSERT_EQ_INT(string_compare(state, a, d), 1);   /* ABC > AB */
     ASSERT_EQ_INT(string_compare(state, d, a), -1);  /* AB < ABC */
 
+    string_desc_t e = string_create(state, "");
+    string_desc_t f = string_create(state, "\xC8");
+    ASSERT_EQ_INT(string_compare(state, e, e), 0);   /* "" = "" */
+    ASSERT_EQ_INT(string_compare(state, e, d), -1);  /* "" < AB */
+    ASSERT_EQ_INT(string_compare(state, f, a), 1);   /* Bytes are unsigned */
+
     basic_free(state);
 }
 
@@ -26,6 +26,16 @@ static mbf_t eval_str(const char *expr) {
     return eval_expression(NULL, tokenized, tok_len, &consumed, &error);
 }
 
+/* Helper: tokenize and evaluate an expression, returning the error */
+static basic_error_t eval_error(const char *expr) {
+    uint8_t tokenized[256];
+    size_t tok_len = tokenize_line(expr, tokenized, sizeof(tokenized));
+    size_t consumed;
+    basic_error_t error;
+    eval_expression(NULL, tokenized, tok_len, &consumed, &error);
+    return error;
+}
+
 /* Helper: evaluate and convert to int */
 static int eval_int(const char *expr) {
     mbf_t result = eval_str(expr);
@@ -93,6 +103,13 @@ TEST(test_parse_power) {
     ASSERT_EQ_INT(eval_int("3^2"), 9);
     ASSERT_EQ_INT(eval_int("2^10"), 1024);
     ASSERT_EQ_INT(eval_int("10^0"), 1);
+    ASSERT_EQ_INT(eval_int("2^14"), 16384);
+    ASSERT_EQ_INT(eval_int("2^-2*8"), 2);
+    ASSERT_EQ_INT(eval_int("81^.5"), 9);
+    ASSERT_EQ_INT(eval_int("-2^-1*4"), -2);
+    ASSERT_EQ_INT(eval_error("2^130"), ERR_OV);
+    ASSERT_EQ_INT(eval_error("(-8)^.5"), ERR_FC);
+    ASSERT_EQ_INT(eval_error("(-8)^3"), ERR_NONE);
 }
 
 /* Test comparison operators */
@@ -156,6 +173,147 @@ TEST(test_parse_complex) {
     ASSERT_EQ_INT(eval_int("ABS(-10)+SGN(5)*5"), 15);
 }
 
+/* Test folded constants are bit-identical to unfolded evaluation */
+TEST(test_fold_audit) {
+    static const char *exprs[] = {
+        "3.14159/180", "2^8", "-3^2", "1E-5*3+7", ".5E+2",
+        "SQR(2)*SQR(2)-2", "(1+2)*(3+4)/7-1/3", "1/3+1/3+1/3-1",
+        "SIN(1)/COS(1)-TAN(1)", "LOG(10)/LOG(2)", "EXP(1)*ATN(1)",
+        "NOT 0 AND 5 OR 2", "(1<2)+(3>=3)", "ABS(-5)+SGN(-2)+INT(-2.5)",
+        "2*3+X*2", "X*3.14159/180", "1.1*1.1*1.1+X", "123456789*10"
+    };
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .input = stdin,
+        .output = stdout
+    };
+
+    for (size_t i = 0; i < sizeof(exprs) / sizeof(exprs[0]); i++) {
+        basic_state_t *state = basic_init(&config);
+        ASSERT(state != NULL);
+
+        /* Evaluate three times: the last passes use the fold table */
+        char line[128];
+        snprintf(line, sizeof(line), "20 A=%s", exprs[i]);
+        basic_execute_line(state, "10 FOR I=1 TO 3");
+        basic_execute_line(state, line);
+        basic_execute_line(state, "30 NEXT I");
+        basic_execute_line(state, "RUN");
+
+        mbf_t folded = var_get_numeric(state, "A");
+        ASSERT_EQ_HEX(folded.raw, eval_str(exprs[i]).raw);
+        ASSERT(fold_constant_spans(state) > 0);
+        basic_free(state);
+    }
+}
+
+/* Test spans known not to be constant follow their variables and edits */
+TEST(test_fold_varying) {
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .input = stdin,
+        .output = stdout
+    };
+    basic_state_t *state = basic_init(&config);
+    ASSERT(state != NULL);
+
+    basic_execute_line(state, "10 FOR I=1 TO 4");
+    basic_execute_line(state, "20 S=S+I");
+    basic_execute_line(state, "30 NEXT I");
+    basic_execute_line(state, "RUN");
+    ASSERT_EQ_HEX(var_get_numeric(state, "S").raw, mbf_from_int16(10).raw);
+    size_t before = fold_constant_spans(state);
+
+    /* Same offsets, now constant: the old marks must not hide them */
+    basic_execute_line(state, "20 S=S+(3+4)");
+    basic_execute_line(state, "RUN");
+    ASSERT_EQ_HEX(var_get_numeric(state, "S").raw, mbf_from_int16(28).raw);
+    ASSERT(fold_constant_spans(state) > before);
+    basic_free(state);
+}
+
+/* Test expressions with nothing to fold are marked plain until an edit */
+TEST(test_fold_plain) {
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .input = stdin,
+        .output = stdout
+    };
+    basic_state_t *state = basic_init(&config);
+    ASSERT(state != NULL);
+
+    /* Lone numbers and variables only: evaluated the same once plain */
+    basic_execute_line(state, "10 K=2: FOR I=1 TO 3");
+    basic_execute_line(state, "20 S=S+I*(K-1)/2+(I-2)*4");
+    basic_execute_line(state, "30 NEXT I");
+    basic_execute_line(state, "RUN");
+    ASSERT_EQ_HEX(var_get_numeric(state, "S").raw, mbf_from_int16(3).raw);
+
+    /* Marks belong to one version of the program */
+    uint16_t at = state->program_start;
+    fold_store_plain(state, at);
+    ASSERT(fold_plain(state, at));
+    basic_execute_line(state, "20 S=S+I*(K-1)/2+(2*3)");
+    ASSERT(!fold_plain(state, at));
+
+    /* A constant span keeps the expression folding on every pass */
+    basic_execute_line(state, "RUN");
+    ASSERT_EQ_HEX(var_get_numeric(state, "S").raw, mbf_from_int16(21).raw);
+    ASSERT(fold_constant_spans(state) > 0);
+    basic_free(state);
+}
+
+/* Test the subscript shortcut against mbf_to_int16() of the full parser */
+TEST(test_eval_int_operand) {
+    basic_config_t config = {
+        .memory_size = BASIC8K_DEFAULT_MEMORY,
+        .terminal_width = BASIC8K_DEFAULT_WIDTH,
+        .input = stdin,
+        .output = stdout
+    };
+    basic_state_t *state = basic_init(&config);
+    ASSERT(state != NULL);
+
+    const uint8_t text[] = "XY)";
+    size_t consumed;
+    int16_t value;
+    bool overflow, expect_overflow;
+
+    /* Every exponent near the int16 range, edge and random mantissas, both signs */
+    uint32_t seed = 12345;
+    for (uint32_t exponent = 0; exponent < 256; exponent++) {
+        for (int k = 0; k < 64; k++) {
+            seed = seed * 1103515245u + 12345u;
+            uint32_t mantissa = seed >> 8;
+            if (k < 16) mantissa &= ~0u << (k + 8);     /* Exact integers */
+            if (k == 16) mantissa = 0x7FFFFF;
+            mbf_t v;
+            v.raw = (exponent << 24) | ((uint32_t)(k & 1) << 23) | (mantissa & 0x7FFFFF);
+            var_set_numeric(state, "XY", v);
+
+            ASSERT(eval_int_operand(state, text, 3, &consumed, &value, &overflow));
+            ASSERT_EQ_INT(consumed, 2);
+            int16_t expect = mbf_to_int16(eval_expression(state, text, 2, NULL, NULL),
+                                          &expect_overflow);
+            ASSERT_EQ_INT(value, expect);
+            ASSERT_EQ_INT(overflow, expect_overflow);
+        }
+    }
+
+    /* Literals up to 32767 only, and only before ',' or ')' */
+    ASSERT(eval_int_operand(state, (const uint8_t *)"32767,", 6, &consumed, &value, &overflow));
+    ASSERT_EQ_INT(value, 32767);
+    ASSERT_EQ_INT(consumed, 5);
+    ASSERT(!eval_int_operand(state, (const uint8_t *)"32768)", 6, &consumed, &value, &overflow));
+    ASSERT(!eval_int_operand(state, (const uint8_t *)"1.5)", 4, &consumed, &value, &overflow));
+    ASSERT(!eval_int_operand(state, (const uint8_t *)"X$)", 3, &consumed, &value, &overflow));
+    ASSERT(!eval_int_operand(state, (const uint8_t *)"X)", 1, &consumed, &value, &overflow));
+    basic_free(state);
+}
+
 /* Run all tests */
 void run_tests(void) {
     RUN_TEST(test_parse_integer);
@@ -172,6 +330,10 @@ void run_tests(void) {
     RUN_TEST(test_parse_logical);
     RUN_TEST(test_parse_functions);
     RUN_TEST(test_parse_complex);
+    RUN_TEST(test_fold_audit);
+    RUN_TEST(test_fold_varying);
+    RUN_TEST(test_fold_plain);
+    RUN_TEST(test_eval_int_operand);
 }
 
 TEST_MAIN()